@@ -0,0 +1,120 @@
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>			// #include this (massive, platform-specific) header in VERY few places (and .CPPs only)
+#include "Engine/Core/AppendOnlyMappedFile.hpp"
+
+AppendOnlyMappedFile::~AppendOnlyMappedFile()
+{
+	Close();
+}
+
+bool AppendOnlyMappedFile::Open( std::string const& filename, bool discardOldContents )
+{
+	Close();
+	HANDLE fileHandle = CreateFileA( filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+		discardOldContents ? CREATE_ALWAYS : OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if (fileHandle == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx( fileHandle, &fileSize )) {
+		CloseHandle( fileHandle );
+		return false;
+	}
+	m_fileHandle = fileHandle;
+	m_fileSize = (uint64_t)fileSize.QuadPart;
+	return true;
+}
+
+void AppendOnlyMappedFile::Close()
+{
+	UnmapView();
+	if (m_fileHandle) {
+		CloseHandle( (HANDLE)m_fileHandle );
+		m_fileHandle = nullptr;
+	}
+	m_fileSize = 0;
+}
+
+bool AppendOnlyMappedFile::IsOpen() const
+{
+	return m_fileHandle != nullptr;
+}
+
+int64_t AppendOnlyMappedFile::Append( void const* data, size_t size )
+{
+	if (m_fileHandle == nullptr) {
+		return -1;
+	}
+	// write at an explicit offset so nothing depends on where the file pointer was left
+	OVERLAPPED overlapped = {};
+	overlapped.Offset = (DWORD)(m_fileSize & 0xffffffffull);
+	overlapped.OffsetHigh = (DWORD)(m_fileSize >> 32);
+	uint8_t const* bytes = (uint8_t const*)data;
+	size_t numOfBytesLeft = size;
+	while (numOfBytesLeft > 0) {
+		DWORD numOfBytesToWrite = numOfBytesLeft > 0x40000000 ? 0x40000000 : (DWORD)numOfBytesLeft;
+		DWORD numOfBytesWritten = 0;
+		if (!WriteFile( (HANDLE)m_fileHandle, bytes, numOfBytesToWrite, &numOfBytesWritten, &overlapped ) || numOfBytesWritten == 0) {
+			return -1;
+		}
+		bytes += numOfBytesWritten;
+		numOfBytesLeft -= numOfBytesWritten;
+		uint64_t nextOffset = ((uint64_t)overlapped.OffsetHigh << 32 | overlapped.Offset) + numOfBytesWritten;
+		overlapped.Offset = (DWORD)(nextOffset & 0xffffffffull);
+		overlapped.OffsetHigh = (DWORD)(nextOffset >> 32);
+	}
+	int64_t startOffset = (int64_t)m_fileSize;
+	m_fileSize += size;
+	return startOffset;
+}
+
+uint8_t const* AppendOnlyMappedFile::GetReadPointer( uint64_t offset, size_t size )
+{
+	if (offset + size > m_fileSize) {
+		return nullptr;
+	}
+	if (offset + size > m_mappedSize && !RemapView()) {
+		return nullptr;
+	}
+	return m_view + offset;
+}
+
+uint64_t AppendOnlyMappedFile::GetSize() const
+{
+	return m_fileSize;
+}
+
+bool AppendOnlyMappedFile::RemapView()
+{
+	UnmapView();
+	if (m_fileHandle == nullptr || m_fileSize == 0) {
+		return false;
+	}
+	// size 0 maps the whole file as it is now, later appends need another remap to be seen
+	HANDLE mappingHandle = CreateFileMappingA( (HANDLE)m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if (mappingHandle == nullptr) {
+		return false;
+	}
+	void* view = MapViewOfFile( mappingHandle, FILE_MAP_READ, 0, 0, 0 );
+	if (view == nullptr) {
+		CloseHandle( mappingHandle );
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+	m_view = (uint8_t const*)view;
+	m_mappedSize = m_fileSize;
+	return true;
+}
+
+void AppendOnlyMappedFile::UnmapView()
+{
+	if (m_view) {
+		UnmapViewOfFile( m_view );
+		m_view = nullptr;
+	}
+	if (m_mappingHandle) {
+		CloseHandle( (HANDLE)m_mappingHandle );
+		m_mappingHandle = nullptr;
+	}
+	m_mappedSize = 0;
+}
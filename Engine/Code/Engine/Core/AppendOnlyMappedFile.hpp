@@ -0,0 +1,36 @@
+#pragma once
+#include <string>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------------------------
+// A file that only grows at its end and is read back through a memory mapping
+// Appends go through the file handle, the read view is remapped when it does not cover the bytes asked for yet
+// Not thread safe, callers that read and append from several threads need their own lock
+class AppendOnlyMappedFile {
+public:
+	AppendOnlyMappedFile() {}
+	AppendOnlyMappedFile( AppendOnlyMappedFile const& copyFrom ) = delete;
+	~AppendOnlyMappedFile();
+
+	/// Open or create the file, discardOldContents empties it first, return false if the file cannot be opened
+	bool Open( std::string const& filename, bool discardOldContents );
+	void Close();
+	bool IsOpen() const;
+
+	/// Write the bytes at the end of the file, return the offset they start at or -1 if the write failed
+	int64_t Append( void const* data, size_t size );
+	/// Get the bytes in [offset, offset + size), nullptr if they are not in the file
+	/// The pointer is only valid until the next Append or Close
+	uint8_t const* GetReadPointer( uint64_t offset, size_t size );
+	uint64_t GetSize() const;
+
+protected:
+	bool RemapView();
+	void UnmapView();
+
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+	uint8_t const* m_view = nullptr;
+	uint64_t m_mappedSize = 0;
+	uint64_t m_fileSize = 0;
+};
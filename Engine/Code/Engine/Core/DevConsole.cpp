@@ -9,6 +9,9 @@
 #include "Engine/Input/InputSystem.hpp"
 #include "Engine/Core/Timer.hpp"
 #include "Engine/NetSystem/NetSystem.hpp"
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+#include "Engine/Core/HeatMaps.hpp"
 
 
 DevConsole* g_devConsole = nullptr;
@@ -50,6 +53,12 @@ void DevConsole::Startup()
 	g_theEventSystem->SubscribeEventCallbackFunction( "help", Command_Help );
 	g_theEventSystem->SubscribeEventCallbackFunction( "remoteCommand", Command_RemoteCommand );
 	g_theEventSystem->SubscribeEventCallbackFunction( "BurstTest", Command_BurstTest );
+	g_theEventSystem->SubscribeEventCallbackFunction( "Command_JobSystemBenchmark", JobSystem::Command_Benchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "JobSystemBenchmark", JobSystem::Command_Benchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "Command_ParallelForBenchmark", Command_ParallelForBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "ParallelForBenchmark", Command_ParallelForBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "Command_DistanceFieldBenchmark", Command_DistanceFieldBenchmark );
+	g_theEventSystem->SubscribeEventCallbackFunction( "DistanceFieldBenchmark", Command_DistanceFieldBenchmark );
 }
 
 void DevConsole::Shutdown()
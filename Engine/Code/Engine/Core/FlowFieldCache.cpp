@@ -0,0 +1,279 @@
+#include "Engine/Core/FlowFieldCache.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+FlowField::FlowField( IntVec2 const& dimensions )
+	:m_dimensions( dimensions )
+	,m_distanceField( dimensions )
+{
+	m_directions.resize( (size_t)dimensions.x * dimensions.y, FlowDirection::NONE );
+}
+
+IntVec2 const& FlowField::GetGoalCoords() const
+{
+	return m_goalCoords;
+}
+
+int FlowField::GetPassability() const
+{
+	return m_passability;
+}
+
+TileHeatMap const& FlowField::GetDistanceField() const
+{
+	return m_distanceField;
+}
+
+float FlowField::GetDistance( IntVec2 const& tileCoords ) const
+{
+	return m_distanceField.GetTileValue( tileCoords, FLT_MAX );
+}
+
+bool FlowField::CanReachGoal( IntVec2 const& tileCoords ) const
+{
+	return GetDistance( tileCoords ) != FLT_MAX;
+}
+
+FlowDirection FlowField::GetDirection( IntVec2 const& tileCoords ) const
+{
+	if (tileCoords.x < 0 || tileCoords.x >= m_dimensions.x || tileCoords.y < 0 || tileCoords.y >= m_dimensions.y) {
+		return FlowDirection::NONE;
+	}
+	return m_directions[(size_t)tileCoords.y * m_dimensions.x + tileCoords.x];
+}
+
+IntVec2 const FlowField::GetNextTileCoords( IntVec2 const& tileCoords ) const
+{
+	switch (GetDirection( tileCoords )) {
+	case FlowDirection::EAST: return tileCoords + IntVec2( 1, 0 );
+	case FlowDirection::WEST: return tileCoords + IntVec2( -1, 0 );
+	case FlowDirection::NORTH: return tileCoords + IntVec2( 0, 1 );
+	case FlowDirection::SOUTH: return tileCoords + IntVec2( 0, -1 );
+	default: return tileCoords;
+	}
+}
+
+FlowFieldCache::FlowFieldCache( IntVec2 const& dimensions, int numOfPassabilities, int maxNumOfUnusedFields )
+	:m_dimensions( dimensions )
+	,m_numOfPassabilities( numOfPassabilities )
+	,m_maxNumOfUnusedFields( maxNumOfUnusedFields )
+{
+	GUARANTEE_OR_DIE( dimensions.x > 0 && dimensions.y > 0 && numOfPassabilities > 0, "Flow field cache needs a map and at least one passability" );
+	size_t numOfTiles = (size_t)dimensions.x * dimensions.y;
+	m_blockedTiles.resize( numOfPassabilities, std::vector<unsigned char>( numOfTiles, 0 ) );
+	// regions start out of date so the first query floods them
+	m_versions.resize( numOfPassabilities, 1 );
+	m_regions.resize( numOfPassabilities, std::vector<int>( numOfTiles, -1 ) );
+	m_regionVersions.resize( numOfPassabilities, 0 );
+	m_queue.resize( numOfTiles );
+}
+
+FlowFieldCache::~FlowFieldCache()
+{
+	for (auto& pair : m_flowFields) {
+		delete pair.second;
+	}
+	m_flowFields.clear();
+}
+
+void FlowFieldCache::SetTileBlocked( int passability, IntVec2 const& tileCoords, bool isBlocked )
+{
+	unsigned char& blocked = m_blockedTiles[passability][(size_t)tileCoords.y * m_dimensions.x + tileCoords.x];
+	if ((blocked != 0) != isBlocked) {
+		blocked = isBlocked ? 1 : 0;
+		++m_versions[passability];
+	}
+}
+
+bool FlowFieldCache::IsTileBlocked( int passability, IntVec2 const& tileCoords ) const
+{
+	if (!IsCoordsInBounds( tileCoords )) {
+		return true;
+	}
+	return m_blockedTiles[passability][(size_t)tileCoords.y * m_dimensions.x + tileCoords.x] != 0;
+}
+
+unsigned int FlowFieldCache::GetVersion( int passability ) const
+{
+	return m_versions[passability];
+}
+
+void FlowFieldCache::InvalidateAllFlowFields()
+{
+	for (auto& version : m_versions) {
+		++version;
+	}
+}
+
+FlowField const* FlowFieldCache::AcquireFlowField( IntVec2 const& goalCoords, int passability )
+{
+	GUARANTEE_OR_DIE( IsCoordsInBounds( goalCoords ) && passability >= 0 && passability < m_numOfPassabilities, "Flow field goal or passability out of range" );
+	int key = (goalCoords.y * m_dimensions.x + goalCoords.x) * m_numOfPassabilities + passability;
+	FlowField* flowField = nullptr;
+	bool isNewField = false;
+	auto found = m_flowFields.find( key );
+	if (found != m_flowFields.end()) {
+		flowField = found->second;
+		if (flowField->m_version != m_versions[passability]) {
+			if (flowField->m_numOfUsers == 0) {
+				BuildFlowField( *flowField );
+			}
+			else {
+				// users keep the old field, the key gets a new one
+				flowField->m_isDetached = true;
+				m_flowFields.erase( found );
+				flowField = nullptr;
+			}
+		}
+	}
+	if (flowField == nullptr) {
+		flowField = new FlowField( m_dimensions );
+		flowField->m_goalCoords = goalCoords;
+		flowField->m_passability = passability;
+		BuildFlowField( *flowField );
+		m_flowFields[key] = flowField;
+		isNewField = true;
+	}
+	++flowField->m_numOfUsers;
+	flowField->m_lastUsedStamp = ++m_useStamp;
+	// after taking the new field, so it is not the one evicted
+	if (isNewField) {
+		EvictUnusedFlowFields();
+	}
+	return flowField;
+}
+
+void FlowFieldCache::ReleaseFlowField( FlowField const* flowField )
+{
+	if (flowField == nullptr) {
+		return;
+	}
+	FlowField* releasedField = const_cast<FlowField*>(flowField);
+	--releasedField->m_numOfUsers;
+	if (releasedField->m_isDetached && releasedField->m_numOfUsers <= 0) {
+		delete releasedField;
+	}
+}
+
+bool FlowFieldCache::AreTilesConnected( int passability, IntVec2 const& a, IntVec2 const& b )
+{
+	if (!IsCoordsInBounds( a ) || !IsCoordsInBounds( b )) {
+		return false;
+	}
+	if (m_regionVersions[passability] != m_versions[passability]) {
+		UpdateRegions( passability );
+	}
+	std::vector<int> const& regions = m_regions[passability];
+	int regionA = regions[(size_t)a.y * m_dimensions.x + a.x];
+	return regionA != -1 && regionA == regions[(size_t)b.y * m_dimensions.x + b.x];
+}
+
+IntVec2 const& FlowFieldCache::GetDimensions() const
+{
+	return m_dimensions;
+}
+
+int FlowFieldCache::GetNumOfCachedFlowFields() const
+{
+	return (int)m_flowFields.size();
+}
+
+int FlowFieldCache::GetNumOfBuiltFlowFields() const
+{
+	return m_numOfBuiltFlowFields;
+}
+
+void FlowFieldCache::BuildFlowField( FlowField& flowField )
+{
+	// bfs from the goal, the goal tile itself is never treated as blocked
+	unsigned char const* blockedTiles = m_blockedTiles[flowField.m_passability].data();
+	int width = m_dimensions.x;
+	TileHeatMap& distanceField = flowField.m_distanceField;
+	distanceField.PopulateDistanceField( flowField.m_goalCoords, [&]( IntVec2 const& tileCoords ) {
+		return blockedTiles[(size_t)tileCoords.y * width + tileCoords.x] == 0;
+		} );
+
+	// steepest descent per tile, checked east, west, north, south and the first of equal steps wins
+	IntVec2 const stepOffsets[4] = { IntVec2( 1, 0 ), IntVec2( -1, 0 ), IntVec2( 0, 1 ), IntVec2( 0, -1 ) };
+	FlowDirection const stepDirections[4] = { FlowDirection::EAST, FlowDirection::WEST, FlowDirection::NORTH, FlowDirection::SOUTH };
+	for (int y = 0; y < m_dimensions.y; y++) {
+		for (int x = 0; x < m_dimensions.x; x++) {
+			IntVec2 thisTile( x, y );
+			float thisTileValue = distanceField.GetTileValue( thisTile );
+			FlowDirection direction = FlowDirection::NONE;
+			float maxDecrease = -1.f;
+			for (int i = 0; i < 4; i++) {
+				float nextTileValue = distanceField.GetTileValue( thisTile + stepOffsets[i], FLT_MAX );
+				if (nextTileValue != FLT_MAX && nextTileValue < thisTileValue && thisTileValue - nextTileValue > maxDecrease) {
+					direction = stepDirections[i];
+					maxDecrease = thisTileValue - nextTileValue;
+				}
+			}
+			flowField.m_directions[(size_t)y * m_dimensions.x + x] = direction;
+		}
+	}
+	flowField.m_version = m_versions[flowField.m_passability];
+	++m_numOfBuiltFlowFields;
+}
+
+void FlowFieldCache::UpdateRegions( int passability )
+{
+	unsigned char const* blockedTiles = m_blockedTiles[passability].data();
+	std::vector<int>& regions = m_regions[passability];
+	std::fill( regions.begin(), regions.end(), -1 );
+	int* queue = m_queue.data();
+	int numOfTiles = m_dimensions.x * m_dimensions.y;
+	int numOfRegions = 0;
+	for (int seedIndex = 0; seedIndex < numOfTiles; seedIndex++) {
+		if (blockedTiles[seedIndex] != 0 || regions[seedIndex] != -1) {
+			continue;
+		}
+		int start = 0;
+		int end = 1;
+		queue[0] = seedIndex;
+		regions[seedIndex] = numOfRegions;
+		while (start < end) {
+			int tileIndex = queue[start++];
+			IntVec2 thisTile( tileIndex % m_dimensions.x, tileIndex / m_dimensions.x );
+			IntVec2 const neighbors[4] = { thisTile + IntVec2( -1, 0 ), thisTile + IntVec2( 0, -1 ), thisTile + IntVec2( 1, 0 ), thisTile + IntVec2( 0, 1 ) };
+			for (IntVec2 const& nextTile : neighbors) {
+				if (!IsCoordsInBounds( nextTile )) {
+					continue;
+				}
+				int nextTileIndex = nextTile.y * m_dimensions.x + nextTile.x;
+				if (blockedTiles[nextTileIndex] == 0 && regions[nextTileIndex] == -1) {
+					regions[nextTileIndex] = numOfRegions;
+					queue[end++] = nextTileIndex;
+				}
+			}
+		}
+		++numOfRegions;
+	}
+	m_regionVersions[passability] = m_versions[passability];
+}
+
+void FlowFieldCache::EvictUnusedFlowFields()
+{
+	std::vector<std::pair<unsigned int, int>> unusedFields;
+	for (auto const& pair : m_flowFields) {
+		if (pair.second->m_numOfUsers <= 0) {
+			unusedFields.push_back( std::pair<unsigned int, int>( pair.second->m_lastUsedStamp, pair.first ) );
+		}
+	}
+	if ((int)unusedFields.size() <= m_maxNumOfUnusedFields) {
+		return;
+	}
+	// least recently used go first
+	std::sort( unusedFields.begin(), unusedFields.end() );
+	int numOfEvictedFields = (int)unusedFields.size() - m_maxNumOfUnusedFields;
+	for (int i = 0; i < numOfEvictedFields; i++) {
+		auto found = m_flowFields.find( unusedFields[i].second );
+		delete found->second;
+		m_flowFields.erase( found );
+	}
+}
+
+bool FlowFieldCache::IsCoordsInBounds( IntVec2 const& tileCoords ) const
+{
+	return tileCoords.x >= 0 && tileCoords.x < m_dimensions.x && tileCoords.y >= 0 && tileCoords.y < m_dimensions.y;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Engine/Core/HeatMaps.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include <vector>
+#include <map>
+
+enum class FlowDirection : unsigned char { NONE, EAST, WEST, NORTH, SOUTH };
+
+//-----------------------------------------------------------------------------------------------
+// Tile distances to one goal tile and the step every tile takes towards it, built and owned by a FlowFieldCache
+// Tiles that cannot reach the goal have distance FLT_MAX, the same as a TileHeatMap distance field
+class FlowField {
+	friend class FlowFieldCache;
+public:
+	FlowField( IntVec2 const& dimensions );
+
+	IntVec2 const& GetGoalCoords() const;
+	int GetPassability() const;
+	TileHeatMap const& GetDistanceField() const;
+	/// FLT_MAX for tiles out of bound or cannot reach the goal
+	float GetDistance( IntVec2 const& tileCoords ) const;
+	bool CanReachGoal( IntVec2 const& tileCoords ) const;
+	FlowDirection GetDirection( IntVec2 const& tileCoords ) const;
+	/// Get the neighbor tile one step closer to the goal, the tile itself if there is no closer neighbor
+	IntVec2 const GetNextTileCoords( IntVec2 const& tileCoords ) const;
+
+private:
+	IntVec2 m_dimensions;
+	TileHeatMap m_distanceField;
+	std::vector<FlowDirection> m_directions;
+	IntVec2 m_goalCoords;
+	int m_passability = 0;
+	unsigned int m_version = 0;
+	int m_numOfUsers = 0;
+	unsigned int m_lastUsedStamp = 0;
+	bool m_isDetached = false; // replaced by a newer field in the cache, deleted when the last user releases it
+};
+
+//-----------------------------------------------------------------------------------------------
+// Shared flow fields of a tile map, one field per (goal tile, passability) serves every agent going to that tile
+// A passability is one set of blocked tiles, e.g. tiles a land unit cannot enter, the game decides what they mean
+// Changing a blocked tile bumps the version of its passability and the fields built on the old version are rebuilt when acquired again
+// A field stays valid until it is released, so an agent can keep sampling it while newer fields replace it
+// Not thread safe, acquire and release fields from one thread
+class FlowFieldCache {
+public:
+	FlowFieldCache( IntVec2 const& dimensions, int numOfPassabilities, int maxNumOfUnusedFields = 32 );
+	~FlowFieldCache();
+
+	/// Tiles start unblocked, setting a tile to the value it has does not invalidate anything
+	void SetTileBlocked( int passability, IntVec2 const& tileCoords, bool isBlocked );
+	/// Tiles out of bound are blocked
+	bool IsTileBlocked( int passability, IntVec2 const& tileCoords ) const;
+	unsigned int GetVersion( int passability ) const;
+	/// Make every field rebuild when acquired again, fields in use stay as they are
+	void InvalidateAllFlowFields();
+
+	/// Get the field to the goal tile, build it if it is not cached or out of date, release it when done with it
+	FlowField const* AcquireFlowField( IntVec2 const& goalCoords, int passability );
+	void ReleaseFlowField( FlowField const* flowField );
+
+	/// Whether an agent on tile a can get to tile b, both tiles need to be unblocked
+	bool AreTilesConnected( int passability, IntVec2 const& a, IntVec2 const& b );
+
+	IntVec2 const& GetDimensions() const;
+	int GetNumOfCachedFlowFields() const;
+	/// How many fields were built from the start, a cache hit does not build one
+	int GetNumOfBuiltFlowFields() const;
+
+private:
+	void BuildFlowField( FlowField& flowField );
+	void UpdateRegions( int passability );
+	void EvictUnusedFlowFields();
+	bool IsCoordsInBounds( IntVec2 const& tileCoords ) const;
+
+private:
+	IntVec2 m_dimensions;
+	int m_numOfPassabilities = 0;
+	int m_maxNumOfUnusedFields = 32;
+	std::vector<std::vector<unsigned char>> m_blockedTiles;
+	std::vector<unsigned int> m_versions;
+	std::map<int, FlowField*> m_flowFields; // key is goal tile index * num of passabilities + passability
+	unsigned int m_useStamp = 0;
+	int m_numOfBuiltFlowFields = 0;
+
+	// connected regions of unblocked tiles, -1 for blocked tiles
+	std::vector<std::vector<int>> m_regions;
+	std::vector<unsigned int> m_regionVersions;
+
+	// one queue reused by every region flood fill
+	std::vector<int> m_queue;
+};
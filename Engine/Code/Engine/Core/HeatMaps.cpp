@@ -3,7 +3,28 @@
 #include "Engine/Math/MathUtils.hpp"
 #include "Engine/Core/VertexUtils.hpp"
 #include "Engine/Renderer/SimpleTriangleFont.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
 #include <string>
+#include <climits>
+#include <algorithm>
+
+TileHeatMapScratch& TileHeatMapScratch::GetForThisThread()
+{
+	thread_local TileHeatMapScratch s_scratch;
+	return s_scratch;
+}
+
+void TileHeatMapScratch::Release()
+{
+	std::vector<int>().swap( m_tileCosts );
+	std::vector<int>().swap( m_distances );
+	std::vector<int>().swap( m_queue );
+	std::vector<std::vector<int>>().swap( m_buckets );
+}
 
 TileHeatMap::TileHeatMap( IntVec2 const& dimensions )
 	:m_dimensions( dimensions )
@@ -14,9 +35,12 @@ TileHeatMap::TileHeatMap( IntVec2 const& dimensions )
 
 void TileHeatMap::SetAllValues( float newValue /*= 0.f */ )
 {
-	for (int i = 0; i < (int)m_values.size(); i++) {
-		m_values[i] = newValue;
-	}
+	// only maps bigger than one grain (128x128) are split over the job workers
+	constexpr int setValuesGrainSize = 16384;
+	float* values = m_values.data();
+	ParallelFor( 0, (int)m_values.size(), setValuesGrainSize, [&]( int i ) {
+		values[i] = newValue;
+		} );
 }
 
 void TileHeatMap::SetTileValue( IntVec2 const& tileCoords, float newValue )
@@ -53,6 +77,117 @@ float TileHeatMap::GetMaxValueExceptSpecialValue( float specialValue ) const
 	return retMaxValue;
 }
 
+int* TileHeatMap::PrepareFloodScratch( TileHeatMapScratch& scratch ) const
+{
+	int paddedWidth = m_dimensions.x + 2;
+	int paddedHeight = m_dimensions.y + 2;
+	size_t numOfPaddedTiles = (size_t)paddedWidth * paddedHeight;
+	if (scratch.m_tileCosts.size() < numOfPaddedTiles) {
+		scratch.m_tileCosts.resize( numOfPaddedTiles );
+		scratch.m_distances.resize( numOfPaddedTiles );
+		scratch.m_queue.resize( numOfPaddedTiles );
+	}
+	int* tileCosts = scratch.m_tileCosts.data();
+	std::fill( tileCosts, tileCosts + paddedWidth, 0 );
+	std::fill( tileCosts + (size_t)(paddedHeight - 1) * paddedWidth, tileCosts + numOfPaddedTiles, 0 );
+	for (int y = 1; y < paddedHeight - 1; y++) {
+		tileCosts[(size_t)y * paddedWidth] = 0;
+		tileCosts[(size_t)y * paddedWidth + paddedWidth - 1] = 0;
+	}
+	return tileCosts;
+}
+
+void TileHeatMap::FloodDistances( TileHeatMapScratch& scratch, IntVec2 const* seeds, int numOfSeeds, int maxTileCost, float seedValue, float unreachableValue )
+{
+	int paddedWidth = m_dimensions.x + 2;
+	size_t numOfPaddedTiles = (size_t)paddedWidth * (m_dimensions.y + 2);
+	int const* tileCosts = scratch.m_tileCosts.data();
+	int* distances = scratch.m_distances.data();
+	std::fill( distances, distances + numOfPaddedTiles, INT_MAX );
+	int const neighborOffsets[4] = { -1, -paddedWidth, 1, paddedWidth };
+
+	if (maxTileCost <= 1) {
+		// every step costs 1, a plain bfs
+		int* queue = scratch.m_queue.data();
+		int start = 0;
+		int end = 0;
+		for (int i = 0; i < numOfSeeds; i++) {
+			if (IsCoordsInBounds( seeds[i] )) {
+				int seedIndex = (seeds[i].y + 1) * paddedWidth + seeds[i].x + 1;
+				if (distances[seedIndex] != 0) {
+					distances[seedIndex] = 0;
+					queue[end++] = seedIndex;
+				}
+			}
+		}
+		while (start < end) {
+			int tileIndex = queue[start++];
+			int nextDistance = distances[tileIndex] + 1;
+			for (int offset : neighborOffsets) {
+				int nextTileIndex = tileIndex + offset;
+				if (tileCosts[nextTileIndex] != 0 && distances[nextTileIndex] == INT_MAX) {
+					distances[nextTileIndex] = nextDistance;
+					queue[end++] = nextTileIndex;
+				}
+			}
+		}
+	}
+	else {
+		// Dijkstra with a ring of buckets, a tile found at distance d + cost can only land maxTileCost buckets ahead
+		int numOfBuckets = maxTileCost + 1;
+		if ((int)scratch.m_buckets.size() < numOfBuckets) {
+			scratch.m_buckets.resize( numOfBuckets );
+		}
+		for (int i = 0; i < numOfBuckets; i++) {
+			scratch.m_buckets[i].clear();
+		}
+		int numOfPendingTiles = 0;
+		for (int i = 0; i < numOfSeeds; i++) {
+			if (IsCoordsInBounds( seeds[i] )) {
+				int seedIndex = (seeds[i].y + 1) * paddedWidth + seeds[i].x + 1;
+				if (distances[seedIndex] != 0) {
+					distances[seedIndex] = 0;
+					scratch.m_buckets[0].push_back( seedIndex );
+					++numOfPendingTiles;
+				}
+			}
+		}
+		for (int distance = 0; numOfPendingTiles > 0; distance++) {
+			std::vector<int>& bucket = scratch.m_buckets[distance % numOfBuckets];
+			for (int tileIndex : bucket) {
+				// a tile is queued again when a cheaper way is found, the old entry is skipped
+				if (distances[tileIndex] != distance) {
+					continue;
+				}
+				for (int offset : neighborOffsets) {
+					int nextTileIndex = tileIndex + offset;
+					int cost = tileCosts[nextTileIndex];
+					if (cost != 0 && distance + cost < distances[nextTileIndex]) {
+						distances[nextTileIndex] = distance + cost;
+						scratch.m_buckets[(distance + cost) % numOfBuckets].push_back( nextTileIndex );
+						++numOfPendingTiles;
+					}
+				}
+			}
+			numOfPendingTiles -= (int)bucket.size();
+			bucket.clear();
+		}
+	}
+
+	for (int y = 0; y < m_dimensions.y; y++) {
+		int const* rowDistances = distances + (size_t)(y + 1) * paddedWidth + 1;
+		float* rowValues = m_values.data() + (size_t)y * m_dimensions.x;
+		for (int x = 0; x < m_dimensions.x; x++) {
+			rowValues[x] = rowDistances[x] == INT_MAX ? unreachableValue : seedValue + (float)rowDistances[x];
+		}
+	}
+
+	// game maps fit in the kept scratch, one big flood does not pin its memory on this thread for good
+	if (scratch.m_tileCosts.size() > TileHeatMapScratch::MAX_NUM_OF_KEPT_TILES) {
+		scratch.Release();
+	}
+}
+
 bool TileHeatMap::RayCastVsGrid2D( RayCastResult2D& out_rayCastRes, Ray2D const& ray2D, float opaqueValue /*= FLT_MAX */ ) const
 {
 	return RayCastVsGrid2D( out_rayCastRes, ray2D.m_startPos, ray2D.m_forwardNormal, ray2D.m_maxDist, opaqueValue );
@@ -212,3 +347,123 @@ bool TileHeatMap::IsCoordsInBounds( IntVec2 const& coords ) const
 {
 	return coords.x >= 0 && coords.x < m_dimensions.x && coords.y >= 0 && coords.y < m_dimensions.y;
 }
+
+// the bfs removed from Libra's Map::PopulateHeatMapDistanceField, kept as it was with the tile tests behind isTileSolid
+// a new queue per call, a bounds check per neighbor and a heat map lookup per test
+template<typename T_SolidFunction>
+static void PopulateDistanceFieldLikeGames( TileHeatMap& out_distanceField, IntVec2 const& dimensions, IntVec2 const& startCoords, float maxCost, float minCost, T_SolidFunction const& isTileSolid )
+{
+	// bfs
+	int maxQueueLength = dimensions.x * dimensions.y;
+	IntVec2* queue = new IntVec2[maxQueueLength];
+	int start = 0;
+	int end = 1;
+	out_distanceField.SetAllValues( maxCost );
+	queue[start] = startCoords;
+	out_distanceField.SetTileValue( startCoords, minCost );
+	while (start < end) {
+		IntVec2 const& thisTile = queue[start];
+		float thisTileValue = out_distanceField.GetTileValue( thisTile );
+		if (thisTile.x >= 1) {
+			IntVec2 nextTile = thisTile + IntVec2( -1, 0 );
+			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost && !isTileSolid( nextTile )) {
+				queue[end] = nextTile;
+				end = (end + 1);
+				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
+			}
+		}
+		if (thisTile.y >= 1) {
+			IntVec2 nextTile = thisTile + IntVec2( 0, -1 );
+			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost && !isTileSolid( nextTile )) {
+				queue[end] = nextTile;
+				end = (end + 1);
+				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
+			}
+		}
+		if (thisTile.x < dimensions.x - 1) {
+			IntVec2 nextTile = thisTile + IntVec2( 1, 0 );
+			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost && !isTileSolid( nextTile )) {
+				queue[end] = nextTile;
+				end = (end + 1);
+				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
+			}
+		}
+		if (thisTile.y < dimensions.y - 1) {
+			IntVec2 nextTile = thisTile + IntVec2( 0, 1 );
+			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost && !isTileSolid( nextTile )) {
+				queue[end] = nextTile;
+				end = (end + 1);
+				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
+			}
+		}
+		start++;
+	}
+	delete[] queue;
+}
+
+bool Command_DistanceFieldBenchmark( EventArgs& args )
+{
+	Strings sizes = SplitStringOnDelimiter( args.GetValue( "sizes", "256,1024" ), ',' );
+	int repeat = atoi( args.GetValue( "repeat", "10" ).c_str() );
+	if (repeat <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "DistanceFieldBenchmark: repeat should be positive" );
+		return false;
+	}
+	for (std::string const& sizeText : sizes) {
+		int size = atoi( sizeText.c_str() );
+		if (size <= 1) {
+			continue;
+		}
+		// a quarter of the tiles are walls, weighted tiles cost 1 to 4
+		IntVec2 dimensions( size, size );
+		RandomNumberGenerator rng( 7 );
+		std::vector<unsigned char> isSolid( (size_t)size * size );
+		std::vector<int> tileCosts( (size_t)size * size );
+		for (int i = 0; i < size * size; i++) {
+			isSolid[i] = rng.RollRandomIntLessThan( 4 ) == 0 ? 1 : 0;
+			tileCosts[i] = isSolid[i] ? 0 : rng.RollRandomIntInRange( 1, 4 );
+		}
+		IntVec2 center( size / 2, size / 2 );
+		auto isTilePassable = [&]( IntVec2 const& tileCoords ) { return isSolid[(size_t)tileCoords.y * size + tileCoords.x] == 0; };
+		auto getTileCost = [&]( IntVec2 const& tileCoords ) { return tileCosts[(size_t)tileCoords.y * size + tileCoords.x]; };
+
+		TileHeatMap gameField( dimensions );
+		TileHeatMap engineField( dimensions );
+		double startTime = GetCurrentTimeSeconds();
+		for (int r = 0; r < repeat; r++) {
+			PopulateDistanceFieldLikeGames( gameField, dimensions, center, FLT_MAX, 0.f, [&]( IntVec2 const& tileCoords ) { return !isTilePassable( tileCoords ); } );
+		}
+		double gameTime = GetCurrentTimeSeconds() - startTime;
+		startTime = GetCurrentTimeSeconds();
+		for (int r = 0; r < repeat; r++) {
+			engineField.PopulateDistanceField( center, isTilePassable );
+		}
+		double bfsTime = GetCurrentTimeSeconds() - startTime;
+		int numOfMismatches = 0;
+		for (int y = 0; y < size; y++) {
+			for (int x = 0; x < size; x++) {
+				if (gameField.GetTileValue( IntVec2( x, y ) ) != engineField.GetTileValue( IntVec2( x, y ) )) {
+					++numOfMismatches;
+				}
+			}
+		}
+
+		std::vector<IntVec2> seeds;
+		for (int i = 0; i < 16; i++) {
+			seeds.push_back( IntVec2( rng.RollRandomIntLessThan( size ), rng.RollRandomIntLessThan( size ) ) );
+		}
+		startTime = GetCurrentTimeSeconds();
+		for (int r = 0; r < repeat; r++) {
+			engineField.PopulateDistanceField( seeds, isTilePassable );
+		}
+		double multiSeedTime = GetCurrentTimeSeconds() - startTime;
+		startTime = GetCurrentTimeSeconds();
+		for (int r = 0; r < repeat; r++) {
+			engineField.PopulateWeightedDistanceField( center, getTileCost, 4 );
+		}
+		double dijkstraTime = GetCurrentTimeSeconds() - startTime;
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "DistanceField %dx%d: game bfs %.3fms, engine bfs %.3fms (x%.2f, %d mismatches), 16 seeds %.3fms, weighted 1-4 %.3fms",
+			size, size, gameTime * 1000.0 / repeat, bfsTime * 1000.0 / repeat, gameTime / bfsTime, numOfMismatches, multiSeedTime * 1000.0 / repeat, dijkstraTime * 1000.0 / repeat ) );
+	}
+	return true;
+}
@@ -7,6 +7,24 @@
 
 struct AABB2;
 struct Vertex_PCU;
+class NamedProperties;
+typedef NamedProperties EventArgs;
+
+//-----------------------------------------------------------------------------------------------
+// Scratch memory of the distance field floods, one per thread and kept between calls
+// The grids have a blocked border one tile wide, so a flood steps to neighbors without bounds checks
+struct TileHeatMapScratch {
+	std::vector<int> m_tileCosts; // cost to step onto a tile, 0 means blocked
+	std::vector<int> m_distances; // INT_MAX means not reached
+	std::vector<int> m_queue;
+	std::vector<std::vector<int>> m_buckets;
+
+	/// Padded tiles kept after a flood, scratch of a bigger map is freed when its flood ends
+	static constexpr size_t MAX_NUM_OF_KEPT_TILES = 258 * 258;
+
+	static TileHeatMapScratch& GetForThisThread();
+	void Release();
+};
 
 class TileHeatMap {
 public:
@@ -22,6 +40,22 @@ public:
 	float GetTileValue( IntVec2 const& tileCoords ) const;
 	float GetTileValue( IntVec2 const& tileCoords, float outOfBoundValue ) const;
 	float GetMaxValueExceptSpecialValue( float specialValue ) const;
+
+	//---------------------------------------------------------------------
+	// Distance fields, every tile gets its distance in 4-neighbor steps to the nearest seed
+	// Seeds get seedValue and are entered even if they are blocked, tiles no seed can reach get unreachableValue
+	// The callbacks are asked once per tile before the flood, so they must not populate a heat map themselves
+	/// isTilePassable( IntVec2 const& tileCoords ) returns whether a tile can be entered, a bfs with every step costing 1
+	template<typename T_PassableFunction>
+	void PopulateDistanceField( IntVec2 const& seed, T_PassableFunction const& isTilePassable, float seedValue = 0.f, float unreachableValue = FLT_MAX );
+	template<typename T_PassableFunction>
+	void PopulateDistanceField( std::vector<IntVec2> const& seeds, T_PassableFunction const& isTilePassable, float seedValue = 0.f, float unreachableValue = FLT_MAX );
+	/// getTileCost( IntVec2 const& tileCoords ) returns the whole cost to step onto a tile, below 1 blocks the tile and above maxTileCost counts as maxTileCost
+	/// Runs a bucketed Dijkstra with maxTileCost + 1 buckets, so keep maxTileCost small
+	template<typename T_CostFunction>
+	void PopulateWeightedDistanceField( IntVec2 const& seed, T_CostFunction const& getTileCost, int maxTileCost, float seedValue = 0.f, float unreachableValue = FLT_MAX );
+	template<typename T_CostFunction>
+	void PopulateWeightedDistanceField( std::vector<IntVec2> const& seeds, T_CostFunction const& getTileCost, int maxTileCost, float seedValue = 0.f, float unreachableValue = FLT_MAX );
 	
 	//---------------------------------------------------------------------
 	// 2D Ray Cast in grids, opaque value means tiles with that value can stop the ray and the ray will impact
@@ -41,7 +75,55 @@ public:
 private:
 	IntVec2 const RoundDownPos( Vec2 const& pos ) const;
 	bool IsCoordsInBounds( IntVec2 const& coords ) const;
+	/// Size the scratch grids for this map and block their border, the caller fills the inner tile costs
+	int* PrepareFloodScratch( TileHeatMapScratch& scratch ) const;
+	void FloodDistances( TileHeatMapScratch& scratch, IntVec2 const* seeds, int numOfSeeds, int maxTileCost, float seedValue, float unreachableValue );
+	template<typename T_CostFunction>
+	void PopulateDistanceFieldFromCosts( IntVec2 const* seeds, int numOfSeeds, T_CostFunction const& getTileCost, int maxTileCost, float seedValue, float unreachableValue );
 private:
 	IntVec2 m_dimensions = IntVec2( -1, -1 );
 	std::vector<float> m_values;
-};
\ No newline at end of file
+};
+
+template<typename T_CostFunction>
+void TileHeatMap::PopulateDistanceFieldFromCosts( IntVec2 const* seeds, int numOfSeeds, T_CostFunction const& getTileCost, int maxTileCost, float seedValue, float unreachableValue )
+{
+	TileHeatMapScratch& scratch = TileHeatMapScratch::GetForThisThread();
+	int* tileCosts = PrepareFloodScratch( scratch );
+	int paddedWidth = m_dimensions.x + 2;
+	for (int y = 0; y < m_dimensions.y; y++) {
+		int* rowCosts = tileCosts + (size_t)(y + 1) * paddedWidth + 1;
+		for (int x = 0; x < m_dimensions.x; x++) {
+			int cost = getTileCost( IntVec2( x, y ) );
+			rowCosts[x] = cost < 1 ? 0 : (cost > maxTileCost ? maxTileCost : cost);
+		}
+	}
+	FloodDistances( scratch, seeds, numOfSeeds, maxTileCost, seedValue, unreachableValue );
+}
+
+template<typename T_PassableFunction>
+void TileHeatMap::PopulateDistanceField( IntVec2 const& seed, T_PassableFunction const& isTilePassable, float seedValue, float unreachableValue )
+{
+	PopulateDistanceFieldFromCosts( &seed, 1, [&]( IntVec2 const& tileCoords ) { return isTilePassable( tileCoords ) ? 1 : 0; }, 1, seedValue, unreachableValue );
+}
+
+template<typename T_PassableFunction>
+void TileHeatMap::PopulateDistanceField( std::vector<IntVec2> const& seeds, T_PassableFunction const& isTilePassable, float seedValue, float unreachableValue )
+{
+	PopulateDistanceFieldFromCosts( seeds.data(), (int)seeds.size(), [&]( IntVec2 const& tileCoords ) { return isTilePassable( tileCoords ) ? 1 : 0; }, 1, seedValue, unreachableValue );
+}
+
+template<typename T_CostFunction>
+void TileHeatMap::PopulateWeightedDistanceField( IntVec2 const& seed, T_CostFunction const& getTileCost, int maxTileCost, float seedValue, float unreachableValue )
+{
+	PopulateDistanceFieldFromCosts( &seed, 1, getTileCost, maxTileCost, seedValue, unreachableValue );
+}
+
+template<typename T_CostFunction>
+void TileHeatMap::PopulateWeightedDistanceField( std::vector<IntVec2> const& seeds, T_CostFunction const& getTileCost, int maxTileCost, float seedValue, float unreachableValue )
+{
+	PopulateDistanceFieldFromCosts( seeds.data(), (int)seeds.size(), getTileCost, maxTileCost, seedValue, unreachableValue );
+}
+
+// console command: DistanceFieldBenchmark sizes=256,1024 repeat=10, the bfs removed from the games against the bfs and bucketed Dijkstra of TileHeatMap
+bool Command_DistanceFieldBenchmark( EventArgs& args );
@@ -1,9 +1,143 @@
 #include "Engine/Core/JobSystem.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
 
 JobSystem* g_theJobSystem = nullptr;
 
+// the worker running on this thread, nullptr on the main thread and other non-worker threads
+static thread_local JobWorkerThread* s_currentWorker = nullptr;
+
+void JobCounter::Increment( int count )
+{
+	m_count += count;
+}
+
+void JobCounter::Decrement()
+{
+	m_count--;
+}
+
+int JobCounter::GetCount() const
+{
+	return m_count;
+}
+
+bool JobCounter::IsZero() const
+{
+	return m_count == 0;
+}
+
+void Job::AddChild( Job* child )
+{
+	m_children.push_back( child );
+	child->m_numOfParents++;
+	child->m_numOfUnfinishedDependencies++;
+}
+
+void Job::AddParent( Job* parent )
+{
+	parent->AddChild( this );
+}
+
+void Job::SetCounter( JobCounter* counter )
+{
+	m_counter = counter;
+	if (m_counter) {
+		m_counter->Increment();
+	}
+}
+
+void JobWorkQueue::PushBack( Job* job )
+{
+	m_mutex.lock();
+	m_jobs.push_back( job );
+	m_numOfJobs++;
+	m_mutex.unlock();
+}
+
+Job* JobWorkQueue::PopBackOfType( JobType type )
+{
+	if (m_numOfJobs == 0) {
+		return nullptr;
+	}
+	m_mutex.lock();
+	for (auto iter = m_jobs.rbegin(); iter != m_jobs.rend(); ++iter) {
+		if ((*iter)->m_type == type) {
+			Job* job = *iter;
+			m_jobs.erase( std::next( iter ).base() );
+			m_numOfJobs--;
+			m_mutex.unlock();
+			return job;
+		}
+	}
+	m_mutex.unlock();
+	return nullptr;
+}
+
+Job* JobWorkQueue::StealFrontOfType( JobType type )
+{
+	if (m_numOfJobs == 0) {
+		return nullptr;
+	}
+	m_mutex.lock();
+	for (auto iter = m_jobs.begin(); iter != m_jobs.end(); ++iter) {
+		if ((*iter)->m_type == type) {
+			Job* job = *iter;
+			m_jobs.erase( iter );
+			m_numOfJobs--;
+			m_mutex.unlock();
+			return job;
+		}
+	}
+	m_mutex.unlock();
+	return nullptr;
+}
+
+Job* JobWorkQueue::PopBackWithCounter( JobCounter const* counter )
+{
+	if (m_numOfJobs == 0) {
+		return nullptr;
+	}
+	m_mutex.lock();
+	for (auto iter = m_jobs.rbegin(); iter != m_jobs.rend(); ++iter) {
+		if ((*iter)->m_counter == counter) {
+			Job* job = *iter;
+			m_jobs.erase( std::next( iter ).base() );
+			m_numOfJobs--;
+			m_mutex.unlock();
+			return job;
+		}
+	}
+	m_mutex.unlock();
+	return nullptr;
+}
+
+bool JobWorkQueue::Remove( Job* job )
+{
+	if (m_numOfJobs == 0) {
+		return false;
+	}
+	m_mutex.lock();
+	for (auto iter = m_jobs.begin(); iter != m_jobs.end(); ++iter) {
+		if (*iter == job) {
+			m_jobs.erase( iter );
+			m_numOfJobs--;
+			m_mutex.unlock();
+			return true;
+		}
+	}
+	m_mutex.unlock();
+	return false;
+}
+
+bool JobWorkQueue::IsEmpty() const
+{
+	return m_numOfJobs == 0;
+}
+
 JobSystem::JobSystem( JobSystemConfig const& config )
 	:m_config(config)
 {
@@ -12,16 +146,16 @@ JobSystem::JobSystem( JobSystemConfig const& config )
 
 void JobSystem::StartUp()
 {
-	if (m_config.m_numOfWorkers == -1) {
-		int numOfWorkers = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
-		for (int i = 0; i < numOfWorkers; i++) {
-			m_workers.push_back( new JobWorkerThread( this, (unsigned int)i ) );
-		}
+	int numOfWorkers = m_config.m_numOfWorkers;
+	if (numOfWorkers == -1) {
+		numOfWorkers = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 1;
 	}
-	else {
-		for (int i = 0; i < m_config.m_numOfWorkers; i++) {
-			m_workers.push_back( new JobWorkerThread( this, (unsigned int)i ) );
-		}
+	// create every worker before any thread starts, workers walk m_workers to steal
+	for (int i = 0; i < numOfWorkers; i++) {
+		m_workers.push_back( new JobWorkerThread( this, (unsigned int)i ) );
+	}
+	for (int i = 0; i < numOfWorkers; i++) {
+		m_workers[i]->StartThread();
 	}
 }
 
@@ -38,21 +172,97 @@ void JobSystem::EndFrame()
 void JobSystem::ShutDown()
 {
 	m_isQuiting = true;
+	for (int i = 0; i < (int)m_workers.size(); i++) {
+		m_workers[i]->m_parkMutex.lock();
+		m_workers[i]->m_wakeSignaled = true;
+		m_workers[i]->m_parkMutex.unlock();
+		m_workers[i]->m_parkCondition.notify_one();
+	}
+	// join everyone before freeing anyone, a running worker may still be stealing from another one's queue
+	for (int i = 0; i < (int)m_workers.size(); i++) {
+		m_workers[i]->m_thread->join();
+	}
 	for (int i = 0; i < (int)m_workers.size(); i++) {
 		delete m_workers[i];
 	}
+	m_workers.clear();
 }
 
 void JobSystem::AddJob( Job* jobToAdd )
+{
+	jobToAdd->m_status = JobStatus::Waiting;
+	ReleaseDependency( jobToAdd );
+}
+
+void JobSystem::WaitForCounter( JobCounter const& counter )
+{
+	JobWorkerThread* currentWorker = s_currentWorker;
+	if (currentWorker && currentWorker->m_jobSystem != this) {
+		currentWorker = nullptr;
+	}
+	while (!counter.IsZero()) {
+		Job* job = ClaimAQueuedJobWithCounter( &counter, currentWorker ? (int)currentWorker->m_UID : -1 );
+		if (job) {
+			job->Execute();
+			WorkerCompleteAJob( currentWorker, job );
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::ReleaseDependency( Job* job )
+{
+	if (job->m_numOfUnfinishedDependencies.fetch_sub( 1 ) == 1) {
+		// every parent is done, nobody else touches the count now; re-arm it so the same graph can be added again
+		job->m_numOfUnfinishedDependencies = job->m_numOfParents + 1;
+		// a job canceled while it was waiting is dropped here instead of being queued
+		JobStatus expectedStatus = JobStatus::Waiting;
+		if (job->m_status.compare_exchange_strong( expectedStatus, JobStatus::Queued )) {
+			QueueReadyJob( job );
+		}
+	}
+}
+
+void JobSystem::QueueReadyJob( Job* jobToAdd )
 {
 	jobToAdd->m_status = JobStatus::Queued;
-	m_queuedJobsMutex.lock();
-	m_queuedJobs.push_back( jobToAdd );
-	m_queuedJobsMutex.unlock();
+	JobType type = jobToAdd->m_type;
+	int numOfWorkers = (int)m_workers.size();
+	if (numOfWorkers == 0) {
+		m_sharedQueue.PushBack( jobToAdd );
+		return;
+	}
+
+	// a job spawned or released by a worker stays on that worker's deque, it is likely to touch the same data
+	JobWorkerThread* currentWorker = s_currentWorker;
+	if (currentWorker && currentWorker->m_jobSystem == this && currentWorker->m_workerType == type) {
+		currentWorker->m_localQueue.PushBack( jobToAdd );
+		WakeWorkerForJobType( type, ((int)currentWorker->m_UID + 1) % numOfWorkers );
+		return;
+	}
+
+	// jobs from outside are spread round-robin over the workers that can run them
+	int startIndex = (int)(m_nextQueueIndex++ % (unsigned int)numOfWorkers);
+	int targetIndex = startIndex;
+	for (int i = 0; i < numOfWorkers; i++) {
+		int index = (startIndex + i) % numOfWorkers;
+		if (m_workers[index]->m_workerType == type) {
+			targetIndex = index;
+			break;
+		}
+	}
+	m_workers[targetIndex]->m_localQueue.PushBack( jobToAdd );
+	WakeWorkerForJobType( type, targetIndex );
 }
 
 bool JobSystem::RetrieveJob( Job* jobToRetrieve )
 {
+	// status is set to completed inside the lock after the job is pushed, so this early out never misses a job
+	if (jobToRetrieve->m_status != JobStatus::Completed) {
+		return false;
+	}
 	m_completedJobsMutex.lock();
 	for (auto iter = m_completedJobs.begin(); iter != m_completedJobs.end(); ++iter) {
 		if (*iter == jobToRetrieve) {
@@ -84,23 +294,44 @@ Job* JobSystem::RetriveOldestCompletedJob()
 
 void JobSystem::CancelJob( Job* jobToCancel )
 {
-	m_queuedJobsMutex.lock();
-	for (auto iter = m_queuedJobs.begin(); iter != m_queuedJobs.end(); ++iter) {
-		if (*iter == jobToCancel) {
-			m_queuedJobs.erase( iter );
-			m_queuedJobsMutex.unlock();
-			jobToCancel->m_status = JobStatus::NoRecord;
-			return;
-		}
+	// a waiting job is in no queue, it only waits for its parents; whichever of this and its last parent changes the status first wins
+	JobStatus expectedStatus = JobStatus::Waiting;
+	if (jobToCancel->m_status.compare_exchange_strong( expectedStatus, JobStatus::NoRecord )) {
+		FinishCanceledJob( jobToCancel );
+		return;
 	}
-	m_queuedJobsMutex.unlock();
+	bool isRemoved = m_sharedQueue.Remove( jobToCancel );
+	for (int i = 0; i < (int)m_workers.size() && !isRemoved; i++) {
+		isRemoved = m_workers[i]->m_localQueue.Remove( jobToCancel );
+	}
+	if (isRemoved) {
+		jobToCancel->m_status = JobStatus::NoRecord;
+		FinishCanceledJob( jobToCancel );
+	}
+}
 
+void JobSystem::FinishCanceledJob( Job* job )
+{
+	// children can never run without this parent, they are canceled with it;
+	// the dependency is still released so a child's count is re-armed once its other parents are done
+	for (Job* child : job->m_children) {
+		JobStatus expectedStatus = JobStatus::Waiting;
+		if (child->m_status.compare_exchange_strong( expectedStatus, JobStatus::NoRecord )) {
+			FinishCanceledJob( child );
+		}
+		ReleaseDependency( child );
+	}
+	if (job->m_counter) {
+		job->m_counter->Decrement();
+	}
 }
 
 bool JobSystem::SetWorkerThreadType( int workerID, WorkerThreadType type )
 {
 	if (workerID >= 0 && workerID < (int)m_workers.size()) {
 		m_workers[workerID]->m_workerType = type;
+		// the worker may be asleep while jobs of its new type wait in other queues
+		m_workers[workerID]->Unpark();
 		return true;
 	}
 	return false;
@@ -120,13 +351,197 @@ int JobSystem::GetWorkersCount() const
 }
 
 Job* JobSystem::WorkerClaimAQueuedJob( JobWorkerThread* worker )
+{
+	return ClaimAQueuedJobOfType( worker->m_workerType, (int)worker->m_UID );
+}
+
+Job* JobSystem::ClaimAQueuedJobOfType( JobType type, int homeWorkerIndex )
+{
+	Job* jobToClaim = nullptr;
+	if (homeWorkerIndex >= 0) {
+		jobToClaim = m_workers[homeWorkerIndex]->m_localQueue.PopBackOfType( type );
+	}
+	if (jobToClaim == nullptr) {
+		jobToClaim = m_sharedQueue.StealFrontOfType( type );
+	}
+	if (jobToClaim == nullptr) {
+		// a thread without its own queue (homeWorkerIndex -1) steals from every worker
+		int numOfWorkers = (int)m_workers.size();
+		int firstVictimIndex = homeWorkerIndex >= 0 ? homeWorkerIndex + 1 : 0;
+		int numOfVictims = homeWorkerIndex >= 0 ? numOfWorkers - 1 : numOfWorkers;
+		for (int i = 0; i < numOfVictims; i++) {
+			JobWorkerThread* victim = m_workers[(firstVictimIndex + i) % numOfWorkers];
+			jobToClaim = victim->m_localQueue.StealFrontOfType( type );
+			if (jobToClaim) {
+				break;
+			}
+		}
+	}
+	if (jobToClaim) {
+		jobToClaim->m_status = JobStatus::Executing;
+	}
+	return jobToClaim;
+}
+
+Job* JobSystem::ClaimAQueuedJobWithCounter( JobCounter const* counter, int homeWorkerIndex )
+{
+	Job* jobToClaim = m_sharedQueue.PopBackWithCounter( counter );
+	// then the own queue before the others, the jobs of a wait inside a job were pushed there
+	int numOfWorkers = (int)m_workers.size();
+	int firstIndex = homeWorkerIndex >= 0 ? homeWorkerIndex : 0;
+	for (int i = 0; i < numOfWorkers && jobToClaim == nullptr; i++) {
+		jobToClaim = m_workers[(firstIndex + i) % numOfWorkers]->m_localQueue.PopBackWithCounter( counter );
+	}
+	if (jobToClaim) {
+		jobToClaim->m_status = JobStatus::Executing;
+	}
+	return jobToClaim;
+}
+
+void JobSystem::WorkerCompleteAJob( JobWorkerThread* worker, Job* job )
+{
+	UNUSED( worker );
+	// the owner may delete the job as soon as it is seen completed, so take everything needed afterwards first
+	JobCounter* counter = job->m_counter;
+	std::vector<Job*> children;
+	if (!job->m_children.empty()) {
+		children = job->m_children;
+	}
+
+	if (job->m_needsRetrieving) {
+		m_completedJobsMutex.lock();
+		m_completedJobs.push_back( job );
+		job->m_status = JobStatus::Completed;
+		m_completedJobsMutex.unlock();
+	}
+	else {
+		job->m_status = JobStatus::Completed;
+	}
+
+	// released children go to this worker's deque and run right after the parent
+	for (Job* child : children) {
+		ReleaseDependency( child );
+	}
+	if (counter) {
+		counter->Decrement();
+	}
+}
+
+void JobSystem::WakeWorkerForJobType( JobType type, int startIndex )
+{
+	int numOfWorkers = (int)m_workers.size();
+	for (int i = 0; i < numOfWorkers; i++) {
+		JobWorkerThread* worker = m_workers[(startIndex + i) % numOfWorkers];
+		if (worker->m_workerType == type && worker->m_isParked && worker->Unpark()) {
+			return;
+		}
+	}
+}
+
+class JobSystemBenchmarkJob : public Job {
+public:
+	virtual void Execute() override {
+		// a few hundred nanoseconds of integer work, small enough that queue overhead dominates
+		unsigned int value = m_seed;
+		for (int i = 0; i < 256; i++) {
+			value ^= value << 13;
+			value ^= value >> 17;
+			value ^= value << 5;
+		}
+		m_seed = value;
+	}
+	unsigned int m_seed = 0x9e3779b9;
+};
+
+//-----------------------------------------------------------------------------------------------
+// The scheduler before work stealing, kept as it was so the benchmark compares against what the engine used to run:
+// one locked queue, a locked list of executing jobs and workers that sleep for 1us whenever there is nothing to claim
+class BaselineJobSystem {
+public:
+	BaselineJobSystem( int numOfWorkers );
+	~BaselineJobSystem();
+	void AddJob( Job* jobToAdd );
+	Job* RetriveOldestCompletedJob();
+
+protected:
+	void ThreadMain();
+	Job* WorkerClaimAQueuedJob();
+	void WorkerCompleteAJob( Job* job );
+
+	std::atomic<bool> m_isQuiting = false;
+	std::vector<std::thread*> m_threads;
+	WorkerThreadType m_workerType = CommonWorker;
+
+	std::deque<Job*> m_completedJobs;
+	std::mutex m_completedJobsMutex;
+	std::deque<Job*> m_queuedJobs;
+	std::mutex m_queuedJobsMutex;
+	std::deque<Job*> m_executingJobs;
+	std::mutex m_executingJobsMutex;
+};
+
+BaselineJobSystem::BaselineJobSystem( int numOfWorkers )
+{
+	for (int i = 0; i < numOfWorkers; i++) {
+		m_threads.push_back( new std::thread( &BaselineJobSystem::ThreadMain, this ) );
+	}
+}
+
+BaselineJobSystem::~BaselineJobSystem()
+{
+	m_isQuiting = true;
+	for (int i = 0; i < (int)m_threads.size(); i++) {
+		m_threads[i]->join();
+		delete m_threads[i];
+	}
+}
+
+void BaselineJobSystem::AddJob( Job* jobToAdd )
+{
+	jobToAdd->m_status = JobStatus::Queued;
+	m_queuedJobsMutex.lock();
+	m_queuedJobs.push_back( jobToAdd );
+	m_queuedJobsMutex.unlock();
+}
+
+Job* BaselineJobSystem::RetriveOldestCompletedJob()
+{
+	m_completedJobsMutex.lock();
+	if ((int)m_completedJobs.size() > 0) {
+		Job* jobToReturn = m_completedJobs.front();
+		m_completedJobs.pop_front();
+		m_completedJobsMutex.unlock();
+		jobToReturn->m_status = JobStatus::Retrieved;
+		return jobToReturn;
+	}
+	else {
+		m_completedJobsMutex.unlock();
+		return nullptr;
+	}
+}
+
+void BaselineJobSystem::ThreadMain()
+{
+	while (!m_isQuiting) {
+		Job* currentJob = WorkerClaimAQueuedJob();
+		if (currentJob) {
+			currentJob->Execute();
+			WorkerCompleteAJob( currentJob );
+		}
+		else {
+			std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+		}
+	}
+}
+
+Job* BaselineJobSystem::WorkerClaimAQueuedJob()
 {
 	m_queuedJobsMutex.lock();
 	if (!m_queuedJobs.empty()) {
 		Job* jobToClaim = nullptr;
 		auto iter = m_queuedJobs.begin();
 		for (; iter != m_queuedJobs.end(); ++iter) {
-			if (worker->m_workerType == (*iter)->m_type) {
+			if (m_workerType == (*iter)->m_type) {
 				jobToClaim = *iter;
 				break;
 			}
@@ -149,9 +564,8 @@ Job* JobSystem::WorkerClaimAQueuedJob( JobWorkerThread* worker )
 	}
 }
 
-void JobSystem::WorkerCompleteAJob( JobWorkerThread* worker, Job* job )
+void BaselineJobSystem::WorkerCompleteAJob( Job* job )
 {
-	UNUSED( worker );
 	m_executingJobsMutex.lock();
 	for (auto iter = m_executingJobs.begin(); iter != m_executingJobs.end(); ++iter) {
 		if (*iter == job) {
@@ -166,37 +580,130 @@ void JobSystem::WorkerCompleteAJob( JobWorkerThread* worker, Job* job )
 	}
 	ERROR_RECOVERABLE( "Cannot find a job in executing list to remove!" );
 	m_executingJobsMutex.unlock();
-	return;
+}
+
+// jobs per second from the first AddJob until every job is retrieved
+template<typename T_JobSystem>
+static double RunJobSystemBenchmarkPass( T_JobSystem& jobSystem, std::vector<JobSystemBenchmarkJob>& jobs )
+{
+	double startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < (int)jobs.size(); i++) {
+		jobSystem.AddJob( &jobs[i] );
+	}
+	int numOfRetrievedJobs = 0;
+	while (numOfRetrievedJobs < (int)jobs.size()) {
+		if (jobSystem.RetriveOldestCompletedJob()) {
+			numOfRetrievedJobs++;
+		}
+		else {
+			std::this_thread::yield();
+		}
+	}
+	double endTime = GetCurrentTimeSeconds();
+	return (double)jobs.size() / (endTime - startTime);
+}
+
+bool JobSystem::Command_Benchmark( EventArgs& args )
+{
+	int numOfJobs = atoi( args.GetValue( "jobs", "20000" ).c_str() );
+	int maxThreads = atoi( args.GetValue( "maxThreads", "64" ).c_str() );
+	if (numOfJobs <= 0 || maxThreads <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "JobSystemBenchmark: jobs and maxThreads should be positive" );
+		return false;
+	}
+
+	std::vector<JobSystemBenchmarkJob> jobs( numOfJobs );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "JobSystemBenchmark: %d jobs per pass", numOfJobs ) );
+	for (int numOfThreads = 1; numOfThreads <= maxThreads; numOfThreads *= 2) {
+		double baselineJobsPerSecond = 0.0;
+		{
+			BaselineJobSystem baselineJobSystem( numOfThreads );
+			baselineJobsPerSecond = RunJobSystemBenchmarkPass( baselineJobSystem, jobs );
+		}
+		JobSystemConfig config;
+		config.m_numOfWorkers = numOfThreads;
+		JobSystem jobSystem( config );
+		jobSystem.StartUp();
+		double workStealingJobsPerSecond = RunJobSystemBenchmarkPass( jobSystem, jobs );
+		jobSystem.ShutDown();
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "threads=%2d baseline: %10.0f jobs/s work stealing: %10.0f jobs/s (x%.2f)",
+			numOfThreads, baselineJobsPerSecond, workStealingJobsPerSecond, workStealingJobsPerSecond / baselineJobsPerSecond ) );
+	}
+	return true;
 }
 
 JobWorkerThread::JobWorkerThread( JobSystem* jobSystem, unsigned int UID )
 	:m_jobSystem(jobSystem)
 	,m_UID(UID)
 {
-	m_thread = new std::thread( &JobWorkerThread::ThreadMain, this );
 }
 
 JobWorkerThread::~JobWorkerThread()
 {
-	m_thread->join();
-	delete m_thread;
+	if (m_thread) {
+		if (m_thread->joinable()) {
+			m_thread->join();
+		}
+		delete m_thread;
+	}
+}
+
+void JobWorkerThread::StartThread()
+{
+	m_thread = new std::thread( &JobWorkerThread::ThreadMain, this );
 }
 
 void JobWorkerThread::ThreadMain()
 {
+	s_currentWorker = this;
 	while (!m_jobSystem->m_isQuiting) {
 		m_currentJob = ClaimAQueuedJob();
+		if (m_currentJob == nullptr) {
+			m_currentJob = ParkUntilWoken();
+		}
 		if (m_currentJob) {
 			m_currentJob->Execute();
 			m_jobSystem->WorkerCompleteAJob( this, m_currentJob );
-		}
-		else {
-			std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
+			m_currentJob = nullptr;
 		}
 	}
+	s_currentWorker = nullptr;
 }
 
 Job* JobWorkerThread::ClaimAQueuedJob()
 {
 	return m_jobSystem->WorkerClaimAQueuedJob( this );
 }
+
+Job* JobWorkerThread::ParkUntilWoken()
+{
+	m_parkMutex.lock();
+	m_wakeSignaled = false;
+	m_parkMutex.unlock();
+	m_isParked = true;
+
+	// look once more after announcing we are parked: a job queued before this point is found here,
+	// a job queued after it sees m_isParked and wakes us
+	Job* job = ClaimAQueuedJob();
+	if (job || m_jobSystem->m_isQuiting) {
+		m_isParked = false;
+		return job;
+	}
+
+	std::unique_lock<std::mutex> lock( m_parkMutex );
+	m_parkCondition.wait( lock, [this]() { return m_wakeSignaled || m_jobSystem->m_isQuiting; } );
+	m_isParked = false;
+	return nullptr;
+}
+
+bool JobWorkerThread::Unpark()
+{
+	if (!m_isParked.exchange( false )) {
+		return false;
+	}
+	m_parkMutex.lock();
+	m_wakeSignaled = true;
+	m_parkMutex.unlock();
+	m_parkCondition.notify_one();
+	return true;
+}
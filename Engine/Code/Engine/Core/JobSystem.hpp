@@ -4,11 +4,15 @@
 #include <vector>
 #include <mutex>
 #include <thread>
+#include <atomic>
+#include <condition_variable>
 
 class JobSystem;
+class NamedProperties;
+typedef NamedProperties EventArgs;
 
 enum class JobStatus {
-	NoRecord, Queued, Executing, Completed, Retrieved, 
+	NoRecord, Waiting, Queued, Executing, Completed, Retrieved,
 };
 
 typedef uint32_t JobType;
@@ -21,13 +25,68 @@ constexpr JobType CommonJob = 0x1;
 constexpr WorkerThreadType NoWorkerType = 0x0;
 constexpr WorkerThreadType CommonWorker = 0x1;
 
+//-----------------------------------------------------------------------------------------------
+// Counts unfinished jobs. Every job that is given the counter adds one, and removes it after it is completed
+class JobCounter {
+public:
+	JobCounter() {};
+	JobCounter( JobCounter const& copyFrom ) = delete;
+	void Increment( int count = 1 );
+	void Decrement();
+	int GetCount() const;
+	bool IsZero() const;
+
+protected:
+	std::atomic<int> m_count = 0;
+};
+
 class Job {
+	friend class JobSystem;
+	friend class JobWorkQueue;
 public:
 	Job(JobType type = CommonJob ) : m_type(type) {};
 	virtual ~Job(){};
 	virtual void Execute() = 0;
+	//---------------------------------------------------------------------
+	// child will not be queued until this job and all other parents of it are completed
+	// build the whole graph before adding any job of it to the job system
+	void AddChild( Job* child );
+	void AddParent( Job* parent );
+	//---------------------------------------------------------------------
+	// counter is incremented now and decremented after this job is completed and its children are released
+	void SetCounter( JobCounter* counter );
+
 	std::atomic<JobStatus> m_status = JobStatus::NoRecord;
 	std::atomic<JobType> m_type = CommonJob;
+	// false: the job does not go to the completed list, nobody retrieves it; track it with a counter or a continuation
+	bool m_needsRetrieving = true;
+
+protected:
+	std::vector<Job*> m_children;
+	int m_numOfParents = 0;
+	// unfinished parents plus one for the AddJob call itself, the job is queued when this reaches zero
+	std::atomic<int> m_numOfUnfinishedDependencies = 1;
+	JobCounter* m_counter = nullptr;
+};
+
+//-----------------------------------------------------------------------------------------------
+// A small locked deque owned by one worker. The owner pushes and pops at the back (LIFO, cache friendly),
+// other workers steal from the front (FIFO, oldest and usually biggest work first).
+// Each side only takes jobs whose type matches the worker, so JobType filtering still works while stealing.
+class JobWorkQueue {
+public:
+	void PushBack( Job* job );
+	Job* PopBackOfType( JobType type );
+	Job* StealFrontOfType( JobType type );
+	/// newest job that decrements the counter, any type
+	Job* PopBackWithCounter( JobCounter const* counter );
+	bool Remove( Job* job );
+	bool IsEmpty() const;
+
+protected:
+	std::deque<Job*> m_jobs;
+	std::mutex m_mutex;
+	std::atomic<int> m_numOfJobs = 0; // readable without the lock so thieves can skip empty queues cheaply
 };
 
 class JobWorkerThread {
@@ -35,8 +94,11 @@ class JobWorkerThread {
 protected:
 	JobWorkerThread( JobSystem* jobSystem, unsigned int UID );
 	virtual ~JobWorkerThread();
+	void StartThread();
 	void ThreadMain();
 	Job* ClaimAQueuedJob();
+	Job* ParkUntilWoken();
+	bool Unpark();
 
 	std::thread* m_thread = nullptr;
 	unsigned int m_UID = (unsigned int)-1;
@@ -44,6 +106,13 @@ protected:
 	Job* m_currentJob = nullptr;
 
 	std::atomic<WorkerThreadType> m_workerType = CommonJob;
+
+	JobWorkQueue m_localQueue;
+	// parking: an idle worker sleeps on its own condition variable and is woken by whoever queues a job it can take
+	std::atomic<bool> m_isParked = false;
+	bool m_wakeSignaled = false;
+	std::mutex m_parkMutex;
+	std::condition_variable m_parkCondition;
 };
 
 struct JobSystemConfig {
@@ -61,27 +130,39 @@ public:
 	void ShutDown();
 
 	void AddJob( Job* jobToAdd );
+	// run the queued jobs of the counter on the calling thread until it reaches zero, safe to call inside a job
+	// other jobs are never picked up, so the main thread is not stalled by a long unrelated job
+	void WaitForCounter( JobCounter const& counter );
 	bool RetrieveJob( Job* jobToRetrieve );
 	Job* RetriveOldestCompletedJob();
+	// a waiting or queued job goes back to NoRecord and never runs, its counter is decremented and its waiting children are canceled too
+	// an executing or completed job is not touched
 	void CancelJob( Job* jobToCancel );
 	bool SetWorkerThreadType( int workerID, WorkerThreadType type );
 	WorkerThreadType GetWorkerThreadType( int workerID ) const;
 	int GetWorkersCount() const;
 
+	// console command: JobSystemBenchmark jobs=20000 maxThreads=64
+	static bool Command_Benchmark( EventArgs& args );
+
 protected:
 	std::atomic<bool> m_isQuiting = false;
+	void QueueReadyJob( Job* job );
+	void ReleaseDependency( Job* job );
+	void FinishCanceledJob( Job* job );
+	Job* ClaimAQueuedJobOfType( JobType type, int homeWorkerIndex );
+	Job* ClaimAQueuedJobWithCounter( JobCounter const* counter, int homeWorkerIndex );
 	Job* WorkerClaimAQueuedJob( JobWorkerThread* worker );
 	void WorkerCompleteAJob( JobWorkerThread* worker, Job* job );
+	void WakeWorkerForJobType( JobType type, int startIndex );
 
 	JobSystemConfig m_config;
 
 	std::vector<JobWorkerThread*> m_workers;
+	std::atomic<unsigned int> m_nextQueueIndex = 0;
+
+	JobWorkQueue m_sharedQueue; // only used when there is no worker, threads that wait on a counter run the jobs
 
 	std::deque<Job*> m_completedJobs;
 	std::mutex m_completedJobsMutex;
-	std::deque<Job*> m_queuedJobs;
-	std::mutex m_queuedJobsMutex;
-	std::deque<Job*> m_executingJobs;
-	std::mutex m_executingJobsMutex;
 };
-
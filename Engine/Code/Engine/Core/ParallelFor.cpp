@@ -0,0 +1,84 @@
+#include "Engine/Core/ParallelFor.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Core/Time.hpp"
+#include "Engine/Core/HeatMaps.hpp"
+#include "Engine/Core/VertexUtils.hpp"
+#include "Engine/Core/Vertex_PCU.hpp"
+#include "Engine/Math/Mat44.hpp"
+#include "Engine/Math/EulerAngles.hpp"
+
+bool Command_ParallelForBenchmark( EventArgs& args )
+{
+	int size = atoi( args.GetValue( "size", "4000000" ).c_str() );
+	int repeat = atoi( args.GetValue( "repeat", "10" ).c_str() );
+	if (size <= 0 || repeat <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ParallelForBenchmark: size and repeat should be positive" );
+		return false;
+	}
+	int numOfWorkers = g_theJobSystem ? g_theJobSystem->GetWorkersCount() : 0;
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "ParallelForBenchmark: %d elements, %d repeats, %d workers + calling thread", size, repeat, numOfWorkers ) );
+
+	// TileHeatMap::SetAllValues
+	int heatMapSide = (int)sqrtf( (float)size );
+	TileHeatMap heatMap( IntVec2( heatMapSide, heatMapSide ) );
+	std::vector<float> serialValues( (size_t)heatMapSide * heatMapSide );
+	double startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		for (int i = 0; i < (int)serialValues.size(); i++) {
+			serialValues[i] = (float)r;
+		}
+	}
+	double serialTime = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		heatMap.SetAllValues( (float)r );
+	}
+	double parallelTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "TileHeatMap::SetAllValues %dx%d: serial %.3fms parallel %.3fms (x%.2f)",
+		heatMapSide, heatMapSide, serialTime * 1000.0 / repeat, parallelTime * 1000.0 / repeat, serialTime / parallelTime ) );
+
+	// TransformVertexArray3D
+	std::vector<Vertex_PCU> verts( size );
+	for (int i = 0; i < size; i++) {
+		verts[i].m_position = Vec3( (float)(i % 1000), (float)(i / 1000), (float)(i % 7) );
+	}
+	Mat44 transform = Mat44::CreateTranslation3D( Vec3( 1.f, 2.f, 3.f ) );
+	transform.Append( EulerAngles( 30.f, 15.f, 5.f ).GetAsMatrix_IFwd_JLeft_KUp() );
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		for (auto& vert : verts) {
+			vert.m_position = transform.TransformPosition3D( vert.m_position );
+		}
+	}
+	serialTime = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		TransformVertexArray3D( verts, transform );
+	}
+	parallelTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "TransformVertexArray3D %d verts: serial %.3fms parallel %.3fms (x%.2f)",
+		size, serialTime * 1000.0 / repeat, parallelTime * 1000.0 / repeat, serialTime / parallelTime ) );
+
+	// ParallelReduce: highest vertex
+	float serialMaxZ = -FLT_MAX;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		serialMaxZ = -FLT_MAX;
+		for (auto const& vert : verts) {
+			serialMaxZ = vert.m_position.z > serialMaxZ ? vert.m_position.z : serialMaxZ;
+		}
+	}
+	serialTime = GetCurrentTimeSeconds() - startTime;
+	float parallelMaxZ = -FLT_MAX;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		parallelMaxZ = ParallelReduce( 0, size, PARALLEL_FOR_AUTO_GRAIN_SIZE, -FLT_MAX,
+			[&]( int i ) { return verts[i].m_position.z; },
+			[]( float a, float b ) { return a > b ? a : b; } );
+	}
+	parallelTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "ParallelReduce max z of %d verts: serial %.3fms parallel %.3fms (x%.2f) %s",
+		size, serialTime * 1000.0 / repeat, parallelTime * 1000.0 / repeat, serialTime / parallelTime, serialMaxZ == parallelMaxZ ? "match" : "MISMATCH" ) );
+	return true;
+}
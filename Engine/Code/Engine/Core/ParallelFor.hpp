@@ -0,0 +1,121 @@
+#pragma once
+#include "Engine/Core/JobSystem.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// Data-parallel loops on top of the job system workers
+// Ranges are half open: [beginIndex, endIndex)
+// The calling thread runs the first chunk and then helps with the rest until all chunks are done,
+// so it is safe to call inside a job (nested ParallelFor) without starving the workers
+// Without a job system or workers the loop simply runs on the calling thread
+
+constexpr int PARALLEL_FOR_AUTO_GRAIN_SIZE = 0;
+
+//-----------------------------------------------------------------------------------------------
+// how many chunks a range is split into, auto grain size gives about four chunks per thread so stealing can even out uneven work
+inline int GetNumOfParallelChunks( int numOfElements, int grainSize )
+{
+	if (numOfElements <= 0) {
+		return 0;
+	}
+	if (g_theJobSystem == nullptr || g_theJobSystem->GetWorkersCount() == 0) {
+		return 1;
+	}
+	if (grainSize <= 0) {
+		int numOfThreads = g_theJobSystem->GetWorkersCount() + 1;
+		grainSize = numOfElements / (numOfThreads * 4);
+		if (grainSize < 1) {
+			grainSize = 1;
+		}
+	}
+	return (numOfElements + grainSize - 1) / grainSize;
+}
+
+template<typename T_Function>
+class ParallelForJob : public Job {
+public:
+	virtual void Execute() override {
+		for (int i = m_beginIndex; i < m_endIndex; i++) {
+			(*m_function)( i );
+		}
+	}
+
+	T_Function const* m_function = nullptr;
+	int m_beginIndex = 0;
+	int m_endIndex = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// call function( index ) for every index in [beginIndex, endIndex), iterations must not depend on each other
+template<typename T_Function>
+void ParallelFor( int beginIndex, int endIndex, int grainSize, T_Function const& function )
+{
+	int numOfElements = endIndex - beginIndex;
+	int numOfChunks = GetNumOfParallelChunks( numOfElements, grainSize );
+	if (numOfChunks <= 1) {
+		for (int i = beginIndex; i < endIndex; i++) {
+			function( i );
+		}
+		return;
+	}
+	int chunkSize = (numOfElements + numOfChunks - 1) / numOfChunks;
+	numOfChunks = (numOfElements + chunkSize - 1) / chunkSize;
+
+	JobCounter counter;
+	std::vector<ParallelForJob<T_Function>> jobs( numOfChunks - 1 );
+	for (int chunkIndex = 1; chunkIndex < numOfChunks; chunkIndex++) {
+		ParallelForJob<T_Function>& job = jobs[chunkIndex - 1];
+		job.m_function = &function;
+		job.m_beginIndex = beginIndex + chunkIndex * chunkSize;
+		job.m_endIndex = job.m_beginIndex + chunkSize < endIndex ? job.m_beginIndex + chunkSize : endIndex;
+		job.m_needsRetrieving = false;
+		job.SetCounter( &counter );
+		g_theJobSystem->AddJob( &job );
+	}
+
+	for (int i = beginIndex; i < beginIndex + chunkSize; i++) {
+		function( i );
+	}
+	g_theJobSystem->WaitForCounter( counter );
+}
+
+//-----------------------------------------------------------------------------------------------
+// reduceFunction( ..., reduceFunction( reduceFunction( identity, mapFunction( beginIndex ) ), mapFunction( beginIndex + 1 ) ), ... )
+// partial results are combined in index order, so the result does not depend on which thread ran which chunk
+// reduceFunction must be associative
+template<typename T_Value, typename T_MapFunction, typename T_ReduceFunction>
+T_Value ParallelReduce( int beginIndex, int endIndex, int grainSize, T_Value const& identity, T_MapFunction const& mapFunction, T_ReduceFunction const& reduceFunction )
+{
+	int numOfElements = endIndex - beginIndex;
+	int numOfChunks = GetNumOfParallelChunks( numOfElements, grainSize );
+	if (numOfChunks <= 1) {
+		T_Value result = identity;
+		for (int i = beginIndex; i < endIndex; i++) {
+			result = reduceFunction( result, mapFunction( i ) );
+		}
+		return result;
+	}
+	int chunkSize = (numOfElements + numOfChunks - 1) / numOfChunks;
+	numOfChunks = (numOfElements + chunkSize - 1) / chunkSize;
+
+	std::vector<T_Value> partialResults( numOfChunks, identity );
+	ParallelFor( 0, numOfChunks, 1, [&]( int chunkIndex ) {
+		int chunkBeginIndex = beginIndex + chunkIndex * chunkSize;
+		int chunkEndIndex = chunkBeginIndex + chunkSize < endIndex ? chunkBeginIndex + chunkSize : endIndex;
+		T_Value result = identity;
+		for (int i = chunkBeginIndex; i < chunkEndIndex; i++) {
+			result = reduceFunction( result, mapFunction( i ) );
+		}
+		partialResults[chunkIndex] = result;
+		} );
+
+	T_Value result = identity;
+	for (int i = 0; i < numOfChunks; i++) {
+		result = reduceFunction( result, partialResults[i] );
+	}
+	return result;
+}
+
+// console command: ParallelForBenchmark size=4000000 repeat=10
+bool Command_ParallelForBenchmark( EventArgs& args );
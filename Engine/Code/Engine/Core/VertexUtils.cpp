@@ -7,9 +7,13 @@
 #include "Engine\Math\AABB3.hpp"
 #include "Engine\Math\OBB3.hpp"
 #include "Engine\Math\ConvexHull2.hpp"
+#include "Engine\Core\ParallelFor.hpp"
 
 Rgba8 g_wireColor = Rgba8( 128, 128, 128 );
 
+// big meshes are transformed on the job workers, anything under one grain stays on the calling thread
+constexpr int TRANSFORM_VERTEX_PARALLEL_GRAIN_SIZE = 16384;
+
 
 void TransformVertexArrayXY3D( int numVerts, Vertex_PCU* verts, float uniformScaleXY, float rotationDegreesAboutZ, Vec2 const& translationXY )
 {
@@ -38,16 +42,15 @@ void TransformVertexArray3D( std::vector<Vertex_PCU>& verts, Vec3 const& positio
 {
 	Mat44 transformMatrix = Mat44::CreateTranslation3D( position );
 	transformMatrix.Append( rotation.GetAsMatrix_IFwd_JLeft_KUp() );
-	for (auto& vert : verts) {
-		vert.m_position = transformMatrix.TransformPosition3D( vert.m_position );
-	}
+	TransformVertexArray3D( verts, transformMatrix );
 }
 
 void TransformVertexArray3D( std::vector<Vertex_PCU>& verts, Mat44 const& transform )
 {
-	for (auto& vert : verts) {
-		transform.TransformPosition3D( vert.m_position );
-	}
+	Vertex_PCU* vertsData = verts.data();
+	ParallelFor( 0, (int)verts.size(), TRANSFORM_VERTEX_PARALLEL_GRAIN_SIZE, [&]( int i ) {
+		vertsData[i].m_position = transform.TransformPosition3D( vertsData[i].m_position );
+		} );
 }
 
 AABB2 const GetVertexBounds2D( std::vector<Vertex_PCU> const& verts )
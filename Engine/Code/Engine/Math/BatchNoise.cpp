@@ -0,0 +1,209 @@
+#include "Engine/Math/BatchNoise.hpp"
+#include <emmintrin.h>
+
+//-----------------------------------------------------------------------------------------------
+// Only SSE2 is used, it is part of every x64 target and the engine is not built with /arch:AVX2
+// Every step mirrors the order of the float operations in SmoothNoise.cpp, so results match bit for bit
+
+namespace {
+
+//-----------------------------------------------------------------------------------------------
+// low 32 bits of a 32 x 32 multiply, _mm_mullo_epi32 needs SSE4.1
+inline __m128i MultiplyLow32( __m128i a, __m128i b )
+{
+	__m128i evenProducts = _mm_mul_epu32( a, b );
+	__m128i oddProducts = _mm_mul_epu32( _mm_srli_epi64( a, 32 ), _mm_srli_epi64( b, 32 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+// SquirrelNoise5 from RawNoise.hpp on four positions
+inline __m128i SquirrelNoise5x4( __m128i positionX, __m128i seed )
+{
+	__m128i const SQ5_BIT_NOISE1 = _mm_set1_epi32( (int)0xd2a80a3f );
+	__m128i const SQ5_BIT_NOISE2 = _mm_set1_epi32( (int)0xa884f197 );
+	__m128i const SQ5_BIT_NOISE3 = _mm_set1_epi32( (int)0x6C736F4B );
+	__m128i const SQ5_BIT_NOISE4 = _mm_set1_epi32( (int)0xB79F3ABB );
+	__m128i const SQ5_BIT_NOISE5 = _mm_set1_epi32( (int)0x1b56c4f5 );
+
+	__m128i mangledBits = MultiplyLow32( positionX, SQ5_BIT_NOISE1 );
+	mangledBits = _mm_add_epi32( mangledBits, seed );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 9 ) );
+	mangledBits = _mm_add_epi32( mangledBits, SQ5_BIT_NOISE2 );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 11 ) );
+	mangledBits = MultiplyLow32( mangledBits, SQ5_BIT_NOISE3 );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 13 ) );
+	mangledBits = _mm_add_epi32( mangledBits, SQ5_BIT_NOISE4 );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 15 ) );
+	mangledBits = MultiplyLow32( mangledBits, SQ5_BIT_NOISE5 );
+	mangledBits = _mm_xor_si128( mangledBits, _mm_srli_epi32( mangledBits, 17 ) );
+	return mangledBits;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline __m128i Get2dNoiseUintx4( __m128i indexX, __m128i indexY, __m128i seed )
+{
+	__m128i const PRIME_NUMBER = _mm_set1_epi32( 198491317 );
+	return SquirrelNoise5x4( _mm_add_epi32( indexX, MultiplyLow32( PRIME_NUMBER, indexY ) ), seed );
+}
+
+//-----------------------------------------------------------------------------------------------
+// floorf for |value| < 2^31, returns the float and the int
+inline __m128 Floorx4( __m128 value, __m128i& out_intFloor )
+{
+	__m128i truncated = _mm_cvttps_epi32( value );
+	__m128 truncatedFloat = _mm_cvtepi32_ps( truncated );
+	__m128i isAbove = _mm_castps_si128( _mm_cmpgt_ps( truncatedFloat, value ) ); // -1 where truncation went up (negative values)
+	out_intFloor = _mm_add_epi32( truncated, isAbove );
+	return _mm_cvtepi32_ps( out_intFloor );
+}
+
+//-----------------------------------------------------------------------------------------------
+// (1 - t) * SmoothStart2( t ) + t * SmoothStop2( t ), as in MathUtils.cpp
+inline __m128 SmoothStep3x4( __m128 t )
+{
+	__m128 const one = _mm_set1_ps( 1.f );
+	__m128 s = _mm_sub_ps( one, t );
+	__m128 smoothStart = _mm_mul_ps( t, t );
+	__m128 smoothStop = _mm_sub_ps( one, _mm_mul_ps( s, s ) );
+	return _mm_add_ps( _mm_mul_ps( s, smoothStart ), _mm_mul_ps( t, smoothStop ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+// the 8 quarter-cardinal unit gradients of Compute2dPerlinNoise, picked by the low 3 bits without a table
+inline void GetGradientx4( __m128i noise, __m128& out_gradientX, __m128& out_gradientY )
+{
+	__m128 const bigComponent = _mm_set1_ps( 0.923879533f );
+	__m128 const smallComponent = _mm_set1_ps( 0.382683432f );
+	__m128i const zero = _mm_setzero_si128();
+	__m128i const signBit = _mm_set1_epi32( (int)0x80000000 );
+	__m128i index = _mm_and_si128( noise, _mm_set1_epi32( 7 ) );
+
+	// x is big for 0, 3, 4, 7 and negative for 2, 3, 4, 5; y is big for 1, 2, 5, 6 and negative for 4, 5, 6, 7
+	__m128 isXBig = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( _mm_add_epi32( index, _mm_set1_epi32( 1 ) ), _mm_set1_epi32( 2 ) ), zero ) );
+	__m128i isXNegative = _mm_cmpeq_epi32( _mm_and_si128( _mm_add_epi32( index, _mm_set1_epi32( 2 ) ), _mm_set1_epi32( 4 ) ), _mm_set1_epi32( 4 ) );
+	__m128i isYNegative = _mm_cmpeq_epi32( _mm_and_si128( index, _mm_set1_epi32( 4 ) ), _mm_set1_epi32( 4 ) );
+
+	__m128 gradientX = _mm_or_ps( _mm_and_ps( isXBig, bigComponent ), _mm_andnot_ps( isXBig, smallComponent ) );
+	__m128 gradientY = _mm_or_ps( _mm_and_ps( isXBig, smallComponent ), _mm_andnot_ps( isXBig, bigComponent ) );
+	out_gradientX = _mm_xor_ps( gradientX, _mm_castsi128_ps( _mm_and_si128( isXNegative, signBit ) ) );
+	out_gradientY = _mm_xor_ps( gradientY, _mm_castsi128_ps( _mm_and_si128( isYNegative, signBit ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+// Compute2dPerlinNoise on four positions, octave amplitudes are the same for every lane
+__m128 Compute2dPerlinNoisex4( __m128 posX, __m128 posY, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	const float OCTAVE_OFFSET = 0.636764989593174f; // Translation/bias to add to each octave
+	__m128 const one = _mm_set1_ps( 1.f );
+	__m128i const oneInt = _mm_set1_epi32( 1 );
+
+	__m128 totalNoise = _mm_setzero_ps();
+	float totalAmplitude = 0.f;
+	float currentAmplitude = 1.f;
+	float invScale = (1.f / scale);
+	__m128 currentPosX = _mm_mul_ps( posX, _mm_set1_ps( invScale ) );
+	__m128 currentPosY = _mm_mul_ps( posY, _mm_set1_ps( invScale ) );
+
+	for (unsigned int octaveNum = 0; octaveNum < numOctaves; ++octaveNum) {
+		__m128i indexWestX;
+		__m128i indexSouthY;
+		__m128 cellMinsX = Floorx4( currentPosX, indexWestX );
+		__m128 cellMinsY = Floorx4( currentPosY, indexSouthY );
+		__m128 cellMaxsX = _mm_add_ps( cellMinsX, one );
+		__m128 cellMaxsY = _mm_add_ps( cellMinsY, one );
+		__m128i indexEastX = _mm_add_epi32( indexWestX, oneInt );
+		__m128i indexNorthY = _mm_add_epi32( indexSouthY, oneInt );
+
+		__m128i seedx4 = _mm_set1_epi32( (int)seed );
+		__m128 gradientSWX, gradientSWY, gradientSEX, gradientSEY, gradientNWX, gradientNWY, gradientNEX, gradientNEY;
+		GetGradientx4( Get2dNoiseUintx4( indexWestX, indexSouthY, seedx4 ), gradientSWX, gradientSWY );
+		GetGradientx4( Get2dNoiseUintx4( indexEastX, indexSouthY, seedx4 ), gradientSEX, gradientSEY );
+		GetGradientx4( Get2dNoiseUintx4( indexWestX, indexNorthY, seedx4 ), gradientNWX, gradientNWY );
+		GetGradientx4( Get2dNoiseUintx4( indexEastX, indexNorthY, seedx4 ), gradientNEX, gradientNEY );
+
+		__m128 displacementFromWest = _mm_sub_ps( currentPosX, cellMinsX );
+		__m128 displacementFromEast = _mm_sub_ps( currentPosX, cellMaxsX );
+		__m128 displacementFromSouth = _mm_sub_ps( currentPosY, cellMinsY );
+		__m128 displacementFromNorth = _mm_sub_ps( currentPosY, cellMaxsY );
+
+		__m128 dotSouthWest = _mm_add_ps( _mm_mul_ps( gradientSWX, displacementFromWest ), _mm_mul_ps( gradientSWY, displacementFromSouth ) );
+		__m128 dotSouthEast = _mm_add_ps( _mm_mul_ps( gradientSEX, displacementFromEast ), _mm_mul_ps( gradientSEY, displacementFromSouth ) );
+		__m128 dotNorthWest = _mm_add_ps( _mm_mul_ps( gradientNWX, displacementFromWest ), _mm_mul_ps( gradientNWY, displacementFromNorth ) );
+		__m128 dotNorthEast = _mm_add_ps( _mm_mul_ps( gradientNEX, displacementFromEast ), _mm_mul_ps( gradientNEY, displacementFromNorth ) );
+
+		__m128 weightEast = SmoothStep3x4( displacementFromWest );
+		__m128 weightNorth = SmoothStep3x4( displacementFromSouth );
+		__m128 weightWest = _mm_sub_ps( one, weightEast );
+		__m128 weightSouth = _mm_sub_ps( one, weightNorth );
+
+		__m128 blendSouth = _mm_add_ps( _mm_mul_ps( weightEast, dotSouthEast ), _mm_mul_ps( weightWest, dotSouthWest ) );
+		__m128 blendNorth = _mm_add_ps( _mm_mul_ps( weightEast, dotNorthEast ), _mm_mul_ps( weightWest, dotNorthWest ) );
+		__m128 blendTotal = _mm_add_ps( _mm_mul_ps( weightSouth, blendSouth ), _mm_mul_ps( weightNorth, blendNorth ) );
+		__m128 noiseThisOctave = _mm_mul_ps( blendTotal, _mm_set1_ps( 1.f / 0.662578106f ) );
+
+		totalNoise = _mm_add_ps( totalNoise, _mm_mul_ps( noiseThisOctave, _mm_set1_ps( currentAmplitude ) ) );
+		totalAmplitude += currentAmplitude;
+		currentAmplitude *= octavePersistence;
+		currentPosX = _mm_add_ps( _mm_mul_ps( currentPosX, _mm_set1_ps( octaveScale ) ), _mm_set1_ps( OCTAVE_OFFSET ) );
+		currentPosY = _mm_add_ps( _mm_mul_ps( currentPosY, _mm_set1_ps( octaveScale ) ), _mm_set1_ps( OCTAVE_OFFSET ) );
+		++seed;
+	}
+
+	if (renormalize && totalAmplitude > 0.f) {
+		__m128 const half = _mm_set1_ps( 0.5f );
+		totalNoise = _mm_div_ps( totalNoise, _mm_set1_ps( totalAmplitude ) );
+		totalNoise = _mm_add_ps( _mm_mul_ps( totalNoise, half ), half );
+		totalNoise = SmoothStep3x4( totalNoise );
+		totalNoise = _mm_sub_ps( _mm_mul_ps( totalNoise, _mm_set1_ps( 2.f ) ), one );
+	}
+	return totalNoise;
+}
+
+}
+
+void Compute2dPerlinNoiseBatch( float* out_noise, float const* posX, float const* posY, int numOfPositions, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	int i = 0;
+	for (; i + 4 <= numOfPositions; i += 4) {
+		__m128 noise = Compute2dPerlinNoisex4( _mm_loadu_ps( posX + i ), _mm_loadu_ps( posY + i ), scale, numOctaves, octavePersistence, octaveScale, renormalize, seed );
+		_mm_storeu_ps( out_noise + i, noise );
+	}
+	if (i < numOfPositions) {
+		// pad the last lanes with the last position
+		float tailX[4];
+		float tailY[4];
+		float tailNoise[4];
+		for (int k = 0; k < 4; k++) {
+			int index = i + k < numOfPositions ? i + k : numOfPositions - 1;
+			tailX[k] = posX[index];
+			tailY[k] = posY[index];
+		}
+		_mm_storeu_ps( tailNoise, Compute2dPerlinNoisex4( _mm_loadu_ps( tailX ), _mm_loadu_ps( tailY ), scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+		for (int k = 0; i + k < numOfPositions; k++) {
+			out_noise[i + k] = tailNoise[k];
+		}
+	}
+}
+
+void Compute2dPerlinNoiseGrid( float* out_noise, int originX, int originY, int numX, int numY, float scale, unsigned int numOctaves, float octavePersistence, float octaveScale, bool renormalize, unsigned int seed )
+{
+	__m128i const laneOffsets = _mm_set_epi32( 3, 2, 1, 0 );
+	for (int y = 0; y < numY; y++) {
+		__m128 posY = _mm_set1_ps( (float)(originY + y) );
+		float* rowNoise = out_noise + y * numX;
+		int x = 0;
+		for (; x + 4 <= numX; x += 4) {
+			__m128 posX = _mm_cvtepi32_ps( _mm_add_epi32( _mm_set1_epi32( originX + x ), laneOffsets ) );
+			_mm_storeu_ps( rowNoise + x, Compute2dPerlinNoisex4( posX, posY, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+		}
+		if (x < numX) {
+			float tailNoise[4];
+			__m128 posX = _mm_cvtepi32_ps( _mm_add_epi32( _mm_set1_epi32( originX + x ), laneOffsets ) );
+			_mm_storeu_ps( tailNoise, Compute2dPerlinNoisex4( posX, posY, scale, numOctaves, octavePersistence, octaveScale, renormalize, seed ) );
+			for (int k = 0; x + k < numX; k++) {
+				rowNoise[x + k] = tailNoise[k];
+			}
+		}
+	}
+}
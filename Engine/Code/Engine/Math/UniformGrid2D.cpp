@@ -0,0 +1,130 @@
+#include "Engine/Math/UniformGrid2D.hpp"
+#include "Engine/Math/MathUtils.hpp"
+#include "Engine/Core/ErrorWarningAssert.hpp"
+#include <algorithm>
+
+void UniformGrid2D::Build( AABB2 const& gridBounds, IntVec2 const& numOfCells, std::vector<AABB2> const& itemBounds )
+{
+	GUARANTEE_OR_DIE( numOfCells.x > 0 && numOfCells.y > 0, "Uniform grid needs at least one cell" );
+	m_bounds = gridBounds;
+	m_numOfCells = numOfCells;
+	Vec2 dimensions = gridBounds.GetDimensions();
+	m_cellSize = Vec2( dimensions.x / (float)numOfCells.x, dimensions.y / (float)numOfCells.y );
+	m_inversedCellSize = Vec2( 1.f / m_cellSize.x, 1.f / m_cellSize.y );
+	m_itemBounds = itemBounds;
+
+	// count first, then fill, so every cell's list is one slice of m_cellItems
+	int numOfAllCells = numOfCells.x * numOfCells.y;
+	m_cellStarts.assign( (size_t)numOfAllCells + 1, 0 );
+	for (auto const& bounds : itemBounds) {
+		IntVec2 minCoords = GetCellCoords( bounds.m_mins );
+		IntVec2 maxCoords = GetCellCoords( bounds.m_maxs );
+		for (int y = minCoords.y; y <= maxCoords.y; y++) {
+			for (int x = minCoords.x; x <= maxCoords.x; x++) {
+				++m_cellStarts[(size_t)y * numOfCells.x + x + 1];
+			}
+		}
+	}
+	for (int i = 0; i < numOfAllCells; i++) {
+		m_cellStarts[(size_t)i + 1] += m_cellStarts[i];
+	}
+	m_cellItems.resize( m_cellStarts[numOfAllCells] );
+	// kept between builds so a grid rebuilt every frame does not allocate
+	std::vector<int>& fillPositions = m_cellFillPositions;
+	fillPositions.assign( m_cellStarts.begin(), m_cellStarts.end() - 1 );
+	for (int itemIndex = 0; itemIndex < (int)itemBounds.size(); itemIndex++) {
+		IntVec2 minCoords = GetCellCoords( itemBounds[itemIndex].m_mins );
+		IntVec2 maxCoords = GetCellCoords( itemBounds[itemIndex].m_maxs );
+		for (int y = minCoords.y; y <= maxCoords.y; y++) {
+			for (int x = minCoords.x; x <= maxCoords.x; x++) {
+				m_cellItems[fillPositions[(size_t)y * numOfCells.x + x]++] = itemIndex;
+			}
+		}
+	}
+}
+
+void UniformGrid2D::Clear()
+{
+	m_numOfCells = IntVec2( 0, 0 );
+	m_cellStarts.clear();
+	m_cellItems.clear();
+	m_itemBounds.clear();
+}
+
+bool UniformGrid2D::IsEmpty() const
+{
+	return m_cellItems.empty();
+}
+
+IntVec2 UniformGrid2D::GetCellCoords( Vec2 const& point ) const
+{
+	int x = (int)floorf( (point.x - m_bounds.m_mins.x) * m_inversedCellSize.x );
+	int y = (int)floorf( (point.y - m_bounds.m_mins.y) * m_inversedCellSize.y );
+	return IntVec2( GetClamped( x, 0, m_numOfCells.x - 1 ), GetClamped( y, 0, m_numOfCells.y - 1 ) );
+}
+
+AABB2 UniformGrid2D::GetCellBounds( IntVec2 const& cellCoords ) const
+{
+	Vec2 mins = m_bounds.m_mins + Vec2( (float)cellCoords.x * m_cellSize.x, (float)cellCoords.y * m_cellSize.y );
+	return AABB2( mins, mins + m_cellSize );
+}
+
+int const* UniformGrid2D::GetItemsInCell( IntVec2 const& cellCoords, int& out_numOfItems ) const
+{
+	size_t cellIndex = (size_t)cellCoords.y * m_numOfCells.x + cellCoords.x;
+	out_numOfItems = m_cellStarts[cellIndex + 1] - m_cellStarts[cellIndex];
+	return m_cellItems.data() + m_cellStarts[cellIndex];
+}
+
+int const* UniformGrid2D::GetItemsAtPoint( Vec2 const& point, int& out_numOfItems ) const
+{
+	if (m_cellItems.empty()) {
+		out_numOfItems = 0;
+		return nullptr;
+	}
+	return GetItemsInCell( GetCellCoords( point ), out_numOfItems );
+}
+
+void UniformGrid2D::GetItemsOverlappingBox( AABB2 const& box, std::vector<int>& out_items ) const
+{
+	if (m_cellItems.empty()) {
+		return;
+	}
+	size_t firstNewItem = out_items.size();
+	IntVec2 minCoords = GetCellCoords( box.m_mins );
+	IntVec2 maxCoords = GetCellCoords( box.m_maxs );
+	for (int y = minCoords.y; y <= maxCoords.y; y++) {
+		for (int x = minCoords.x; x <= maxCoords.x; x++) {
+			int numOfItems = 0;
+			int const* items = GetItemsInCell( IntVec2( x, y ), numOfItems );
+			for (int i = 0; i < numOfItems; i++) {
+				AABB2 const& bounds = m_itemBounds[items[i]];
+				if (bounds.m_mins.x <= box.m_maxs.x && bounds.m_maxs.x >= box.m_mins.x && bounds.m_mins.y <= box.m_maxs.y && bounds.m_maxs.y >= box.m_mins.y) {
+					out_items.push_back( items[i] );
+				}
+			}
+		}
+	}
+	// an item spanning several cells was found once per cell
+	std::sort( out_items.begin() + firstNewItem, out_items.end() );
+	out_items.erase( std::unique( out_items.begin() + firstNewItem, out_items.end() ), out_items.end() );
+}
+
+AABB2 const& UniformGrid2D::GetItemBounds( int itemIndex ) const
+{
+	return m_itemBounds[itemIndex];
+}
+
+IntVec2 UniformGrid2D::GetSuggestedNumOfCells( AABB2 const& gridBounds, int numOfItems, float itemsPerCell )
+{
+	Vec2 dimensions = gridBounds.GetDimensions();
+	float numOfAllCells = (float)numOfItems / itemsPerCell;
+	if (numOfAllCells < 1.f || dimensions.x <= 0.f || dimensions.y <= 0.f) {
+		return IntVec2( 1, 1 );
+	}
+	// square cells as far as the box allows
+	float cellSideLength = sqrtf( dimensions.x * dimensions.y / numOfAllCells );
+	int numOfCellsX = (int)ceilf( dimensions.x / cellSideLength );
+	int numOfCellsY = (int)ceilf( dimensions.y / cellSideLength );
+	return IntVec2( numOfCellsX > 1 ? numOfCellsX : 1, numOfCellsY > 1 ? numOfCellsY : 1 );
+}
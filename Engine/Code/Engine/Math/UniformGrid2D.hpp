@@ -0,0 +1,45 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/IntVec2.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+// A uniform grid of cells over a box, every cell lists the items whose bounds overlap it
+// Items are the indexes of the bounds given to Build, the caller maps them back to its own objects
+// A cell keeps its items in ascending index order, so the first hit in a cell is the first hit of a linear scan
+// The lists are packed in one array, the grid is rebuilt rather than updated when items move
+// Queries do not change the grid, so several threads can query it at the same time
+class UniformGrid2D {
+public:
+	UniformGrid2D() {}
+
+	/// Put every item into the cells its bounds overlap, bounds outside the grid box are clamped into the border cells
+	void Build( AABB2 const& gridBounds, IntVec2 const& numOfCells, std::vector<AABB2> const& itemBounds );
+	void Clear();
+	bool IsEmpty() const;
+
+	/// Get the cell a point falls in, points outside the grid box go to the nearest border cell
+	IntVec2 GetCellCoords( Vec2 const& point ) const;
+	AABB2 GetCellBounds( IntVec2 const& cellCoords ) const;
+	/// Get the items listed in a cell, out_numOfItems is 0 for an empty cell
+	int const* GetItemsInCell( IntVec2 const& cellCoords, int& out_numOfItems ) const;
+	/// Get the candidates for a point query, the items listed in the cell of the point
+	int const* GetItemsAtPoint( Vec2 const& point, int& out_numOfItems ) const;
+	/// Append the items whose bounds overlap the box, each item only once and in ascending order
+	void GetItemsOverlappingBox( AABB2 const& box, std::vector<int>& out_items ) const;
+	AABB2 const& GetItemBounds( int itemIndex ) const;
+
+	/// Pick a cell count that puts about itemsPerCell items into a cell for items spread evenly over the box
+	static IntVec2 GetSuggestedNumOfCells( AABB2 const& gridBounds, int numOfItems, float itemsPerCell = 2.f );
+
+protected:
+	AABB2 m_bounds;
+	IntVec2 m_numOfCells;
+	Vec2 m_cellSize;
+	Vec2 m_inversedCellSize;
+	std::vector<int> m_cellStarts; // items of cell i are m_cellItems[m_cellStarts[i], m_cellStarts[i + 1])
+	std::vector<int> m_cellItems;
+	std::vector<AABB2> m_itemBounds;
+	std::vector<int> m_cellFillPositions;
+};
@@ -0,0 +1,608 @@
+#include "Engine/Math/VoronoiDiagram.hpp"
+#include "Engine/Math/RandomNumberGenerator.hpp"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+//-----------------------------------------------------------------------------------------------
+// The sweep runs in doubles and does its float operations in the same order as the old game side
+// solvers, so diagrams do not change for a caller that moves over to this one
+
+static VoronoiVec2d GetBisectorDir( VoronoiVec2d const& siteA, VoronoiVec2d const& siteB )
+{
+	// (siteA - siteB) normalized and rotated by -90 degrees
+	double x = siteA.x - siteB.x;
+	double y = siteA.y - siteB.y;
+	double length = sqrt( x * x + y * y );
+	return VoronoiVec2d( y / length, -(x / length) );
+}
+
+static double GetDistance2D( VoronoiVec2d const& positionA, VoronoiVec2d const& positionB )
+{
+	return sqrt( (positionA.x - positionB.x) * (positionA.x - positionB.x) + (positionA.y - positionB.y) * (positionA.y - positionB.y) );
+}
+
+static bool SolveSweepEdgeIntersection( VoronoiSweepEdge const& e1, VoronoiSweepEdge const& e2, VoronoiVec2d& out_res )
+{
+	double d = -(e1.m_dir.x * e2.m_dir.y) + (e1.m_dir.y * e2.m_dir.x);
+	double dx = -(e2.m_startPos.x - e1.m_startPos.x) * e2.m_dir.y + (e2.m_startPos.y - e1.m_startPos.y) * e2.m_dir.x;
+	if (d == 0.f) {
+		return false;
+	}
+	double t1 = dx / d;
+	out_res = VoronoiVec2d( e1.m_dir.x * t1 + e1.m_startPos.x, e1.m_dir.y * t1 + e1.m_startPos.y );
+	if ((out_res.x - e1.m_startPos.x) / e1.m_dir.x < 0) {
+		return false;
+	}
+	else if ((out_res.y - e1.m_startPos.y) / e1.m_dir.y < 0) {
+		return false;
+	}
+	else if ((out_res.x - e2.m_startPos.x) / e2.m_dir.x < 0) {
+		return false;
+	}
+	else if ((out_res.y - e2.m_startPos.y) / e2.m_dir.y < 0) {
+		return false;
+	}
+	return true;
+}
+
+// the arc of a focus for the directrix is y = a * (x - b)^2 + c
+struct VoronoiArc {
+	VoronoiArc( VoronoiVec2d const& focus, double directrixY )
+		:a( 1.f / (focus.y - directrixY) * 0.5f ), b( focus.x ), c( (focus.y + directrixY) * 0.5f ) {}
+	double Calculate( double x ) const { double xmb = x - b; return a * xmb * xmb + c; }
+	double a;
+	double b;
+	double c;
+};
+
+static void SolveArcIntersection( VoronoiArc const& p1, VoronoiArc const& p2, double& out_x1, double& out_x2 )
+{
+	double a = (p1.a - p2.a);
+	double b = -2.f * (p1.a * p1.b - p2.a * p2.b);
+	double c = p1.a * p1.b * p1.b + p1.c - p2.a * p2.b * p2.b - p2.c;
+	double sqrDelta = b * b - 4 * a * c;
+	if (sqrDelta < 0.f) {
+		out_x1 = FLT_MAX;
+		out_x2 = FLT_MAX;
+		return;
+	}
+	double inv2a = 0.5f / a;
+	out_x1 = inv2a * (-b + sqrt( sqrDelta ));
+	out_x2 = inv2a * (-b - sqrt( sqrDelta ));
+}
+
+//-----------------------------------------------------------------------------------------------
+void VoronoiDiagram::Clear()
+{
+	m_sites.clear();
+	m_vertices.clear();
+	m_halfEdges.clear();
+	m_siteHalfEdges.clear();
+}
+
+bool VoronoiDiagram::GetCellVertices( int siteIndex, std::vector<Vec2>& out_vertices ) const
+{
+	out_vertices.clear();
+	int firstHalfEdge = m_siteHalfEdges[siteIndex];
+	if (firstHalfEdge < 0) {
+		return false;
+	}
+	int halfEdge = firstHalfEdge;
+	do {
+		VoronoiHalfEdge const& edge = m_halfEdges[halfEdge];
+		if (edge.m_origin < 0 || edge.m_next < 0 || (int)out_vertices.size() > (int)m_halfEdges.size()) {
+			out_vertices.clear();
+			return false;
+		}
+		out_vertices.push_back( m_vertices[edge.m_origin] );
+		halfEdge = edge.m_next;
+	} while (halfEdge != firstHalfEdge);
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void VoronoiSolver::Solve( std::vector<Vec2> const& sites, VoronoiDiagram& out_diagram, RandomNumberGenerator* jitterRNG /*= nullptr */ )
+{
+	out_diagram.Clear();
+	m_diagram = &out_diagram;
+	m_sites.clear();
+	m_sweepEdges.clear();
+	m_breakpoints.clear();
+	m_events.clear();
+	m_eventHeap.clear();
+	m_root = -1;
+	m_firstPoint = -1;
+	m_priorityState = 0x9E3779B9u;
+
+	int numOfSites = (int)sites.size();
+	m_sites.reserve( numOfSites );
+	out_diagram.m_sites.reserve( numOfSites );
+	out_diagram.m_siteHalfEdges.resize( numOfSites, -1 );
+	for (int i = 0; i < numOfSites; i++) {
+		VoronoiVec2d pos( sites[i].x, sites[i].y );
+		if (jitterRNG) {
+			double xNoise = (double)jitterRNG->RollRandomFloatInRange( -0.0001f, 0.0001f ) * (double)jitterRNG->RollRandomFloatInRange( -0.0001f, 0.0001f );
+			double yNoise = (double)jitterRNG->RollRandomFloatInRange( -0.0001f, 0.0001f ) * (double)jitterRNG->RollRandomFloatInRange( -0.0001f, 0.0001f );
+			pos = VoronoiVec2d( xNoise + pos.x, yNoise + pos.y );
+		}
+		m_sites.push_back( pos );
+		out_diagram.m_sites.push_back( Vec2( (float)pos.x, (float)pos.y ) );
+	}
+	// a diagram of n sites has at most 2n - 5 vertices, each site and each vertex makes one edge (two half edges)
+	out_diagram.m_vertices.reserve( (size_t)numOfSites * 2 );
+	out_diagram.m_halfEdges.reserve( (size_t)numOfSites * 6 );
+	m_sweepEdges.reserve( (size_t)numOfSites * 6 );
+	m_breakpoints.reserve( (size_t)numOfSites * 4 + 2 );
+	m_events.reserve( (size_t)numOfSites * 4 );
+	for (int i = 0; i < numOfSites; i++) {
+		VoronoiSweepEvent event;
+		event.m_triggerY = m_sites[i].y;
+		event.m_siteIndex = i;
+		m_events.push_back( event );
+		PushEvent( i );
+	}
+
+	while (!m_eventHeap.empty()) {
+		int eventIndex = PopEvent();
+		m_directrixY = m_events[eventIndex].m_triggerY;
+		if (m_events[eventIndex].m_siteIndex >= 0) {
+			HandleSiteEvent( m_events[eventIndex].m_siteIndex );
+		}
+		else {
+			// copy, new events can reallocate the list
+			VoronoiSweepEvent event = m_events[eventIndex];
+			HandleCircleEvent( event );
+		}
+	}
+	m_diagram = nullptr;
+}
+
+void VoronoiSolver::HandleSiteEvent( int siteIndex )
+{
+	if (m_firstPoint < 0) {
+		int leftEnd = NewBreakpoint( -1, -1, -1, siteIndex );
+		m_breakpoints[leftEnd].m_hasLeftArc = false;
+		int rightEnd = NewBreakpoint( -1, -1, siteIndex, -1 );
+		m_breakpoints[rightEnd].m_hasRightArc = false;
+		m_root = leftEnd;
+		m_firstPoint = leftEnd;
+		InsertBreakpointAfter( leftEnd, rightEnd );
+		return;
+	}
+
+	VoronoiVec2d const sitePos = m_sites[siteIndex];
+	// last breakpoint left of the site, the arc above the site starts there
+	int arcStart = -1;
+	for (int point = m_root; point >= 0;) {
+		if (GetBreakpointX( m_breakpoints[point] ) <= sitePos.x) {
+			arcStart = point;
+			point = m_breakpoints[point].m_rightChild;
+		}
+		else {
+			point = m_breakpoints[point].m_leftChild;
+		}
+	}
+	if (arcStart < 0 || m_breakpoints[arcStart].m_next < 0 || !(GetBreakpointX( m_breakpoints[m_breakpoints[arcStart].m_next] ) > sitePos.x)) {
+		return;
+	}
+	int arcEnd = m_breakpoints[arcStart].m_next;
+	int arcSite = m_breakpoints[arcStart].m_rightSite;
+	double y = VoronoiArc( m_sites[arcSite], m_directrixY ).Calculate( sitePos.x );
+
+	int leftHalfEdge = AddHalfEdgePair( arcSite, siteIndex, VoronoiVec2d( sitePos.x, y ), GetBisectorDir( m_sites[arcSite], sitePos ) );
+	int rightHalfEdge = leftHalfEdge + 1;
+	int IP1 = NewBreakpoint( leftHalfEdge, rightHalfEdge, arcSite, siteIndex );
+	int IP2 = NewBreakpoint( rightHalfEdge, leftHalfEdge, siteIndex, arcSite );
+	if (m_breakpoints[arcStart].m_leftHalfEdge >= 0) {
+		AddCircleEventIfBelow( m_breakpoints[arcStart].m_leftHalfEdge, leftHalfEdge, arcSite, arcStart, IP1 );
+	}
+	if (m_breakpoints[arcEnd].m_leftHalfEdge >= 0) {
+		AddCircleEventIfBelow( m_breakpoints[arcEnd].m_leftHalfEdge, rightHalfEdge, arcSite, IP2, arcEnd );
+	}
+	InsertBreakpointAfter( arcStart, IP1 );
+	InsertBreakpointAfter( IP1, IP2 );
+}
+
+void VoronoiSolver::HandleCircleEvent( VoronoiSweepEvent const& event )
+{
+	int IPLeft = event.m_pointMeetLeft;
+	int IPRight = event.m_pointMeetRight;
+	if (!m_breakpoints[IPLeft].m_isActive || !m_breakpoints[IPRight].m_isActive) {
+		return;
+	}
+	std::vector<VoronoiHalfEdge>& halfEdges = m_diagram->m_halfEdges;
+	VoronoiVec2d const intrPos = event.m_intersectionPos;
+	int vertexIndex = (int)m_diagram->m_vertices.size();
+	m_diagram->m_vertices.push_back( Vec2( (float)intrPos.x, (float)intrPos.y ) );
+	int IPLeftLeftHalfEdge = m_breakpoints[IPLeft].m_leftHalfEdge;
+	int IPLeftRightHalfEdge = m_breakpoints[IPLeft].m_rightHalfEdge;
+	int IPRightLeftHalfEdge = m_breakpoints[IPRight].m_leftHalfEdge;
+	int IPRightRightHalfEdge = m_breakpoints[IPRight].m_rightHalfEdge;
+	halfEdges[IPLeftRightHalfEdge].m_origin = vertexIndex;
+	halfEdges[IPRightRightHalfEdge].m_origin = vertexIndex;
+	// the neighbors are taken around IPLeft and the breakpoint after it, IPRight is that one whenever the event is still valid
+	int IPLeftLeft = m_breakpoints[IPLeft].m_prev;
+	int IPRightRight = m_breakpoints[m_breakpoints[IPLeft].m_next].m_next;
+
+	int leftSite = m_breakpoints[IPLeft].m_leftSite;
+	int rightSite = m_breakpoints[IPRight].m_rightSite;
+	int newLeftHalfEdge = AddHalfEdgePair( leftSite, rightSite, intrPos, GetBisectorDir( m_sites[leftSite], m_sites[rightSite] ) );
+	int newRightHalfEdge = newLeftHalfEdge + 1;
+	halfEdges[newLeftHalfEdge].m_origin = vertexIndex;
+
+	halfEdges[newLeftHalfEdge].m_prev = IPLeftLeftHalfEdge;
+	halfEdges[IPLeftLeftHalfEdge].m_next = newLeftHalfEdge;
+	halfEdges[newRightHalfEdge].m_next = IPRightRightHalfEdge;
+	halfEdges[IPRightRightHalfEdge].m_prev = newRightHalfEdge;
+	halfEdges[IPRightLeftHalfEdge].m_next = IPLeftRightHalfEdge;
+	halfEdges[IPLeftRightHalfEdge].m_prev = IPRightLeftHalfEdge;
+
+	int IPNew = NewBreakpoint( newLeftHalfEdge, newRightHalfEdge, leftSite, rightSite );
+	m_breakpoints[IPNew].m_hasLeftArc = m_breakpoints[IPLeft].m_hasLeftArc;
+	m_breakpoints[IPNew].m_hasRightArc = m_breakpoints[IPRight].m_hasRightArc;
+	InsertBreakpointAfter( IPLeftLeft, IPNew );
+	EraseBreakpoint( m_breakpoints[IPLeft].m_next );
+	EraseBreakpoint( IPLeft );
+	DeactivateBreakpoint( IPLeft );
+	DeactivateBreakpoint( IPRight );
+
+	int IPLeftLeftEdge = m_breakpoints[IPLeftLeft].m_leftHalfEdge;
+	if (IPLeftLeftEdge >= 0) {
+		AddCircleEventIfBelow( IPLeftLeftEdge, newLeftHalfEdge, m_breakpoints[IPLeftLeft].m_rightSite, IPLeftLeft, IPNew );
+		AddCircleEventIfBelow( IPLeftLeftEdge, newRightHalfEdge, m_breakpoints[IPLeftLeft].m_rightSite, IPLeftLeft, IPNew );
+	}
+	int IPRightRightEdge = m_breakpoints[IPRightRight].m_leftHalfEdge;
+	if (IPRightRightEdge >= 0) {
+		AddCircleEventIfBelow( IPRightRightEdge, newLeftHalfEdge, m_breakpoints[IPRightRight].m_leftSite, IPNew, IPRightRight );
+		AddCircleEventIfBelow( IPRightRightEdge, newRightHalfEdge, m_breakpoints[IPRightRight].m_leftSite, IPNew, IPRightRight );
+	}
+}
+
+double VoronoiSolver::GetBreakpointX( VoronoiBreakpoint const& point ) const
+{
+	if (!point.m_hasLeftArc) {
+		return -10000000000.f;
+	}
+	if (!point.m_hasRightArc) {
+		return 10000000000.f;
+	}
+	double x1, x2;
+	SolveArcIntersection( VoronoiArc( m_sites[point.m_leftSite], m_directrixY ), VoronoiArc( m_sites[point.m_rightSite], m_directrixY ), x1, x2 );
+	if (m_sweepEdges[point.m_leftHalfEdge].m_dir.x < 0.f) {
+		return std::min( x1, x2 );
+	}
+	else {
+		return std::max( x1, x2 );
+	}
+}
+
+int VoronoiSolver::AddHalfEdgePair( int site, int twinSite, VoronoiVec2d const& startPos, VoronoiVec2d const& dir )
+{
+	std::vector<VoronoiHalfEdge>& halfEdges = m_diagram->m_halfEdges;
+	int halfEdge = (int)halfEdges.size();
+	halfEdges.emplace_back();
+	halfEdges.emplace_back();
+	halfEdges[halfEdge].m_site = site;
+	halfEdges[halfEdge].m_twin = halfEdge + 1;
+	halfEdges[halfEdge + 1].m_site = twinSite;
+	halfEdges[halfEdge + 1].m_twin = halfEdge;
+	m_sweepEdges.push_back( VoronoiSweepEdge{ startPos, dir } );
+	m_sweepEdges.push_back( VoronoiSweepEdge{ startPos, VoronoiVec2d( -dir.x, -dir.y ) } );
+
+	std::vector<int>& siteHalfEdges = m_diagram->m_siteHalfEdges;
+	if (siteHalfEdges[site] < 0) {
+		siteHalfEdges[site] = halfEdge;
+	}
+	if (siteHalfEdges[twinSite] < 0) {
+		siteHalfEdges[twinSite] = halfEdge + 1;
+	}
+	return halfEdge;
+}
+
+void VoronoiSolver::AddCircleEventIfBelow( int halfEdgeA, int halfEdgeB, int focusSite, int pointMeetLeft, int pointMeetRight )
+{
+	VoronoiVec2d intrPos;
+	if (!SolveSweepEdgeIntersection( m_sweepEdges[halfEdgeA], m_sweepEdges[halfEdgeB], intrPos )) {
+		return;
+	}
+	double dist = GetDistance2D( intrPos, m_sites[focusSite] );
+	if (!(intrPos.y + dist > m_directrixY)) {
+		return;
+	}
+	VoronoiSweepEvent event;
+	event.m_triggerY = intrPos.y + dist;
+	event.m_intersectionPos = intrPos;
+	event.m_pointMeetLeft = pointMeetLeft;
+	event.m_pointMeetRight = pointMeetRight;
+	event.m_nextEventOfLeft = m_breakpoints[pointMeetLeft].m_firstEventAsLeft;
+	event.m_nextEventOfRight = m_breakpoints[pointMeetRight].m_firstEventAsRight;
+	int eventIndex = (int)m_events.size();
+	m_breakpoints[pointMeetLeft].m_firstEventAsLeft = eventIndex;
+	m_breakpoints[pointMeetRight].m_firstEventAsRight = eventIndex;
+	m_events.push_back( event );
+	PushEvent( eventIndex );
+}
+
+void VoronoiSolver::DeactivateBreakpoint( int point )
+{
+	m_breakpoints[point].m_isActive = false;
+	for (int eventIndex = m_breakpoints[point].m_firstEventAsLeft; eventIndex >= 0; eventIndex = m_events[eventIndex].m_nextEventOfLeft) {
+		RemoveEvent( eventIndex );
+	}
+	for (int eventIndex = m_breakpoints[point].m_firstEventAsRight; eventIndex >= 0; eventIndex = m_events[eventIndex].m_nextEventOfRight) {
+		RemoveEvent( eventIndex );
+	}
+}
+
+int VoronoiSolver::NewBreakpoint( int leftHalfEdge, int rightHalfEdge, int leftSite, int rightSite )
+{
+	int point = (int)m_breakpoints.size();
+	m_breakpoints.emplace_back();
+	VoronoiBreakpoint& newPoint = m_breakpoints.back();
+	newPoint.m_leftHalfEdge = leftHalfEdge;
+	newPoint.m_rightHalfEdge = rightHalfEdge;
+	newPoint.m_leftSite = leftSite;
+	newPoint.m_rightSite = rightSite;
+	// xorshift, the tree shape is the same every run
+	m_priorityState ^= m_priorityState << 13;
+	m_priorityState ^= m_priorityState >> 17;
+	m_priorityState ^= m_priorityState << 5;
+	newPoint.m_priority = m_priorityState;
+	return point;
+}
+
+void VoronoiSolver::InsertBreakpointAfter( int prevPoint, int point )
+{
+	VoronoiBreakpoint& prev = m_breakpoints[prevPoint];
+	VoronoiBreakpoint& cur = m_breakpoints[point];
+	cur.m_prev = prevPoint;
+	cur.m_next = prev.m_next;
+	if (prev.m_next >= 0) {
+		m_breakpoints[prev.m_next].m_prev = point;
+	}
+	prev.m_next = point;
+
+	// the in-order successor slot: right child of prevPoint, or left child of the leftmost node of its right subtree
+	if (prev.m_rightChild < 0) {
+		prev.m_rightChild = point;
+		cur.m_parent = prevPoint;
+	}
+	else {
+		int leftmost = prev.m_rightChild;
+		while (m_breakpoints[leftmost].m_leftChild >= 0) {
+			leftmost = m_breakpoints[leftmost].m_leftChild;
+		}
+		m_breakpoints[leftmost].m_leftChild = point;
+		cur.m_parent = leftmost;
+	}
+	while (cur.m_parent >= 0 && m_breakpoints[cur.m_parent].m_priority < cur.m_priority) {
+		RotateUp( point );
+	}
+}
+
+void VoronoiSolver::EraseBreakpoint( int point )
+{
+	VoronoiBreakpoint& cur = m_breakpoints[point];
+	// rotate the point down to a leaf, keeping the heap order of the priorities
+	while (cur.m_leftChild >= 0 || cur.m_rightChild >= 0) {
+		int child = cur.m_leftChild;
+		if (child < 0 || (cur.m_rightChild >= 0 && m_breakpoints[cur.m_rightChild].m_priority > m_breakpoints[child].m_priority)) {
+			child = cur.m_rightChild;
+		}
+		RotateUp( child );
+	}
+	if (cur.m_parent < 0) {
+		m_root = -1;
+	}
+	else if (m_breakpoints[cur.m_parent].m_leftChild == point) {
+		m_breakpoints[cur.m_parent].m_leftChild = -1;
+	}
+	else {
+		m_breakpoints[cur.m_parent].m_rightChild = -1;
+	}
+	cur.m_parent = -1;
+
+	if (cur.m_prev >= 0) {
+		m_breakpoints[cur.m_prev].m_next = cur.m_next;
+	}
+	else {
+		m_firstPoint = cur.m_next;
+	}
+	if (cur.m_next >= 0) {
+		m_breakpoints[cur.m_next].m_prev = cur.m_prev;
+	}
+}
+
+void VoronoiSolver::RotateUp( int point )
+{
+	VoronoiBreakpoint& cur = m_breakpoints[point];
+	int parentIndex = cur.m_parent;
+	VoronoiBreakpoint& parent = m_breakpoints[parentIndex];
+	int grandParent = parent.m_parent;
+	if (parent.m_leftChild == point) {
+		parent.m_leftChild = cur.m_rightChild;
+		if (cur.m_rightChild >= 0) {
+			m_breakpoints[cur.m_rightChild].m_parent = parentIndex;
+		}
+		cur.m_rightChild = parentIndex;
+	}
+	else {
+		parent.m_rightChild = cur.m_leftChild;
+		if (cur.m_leftChild >= 0) {
+			m_breakpoints[cur.m_leftChild].m_parent = parentIndex;
+		}
+		cur.m_leftChild = parentIndex;
+	}
+	parent.m_parent = point;
+	cur.m_parent = grandParent;
+	if (grandParent < 0) {
+		m_root = point;
+	}
+	else if (m_breakpoints[grandParent].m_leftChild == parentIndex) {
+		m_breakpoints[grandParent].m_leftChild = point;
+	}
+	else {
+		m_breakpoints[grandParent].m_rightChild = point;
+	}
+}
+
+bool VoronoiSolver::IsEventBefore( int eventA, int eventB ) const
+{
+	// equal y goes in creation order, sites first
+	if (m_events[eventA].m_triggerY != m_events[eventB].m_triggerY) {
+		return m_events[eventA].m_triggerY < m_events[eventB].m_triggerY;
+	}
+	return eventA < eventB;
+}
+
+void VoronoiSolver::PushEvent( int eventIndex )
+{
+	m_events[eventIndex].m_heapIndex = (int)m_eventHeap.size();
+	m_eventHeap.push_back( eventIndex );
+	SiftEventUp( (int)m_eventHeap.size() - 1 );
+}
+
+int VoronoiSolver::PopEvent()
+{
+	int eventIndex = m_eventHeap[0];
+	RemoveEvent( eventIndex );
+	return eventIndex;
+}
+
+void VoronoiSolver::RemoveEvent( int eventIndex )
+{
+	int heapIndex = m_events[eventIndex].m_heapIndex;
+	if (heapIndex < 0) {
+		return;
+	}
+	m_events[eventIndex].m_heapIndex = -1;
+	int lastEventIndex = m_eventHeap.back();
+	m_eventHeap.pop_back();
+	if (heapIndex == (int)m_eventHeap.size()) {
+		return;
+	}
+	m_eventHeap[heapIndex] = lastEventIndex;
+	m_events[lastEventIndex].m_heapIndex = heapIndex;
+	SiftEventUp( heapIndex );
+	SiftEventDown( m_events[lastEventIndex].m_heapIndex );
+}
+
+void VoronoiSolver::SiftEventUp( int heapIndex )
+{
+	int eventIndex = m_eventHeap[heapIndex];
+	while (heapIndex > 0) {
+		int parentIndex = (heapIndex - 1) / 2;
+		if (!IsEventBefore( eventIndex, m_eventHeap[parentIndex] )) {
+			break;
+		}
+		m_eventHeap[heapIndex] = m_eventHeap[parentIndex];
+		m_events[m_eventHeap[heapIndex]].m_heapIndex = heapIndex;
+		heapIndex = parentIndex;
+	}
+	m_eventHeap[heapIndex] = eventIndex;
+	m_events[eventIndex].m_heapIndex = heapIndex;
+}
+
+void VoronoiSolver::SiftEventDown( int heapIndex )
+{
+	int eventIndex = m_eventHeap[heapIndex];
+	int heapSize = (int)m_eventHeap.size();
+	for (;;) {
+		int childIndex = heapIndex * 2 + 1;
+		if (childIndex >= heapSize) {
+			break;
+		}
+		if (childIndex + 1 < heapSize && IsEventBefore( m_eventHeap[childIndex + 1], m_eventHeap[childIndex] )) {
+			childIndex++;
+		}
+		if (!IsEventBefore( m_eventHeap[childIndex], eventIndex )) {
+			break;
+		}
+		m_eventHeap[heapIndex] = m_eventHeap[childIndex];
+		m_events[m_eventHeap[heapIndex]].m_heapIndex = heapIndex;
+		heapIndex = childIndex;
+	}
+	m_eventHeap[heapIndex] = eventIndex;
+	m_events[eventIndex].m_heapIndex = heapIndex;
+}
+
+//-----------------------------------------------------------------------------------------------
+void SolveVoronoiDiagram( std::vector<Vec2> const& sites, VoronoiDiagram& out_diagram, RandomNumberGenerator* jitterRNG /*= nullptr */ )
+{
+	VoronoiSolver solver;
+	solver.Solve( sites, out_diagram, jitterRNG );
+}
+
+// keep the part of the polygon on one side of an axis aligned line (Sutherland-Hodgman)
+static void ClipPolygonByAxis( std::vector<Vec2> const& polygon, std::vector<Vec2>& out_polygon, int axis, float value, bool keepGreater )
+{
+	out_polygon.clear();
+	int numOfVertices = (int)polygon.size();
+	for (int i = 0; i < numOfVertices; i++) {
+		Vec2 const& cur = polygon[i];
+		Vec2 const& next = polygon[(i + 1) % numOfVertices];
+		float curValue = axis == 0 ? cur.x : cur.y;
+		float nextValue = axis == 0 ? next.x : next.y;
+		bool isCurInside = keepGreater ? curValue >= value : curValue <= value;
+		bool isNextInside = keepGreater ? nextValue >= value : nextValue <= value;
+		if (isCurInside) {
+			out_polygon.push_back( cur );
+		}
+		if (isCurInside != isNextInside) {
+			float t = (value - curValue) / (nextValue - curValue);
+			out_polygon.push_back( cur + (next - cur) * t );
+		}
+	}
+}
+
+void RelaxVoronoiSites( std::vector<Vec2>& sites, AABB2 const& bounds, int numOfIterations /*= 1*/, RandomNumberGenerator* jitterRNG /*= nullptr */ )
+{
+	int numOfSites = (int)sites.size();
+	// four far away guard sites close every cell that reaches into the bounds
+	Vec2 center = bounds.GetCenter();
+	Vec2 dimensions = bounds.GetDimensions();
+	float guardDist = std::max( dimensions.x, dimensions.y ) * 10.f + 1.f;
+	VoronoiSolver solver;
+	VoronoiDiagram diagram;
+	std::vector<Vec2> guardedSites;
+	std::vector<Vec2> cell;
+	std::vector<Vec2> clippedCell;
+	for (int iteration = 0; iteration < numOfIterations; iteration++) {
+		guardedSites = sites;
+		guardedSites.push_back( Vec2( center.x - guardDist, center.y ) );
+		guardedSites.push_back( Vec2( center.x + guardDist, center.y ) );
+		guardedSites.push_back( Vec2( center.x, center.y - guardDist ) );
+		guardedSites.push_back( Vec2( center.x, center.y + guardDist ) );
+		solver.Solve( guardedSites, diagram, jitterRNG );
+
+		for (int i = 0; i < numOfSites; i++) {
+			if (!diagram.GetCellVertices( i, cell )) {
+				continue;
+			}
+			ClipPolygonByAxis( cell, clippedCell, 0, bounds.m_mins.x, true );
+			ClipPolygonByAxis( clippedCell, cell, 0, bounds.m_maxs.x, false );
+			ClipPolygonByAxis( cell, clippedCell, 1, bounds.m_mins.y, true );
+			ClipPolygonByAxis( clippedCell, cell, 1, bounds.m_maxs.y, false );
+			// centroid of the clipped cell, the signed area makes it independent of the winding
+			// work relative to the first corner, small cells far from the origin lose everything to cancellation otherwise
+			int numOfVertices = (int)cell.size();
+			if (numOfVertices < 3) {
+				continue;
+			}
+			Vec2 origin = cell[0];
+			float doubleArea = 0.f;
+			Vec2 weightedSum;
+			for (int j = 1; j < numOfVertices - 1; j++) {
+				Vec2 cur = cell[j] - origin;
+				Vec2 next = cell[j + 1] - origin;
+				float cross = cur.x * next.y - next.x * cur.y;
+				doubleArea += cross;
+				weightedSum += (cur + next) * cross;
+			}
+			if (doubleArea != 0.f) {
+				sites[i] = origin + weightedSum / (3.f * doubleArea);
+			}
+		}
+	}
+}
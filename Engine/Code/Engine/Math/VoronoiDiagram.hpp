@@ -0,0 +1,123 @@
+#pragma once
+#include "Engine/Math/Vec2.hpp"
+#include "Engine/Math/AABB2.hpp"
+#include <vector>
+
+class RandomNumberGenerator;
+
+//-----------------------------------------------------------------------------------------------
+// Voronoi diagrams by Fortune's sweep, output as a doubly connected edge list in flat arrays
+// A half edge lies on the boundary of its site's cell and runs from its origin to its twin's origin,
+// next and prev walk around that cell
+struct VoronoiHalfEdge {
+	int m_site = -1;
+	int m_origin = -1; // -1 while this end runs off to infinity, only cells on the hull of the sites have those
+	int m_twin = -1;
+	int m_next = -1; // -1 where the cell is open
+	int m_prev = -1;
+};
+
+struct VoronoiDiagram {
+public:
+	void Clear();
+	/// Get the corners of a closed cell in boundary order, return false if the cell is open
+	bool GetCellVertices( int siteIndex, std::vector<Vec2>& out_vertices ) const;
+
+public:
+	std::vector<Vec2> m_sites; // positions the diagram was solved for, after the jitter
+	std::vector<Vec2> m_vertices;
+	std::vector<VoronoiHalfEdge> m_halfEdges;
+	std::vector<int> m_siteHalfEdges; // first half edge of each cell, -1 if the site got none
+};
+
+//-----------------------------------------------------------------------------------------------
+// the sweep itself, keep one around to reuse its buffers between solves
+// The beach line is a treap of breakpoints and the events an indexed heap, so a solve is O(n log n)
+struct VoronoiVec2d {
+	VoronoiVec2d() {}
+	VoronoiVec2d( double inX, double inY ) :x( inX ), y( inY ) {}
+	double x = 0.0;
+	double y = 0.0;
+};
+
+struct VoronoiSweepEdge {
+	VoronoiVec2d m_startPos;
+	VoronoiVec2d m_dir;
+};
+
+struct VoronoiBreakpoint {
+	int m_leftHalfEdge = -1;
+	int m_rightHalfEdge = -1;
+	int m_leftSite = -1;
+	int m_rightSite = -1;
+	bool m_hasLeftArc = true; // the two ends of the beach line have only one arc
+	bool m_hasRightArc = true;
+	bool m_isActive = true;
+	int m_firstEventAsLeft = -1;
+	int m_firstEventAsRight = -1;
+
+	// beach line order
+	int m_prev = -1;
+	int m_next = -1;
+	// treap, a parent's priority is never lower than its children's
+	int m_parent = -1;
+	int m_leftChild = -1;
+	int m_rightChild = -1;
+	unsigned int m_priority = 0;
+};
+
+struct VoronoiSweepEvent {
+	double m_triggerY = 0.0;
+	int m_heapIndex = -1; // -1 once it is popped or removed
+	int m_siteIndex = -1; // -1 for circle events
+	VoronoiVec2d m_intersectionPos;
+	int m_pointMeetLeft = -1;
+	int m_pointMeetRight = -1;
+	int m_nextEventOfLeft = -1; // lists of the circle events of each breakpoint
+	int m_nextEventOfRight = -1;
+};
+
+class VoronoiSolver {
+public:
+	/// Solve the diagram of the sites, jitterRNG shakes every site by about 1e-8 so no four sites sit on one circle
+	void Solve( std::vector<Vec2> const& sites, VoronoiDiagram& out_diagram, RandomNumberGenerator* jitterRNG = nullptr );
+
+private:
+	void HandleSiteEvent( int siteIndex );
+	void HandleCircleEvent( VoronoiSweepEvent const& event );
+	double GetBreakpointX( VoronoiBreakpoint const& point ) const;
+	int AddHalfEdgePair( int site, int twinSite, VoronoiVec2d const& startPos, VoronoiVec2d const& dir );
+	void AddCircleEventIfBelow( int halfEdgeA, int halfEdgeB, int focusSite, int pointMeetLeft, int pointMeetRight );
+	void DeactivateBreakpoint( int point );
+
+	int NewBreakpoint( int leftHalfEdge, int rightHalfEdge, int leftSite, int rightSite );
+	void InsertBreakpointAfter( int prevPoint, int point );
+	void EraseBreakpoint( int point );
+	void RotateUp( int point );
+
+	bool IsEventBefore( int eventA, int eventB ) const;
+	void PushEvent( int eventIndex );
+	int PopEvent();
+	void RemoveEvent( int eventIndex );
+	void SiftEventUp( int heapIndex );
+	void SiftEventDown( int heapIndex );
+
+	VoronoiDiagram* m_diagram = nullptr;
+	std::vector<VoronoiVec2d> m_sites;
+	std::vector<VoronoiSweepEdge> m_sweepEdges; // parallel to the diagram's half edges
+	std::vector<VoronoiBreakpoint> m_breakpoints;
+	std::vector<VoronoiSweepEvent> m_events;
+	std::vector<int> m_eventHeap;
+	int m_root = -1;
+	int m_firstPoint = -1;
+	unsigned int m_priorityState = 0x9E3779B9u;
+	double m_directrixY = 0.0;
+};
+
+//-----------------------------------------------------------------------------------------------
+void SolveVoronoiDiagram( std::vector<Vec2> const& sites, VoronoiDiagram& out_diagram, RandomNumberGenerator* jitterRNG = nullptr );
+
+//-----------------------------------------------------------------------------------------------
+// Lloyd relaxation: move every site to the centroid of its cell clipped to the bounds, numOfIterations times
+// Sites end up evenly spaced without the grid look of a jittered grid
+void RelaxVoronoiSites( std::vector<Vec2>& sites, AABB2 const& bounds, int numOfIterations = 1, RandomNumberGenerator* jitterRNG = nullptr );
@@ -876,6 +876,11 @@ Shader* DX11Renderer::CreateShader( char const* shaderName, char const* shaderSo
 		inputElementDesc[3] = { "NORMAL", 0, DXGI_FORMAT_R32G32_FLOAT, 3, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 };
 		numElements = 4;
 	}
+	else if (type == VertexType::BYTE4_BYTE4) {
+		inputElementDesc[0] = { "POSITION", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+		inputElementDesc[1] = { "TEXCOORD", 0, DXGI_FORMAT_R8G8B8A8_UINT, 0, D3D11_APPEND_ALIGNED_ELEMENT, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+		numElements = 2;
+	}
 
 	hr = m_device->CreateInputLayout(
 		inputElementDesc, numElements,
@@ -1028,6 +1033,18 @@ void DX11Renderer::CopyCPUToGPU( void* data, size_t size, VertexBuffer*& vbo, si
 	m_deviceContext->Unmap( vbo->m_vertexBuffer, 0 );
 }
 
+void DX11Renderer::CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges )
+{
+	UNUSED( changedRanges );
+	GUARANTEE_OR_DIE( size <= vbo->m_size, "Copy is larger than the vertex buffer" );
+	// a dynamic buffer drawn every frame is always in use by a frame in flight, writing ranges in place with no overwrite
+	// would race those draws; discard hands out fresh memory, which has to be filled completely
+	D3D11_MAPPED_SUBRESOURCE resource;
+	m_deviceContext->Map( vbo->m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &resource );
+	memcpy( resource.pData, data, size );
+	m_deviceContext->Unmap( vbo->m_vertexBuffer, 0 );
+}
+
 IndexBuffer* DX11Renderer::CreateIndexBuffer( size_t const size )
 {
 	IndexBuffer* indexBuffer = new IndexBuffer( size );
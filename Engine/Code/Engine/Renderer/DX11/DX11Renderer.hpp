@@ -84,6 +84,7 @@ public:
 	VertexBuffer* CreateVertexBuffer( size_t const size, unsigned int stride = sizeof( Vertex_PCU ) );
 	void CopyCPUToGPU( void const* data, size_t size, VertexBuffer*& vbo, size_t vboOffset = 0 );
 	void CopyCPUToGPU( void* data, size_t size, VertexBuffer*& vbo, size_t vboOffset = 0 );
+	void CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges );
 	void BindVertexBuffer( VertexBuffer* vbo );
 	ConstantBuffer* CreateConstantBuffer( size_t const size );
 	void CopyCPUToGPU( void const* data, size_t size, ConstantBuffer*& cbo );
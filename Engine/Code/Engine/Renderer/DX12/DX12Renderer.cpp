@@ -823,6 +823,26 @@ void DX12Renderer::CopyCPUToGPU( void const* data, size_t size, VertexBuffer*& v
 	vbo->m_vertexBufferView->SizeInBytes = (UINT)size;
 }
 
+void DX12Renderer::CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges )
+{
+	GUARANTEE_OR_DIE( size <= vbo->m_size, "Copy is larger than the vertex buffer" );
+	// the buffer lives in an upload heap and every frame waits for the gpu before it ends,
+	// so no draw reads it now and the changed ranges are written in place
+	UINT8* pVertexDataBegin;
+	CD3DX12_RANGE readRange( 0, 0 );        // We do not intend to read from this resource on the CPU.
+	vbo->m_dx12VertexBuffer->Map( 0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin) );
+	size_t writtenBegin = size;
+	size_t writtenEnd = 0;
+	for (auto const& range : changedRanges) {
+		GUARANTEE_OR_DIE( range.first <= range.second && range.second <= size, "Copy range is out of the vertex buffer" );
+		memcpy( pVertexDataBegin + range.first, (UINT8 const*)data + range.first, range.second - range.first );
+		writtenBegin = range.first < writtenBegin ? range.first : writtenBegin;
+		writtenEnd = range.second > writtenEnd ? range.second : writtenEnd;
+	}
+	CD3DX12_RANGE writtenRange( writtenBegin < writtenEnd ? writtenBegin : 0, writtenEnd );
+	vbo->m_dx12VertexBuffer->Unmap( 0, &writtenRange );
+}
+
 void DX12Renderer::CopyCPUToGPU( void const* data, size_t size, ConstantBuffer*& cbo )
 {
 	DebuggerPrintf( "Warning! Cannot copy CPU to GPU for constant buffer in dx12 interface! Use set custom constants instead!" );
@@ -82,6 +82,7 @@ public:
 	// buffers
 	VertexBuffer* CreateVertexBuffer( size_t const size, unsigned int stride = sizeof( Vertex_PCU ) );
 	void CopyCPUToGPU( void const* data, size_t size, VertexBuffer*& vbo );
+	void CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges );
 	void BindVertexBuffer( VertexBuffer* vbo );
 	ConstantBuffer* CreateConstantBuffer( size_t const size );
 	void CopyCPUToGPU( void const* data, size_t size, ConstantBuffer*& cbo );
@@ -335,6 +335,16 @@ void Renderer::CopyCPUToGPU( void* data, size_t size, VertexBuffer*& vbo, size_t
 #endif
 }
 
+void Renderer::CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges )
+{
+#ifdef ENGINE_DX11_RENDERER_INTERFACE
+	m_dx11Renderer->CopyCPUToGPURanges( data, size, vbo, changedRanges );
+#endif
+#ifdef ENGINE_DX12_RENDERER_INTERFACE
+	m_dx12Renderer->CopyCPUToGPURanges( data, size, vbo, changedRanges );
+#endif
+}
+
 void Renderer::BindVertexBuffer( VertexBuffer* vbo )
 {
 #ifdef ENGINE_DX11_RENDERER_INTERFACE
@@ -66,6 +66,9 @@ public:
 	VertexBuffer* CreateVertexBuffer( size_t const size, unsigned int stride = sizeof( Vertex_PCU ) );
 	void CopyCPUToGPU( void const* data, size_t size, VertexBuffer*& vbo, size_t vboOffset = 0 );
 	void CopyCPUToGPU( void* data, size_t size, VertexBuffer*& vbo, size_t vboOffset = 0 );
+	// data is the whole buffer, only the [begin, end) byte ranges in changedRanges differ from the last upload
+	// dx12 writes just those ranges, dx11 has to upload everything because last frames' draws may still read the buffer
+	void CopyCPUToGPURanges( void const* data, size_t size, VertexBuffer* vbo, std::vector<std::pair<size_t, size_t>> const& changedRanges );
 	void BindVertexBuffer( VertexBuffer* vbo );
 	ConstantBuffer* CreateConstantBuffer( size_t const size );
 	void CopyCPUToGPU( void const* data, size_t size, ConstantBuffer*& cbo );
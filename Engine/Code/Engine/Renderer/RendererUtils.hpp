@@ -56,6 +56,7 @@ enum class VertexType {
 	PCUTBN,
 	PCU_SEPARATED,
 	PCUN_SEPARATED,
+	BYTE4_BYTE4, // 8 byte vertex: POSITION and TEXCOORD are four unsigned bytes each (uint4 in hlsl), the shader decodes them
 };
 
 enum class ShadowMode
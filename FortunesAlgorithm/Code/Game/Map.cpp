@@ -1,9 +1,14 @@
 #include "Game/Map.hpp"
 #include "Game/Game.hpp"
 #include "Game/VoronoiHelper.hpp"
+#include "Engine/Math/VoronoiDiagram.hpp"
 
 static FortuneAlgorithmSolverClass fortuneSolver;
 static std::vector<Vec2> randomPoints;
+// the finished diagram from the engine solver, drawn under the sweep to check it against
+static VoronoiDiagram finishedDiagram;
+static bool showFinishedDiagram = false;
+static int stepCount = 1;
 Map::Map()
 {
 
@@ -22,20 +27,29 @@ void Map::Startup()
 
 void Map::Update()
 {
-	static int count = 1;
-	if (count > 0) {
+	if (stepCount > 0) {
 		for (int i = 0; i < 10; i++) {
 			fortuneSolver.FortuneAlgorithmSingleStep();
 			fortuneSolver.m_doNextStep = false;
-			--count;
-			if (count <= 0) {
+			--stepCount;
+			if (stepCount <= 0) {
 				break;
 			}
 		}
 	}
 	if (g_theInput->WasKeyJustPressed( 'I' )) {
 		fortuneSolver.m_doNextStep = true;
-		count += 100000;
+		stepCount += 100000;
+	}
+	if (g_theInput->WasKeyJustPressed( 'V' )) {
+		showFinishedDiagram = !showFinishedDiagram;
+	}
+	// one Lloyd pass on the points, then sweep again from the top
+	if (g_theInput->WasKeyJustPressed( 'L' )) {
+		std::vector<Vec2> sites( randomPoints.begin(), randomPoints.end() - 4 );
+		RelaxVoronoiSites( sites, g_theGame->m_worldCamera.m_cameraBox );
+		std::copy( sites.begin(), sites.end(), randomPoints.begin() );
+		RestartSweep();
 	}
 }
 
@@ -45,6 +59,15 @@ void Map::Render() const
 	for (int i = 0; i < (int)randomPoints.size(); i++) {
 		AddVertsForAABB2D( verts, AABB2( randomPoints[i] - Vec2( 0.5f, 0.5f ), randomPoints[i] + Vec2( 0.5f, 0.5f ) ), Rgba8( 255, 0, 0 ) );
 	}
+	if (showFinishedDiagram) {
+		for (int i = 0; i < (int)finishedDiagram.m_halfEdges.size(); i++) {
+			VoronoiHalfEdge const& halfEdge = finishedDiagram.m_halfEdges[i];
+			int endVertex = finishedDiagram.m_halfEdges[halfEdge.m_twin].m_origin;
+			if (i < halfEdge.m_twin && halfEdge.m_origin >= 0 && endVertex >= 0) {
+				AddVertsForLineSegment2D( verts, finishedDiagram.m_vertices[halfEdge.m_origin], finishedDiagram.m_vertices[endVertex], 0.6f, Rgba8( 255, 200, 0 ) );
+			}
+		}
+	}
 	fortuneSolver.AddDebugVerts( verts );
 	g_theRenderer->BindTexture( nullptr );
 	g_theRenderer->BindShader( nullptr );
@@ -88,6 +111,14 @@ ExitLoop:*/
 	randomPoints.push_back( Vec2( 100.f, -1000.f ) );
 	randomPoints.push_back( Vec2( 100.f, 1000.f ) );
 	
-	fortuneSolver.FortuneAlgorithmStepInit( randomPoints );
+	RestartSweep();
 	//FortuneAlgorithmSolver( randomPoints, bounds, outEdges );
 }
+
+void Map::RestartSweep()
+{
+	fortuneSolver.FortuneAlgorithmReset();
+	fortuneSolver.FortuneAlgorithmStepInit( randomPoints );
+	SolveVoronoiDiagram( randomPoints, finishedDiagram );
+	stepCount = 1;
+}
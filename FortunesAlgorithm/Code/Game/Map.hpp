@@ -12,5 +12,7 @@ public:
 	void Render() const;
 
 	void PopulateMapWithPolygons();
+	/// start the step by step sweep over randomPoints again and solve the finished diagram for them
+	void RestartSweep();
 	std::vector<MapPolygonUnit> m_mapPolygonUnits;
 };
\ No newline at end of file
@@ -216,6 +216,8 @@ public:
 	void FortuneAlgorithmSolver( std::vector<Vec2> const& sitesPos, std::vector<FortuneHalfEdge*>& out_edges );
 	void FortuneAlgorithmStepInit( std::vector<Vec2> const& sitesPos );
 	void FortuneAlgorithmSingleStep();
+	/// free everything of the last sweep so StepInit can start a new one
+	void FortuneAlgorithmReset();
 	void AddDebugVerts( std::vector<Vertex_PCU>& verts );
 
 	std::priority_queue<FortuneEvent*, std::vector<FortuneEvent*>, FortuneEventGreater> eventList;
@@ -240,6 +242,29 @@ void FortuneAlgorithmSolverClass::FortuneAlgorithmSolver( std::vector<Vec2> cons
 
 }
 
+void FortuneAlgorithmSolverClass::FortuneAlgorithmReset()
+{
+	for (int i = 0; i < (int)parabolas.size(); i++) {
+		delete parabolas[i];
+	}
+	parabolas.clear();
+	for (int i = 0; i < (int)beachline.size(); i++) {
+		delete beachline[i];
+	}
+	beachline.clear();
+	for (int i = 0; i < (int)debugEventList.size(); i++) {
+		delete debugEventList[i];
+	}
+	debugEventList.clear();
+	for (int i = 0; i < (int)allEdges.size(); i++) {
+		delete allEdges[i];
+	}
+	allEdges.clear();
+	eventList = std::priority_queue<FortuneEvent*, std::vector<FortuneEvent*>, FortuneEventGreater>();
+	sites.clear();
+	directrixY = 0.f;
+}
+
 void FortuneAlgorithmSolverClass::FortuneAlgorithmStepInit( std::vector<Vec2> const& sitesPos )
 {
 	for (int i = 0; i < (int)sitesPos.size(); i++) {
@@ -73,6 +73,7 @@ void App::Startup() {
 	m_attractModeMusic = g_theAudio->StartSound( m_audioDictionary[(int)AudioName::AttractMode], true );
 
 	SubscribeEventCallbackFunction( "quit", App::SetQuitting );
+	SubscribeEventCallbackFunction( "Command_PathingBenchmark", Map::Command_PathingBenchmark );
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Libra Version 0.1" );
 	g_devConsole->AddLine( DevConsole::INFO_MINOR, "Initializing..." );
 
@@ -4,6 +4,7 @@
 #include "Game/Bullet.hpp"
 #include "Game/Ray.hpp"
 #include "Game/App.hpp"
+#include "Engine/Core/FlowFieldCache.hpp"
 
 Entity::Entity( Vec2 const& startPos, Map* map):
 	m_position(startPos),
@@ -21,7 +22,7 @@ Entity::Entity( Vec2 const& startPos, Map* map):
 }
 
 Entity::~Entity() {
-  	delete m_targetDistanceTileHeatMap;
+	m_map->ReleaseFlowField( m_targetFlowField );
 }
 
 void Entity::DebugRender() const
@@ -82,7 +83,7 @@ bool Entity::IsActor() const
 
 TileHeatMap const* Entity::GetTargetDistanceTileHeatMap() const
 {
-	return m_targetDistanceTileHeatMap;
+	return m_targetFlowField ? &m_targetFlowField->GetDistanceField() : nullptr;
 }
 
 void Entity::BeAttacked( float hit )
@@ -117,10 +118,9 @@ void Entity::GetAttackedByBullet( Bullet* b )
 
 void Entity::InitializeMovingWarrior()
 {
-	m_targetDistanceTileHeatMap = new TileHeatMap( m_map->GetDimensions() );
 	// wondering
-	m_map->GetRandomWonderPosAndDistanceTileHeatMap( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-	m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+	m_map->GetRandomWonderPosAndFlowField( this, m_lastSeenPosition, m_targetFlowField );
+	m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 	OptimizeRoute();
 	m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_lastSeenPosition;
 	m_goalOrientationDegrees = (m_nextWayPointPosition - m_position).GetOrientationDegrees();
@@ -130,8 +130,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 {
 	if (m_target && m_target->m_isDead) {
 		m_curState = 1;
-		m_map->GetRandomWonderPosAndDistanceTileHeatMap( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-		m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+		m_map->GetRandomWonderPosAndFlowField( this, m_lastSeenPosition, m_targetFlowField );
+		m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 	}
 	m_target = m_map->GetNearestEnemyActor( this );
 
@@ -163,8 +163,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 			if (m_target->m_type == EntityType::_GOOD_PLAYER) {
 				m_map->PlaySound( AudioName::EnemyAlert, m_position, 0.5f );
 			}
-			m_map->GetDistanceTileHeatMapForTargetPos( this, m_target->m_position, *m_targetDistanceTileHeatMap );
-			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_target->m_position );
+			m_map->GetFlowFieldForTargetPos( this, m_target->m_position, m_targetFlowField );
+			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_target->m_position );
 			OptimizeRoute();
 			m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_target->m_position;
 			m_goalOrientationDegrees = (m_nextWayPointPosition - m_position).GetOrientationDegrees();
@@ -181,8 +181,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 			// wondering
 			// is entity reach the destination
 			if (IsPointInsideDisc2D( m_lastSeenPosition, m_position, m_physicsRadius )) {
-				m_map->GetRandomWonderPosAndDistanceTileHeatMap( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-				m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+				m_map->GetRandomWonderPosAndFlowField( this, m_lastSeenPosition, m_targetFlowField );
+				m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 				OptimizeRoute();
 				m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_lastSeenPosition;
 				m_goalOrientationDegrees = (m_nextWayPointPosition - m_position).GetOrientationDegrees();
@@ -208,8 +208,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 		if (!m_target || m_target->m_isDead) {
 			m_curState = 1;
 			m_target = m_map->GetNearestEnemyActor( this );
-			m_map->GetRandomWonderPosAndDistanceTileHeatMap( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+			m_map->GetRandomWonderPosAndFlowField( this, m_lastSeenPosition, m_targetFlowField );
+			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 			OptimizeRoute();
 			m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_lastSeenPosition;
 			m_goalOrientationDegrees = (m_nextWayPointPosition - m_position).GetOrientationDegrees();
@@ -226,8 +226,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 		else if (!hasSight) {
 			m_curState = 3;
 			// update heat map
-			m_map->GetDistanceTileHeatMapForTargetPos( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+			m_map->GetFlowFieldForTargetPos( this, m_lastSeenPosition, m_targetFlowField );
+			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 			OptimizeRoute();
 			m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_lastSeenPosition;
 			// prepare goto state 3
@@ -246,8 +246,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 			// if target moves to another tile
 			if (m_map->GetMapPosFromWorldPos( m_lastSeenPosition ) != m_map->GetMapPosFromWorldPos( m_target->m_position )) {
 				// update heat map
-				m_map->GetDistanceTileHeatMapForTargetPos( this, m_target->m_position, *m_targetDistanceTileHeatMap );
-				m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_target->m_position );
+				m_map->GetFlowFieldForTargetPos( this, m_target->m_position, m_targetFlowField );
+				m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_target->m_position );
 				OptimizeRoute();
 				m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_target->m_position;
 			}
@@ -265,8 +265,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 				float length = forwardVector.GetLength();
 				Vec2 forwardNormal = forwardVector / length;
 				Vec2 sideVector = forwardNormal.GetRotated90Degrees() * (BULLET_PHYSICS_RADIUS + 0.01f);
-				if (!m_targetDistanceTileHeatMap->RayCastVsGrid2D( res1, Ray2D( m_position + sideVector, forwardNormal, length ), FLT_MAX )
-					&& !m_targetDistanceTileHeatMap->RayCastVsGrid2D( res2, Ray2D( m_position - sideVector, forwardNormal, length ), FLT_MAX )) {
+				if (!m_targetFlowField->GetDistanceField().RayCastVsGrid2D( res1, Ray2D( m_position + sideVector, forwardNormal, length ), FLT_MAX )
+					&& !m_targetFlowField->GetDistanceField().RayCastVsGrid2D( res2, Ray2D( m_position - sideVector, forwardNormal, length ), FLT_MAX )) {
 					m_goalOrientationDegrees = (m_target->m_position - m_position).GetOrientationDegrees();;
 					m_velocity = Vec2( 0, 0 );
 				}
@@ -295,8 +295,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 		if (hasSight) {
 			m_curState = 2;
 			// update heat map
-			m_map->GetDistanceTileHeatMapForTargetPos( this, m_target->m_position, *m_targetDistanceTileHeatMap );
-			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_target->m_position );
+			m_map->GetFlowFieldForTargetPos( this, m_target->m_position, m_targetFlowField );
+			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_target->m_position );
 			OptimizeRoute();
 			m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_target->m_position;
 			// prepare goto stage 2
@@ -313,8 +313,8 @@ void Entity::ConductAIMovingWarrior( float deltaTime )
 		// if in last seen spot, goto state 1
 		else if (IsPointInsideDisc2D( m_lastSeenPosition, m_position, m_physicsRadius )) {
 			m_curState = 1;
-			m_map->GetRandomWonderPosAndDistanceTileHeatMap( this, m_lastSeenPosition, *m_targetDistanceTileHeatMap );
-			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetDistanceTileHeatMap, m_position, m_lastSeenPosition );
+			m_map->GetRandomWonderPosAndFlowField( this, m_lastSeenPosition, m_targetFlowField );
+			m_map->GenerateEntityPathToGoal( m_pathPoints, *m_targetFlowField, m_position, m_lastSeenPosition );
 			OptimizeRoute();
 			m_nextWayPointPosition = (int)m_pathPoints.size() >= 1 && m_optimizedPathPointsIndex != 0 ? m_pathPoints[m_optimizedPathPointsIndex] : m_lastSeenPosition;
 			m_goalOrientationDegrees = (m_nextWayPointPosition - m_position).GetOrientationDegrees();
@@ -358,8 +358,8 @@ void Entity::OptimizeRoute()
 			RayCastResult2D res1;
 			RayCastResult2D res2;
 			Vec2 sideVector = Vec2::MakeFromPolarDegrees( m_orientationDegrees + 90, m_physicsRadius );
-			if (m_map->HasLineOfSight( m_position + sideVector, m_pathPoints[i] + sideVector, res1, *m_targetDistanceTileHeatMap )
-				&& m_map->HasLineOfSight( m_position - sideVector, m_pathPoints[i] - sideVector, res2, *m_targetDistanceTileHeatMap )) {
+			if (m_map->HasLineOfSight( m_position + sideVector, m_pathPoints[i] + sideVector, res1, m_targetFlowField->GetDistanceField() )
+				&& m_map->HasLineOfSight( m_position - sideVector, m_pathPoints[i] - sideVector, res2, m_targetFlowField->GetDistanceField() )) {
 				m_pathPoints.pop_back();
 			}
 			else {
@@ -372,8 +372,8 @@ void Entity::OptimizeRoute()
 			RayCastResult2D res1;
 			RayCastResult2D res2;
 			Vec2 sideVector = (m_pathPoints[(int)m_pathPoints.size() - 2] - m_position).GetNormalized().GetRotated90Degrees() * m_physicsRadius;
-			if (m_map->HasLineOfSight( m_position + sideVector, m_pathPoints[(int)m_pathPoints.size() - 2] + sideVector, res1, *m_targetDistanceTileHeatMap )
-				&& m_map->HasLineOfSight( m_position - sideVector, m_pathPoints[(int)m_pathPoints.size() - 2] - sideVector, res2, *m_targetDistanceTileHeatMap )) {
+			if (m_map->HasLineOfSight( m_position + sideVector, m_pathPoints[(int)m_pathPoints.size() - 2] + sideVector, res1, m_targetFlowField->GetDistanceField() )
+				&& m_map->HasLineOfSight( m_position - sideVector, m_pathPoints[(int)m_pathPoints.size() - 2] - sideVector, res2, m_targetFlowField->GetDistanceField() )) {
 				m_pathPoints.pop_back();
 			}
 		}*/
@@ -387,8 +387,8 @@ void Entity::OptimizeRoute()
 			float length = forwardVector.GetLength();
 			Vec2 forwardNormal = forwardVector / length;
 			Vec2 sideVector = forwardNormal.GetRotated90Degrees() * m_physicsRadius;
-			if (!m_targetDistanceTileHeatMap->RayCastVsGrid2D( res1, Ray2D( m_position + sideVector, forwardNormal, length ), FLT_MAX )
-				&& !m_targetDistanceTileHeatMap->RayCastVsGrid2D( res2, Ray2D( m_position - sideVector, forwardNormal, length ), FLT_MAX )) {
+			if (!m_targetFlowField->GetDistanceField().RayCastVsGrid2D( res1, Ray2D( m_position + sideVector, forwardNormal, length ), FLT_MAX )
+				&& !m_targetFlowField->GetDistanceField().RayCastVsGrid2D( res2, Ray2D( m_position - sideVector, forwardNormal, length ), FLT_MAX )) {
 				//for (int j = 0; j < pathPointsInitialSize - i - 1; j++) {
 				//	m_pathPoints.pop_back();
 				//}
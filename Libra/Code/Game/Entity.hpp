@@ -6,6 +6,7 @@ class Map;
 class Texture;
 class Bullet;
 class TileHeatMap;
+class FlowField;
 
 constexpr int NUM_OF_BULLET_TYPES = 4;
 enum class EntityType { _UNKNOWN = -1, _RUBBLE, _GOOD_PLAYER, _SCORPIO, _LEO, _ARIES, _CAPRICORN, _CANCER, _BULLET, _BOLT, _GUIDED_BULLET, _FLAME_BULLET, _EXPLOSION, _BUILDING, NUM };
@@ -69,7 +70,7 @@ protected:
 	Map* m_map; // a pointer back to the Map instance
 	int m_curState = 1;
 	float m_goalOrientationDegrees = 0.f;
-	TileHeatMap* m_targetDistanceTileHeatMap = nullptr;
+	FlowField const* m_targetFlowField = nullptr; // shared with every entity going to the same tile, released back to the map
 	Vec2 m_lastSeenPosition = Vec2(); // is m_goalPosition 
 	Vec2 m_nextWayPointPosition = Vec2();
 	float m_shootHalfAngleDegrees;
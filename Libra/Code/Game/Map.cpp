@@ -16,6 +16,7 @@
 #include "Engine/Renderer/Sprite.hpp"
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/Core/HeatMaps.hpp"
+#include "Engine/Core/FlowFieldCache.hpp"
 #include "Engine/Core/Image.hpp"
 
 Map::Map()
@@ -37,6 +38,8 @@ Map::~Map()
 	delete m_startToEndHeatMap;
 	delete m_solidTileHeatMap;
 	delete m_amphibiousTileHeatMap;
+	// after the entities, they give their flow fields back when deleted
+	delete m_flowFieldCache;
 }
 
 void Map::Startup( MapDefinition const& config )
@@ -93,6 +96,7 @@ void Map::Update( float deltaTime )
 	UpdateState( deltaTime );
 	HandleKeys();
 	if (m_curMapState == MapState::PLAYING) {
+		UpdateFlowFieldScorpioTiles();
 		UpdateEntityLists( deltaTime );
 		AllEntitiesCorrectCollisionWithEachOther( deltaTime );
 		AllEntitiesCorrectCollisionWithWall();
@@ -240,6 +244,12 @@ void Map::PopulateMap( MapDefinition const& config )
 	m_amphibiousTileHeatMap = new TileHeatMap( m_dimensions );
 	BuildSolidTileHeatMap();
 	BuildAmphibiousTileHeatMap();
+
+	// shared flow fields for pathing, ChangeTileType keeps the blocked tiles up to date from now on
+	m_flowFieldCache = new FlowFieldCache( m_dimensions, NUM_OF_PATHING_PASSABILITIES );
+	for (int i = 0; i < m_dimensions.x * m_dimensions.y; i++) {
+		UpdateFlowFieldTile( GetXYPosFromArrayIndex( i ) );
+	}
 }
 
 void Map::LoadEnemy( MapDefinition const& config )
@@ -735,56 +745,9 @@ void Map::HandleTasks()
 
 void Map::PopulateHeatMapDistanceField( TileHeatMap& out_distanceField, IntVec2 const& startCoords, float maxCost, float minCost, bool treatWaterAsSolid, bool treatScorpioAsSolid ) const
 {
-	// bfs
-	int maxQueueLength = m_dimensions.x * m_dimensions.y;
-	IntVec2* queue = new IntVec2[maxQueueLength];
-	int start = 0;
-	int end = 1;
-	out_distanceField.SetAllValues( maxCost );
-	queue[start] = startCoords;
-	out_distanceField.SetTileValue( startCoords, minCost );
-	while (start < end) {
-		IntVec2 const& thisTile = queue[start];
-		float thisTileValue = out_distanceField.GetTileValue( thisTile );
-		if (thisTile.x >= 1) {
-			IntVec2 nextTile = thisTile + IntVec2( -1, 0 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost 
-				&& !IsTileSolid( nextTile ) && !(treatWaterAsSolid && IsTileWater( nextTile )) && !(treatScorpioAsSolid && IsTileScorpio( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.y >= 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 0, -1 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost 
-				&& !IsTileSolid( nextTile ) && !(treatWaterAsSolid && IsTileWater( nextTile )) && !(treatScorpioAsSolid && IsTileScorpio( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.x < m_dimensions.x - 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 1, 0 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost 
-				&& !IsTileSolid( nextTile ) && !(treatWaterAsSolid && IsTileWater( nextTile )) && !(treatScorpioAsSolid && IsTileScorpio( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.y < m_dimensions.y - 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 0, 1 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost 
-				&& !IsTileSolid( nextTile ) && !(treatWaterAsSolid && IsTileWater( nextTile )) && !(treatScorpioAsSolid && IsTileScorpio( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		start++;//= (start + 1) % maxQueueLength;
-	}
-	delete[] queue;
+	out_distanceField.PopulateDistanceField( startCoords, [&]( IntVec2 const& tileCoords ) {
+		return !IsTileSolid( tileCoords ) && !(treatWaterAsSolid && IsTileWater( tileCoords )) && !(treatScorpioAsSolid && IsTileScorpio( tileCoords ));
+		}, minCost, maxCost );
 }
 
 void Map::BuildSolidTileHeatMap()
@@ -811,6 +774,51 @@ void Map::BuildAmphibiousTileHeatMap()
 	}
 }
 
+void Map::UpdateFlowFieldTile( IntVec2 const& mapPos )
+{
+	bool isSolid = IsTileSolid( mapPos );
+	bool isWater = IsTileWater( mapPos );
+	bool isScorpio = IsTileScorpio( mapPos );
+	for (int passability = 0; passability < NUM_OF_PATHING_PASSABILITIES; passability++) {
+		bool isBlocked = isSolid || ((passability & PATHING_WATER_IS_SOLID) && isWater) || ((passability & PATHING_SCORPIO_IS_SOLID) && isScorpio);
+		m_flowFieldCache->SetTileBlocked( passability, mapPos, isBlocked );
+	}
+}
+
+void Map::UpdateFlowFieldScorpioTiles()
+{
+	if (m_flowFieldCache == nullptr) {
+		return;
+	}
+	// living scorpios block their tiles, only a spawn or a death changes the fields
+	int numOfScorpioTiles = 0;
+	bool isChanged = false;
+	for (Entity* entity : m_entityListsByType[(int)EntityType::_SCORPIO]) {
+		if (entity && entity->IsAlive()) {
+			if (numOfScorpioTiles >= (int)m_flowFieldScorpioTiles.size() || m_flowFieldScorpioTiles[numOfScorpioTiles] != GetMapPosFromWorldPos( entity->m_position )) {
+				isChanged = true;
+			}
+			++numOfScorpioTiles;
+		}
+	}
+	if (!isChanged && numOfScorpioTiles == (int)m_flowFieldScorpioTiles.size()) {
+		return;
+	}
+	std::vector<IntVec2> oldScorpioTiles;
+	oldScorpioTiles.swap( m_flowFieldScorpioTiles );
+	for (Entity* entity : m_entityListsByType[(int)EntityType::_SCORPIO]) {
+		if (entity && entity->IsAlive()) {
+			m_flowFieldScorpioTiles.push_back( GetMapPosFromWorldPos( entity->m_position ) );
+		}
+	}
+	for (IntVec2 const& tile : oldScorpioTiles) {
+		UpdateFlowFieldTile( tile );
+	}
+	for (IntVec2 const& tile : m_flowFieldScorpioTiles) {
+		UpdateFlowFieldTile( tile );
+	}
+}
+
 void Map::AddEntityToAllEntityLists( Entity* entity )
 {
 	EntityList& entityTypeArray = m_entityListsByType[(int)entity->m_type];
@@ -992,20 +1000,38 @@ Vec2 const Map::GetNextPosGoTo( Vec2 const& startPos, Vec2 const& targetPosition
 	return GetWorldPosFromMapPosCenter( inquiryerCurMapPos );
 }
 
-Vec2 const Map::GetDistanceTileHeatMapForTargetPos( Entity const* inquiryer, Vec2 const& targetPosition, TileHeatMap& out_tileHeatMap ) const
+Vec2 const Map::GetNextPosGoTo( Entity const* inquiryer, Vec2 const& targetPosition, FlowField const& flowField ) const
+{
+	// do not use taxicab distance! take care of diagonal 
+	if (GetDistanceSquared2D( targetPosition, inquiryer->m_position ) <= 1.f) {
+		return targetPosition;
+	}
+	return GetNextPosGoTo( inquiryer->m_position, flowField );
+}
+
+Vec2 const Map::GetNextPosGoTo( Vec2 const& startPos, FlowField const& flowField ) const
+{
+	// the field already holds the steepest step of every tile
+	return GetWorldPosFromMapPosCenter( flowField.GetNextTileCoords( GetMapPosFromWorldPos( startPos ) ) );
+}
+
+Vec2 const Map::GetFlowFieldForTargetPos( Entity const* inquiryer, Vec2 const& targetPosition, FlowField const*& inout_flowField )
 {
 	IntVec2 targetCurMapPos = GetMapPosFromWorldPos( targetPosition );
-	// IntVec2 inquiryerCurMapPos = GetMapPosFromWorldPos( inquiryer->m_position );
-	PopulateHeatMapDistanceField( out_tileHeatMap, targetCurMapPos, FLT_MAX, 0.f, !inquiryer->m_isAmphibious, true );
-	return GetNextPosGoTo( inquiryer, targetPosition, out_tileHeatMap );
+	// acquire before releasing, so keeping the same goal does not drop and rebuild the field
+	FlowField const* flowField = m_flowFieldCache->AcquireFlowField( targetCurMapPos, GetPathingPassability( inquiryer ) );
+	m_flowFieldCache->ReleaseFlowField( inout_flowField );
+	inout_flowField = flowField;
+	return GetNextPosGoTo( inquiryer, targetPosition, *flowField );
 }
 
-Vec2 const Map::GetRandomWonderPosAndDistanceTileHeatMap( Entity const* inquiryer, Vec2& out_WonderPos, TileHeatMap& out_tileHeatMap ) const
+Vec2 const Map::GetRandomWonderPosAndFlowField( Entity const* inquiryer, Vec2& out_WonderPos, FlowField const*& inout_flowField )
 {
-	Vec2 nextPosToGo;
 	IntVec2 newPos;
 	static int tryTime = 0;
 	tryTime = 0;
+	int passability = GetPathingPassability( inquiryer );
+	IntVec2 inquiryerCurMapPos = GetMapPosFromWorldPos( inquiryer->m_position );
 	int searchStrategy = 0;
 	if((m_taskType == TaskType::Breakthrough && inquiryer->m_faction == EntityFaction::FACTION_EVIL)
 		|| (m_taskType == TaskType::Clear && inquiryer->m_faction == EntityFaction::FACTION_GOOD)) {
@@ -1051,15 +1077,27 @@ Vec2 const Map::GetRandomWonderPosAndDistanceTileHeatMap( Entity const* inquirye
 					g_theGame->m_randNumGen->RollRandomIntInRange( m_dimensions.y - 6, m_dimensions.y - 2 ) );
 			}
 		}
-
-		if (IsTileSolid( newPos ) || (!inquiryer->m_isAmphibious && IsTileWater( newPos )) || IsTileScorpio( newPos )) {
-			continue;
-		}
-		nextPosToGo = GetDistanceTileHeatMapForTargetPos( inquiryer, GetWorldPosFromMapPosCenter( newPos ), out_tileHeatMap );
-	} while (IsTileSolid( newPos ) || (!inquiryer->m_isAmphibious && IsTileWater( newPos )) || IsTileScorpio( newPos ) || out_tileHeatMap.GetTileValue(GetMapPosFromWorldPos(inquiryer->m_position)) == FLT_MAX);
-	// #ToDo: what will happen when exceeds max try time
+		// a connected tile is never solid, water for a land unit or a scorpio, and the field built to it reaches the inquiryer
+	} while (!m_flowFieldCache->AreTilesConnected( passability, inquiryerCurMapPos, newPos ));
+	// no reachable tile found, stay on this tile and try again when reached
+	if (tryTime > 100) {
+		newPos = inquiryerCurMapPos;
+	}
 	out_WonderPos = GetWorldPosFromMapPosCenter( newPos );
-	return nextPosToGo;
+	return GetFlowFieldForTargetPos( inquiryer, out_WonderPos, inout_flowField );
+}
+
+void Map::ReleaseFlowField( FlowField const*& inout_flowField )
+{
+	if (m_flowFieldCache) {
+		m_flowFieldCache->ReleaseFlowField( inout_flowField );
+	}
+	inout_flowField = nullptr;
+}
+
+int Map::GetPathingPassability( Entity const* inquiryer ) const
+{
+	return inquiryer->m_isAmphibious ? PATHING_SCORPIO_IS_SOLID : PATHING_WATER_IS_SOLID | PATHING_SCORPIO_IS_SOLID;
 }
 
 void Map::GenerateEntityPathToGoal( std::vector<Vec2>& out_pathPoints, TileHeatMap const& tileHeatMap, Vec2 const& startPos, Vec2 const& targetPos ) const
@@ -1086,6 +1124,30 @@ void Map::GenerateEntityPathToGoal( std::vector<Vec2>& out_pathPoints, TileHeatM
 	}
 }
 
+void Map::GenerateEntityPathToGoal( std::vector<Vec2>& out_pathPoints, FlowField const& flowField, Vec2 const& startPos, Vec2 const& targetPos ) const
+{
+	out_pathPoints.clear();
+	std::vector<Vec2> tempVector;
+	tempVector.reserve( 20 );
+	Vec2 curPos = startPos;
+	Vec2 lastPos = curPos;
+	while ( GetMapPosFromWorldPos( curPos ) != GetMapPosFromWorldPos( targetPos ) ) {
+		curPos = GetNextPosGoTo( curPos, flowField );
+		if (curPos == lastPos) {
+			// cannot find path
+			break;
+		}
+		else {
+			lastPos = curPos;
+			tempVector.push_back( curPos );
+		}
+	}
+	// reverse order
+	for (int i = 0; i < (int)tempVector.size(); i++) {
+		out_pathPoints.push_back( tempVector[tempVector.size() - 1 - i] );
+	}
+}
+
 Entity* Map::SpawnNewEntity( EntityType type, Vec2 const& position, EntityFaction faction, Entity const* spawner, float orientationDegrees )
 {
 	Entity* retEntity = nullptr;
@@ -1141,6 +1203,9 @@ Entity* Map::SpawnNewEntity( EntityType type, Vec2 const& position, EntityFactio
 	
 	if (retEntity) {
 		AddEntityToAllEntityLists( retEntity );
+		if (type == EntityType::_SCORPIO) {
+			UpdateFlowFieldScorpioTiles();
+		}
 	}
 	return retEntity;
 }
@@ -1613,14 +1678,82 @@ bool Map::PlaySound( AudioName name, Vec2 const& playPosition, float intervalTim
 	return g_theApp->PlaySound( name, intervalTimeSeconds, isLooped, newVolume, balance, speed );
 }
 
+bool Map::Command_PathingBenchmark( EventArgs& args )
+{
+	Map* map = g_theGame ? g_theGame->GetCurrentMap() : nullptr;
+	if (map == nullptr || map->m_playerTank == nullptr || map->m_flowFieldCache == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "No map to benchmark pathing" );
+		return false;
+	}
+	int numOfEnemies = args.GetValue( "enemies", 200 );
+	int passability = PATHING_WATER_IS_SOLID | PATHING_SCORPIO_IS_SOLID;
+	Vec2 targetPos = map->m_playerTank->m_position;
+	IntVec2 targetMapPos = map->GetMapPosFromWorldPos( targetPos );
+
+	// land enemies spread over every tile that can reach the player
+	std::vector<IntVec2> startTiles;
+	for (int i = 0; i < map->m_dimensions.x * map->m_dimensions.y; i++) {
+		IntVec2 coords = map->GetXYPosFromArrayIndex( i );
+		if (coords != targetMapPos && map->m_flowFieldCache->AreTilesConnected( passability, coords, targetMapPos )) {
+			startTiles.push_back( coords );
+		}
+	}
+	if (startTiles.empty() || numOfEnemies <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "No tile can reach the player" );
+		return false;
+	}
+	std::vector<Vec2> startPositions;
+	startPositions.reserve( numOfEnemies );
+	for (int i = 0; i < numOfEnemies; i++) {
+		startPositions.push_back( map->GetWorldPosFromMapPosCenter( startTiles[g_theGame->m_randNumGen->RollRandomIntLessThan( (int)startTiles.size() )] ) );
+	}
+
+	// before: every enemy floods its own heat map
+	std::vector<TileHeatMap> heatMaps( numOfEnemies, TileHeatMap( map->m_dimensions ) );
+	std::vector<std::vector<Vec2>> heatMapPaths( numOfEnemies );
+	double startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfEnemies; i++) {
+		map->PopulateHeatMapDistanceField( heatMaps[i], targetMapPos, FLT_MAX, 0.f, true, true );
+		map->GenerateEntityPathToGoal( heatMapPaths[i], heatMaps[i], startPositions[i], targetPos );
+	}
+	double heatMapSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// after: the first enemy builds the shared field, every other one samples it
+	map->m_flowFieldCache->InvalidateAllFlowFields();
+	int numOfBuiltFieldsBefore = map->m_flowFieldCache->GetNumOfBuiltFlowFields();
+	std::vector<FlowField const*> flowFields( numOfEnemies, nullptr );
+	std::vector<std::vector<Vec2>> flowFieldPaths( numOfEnemies );
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfEnemies; i++) {
+		flowFields[i] = map->m_flowFieldCache->AcquireFlowField( targetMapPos, passability );
+		map->GenerateEntityPathToGoal( flowFieldPaths[i], *flowFields[i], startPositions[i], targetPos );
+	}
+	double flowFieldSeconds = GetCurrentTimeSeconds() - startTime;
+	int numOfBuiltFields = map->m_flowFieldCache->GetNumOfBuiltFlowFields() - numOfBuiltFieldsBefore;
+
+	int numOfMismatches = 0;
+	for (int i = 0; i < numOfEnemies; i++) {
+		if (heatMapPaths[i] != flowFieldPaths[i]) {
+			++numOfMismatches;
+		}
+		map->m_flowFieldCache->ReleaseFlowField( flowFields[i] );
+	}
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "Pathing %d enemies on %dx%d tiles: own heat maps %.3fms, shared flow field %.3fms (%d fields built), %d path mismatches",
+		numOfEnemies, map->m_dimensions.x, map->m_dimensions.y, heatMapSeconds * 1000.0, flowFieldSeconds * 1000.0, numOfBuiltFields, numOfMismatches ) );
+	return true;
+}
+
 void Map::ChangeTileType(int x, int y, TileDefinition const& newType)
 {
-	m_tiles[(size_t)y * m_dimensions.x + x].ChangeType( newType );
+	ChangeTileType( IntVec2( x, y ), newType );
 }
 
 void Map::ChangeTileType( IntVec2 const& pos, TileDefinition const& newType )
 {
 	m_tiles[(size_t)pos.y * m_dimensions.x + pos.x].ChangeType( newType );
+	if (m_flowFieldCache) {
+		UpdateFlowFieldTile( pos );
+	}
 }
 
 void Map::TileGetDamage( IntVec2 mapPos, float damage )
@@ -9,9 +9,13 @@ struct Vec2;
 class PlayerTank;
 class SpriteSheet;
 class TileHeatMap;
+class FlowField;
+class FlowFieldCache;
 struct Ray2D;
 struct RayCastResult2D;
 enum class AudioName;
+class NamedProperties;
+typedef NamedProperties EventArgs;
 
 enum class MapState { PLAYING, PLAYER_DEAD, WIN, ENTER_MAP, EXIT_MAP, FINISH_EXIT };
 enum class MapRenderState { NORMAL, DISTANCE_MAP, SOLID_MAP, AMPHIBIOUS_MAP, ENEMY_PATH_FINDING_MAP, NUM };
@@ -19,6 +23,11 @@ enum class TaskType { Default = -1, Breakthrough, Defense, Clear, Capture };
 
 typedef std::vector<Entity*> EntityList;
 
+// what blocks a path besides solid tiles, the flags together index the passabilities of the map's flow field cache
+constexpr int PATHING_WATER_IS_SOLID = 1;
+constexpr int PATHING_SCORPIO_IS_SOLID = 2;
+constexpr int NUM_OF_PATHING_PASSABILITIES = 4;
+
 Rgba8 const ENEMY_SCORPIO = Rgba8( 255, 0, 0, 255 );
 Rgba8 const ENEMY_LEO = Rgba8( 155, 0, 0, 255 );
 Rgba8 const ENEMY_ARIES = Rgba8( 55, 0, 0, 255 );
@@ -99,15 +108,22 @@ public:
 	//------------------------------
 	Vec2 const GetNextPosGoTo( Vec2 const& startPos, Vec2 const& targetPosition, TileHeatMap const& tileHeatMap ) const;
 	Vec2 const GetNextPosGoTo( Entity const* inquiryer, Vec2 const& targetPosition, TileHeatMap const& tileHeatMap ) const;
+	Vec2 const GetNextPosGoTo( Vec2 const& startPos, FlowField const& flowField ) const;
+	Vec2 const GetNextPosGoTo( Entity const* inquiryer, Vec2 const& targetPosition, FlowField const& flowField ) const;
+	//------------------------------
+	// swap inout_flowField for the shared flow field to the target, return next tile center world position inquiryer should go to
+	Vec2 const GetFlowFieldForTargetPos( Entity const* inquiryer, Vec2 const& targetPosition, FlowField const*& inout_flowField );
 	//------------------------------
-	// return next tile center world position inquiryer should go to
-	Vec2 const GetDistanceTileHeatMapForTargetPos( Entity const* inquiryer, Vec2 const& targetPosition, TileHeatMap& out_tileHeatMap ) const;
+	// swap inout_flowField for the shared flow field to the wonder pos, return next tile center world position inquiryer should go to
+	Vec2 const GetRandomWonderPosAndFlowField( Entity const* inquiryer, Vec2& out_WonderPos, FlowField const*& inout_flowField );
 	//------------------------------
-	// return next tile center world position inquiryer should go to
-	Vec2 const GetRandomWonderPosAndDistanceTileHeatMap( Entity const* inquiryer, Vec2& out_WonderPos, TileHeatMap& out_tileHeatMap ) const;
+	// give back a flow field from GetFlowFieldForTargetPos or GetRandomWonderPosAndFlowField and set the pointer to nullptr
+	void ReleaseFlowField( FlowField const*& inout_flowField );
+	int GetPathingPassability( Entity const* inquiryer ) const;
 	//------------------------------
 	// generate a reversed path of points to goal 
 	void GenerateEntityPathToGoal( std::vector<Vec2>& out_pathPoints, TileHeatMap const& tileHeatMap, Vec2 const& startPos, Vec2 const& targetPos ) const;
+	void GenerateEntityPathToGoal( std::vector<Vec2>& out_pathPoints, FlowField const& flowField, Vec2 const& startPos, Vec2 const& targetPos ) const;
 	//------------------------------
 	Entity* SpawnNewEntity(EntityType type, Vec2 const& position, EntityFaction faction, Entity const* spawner = nullptr, float orientationDegrees = 0.f);
 	void SpawnExplosion( Vec2 const& position, float sizeFactor, float lifeSpanSeconds );
@@ -130,6 +146,9 @@ public:
 	bool HasLineOfSight( Vec2 const& startPos, Vec2 const& targetPos, RayCastResult2D& outRayCastResult, TileHeatMap const& tileHeatMap, float opaqueValue = FLT_MAX ) const;
 
 	bool PlaySound( AudioName name, Vec2 const& playPosition, float intervalTimeSeconds = 0.f, bool isLooped = false, float volume = 1.f, float speed = 1.f );
+
+	// console command: PathingBenchmark enemies=200, paths every enemy to the player with its own heat map, then with one shared flow field
+	static bool Command_PathingBenchmark( EventArgs& args );
 private:
 	void PopulateMap( MapDefinition const& config );
 	void LoadEnemy( MapDefinition const& config );
@@ -155,6 +174,8 @@ private:
 	void PopulateHeatMapDistanceField( TileHeatMap& out_distanceField, IntVec2 const& startCoords, float maxCost = FLT_MAX, float minCost = 0.f, bool treatWaterAsSolid = true, bool treatScorpioAsSolid = false ) const;
 	void BuildSolidTileHeatMap();
 	void BuildAmphibiousTileHeatMap();
+	void UpdateFlowFieldTile( IntVec2 const& mapPos );
+	void UpdateFlowFieldScorpioTiles();
 
 	void AddEntityToAllEntityLists( Entity* entity );
 	void AddEntityToEntityList( Entity* entity, EntityList& entityList );
@@ -212,6 +233,8 @@ private:
 	TileHeatMap* m_startToEndHeatMap = nullptr;
 	TileHeatMap* m_solidTileHeatMap = nullptr;
 	TileHeatMap* m_amphibiousTileHeatMap = nullptr;
+	FlowFieldCache* m_flowFieldCache = nullptr;
+	std::vector<IntVec2> m_flowFieldScorpioTiles;
 
 	MapRenderState m_mapRenderState = MapRenderState::NORMAL;
 	int m_thisRenderHeatMapEntityIndex = 0;
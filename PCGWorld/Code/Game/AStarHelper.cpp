@@ -1,151 +1,762 @@
 #include "Game/AStarHelper.hpp"
 #include "Game\MapPolygonUnit.hpp"
+#include "Engine/Core/ParallelFor.hpp"
+#include <algorithm>
+
+// 4-ary heap: shallower than a binary heap and the four children share a cache line
+constexpr int ASTAR_HEAP_ARITY = 4;
+
+static void PushOpenList( std::vector<AStarHeapEntry>& heap, AStarHeapEntry const& entry )
+{
+	int index = (int)heap.size();
+	heap.push_back( entry );
+	while (index > 0) {
+		int parentIndex = (index - 1) / ASTAR_HEAP_ARITY;
+		if (heap[parentIndex].m_cost <= entry.m_cost) {
+			break;
+		}
+		heap[index] = heap[parentIndex];
+		index = parentIndex;
+	}
+	heap[index] = entry;
+}
+
+static AStarHeapEntry PopOpenList( std::vector<AStarHeapEntry>& heap )
+{
+	AStarHeapEntry top = heap[0];
+	AStarHeapEntry last = heap.back();
+	heap.pop_back();
+	int size = (int)heap.size();
+	if (size == 0) {
+		return top;
+	}
+	int index = 0;
+	for (;;) {
+		int firstChild = index * ASTAR_HEAP_ARITY + 1;
+		if (firstChild >= size) {
+			break;
+		}
+		int lastChild = firstChild + ASTAR_HEAP_ARITY < size ? firstChild + ASTAR_HEAP_ARITY : size;
+		int minChild = firstChild;
+		for (int child = firstChild + 1; child < lastChild; child++) {
+			if (heap[child].m_cost < heap[minChild].m_cost) {
+				minChild = child;
+			}
+		}
+		if (last.m_cost <= heap[minChild].m_cost) {
+			break;
+		}
+		heap[index] = heap[minChild];
+		index = minChild;
+	}
+	heap[index] = last;
+	return top;
+}
+
+AStarHelper::~AStarHelper()
+{
+	for (AStarScratch* scratch : m_freeScratches) {
+		delete scratch;
+	}
+	m_freeScratches.clear();
+}
 
 void AStarHelper::AStarHelperInit( std::vector<MapPolygonUnit*> const& units )
 {
-	m_nodes.reserve( units.size() );
+	m_nodeUnits.clear();
+	m_positions.clear();
+	m_isWater.clear();
+	m_nodeUnits.reserve( units.size() );
+	m_unitIDToNode.assign( units.size(), -1 );
 	for (auto unit : units) {
 		if (!unit->m_isFarAwayFakeUnit) {
-			m_nodes.emplace_back( unit );
-			m_unitToNodeMap[unit] = &(m_nodes[m_nodes.size() - 1]);
+			if (unit->m_id >= (int)m_unitIDToNode.size()) {
+				m_unitIDToNode.resize( unit->m_id + 1, -1 );
+			}
+			m_unitIDToNode[unit->m_id] = (int)m_nodeUnits.size();
+			m_nodeUnits.push_back( unit );
+			m_positions.push_back( unit->m_geoCenterPos );
+			// landforms are final by the time the helper is built
+			m_isWater.push_back( unit->IsWater() ? 1 : 0 );
 		}
 	}
-	for (auto unit : units) {
-		if (!unit->m_isFarAwayFakeUnit) {
-			AStarNode* node = (*m_unitToNodeMap.find( unit )).second;
-			for (auto adjUnit : unit->m_adjacentUnits) {
-				AStarNode* adjNode = (*m_unitToNodeMap.find( adjUnit )).second;
-				node->m_neighbors.emplace_back( adjNode, GetDistance2D( unit->m_geoCenterPos, adjUnit->m_geoCenterPos ) );
+	std::vector<std::vector<int>> adjacentNodes;
+	adjacentNodes.resize( m_nodeUnits.size() );
+	for (int i = 0; i < (int)m_nodeUnits.size(); i++) {
+		for (auto adjUnit : m_nodeUnits[i]->m_adjacentUnits) {
+			adjacentNodes[i].push_back( GetNodeIndex( adjUnit ) );
+		}
+	}
+	BuildNeighborLists( adjacentNodes );
+}
+
+void AStarHelper::AStarHelperInit( std::vector<Vec2> const& positions, std::vector<std::vector<int>> const& adjacentNodes, std::vector<bool> const& isWater )
+{
+	m_nodeUnits.assign( positions.size(), nullptr );
+	m_unitIDToNode.clear();
+	m_positions = positions;
+	m_isWater.resize( positions.size() );
+	for (int i = 0; i < (int)positions.size(); i++) {
+		m_isWater[i] = i < (int)isWater.size() && isWater[i] ? 1 : 0;
+	}
+	BuildNeighborLists( adjacentNodes );
+}
+
+void AStarHelper::BuildNeighborLists( std::vector<std::vector<int>> const& adjacentNodes )
+{
+	int numOfNodes = (int)m_positions.size();
+	m_neighborBegins.clear();
+	m_neighborNodes.clear();
+	m_neighborDists.clear();
+	m_neighborBegins.reserve( numOfNodes + 1 );
+	for (int i = 0; i < numOfNodes; i++) {
+		m_neighborBegins.push_back( (int)m_neighborNodes.size() );
+		for (int adjNode : adjacentNodes[i]) {
+			if (adjNode >= 0) {
+				m_neighborNodes.push_back( adjNode );
+				m_neighborDists.push_back( GetDistance2D( m_positions[i], m_positions[adjNode] ) );
 			}
 		}
 	}
+	m_neighborBegins.push_back( (int)m_neighborNodes.size() );
+	ClearHierarchy();
 
+	// scratches are sized for the old graph
+	std::lock_guard<std::mutex> lock( m_scratchMutex );
+	for (AStarScratch* scratch : m_freeScratches) {
+		delete scratch;
+	}
+	m_freeScratches.clear();
 }
 
 void AStarHelper::CalculateRoute( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route )
 {
-	out_route.clear();
-	for (auto& node : m_nodes) {
-		node.m_cost = FLT_MAX;
-	}
-	std::priority_queue < AStarNode*, std::vector<AStarNode*>, decltype(m_compFunc) > openList;
-	//std::vector<AStarNode*> closedList;
-	AStarNode* startNode = (*m_unitToNodeMap.find( start )).second;
-	startNode->m_cost = 0.f;
-	startNode->m_distCost = 0.f;
-	startNode->m_heuristicCost = 0.f;
-	startNode->m_parent = nullptr;
-	openList.push( startNode );
+	std::vector<int> nodeRoute;
+	CalculateNodeRoute( GetNodeIndex( start ), GetNodeIndex( end ), false, nodeRoute );
+	ConvertNodeRoute( nodeRoute, out_route );
+}
+
+bool AStarHelper::CalculateRouteWaterBlockRouteAndHeightWeight( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route )
+{
+	// the height term of the old search compared a node with itself and was always 0,
+	// the cost stays plain distance so routes do not change
+	std::vector<int> nodeRoute;
+	bool hasRoute = CalculateNodeRoute( GetNodeIndex( start ), GetNodeIndex( end ), true, nodeRoute );
+	ConvertNodeRoute( nodeRoute, out_route );
+	return hasRoute;
+}
+
+void AStarHelper::CalculateRoutes( std::vector<AStarQuery>& queries )
+{
+	ParallelFor( 0, (int)queries.size(), 1, [this, &queries]( int i ) {
+		AStarQuery& query = queries[i];
+		query.m_hasRoute = CalculateNodeRoute( query.m_startNode, query.m_endNode, query.m_blockWater, query.m_nodeRoute );
+		} );
+}
+
+bool AStarHelper::CalculateNodeRoute( int startNode, int endNode, bool blockWater, std::vector<int>& out_nodeRoute )
+{
+	out_nodeRoute.clear();
+	if (startNode < 0 || endNode < 0) {
+		return false;
+	}
+	AStarScratch* scratch = AcquireScratch();
+	bool hasRoute = SearchNodes( scratch, startNode, endNode, blockWater, -1 );
+	if (hasRoute) {
+		for (int node = endNode; node != -1; node = scratch->m_parents[node]) {
+			out_nodeRoute.push_back( node );
+		}
+	}
+	ReleaseScratch( scratch );
+	return hasRoute;
+}
 
-	AStarNode* endNode = (*m_unitToNodeMap.find( end )).second;
+bool AStarHelper::CalculateNodeRouteByFullReset( int startNode, int endNode, std::vector<int>& out_nodeRoute )
+{
+	out_nodeRoute.clear();
+	if (startNode < 0 || endNode < 0) {
+		return false;
+	}
+	int numOfNodes = GetNumOfNodes();
+	m_fullResetCosts.resize( numOfNodes );
+	m_fullResetDistCosts.resize( numOfNodes );
+	m_fullResetParents.resize( numOfNodes );
+	for (int i = 0; i < numOfNodes; i++) {
+		m_fullResetCosts[i] = FLT_MAX;
+	}
+	std::vector<float>& costs = m_fullResetCosts;
+	auto compFunc = [&costs]( int a, int b )->bool { return costs[a] > costs[b]; };
+	std::priority_queue<int, std::vector<int>, decltype(compFunc)> openList( compFunc );
+	costs[startNode] = 0.f;
+	m_fullResetDistCosts[startNode] = 0.f;
+	m_fullResetParents[startNode] = -1;
+	openList.push( startNode );
 
 	while (1) {
-		AStarNode* thisNode = openList.top();
+		if (openList.empty()) {
+			return false;
+		}
+		int thisNode = openList.top();
 		if (thisNode == endNode) {
-			//closedList.push_back( thisNode );
 			break;
 		}
-		else {
-			openList.pop();
-			//closedList.push_back( thisNode );
-			for (auto& adjNodePair : thisNode->m_neighbors) {
-				// haven't visited
-				if (adjNodePair.first->m_cost == FLT_MAX) {
-					adjNodePair.first->m_distCost = thisNode->m_distCost + adjNodePair.second;
-					adjNodePair.first->m_heuristicCost = CalculateHeuristicCost( adjNodePair.first, endNode );
-					adjNodePair.first->m_cost = adjNodePair.first->m_distCost + adjNodePair.first->m_heuristicCost;
-					adjNodePair.first->m_parent = thisNode;
-					openList.push( adjNodePair.first );
+		openList.pop();
+		for (int i = m_neighborBegins[thisNode]; i < m_neighborBegins[thisNode + 1]; i++) {
+			int adjNode = m_neighborNodes[i];
+			float distCost = m_fullResetDistCosts[thisNode] + m_neighborDists[i];
+			if (costs[adjNode] == FLT_MAX) {
+				m_fullResetDistCosts[adjNode] = distCost;
+				costs[adjNode] = distCost + CalculateHeuristicCost( adjNode, endNode );
+				m_fullResetParents[adjNode] = thisNode;
+				openList.push( adjNode );
+			}
+			else if (m_fullResetDistCosts[adjNode] > distCost) {
+				costs[adjNode] = costs[adjNode] - m_fullResetDistCosts[adjNode] + distCost;
+				m_fullResetDistCosts[adjNode] = distCost;
+				m_fullResetParents[adjNode] = thisNode;
+			}
+		}
+	}
+
+	for (int node = endNode; node != -1; node = m_fullResetParents[node]) {
+		out_nodeRoute.push_back( node );
+	}
+	return true;
+}
+
+bool AStarHelper::CalculateHierarchicalNodeRoute( int startNode, int endNode, bool blockWater, std::vector<int>& out_nodeRoute )
+{
+	out_nodeRoute.clear();
+	if (startNode < 0 || endNode < 0) {
+		return false;
+	}
+	// the flat search would flood all the land before it gives up
+	if (HasHierarchy() && blockWater && m_isWater[endNode] && startNode != endNode) {
+		return false;
+	}
+	if (!CanUseHierarchy( startNode, endNode, blockWater )) {
+		return CalculateNodeRoute( startNode, endNode, blockWater, out_nodeRoute );
+	}
+	if (m_nodeComponents[blockWater][startNode] != m_nodeComponents[blockWater][endNode]) {
+		return false;
+	}
+
+	AStarScratch* scratch = AcquireScratch();
+	std::vector<int> portalRoute;
+	bool hasRoute = SearchPortalRoute( scratch, startNode, endNode, blockWater, portalRoute );
+	if (hasRoute) {
+		// build the route from end to start, a leg inside one cluster is searched again, a portal edge is one step
+		for (int i = (int)portalRoute.size() - 1; i > 0; i--) {
+			int legStart = portalRoute[i - 1];
+			int legEnd = portalRoute[i];
+			int clusterIndex = m_nodeClusters[legStart];
+			if (clusterIndex != m_nodeClusters[legEnd]) {
+				out_nodeRoute.push_back( legEnd );
+			}
+			else if (SearchNodes( scratch, legStart, legEnd, blockWater, clusterIndex )) {
+				for (int node = legEnd; node != legStart; node = scratch->m_parents[node]) {
+					out_nodeRoute.push_back( node );
 				}
-				// visited
-				else {
-					// has a smaller connection option
-					if (adjNodePair.first->m_distCost > thisNode->m_distCost + adjNodePair.second) {
-						adjNodePair.first->m_distCost = thisNode->m_distCost + adjNodePair.second;
-						adjNodePair.first->m_cost = adjNodePair.first->m_distCost + adjNodePair.first->m_heuristicCost;
-						adjNodePair.first->m_parent = thisNode;
-					}
+			}
+			else {
+				hasRoute = false;
+				break;
+			}
+		}
+		out_nodeRoute.push_back( startNode );
+	}
+	ReleaseScratch( scratch );
+	if (!hasRoute) {
+		// a cluster cut in two by water can hide a crossing from the portal graph, the flat search does not miss it
+		return CalculateNodeRoute( startNode, endNode, blockWater, out_nodeRoute );
+	}
+	return true;
+}
+
+int AStarHelper::CalculateNextNodeOnRoute( int startNode, int endNode, bool blockWater )
+{
+	if (startNode < 0 || endNode < 0 || startNode == endNode) {
+		return -1;
+	}
+	if (HasHierarchy() && blockWater && m_isWater[endNode]) {
+		return -1;
+	}
+	std::vector<int> route;
+	if (!CanUseHierarchy( startNode, endNode, blockWater )) {
+		if (!CalculateNodeRoute( startNode, endNode, blockWater, route )) {
+			return -1;
+		}
+		return route[route.size() - 2];
+	}
+	if (m_nodeComponents[blockWater][startNode] != m_nodeComponents[blockWater][endNode]) {
+		return -1;
+	}
+
+	AStarScratch* scratch = AcquireScratch();
+	int nextNode = -1;
+	if (SearchPortalRoute( scratch, startNode, endNode, blockWater, route )) {
+		// only the first leg matters, the rest of the route is never walked
+		int legEnd = route[1];
+		int clusterIndex = m_nodeClusters[startNode];
+		if (clusterIndex != m_nodeClusters[legEnd]) {
+			nextNode = legEnd;
+		}
+		else if (SearchNodes( scratch, startNode, legEnd, blockWater, clusterIndex )) {
+			nextNode = legEnd;
+			while (scratch->m_parents[nextNode] != startNode) {
+				nextNode = scratch->m_parents[nextNode];
+			}
+		}
+	}
+	ReleaseScratch( scratch );
+	if (nextNode < 0 && CalculateNodeRoute( startNode, endNode, blockWater, route )) {
+		nextNode = route[route.size() - 2];
+	}
+	return nextNode;
+}
+
+MapPolygonUnit* AStarHelper::CalculateNextUnitOnRoute( MapPolygonUnit const* start, MapPolygonUnit const* end, bool blockWater )
+{
+	int nextNode = CalculateNextNodeOnRoute( GetNodeIndex( start ), GetNodeIndex( end ), blockWater );
+	return nextNode < 0 ? nullptr : m_nodeUnits[nextNode];
+}
+
+void AStarHelper::BuildHierarchy( std::vector<int> const& nodeClusters, int maxFloodClusterSize )
+{
+	int numOfNodes = GetNumOfNodes();
+	m_clusters.clear();
+	m_nodeClusters.assign( numOfNodes, -1 );
+	m_nodePortalIndices.assign( numOfNodes, -1 );
+
+	// given ids can be sparse, clusters are numbered in order of first use
+	std::vector<int> idToCluster;
+	for (int i = 0; i < numOfNodes && i < (int)nodeClusters.size(); i++) {
+		int id = nodeClusters[i];
+		if (id < 0) {
+			continue;
+		}
+		if (id >= (int)idToCluster.size()) {
+			idToCluster.resize( id + 1, -1 );
+		}
+		if (idToCluster[id] < 0) {
+			idToCluster[id] = (int)m_clusters.size();
+			m_clusters.emplace_back();
+		}
+		m_nodeClusters[i] = idToCluster[id];
+	}
+
+	// breadth first flood over the nodes that are left, a cluster never mixes water and land
+	std::vector<int> floodQueue;
+	for (int i = 0; i < numOfNodes; i++) {
+		if (m_nodeClusters[i] >= 0) {
+			continue;
+		}
+		int clusterIndex = (int)m_clusters.size();
+		m_clusters.emplace_back();
+		floodQueue.clear();
+		floodQueue.push_back( i );
+		m_nodeClusters[i] = clusterIndex;
+		for (int front = 0; front < (int)floodQueue.size() && (int)floodQueue.size() < maxFloodClusterSize; front++) {
+			int thisNode = floodQueue[front];
+			for (int j = m_neighborBegins[thisNode]; j < m_neighborBegins[thisNode + 1] && (int)floodQueue.size() < maxFloodClusterSize; j++) {
+				int adjNode = m_neighborNodes[j];
+				if (m_nodeClusters[adjNode] < 0 && m_isWater[adjNode] == m_isWater[i]) {
+					m_nodeClusters[adjNode] = clusterIndex;
+					floodQueue.push_back( adjNode );
 				}
 			}
 		}
 	}
 
-	AStarNode* nodeIter = endNode;
-	out_route.clear();
-	while (nodeIter != nullptr) {
-		out_route.push_back( const_cast<MapPolygonUnit*>(nodeIter->m_base) );
-		nodeIter = nodeIter->m_parent;
+	for (int i = 0; i < numOfNodes; i++) {
+		AStarCluster& cluster = m_clusters[m_nodeClusters[i]];
+		cluster.m_nodes.push_back( i );
+		cluster.m_center += m_positions[i];
+		for (int j = m_neighborBegins[i]; j < m_neighborBegins[i + 1]; j++) {
+			int adjCluster = m_nodeClusters[m_neighborNodes[j]];
+			if (adjCluster != m_nodeClusters[i] && std::find( cluster.m_adjClusters.begin(), cluster.m_adjClusters.end(), adjCluster ) == cluster.m_adjClusters.end()) {
+				cluster.m_adjClusters.push_back( adjCluster );
+			}
+		}
+	}
+	for (AStarCluster& cluster : m_clusters) {
+		cluster.m_center /= (float)cluster.m_nodes.size();
 	}
+	BuildClusterPortals();
 }
 
-bool AStarHelper::CalculateRouteWaterBlockRouteAndHeightWeight( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route )
+void AStarHelper::ClearHierarchy()
+{
+	m_clusters.clear();
+	m_nodeClusters.clear();
+	m_nodePortalIndices.clear();
+	m_nodeComponents[0].clear();
+	m_nodeComponents[1].clear();
+}
+
+bool AStarHelper::HasHierarchy() const
+{
+	return !m_clusters.empty();
+}
+
+int AStarHelper::GetNodeIndex( MapPolygonUnit const* unit ) const
+{
+	if (unit == nullptr || unit->m_id < 0 || unit->m_id >= (int)m_unitIDToNode.size()) {
+		return -1;
+	}
+	return m_unitIDToNode[unit->m_id];
+}
+
+MapPolygonUnit* AStarHelper::GetNodeUnit( int nodeIndex ) const
+{
+	return m_nodeUnits[nodeIndex];
+}
+
+int AStarHelper::GetNumOfNodes() const
+{
+	return (int)m_positions.size();
+}
+
+float AStarHelper::GetNodeRouteDistance( std::vector<int> const& nodeRoute ) const
+{
+	float distance = 0.f;
+	for (int i = 0; i + 1 < (int)nodeRoute.size(); i++) {
+		distance += GetDistance2D( m_positions[nodeRoute[i]], m_positions[nodeRoute[i + 1]] );
+	}
+	return distance;
+}
+
+int AStarHelper::GetNumOfClusters() const
+{
+	return (int)m_clusters.size();
+}
+
+int AStarHelper::GetNumOfPortalNodes() const
+{
+	int numOfPortalNodes = 0;
+	for (AStarCluster const& cluster : m_clusters) {
+		numOfPortalNodes += (int)cluster.m_portalNodes.size();
+	}
+	return numOfPortalNodes;
+}
+
+static uint32_t StartNewGeneration( AStarScratch* scratch )
+{
+	// a new generation invalidates every node at once, clear the stamps only when the counter wraps
+	scratch->m_generation++;
+	if (scratch->m_generation == 0) {
+		std::fill( scratch->m_generations.begin(), scratch->m_generations.end(), 0 );
+		scratch->m_generation = 1;
+	}
+	return scratch->m_generation;
+}
+
+bool AStarHelper::SearchNodes( AStarScratch* scratch, int startNode, int endNode, bool blockWater, int clusterIndex ) const
+{
+	uint32_t generation = StartNewGeneration( scratch );
+	uint32_t* generations = scratch->m_generations.data();
+	float* distCosts = scratch->m_distCosts.data();
+	float* costs = scratch->m_costs.data();
+	int* parents = scratch->m_parents.data();
+	std::vector<AStarHeapEntry>& openList = scratch->m_openList;
+	openList.clear();
+
+	generations[startNode] = generation;
+	distCosts[startNode] = 0.f;
+	costs[startNode] = 0.f;
+	parents[startNode] = -1;
+	PushOpenList( openList, AStarHeapEntry{ 0.f, startNode } );
+
+	while (!openList.empty()) {
+		AStarHeapEntry entry = PopOpenList( openList );
+		int thisNode = entry.m_node;
+		// a cheaper path to this node was pushed after this entry
+		if (entry.m_cost != costs[thisNode]) {
+			continue;
+		}
+		if (thisNode == endNode) {
+			return true;
+		}
+		float thisDistCost = distCosts[thisNode];
+		for (int i = m_neighborBegins[thisNode]; i < m_neighborBegins[thisNode + 1]; i++) {
+			int adjNode = m_neighborNodes[i];
+			if ((blockWater && m_isWater[adjNode]) || (clusterIndex >= 0 && m_nodeClusters[adjNode] != clusterIndex)) {
+				continue;
+			}
+			float distCost = thisDistCost + m_neighborDists[i];
+			if (generations[adjNode] != generation || distCost < distCosts[adjNode]) {
+				generations[adjNode] = generation;
+				distCosts[adjNode] = distCost;
+				costs[adjNode] = endNode >= 0 ? distCost + CalculateHeuristicCost( adjNode, endNode ) : distCost;
+				parents[adjNode] = thisNode;
+				PushOpenList( openList, AStarHeapEntry{ costs[adjNode], adjNode } );
+			}
+		}
+	}
+	return false;
+}
+
+float AStarHelper::CalculateHeuristicCost( int nodeA, int nodeB ) const
+{
+	return GetDistance2D( m_positions[nodeA], m_positions[nodeB] );
+}
+
+void AStarHelper::ConvertNodeRoute( std::vector<int> const& nodeRoute, std::vector<MapPolygonUnit*>& out_route ) const
 {
 	out_route.clear();
-	for (auto& node : m_nodes) {
-		node.m_cost = FLT_MAX;
-	}
-	std::priority_queue < AStarNode*, std::vector<AStarNode*>, decltype(m_compFunc) > openList;
-	AStarNode* startNode = (*m_unitToNodeMap.find( start )).second;
-	startNode->m_cost = 0.f;
-	startNode->m_distCost = 0.f;
-	startNode->m_distCostHeight = 0.f;
-	startNode->m_heuristicCost = 0.f;
-	startNode->m_parent = nullptr;
-	openList.push( startNode );
+	out_route.reserve( nodeRoute.size() );
+	for (int node : nodeRoute) {
+		out_route.push_back( m_nodeUnits[node] );
+	}
+}
 
-	AStarNode* endNode = (*m_unitToNodeMap.find( end )).second;
+bool AStarHelper::SearchPortalRoute( AStarScratch* scratch, int startNode, int endNode, bool blockWater, std::vector<int>& out_portalRoute ) const
+{
+	out_portalRoute.clear();
+	AStarCluster const& startCluster = m_clusters[m_nodeClusters[startNode]];
+	int endClusterIndex = m_nodeClusters[endNode];
+	AStarCluster const& endCluster = m_clusters[endClusterIndex];
 
-	while (1) {
-		if (openList.empty()) {
-			return false;
+	// start is linked to the portals of its cluster and the portals of the end cluster are linked to end,
+	// both by a flood that stays inside the cluster
+	std::vector<float> startDists( startCluster.m_portalNodes.size(), FLT_MAX );
+	SearchNodes( scratch, startNode, -1, blockWater, m_nodeClusters[startNode] );
+	for (int i = 0; i < (int)startCluster.m_portalNodes.size(); i++) {
+		int portalNode = startCluster.m_portalNodes[i];
+		if (scratch->m_generations[portalNode] == scratch->m_generation) {
+			startDists[i] = scratch->m_distCosts[portalNode];
+		}
+	}
+	std::vector<float> endDists( endCluster.m_portalNodes.size(), FLT_MAX );
+	SearchNodes( scratch, endNode, -1, blockWater, endClusterIndex );
+	for (int i = 0; i < (int)endCluster.m_portalNodes.size(); i++) {
+		int portalNode = endCluster.m_portalNodes[i];
+		if (scratch->m_generations[portalNode] == scratch->m_generation) {
+			endDists[i] = scratch->m_distCosts[portalNode];
+		}
+	}
+
+	uint32_t generation = StartNewGeneration( scratch );
+	uint32_t* generations = scratch->m_generations.data();
+	float* distCosts = scratch->m_distCosts.data();
+	float* costs = scratch->m_costs.data();
+	int* parents = scratch->m_parents.data();
+	std::vector<AStarHeapEntry>& openList = scratch->m_openList;
+	openList.clear();
+	auto relaxNode = [&]( int node, float distCost, int parent ) {
+		if (generations[node] != generation || distCost < distCosts[node]) {
+			generations[node] = generation;
+			distCosts[node] = distCost;
+			costs[node] = distCost + CalculateHeuristicCost( node, endNode );
+			parents[node] = parent;
+			PushOpenList( openList, AStarHeapEntry{ costs[node], node } );
+		}
+		};
+	relaxNode( startNode, 0.f, -1 );
+
+	int blockWaterIndex = blockWater ? 1 : 0;
+	bool hasRoute = false;
+	while (!openList.empty()) {
+		AStarHeapEntry entry = PopOpenList( openList );
+		int thisNode = entry.m_node;
+		if (entry.m_cost != costs[thisNode]) {
+			continue;
 		}
-		AStarNode* thisNode = openList.top();
 		if (thisNode == endNode) {
-			//closedList.push_back( thisNode );
+			hasRoute = true;
 			break;
 		}
-		else {
-			openList.pop();
-			//closedList.push_back( thisNode );
-			for (auto& adjNodePair : thisNode->m_neighbors) {
-				// check if it is water
-				if (!adjNodePair.first->m_base->IsWater()) { // haven't visited
-					if (adjNodePair.first->m_cost == FLT_MAX) {
-						adjNodePair.first->m_distCostHeight = thisNode->GetDistCostByHeight( thisNode ) + adjNodePair.second;
-						adjNodePair.first->m_heuristicCost = CalculateHeuristicCost( adjNodePair.first, endNode );
-						adjNodePair.first->m_cost = adjNodePair.first->m_distCostHeight + adjNodePair.first->m_heuristicCost;
-						adjNodePair.first->m_parent = thisNode;
-						openList.push( adjNodePair.first );
-					}
-					// visited
-					else {
-						// has a smaller connection option
-						if (adjNodePair.first->m_distCostHeight > thisNode->GetDistCostByHeight( thisNode ) + adjNodePair.second) {
-							adjNodePair.first->m_distCostHeight = thisNode->GetDistCostByHeight( thisNode ) + adjNodePair.second;
-							adjNodePair.first->m_cost = adjNodePair.first->m_distCostHeight + adjNodePair.first->m_heuristicCost;
-							adjNodePair.first->m_parent = thisNode;
-						}
+		float thisDistCost = distCosts[thisNode];
+		int portalIndex = m_nodePortalIndices[thisNode];
+		AStarCluster const& cluster = m_clusters[m_nodeClusters[thisNode]];
+		int numOfPortals = (int)cluster.m_portalNodes.size();
+		if (thisNode == startNode) {
+			for (int i = 0; i < numOfPortals; i++) {
+				if (startDists[i] != FLT_MAX) {
+					relaxNode( cluster.m_portalNodes[i], thisDistCost + startDists[i], thisNode );
+				}
+			}
+		}
+		else if (portalIndex >= 0) {
+			float const* portalDists = &cluster.m_portalDists[blockWaterIndex][(size_t)portalIndex * numOfPortals];
+			for (int i = 0; i < numOfPortals; i++) {
+				if (i != portalIndex && portalDists[i] != FLT_MAX) {
+					relaxNode( cluster.m_portalNodes[i], thisDistCost + portalDists[i], thisNode );
+				}
+			}
+		}
+		if (portalIndex >= 0) {
+			for (AStarPortalEdge const& edge : cluster.m_portalEdges) {
+				if (edge.m_fromNode == thisNode && (!blockWater || edge.m_isLand)) {
+					relaxNode( edge.m_toNode, thisDistCost + edge.m_dist, thisNode );
+				}
+			}
+			if (m_nodeClusters[thisNode] == endClusterIndex && endDists[portalIndex] != FLT_MAX) {
+				relaxNode( endNode, thisDistCost + endDists[portalIndex], thisNode );
+			}
+		}
+	}
+
+	if (hasRoute) {
+		for (int node = endNode; node != -1; node = parents[node]) {
+			out_portalRoute.push_back( node );
+		}
+		std::reverse( out_portalRoute.begin(), out_portalRoute.end() );
+	}
+	return hasRoute;
+}
+
+bool AStarHelper::CanUseHierarchy( int startNode, int endNode, bool blockWater ) const
+{
+	if (!HasHierarchy() || startNode == endNode || (blockWater && (m_isWater[startNode] || m_isWater[endNode]))) {
+		return false;
+	}
+	// near routes gain nothing from the portals and the flat search is exact
+	int startCluster = m_nodeClusters[startNode];
+	int endCluster = m_nodeClusters[endNode];
+	std::vector<int> const& adjClusters = m_clusters[startCluster].m_adjClusters;
+	return startCluster != endCluster && std::find( adjClusters.begin(), adjClusters.end(), endCluster ) == adjClusters.end();
+}
+
+void AStarHelper::BuildClusterPortals()
+{
+	BuildNodeComponents();
+	// one pass over every pair of adjacent clusters
+	for (int clusterIndex = 0; clusterIndex < (int)m_clusters.size(); clusterIndex++) {
+		for (int adjCluster : m_clusters[clusterIndex].m_adjClusters) {
+			if (adjCluster > clusterIndex) {
+				ChoosePortalEdges( clusterIndex, adjCluster );
+			}
+		}
+	}
+	for (AStarCluster& cluster : m_clusters) {
+		for (AStarPortalEdge const& edge : cluster.m_portalEdges) {
+			if (m_nodePortalIndices[edge.m_fromNode] < 0) {
+				m_nodePortalIndices[edge.m_fromNode] = (int)cluster.m_portalNodes.size();
+				cluster.m_portalNodes.push_back( edge.m_fromNode );
+			}
+		}
+	}
+	ParallelFor( 0, (int)m_clusters.size(), 1, [this]( int i ) {
+		BuildClusterPortalDists( i );
+		} );
+}
+
+void AStarHelper::BuildNodeComponents()
+{
+	int numOfNodes = GetNumOfNodes();
+	std::vector<int> floodQueue;
+	for (int blockWaterIndex = 0; blockWaterIndex < 2; blockWaterIndex++) {
+		std::vector<int>& components = m_nodeComponents[blockWaterIndex];
+		components.assign( numOfNodes, -1 );
+		int numOfComponents = 0;
+		for (int i = 0; i < numOfNodes; i++) {
+			if (components[i] >= 0 || (blockWaterIndex == 1 && m_isWater[i])) {
+				continue;
+			}
+			floodQueue.clear();
+			floodQueue.push_back( i );
+			components[i] = numOfComponents;
+			for (int front = 0; front < (int)floodQueue.size(); front++) {
+				int thisNode = floodQueue[front];
+				for (int j = m_neighborBegins[thisNode]; j < m_neighborBegins[thisNode + 1]; j++) {
+					int adjNode = m_neighborNodes[j];
+					if (components[adjNode] < 0 && (blockWaterIndex == 0 || !m_isWater[adjNode])) {
+						components[adjNode] = numOfComponents;
+						floodQueue.push_back( adjNode );
 					}
 				}
 			}
+			numOfComponents++;
 		}
 	}
+}
 
-	AStarNode* nodeIter = endNode;
-	out_route.clear();
-	while (nodeIter != nullptr) {
-		out_route.push_back( const_cast<MapPolygonUnit*>(nodeIter->m_base) );
-		nodeIter = nodeIter->m_parent;
+void AStarHelper::ChoosePortalEdges( int clusterA, int clusterB )
+{
+	// the crossing closest to the middle of the two clusters, and the closest land crossing if that one touches water
+	Vec2 middlePos = (m_clusters[clusterA].m_center + m_clusters[clusterB].m_center) * 0.5f;
+	AStarPortalEdge bestEdge;
+	AStarPortalEdge bestLandEdge;
+	float bestDistSquared = FLT_MAX;
+	float bestLandDistSquared = FLT_MAX;
+	for (int node : m_clusters[clusterA].m_nodes) {
+		for (int i = m_neighborBegins[node]; i < m_neighborBegins[node + 1]; i++) {
+			int adjNode = m_neighborNodes[i];
+			if (m_nodeClusters[adjNode] != clusterB) {
+				continue;
+			}
+			float distSquared = GetDistanceSquared2D( (m_positions[node] + m_positions[adjNode]) * 0.5f, middlePos );
+			AStarPortalEdge edge{ node, adjNode, m_neighborDists[i], !m_isWater[node] && !m_isWater[adjNode] };
+			if (distSquared < bestDistSquared) {
+				bestDistSquared = distSquared;
+				bestEdge = edge;
+			}
+			if (edge.m_isLand && distSquared < bestLandDistSquared) {
+				bestLandDistSquared = distSquared;
+				bestLandEdge = edge;
+			}
+		}
 	}
-	return true;
+	auto addEdge = [this, clusterA, clusterB]( AStarPortalEdge const& edge ) {
+		m_clusters[clusterA].m_portalEdges.push_back( edge );
+		m_clusters[clusterB].m_portalEdges.push_back( AStarPortalEdge{ edge.m_toNode, edge.m_fromNode, edge.m_dist, edge.m_isLand } );
+		};
+	if (bestEdge.m_fromNode >= 0) {
+		addEdge( bestEdge );
+	}
+	if (bestLandEdge.m_fromNode >= 0 && !bestEdge.m_isLand) {
+		addEdge( bestLandEdge );
+	}
+}
+
+void AStarHelper::BuildClusterPortalDists( int clusterIndex )
+{
+	AStarCluster& cluster = m_clusters[clusterIndex];
+	int numOfPortals = (int)cluster.m_portalNodes.size();
+	AStarScratch* scratch = AcquireScratch();
+	for (int blockWaterIndex = 0; blockWaterIndex < 2; blockWaterIndex++) {
+		std::vector<float>& portalDists = cluster.m_portalDists[blockWaterIndex];
+		portalDists.assign( (size_t)numOfPortals * numOfPortals, FLT_MAX );
+		for (int i = 0; i < numOfPortals; i++) {
+			if (blockWaterIndex == 1 && m_isWater[cluster.m_portalNodes[i]]) {
+				continue;
+			}
+			SearchNodes( scratch, cluster.m_portalNodes[i], -1, blockWaterIndex == 1, clusterIndex );
+			for (int j = 0; j < numOfPortals; j++) {
+				int portalNode = cluster.m_portalNodes[j];
+				if (scratch->m_generations[portalNode] == scratch->m_generation) {
+					portalDists[(size_t)i * numOfPortals + j] = scratch->m_distCosts[portalNode];
+				}
+			}
+		}
+	}
+	ReleaseScratch( scratch );
 }
 
-float AStarHelper::CalculateHeuristicCost( AStarNode* a, AStarNode* b )
+AStarScratch* AStarHelper::AcquireScratch()
 {
-	return GetDistance2D( a->m_base->m_geoCenterPos, b->m_base->m_geoCenterPos );
+	{
+		std::lock_guard<std::mutex> lock( m_scratchMutex );
+		if (!m_freeScratches.empty()) {
+			AStarScratch* scratch = m_freeScratches.back();
+			m_freeScratches.pop_back();
+			return scratch;
+		}
+	}
+	// one scratch for each thread that searches at the same time, they are kept until the graph changes
+	int numOfNodes = GetNumOfNodes();
+	AStarScratch* scratch = new AStarScratch();
+	scratch->m_generations.resize( numOfNodes, 0 );
+	scratch->m_distCosts.resize( numOfNodes );
+	scratch->m_costs.resize( numOfNodes );
+	scratch->m_parents.resize( numOfNodes );
+	scratch->m_openList.reserve( 256 );
+	return scratch;
 }
 
-float AStarNode::GetDistCostByHeight( AStarNode* parent ) const
+void AStarHelper::ReleaseScratch( AStarScratch* scratch )
 {
-	return parent->m_distCostHeight + abs( m_base->m_height - parent->m_base->m_height ) / 200.f;
+	std::lock_guard<std::mutex> lock( m_scratchMutex );
+	m_freeScratches.push_back( scratch );
 }
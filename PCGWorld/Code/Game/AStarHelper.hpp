@@ -1,35 +1,131 @@
 #pragma once
 #include "Game/GameCommon.hpp"
 #include <queue>
+#include <mutex>
 
 class MapPolygonUnit;
 
-struct AStarNode {
-	AStarNode( MapPolygonUnit* base ) :m_base( base ) {};
-	
-	float GetDistCostByHeight( AStarNode* parent ) const;
-
-	MapPolygonUnit const* m_base = nullptr;
-	std::vector<std::pair<AStarNode*, float>> m_neighbors;
-	AStarNode* m_parent = nullptr;
-	float m_distCost = FLT_MAX;
-	float m_distCostHeight = FLT_MAX;
-	float m_heuristicCost = FLT_MAX;
-	float m_cost = FLT_MAX;
+// one (start, end) pair of a batch, nodes are the indices of AStarHelper
+struct AStarQuery {
+	int m_startNode = -1;
+	int m_endNode = -1;
+	bool m_blockWater = false;
+	bool m_hasRoute = false;
+	std::vector<int> m_nodeRoute; // end node first, start node last
 };
 
+struct AStarHeapEntry {
+	float m_cost = 0.f;
+	int m_node = -1;
+};
+
+// search state of one query, a node's values only count if its generation is the current one,
+// so starting a query is O(1) instead of resetting every node
+struct AStarScratch {
+	std::vector<uint32_t> m_generations;
+	std::vector<float> m_distCosts;
+	std::vector<float> m_costs;
+	std::vector<int> m_parents;
+	std::vector<AStarHeapEntry> m_openList; // 4-ary min heap by m_cost
+	uint32_t m_generation = 0;
+};
+
+// crossing between two adjacent clusters, each cluster keeps its own direction
+struct AStarPortalEdge {
+	int m_fromNode = -1; // in the cluster that keeps the edge
+	int m_toNode = -1;
+	float m_dist = 0.f;
+	bool m_isLand = false; // both ends are land, routes that block water can use it
+};
+
+// group of nodes for the hierarchical routes, long routes only look at the portal nodes and
+// the cached shortest distances between them inside the cluster
+struct AStarCluster {
+	std::vector<int> m_nodes;
+	std::vector<int> m_adjClusters;
+	std::vector<AStarPortalEdge> m_portalEdges;
+	std::vector<int> m_portalNodes;
+	std::vector<float> m_portalDists[2]; // [blockWater][i * numOfPortals + j], FLT_MAX if j cannot be reached inside the cluster
+	Vec2 m_center;
+};
+
+// A* over the adjacency graph of the polygon units, the graph does not change after init
+// queries do not share any state, so any number of threads can search at the same time
 class AStarHelper {
 public:
 	AStarHelper() {};
+	~AStarHelper();
 	void AStarHelperInit( std::vector<MapPolygonUnit*> const& units );
+	/// graph without map units, node i is at positions[i]
+	void AStarHelperInit( std::vector<Vec2> const& positions, std::vector<std::vector<int>> const& adjacentNodes, std::vector<bool> const& isWater );
+
+	/// out_route goes from end to start, empty if end cannot be reached; always the shortest route, the hierarchy is not used
 	void CalculateRoute( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route );
 	//void CalculateRouteWaterBlockRoute( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route );
+	/// same as CalculateRoute but never walks into water, returns false if end cannot be reached that way
 	bool CalculateRouteWaterBlockRouteAndHeightWeight( MapPolygonUnit const* start, MapPolygonUnit const* end, std::vector<MapPolygonUnit*>& out_route );
+	/// run every query, the job workers help when there are several
+	void CalculateRoutes( std::vector<AStarQuery>& queries );
+	/// out_nodeRoute goes from end to start, returns false if end cannot be reached
+	bool CalculateNodeRoute( int startNode, int endNode, bool blockWater, std::vector<int>& out_nodeRoute );
+	/// the search before generation stamps: resets every node, std::priority_queue; kept to compare against, not thread safe
+	bool CalculateNodeRouteByFullReset( int startNode, int endNode, std::vector<int>& out_nodeRoute );
+
+	/// group the nodes for hierarchical routes, node i goes to cluster nodeClusters[i]
+	/// nodes with -1 are flooded into clusters of at most maxFloodClusterSize nodes, water and land apart
+	/// the hierarchy is built once for the current water, do not call while searches run
+	void BuildHierarchy( std::vector<int> const& nodeClusters, int maxFloodClusterSize = 32 );
+	void ClearHierarchy();
+	bool HasHierarchy() const;
+	/// searches the portal graph when start and end are more than one cluster apart, the route can be a little longer than the shortest one
+	/// without a hierarchy it is the same as CalculateNodeRoute
+	bool CalculateHierarchicalNodeRoute( int startNode, int endNode, bool blockWater, std::vector<int>& out_nodeRoute );
+	/// first step of the hierarchical route, only the first leg is refined; -1 if end cannot be reached or is start
+	int CalculateNextNodeOnRoute( int startNode, int endNode, bool blockWater );
+	MapPolygonUnit* CalculateNextUnitOnRoute( MapPolygonUnit const* start, MapPolygonUnit const* end, bool blockWater );
+
+	int GetNodeIndex( MapPolygonUnit const* unit ) const;
+	MapPolygonUnit* GetNodeUnit( int nodeIndex ) const;
+	int GetNumOfNodes() const;
+	/// sum of the edge lengths along a node route
+	float GetNodeRouteDistance( std::vector<int> const& nodeRoute ) const;
+	int GetNumOfClusters() const;
+	int GetNumOfPortalNodes() const;
 protected:
-	float CalculateHeuristicCost( AStarNode* a, AStarNode* b );
+	float CalculateHeuristicCost( int nodeA, int nodeB ) const;
+	/// A* from start, stays inside clusterIndex if it is not -1; with endNode -1 it floods everything it can reach
+	/// the result stays in the scratch for the current generation
+	bool SearchNodes( AStarScratch* scratch, int startNode, int endNode, bool blockWater, int clusterIndex ) const;
+	/// A* over the portal nodes, out_portalRoute goes from start to end and each step stays in one cluster or crosses one portal edge
+	bool SearchPortalRoute( AStarScratch* scratch, int startNode, int endNode, bool blockWater, std::vector<int>& out_portalRoute ) const;
+	bool CanUseHierarchy( int startNode, int endNode, bool blockWater ) const;
+	void BuildClusterPortals();
+	void BuildNodeComponents();
+	void ChoosePortalEdges( int clusterA, int clusterB );
+	void BuildClusterPortalDists( int clusterIndex );
+	void BuildNeighborLists( std::vector<std::vector<int>> const& adjacentNodes );
+	void ConvertNodeRoute( std::vector<int> const& nodeRoute, std::vector<MapPolygonUnit*>& out_route ) const;
+
+	AStarScratch* AcquireScratch();
+	void ReleaseScratch( AStarScratch* scratch );
+
+	// compressed adjacency: the neighbors of node i are [m_neighborBegins[i], m_neighborBegins[i + 1])
+	std::vector<int> m_neighborBegins;
+	std::vector<int> m_neighborNodes;
+	std::vector<float> m_neighborDists;
+	std::vector<Vec2> m_positions;
+	std::vector<uint8_t> m_isWater;
+	std::vector<MapPolygonUnit*> m_nodeUnits;
+	std::vector<int> m_unitIDToNode;
 
-	std::vector<AStarNode> m_nodes;
-	std::map<MapPolygonUnit const*, AStarNode*> m_unitToNodeMap;
-	static inline auto const m_compFunc = []( AStarNode* a, AStarNode* b )->bool { return a->m_cost > b->m_cost; };
+	std::vector<AStarCluster> m_clusters;
+	std::vector<int> m_nodeClusters;
+	std::vector<int> m_nodePortalIndices; // index in the portal list of the node's cluster, -1 if it is no portal
+	std::vector<int> m_nodeComponents[2]; // connected parts of the graph, [1] without water and -1 on water nodes
 
+	std::mutex m_scratchMutex;
+	std::vector<AStarScratch*> m_freeScratches;
+	std::vector<float> m_fullResetCosts;
+	std::vector<float> m_fullResetDistCosts;
+	std::vector<int> m_fullResetParents;
 };
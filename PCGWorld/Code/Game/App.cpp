@@ -89,6 +89,11 @@ void App::Startup() {
 	g_theGame->Startup();
 
 	SubscribeEventCallbackFunction( "quit", App::SetQuitting );
+	SubscribeEventCallbackFunction( "Command_ColorMapBenchmark", Map::Command_ColorMapBenchmark );
+	SubscribeEventCallbackFunction( "Command_PathfindingBenchmark", Map::Command_PathfindingBenchmark );
+	SubscribeEventCallbackFunction( "Command_VoronoiBenchmark", Map::Command_VoronoiBenchmark );
+	SubscribeEventCallbackFunction( "Command_SimulationBenchmark", Map::Command_SimulationBenchmark );
+	SubscribeEventCallbackFunction( "Command_ProvincePickingBenchmark", Map::Command_ProvincePickingBenchmark );
 	g_devConsole->AddLine( DevConsole::INFO_MINOR, "Initializing..." );
 
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Successfully Initialized!" );
@@ -63,24 +63,15 @@ void Army::GetAllProvincesCanGo( std::vector<MapPolygonUnit*>& out_provs )
 
 MapPolygonUnit* Army::FindNextProvinceToGo( MapPolygonUnit* target ) const
 {
+	// only the next step is used, so only the first leg of the route is searched in detail
 	Map* map = GetCurMap();
-	std::vector<MapPolygonUnit*> route;
-	bool hasRes = map->m_aStarHelper.CalculateRouteWaterBlockRouteAndHeightWeight( m_provIn, target, route );
-	if (!hasRes || (int)route.size() <= 1 || route[route.size() - 1] != m_provIn) {
-		if (!hasRes) {
-			map->m_aStarHelper.CalculateRoute( m_provIn, target, route );
-			if ((int)route.size() <= 1 || route[route.size() - 1] != m_provIn) {
-				ERROR_RECOVERABLE( "Cannot reach here!" );
-				return nullptr;
-			}
-			else {
-				return route[route.size() - 2];
-			}
-		}
-		else {
-			ERROR_RECOVERABLE( "Cannot reach here!" );
-			return nullptr;
-		}
+	MapPolygonUnit* nextProv = map->m_aStarHelper.CalculateNextUnitOnRoute( m_provIn, target, true );
+	if (!nextProv) {
+		nextProv = map->m_aStarHelper.CalculateNextUnitOnRoute( m_provIn, target, false );
+	}
+	if (!nextProv) {
+		// only called while the owner plans on a worker thread, the map reports it later
+		m_owner->m_planningErrors.push_back( "Cannot reach here!" );
 	}
-	return route[route.size() - 2];
+	return nextProv;
 }
@@ -795,7 +795,7 @@ void Country::SetUpSimulation()
 	m_funds = 6 * m_economyValue;
 }
 
-void Country::ExecuteCountryBehavior()
+void Country::PlanCountryBehavior( std::vector<CountryInstruction*>& out_instructions )
 {
 	//if (m_funds < -m_economyValue) {
 	//	return;
@@ -824,7 +824,7 @@ void Country::ExecuteCountryBehavior()
 						//m_funds -= BUILD_ARMY_COST;
 					}
 					buildArmySuccessfully = true;
-					map->AddInstructionToQueue( newInstr );
+					out_instructions.push_back( newInstr );
 					costToAddThisMonth += ARMY_COST;
 					break;
 				}
@@ -838,7 +838,7 @@ void Country::ExecuteCountryBehavior()
 						SpendMoney( BUILD_ARMY_COST );
 					}
 					buildArmySuccessfully = true;
-					map->AddInstructionToQueue( newInstr );
+					out_instructions.push_back( newInstr );
 					costToAddThisMonth += ARMY_COST;
 				}
 			}
@@ -869,7 +869,7 @@ void Country::ExecuteCountryBehavior()
 							cultureFactor += 0.5f;
 						}
 						SpendMoney( int( float( numOfSoldierToRecruit * RECRUIT_SOLDIER_COST ) * cultureFactor ) );
-						map->AddInstructionToQueue( newInstr );
+						out_instructions.push_back( newInstr );
 						costToAddThisMonth += int( float( numOfSoldierToRecruit * ARMY_SOLDIER_COST ) );
 					}
 				}
@@ -903,7 +903,7 @@ void Country::ExecuteCountryBehavior()
 				continue;
 			}
 			if (army->m_provIn->m_armiesOnProv.size() == 0 || (!army->m_provIn->IsWater() && army != army->m_provIn->m_armiesOnProv[0].first)) {
-				ERROR_RECOVERABLE( "Hit a BAD Point!" );
+				m_planningErrors.push_back( "Hit a BAD Point!" );
 			}
 			// find the province need to go
 			for (auto prov : m_provinces) {
@@ -976,7 +976,7 @@ void Country::ExecuteCountryBehavior()
 					newInstr->m_army = army;
 					newInstr->m_fromProv = army->m_provIn;
 					newInstr->m_toProv = provToGo;
-					map->AddInstructionToQueue( newInstr );
+					out_instructions.push_back( newInstr );
 					army->m_goingTarget = finalTarget;
 				}
 			}
@@ -985,7 +985,7 @@ void Country::ExecuteCountryBehavior()
 				newInstr->m_army = army;
 				newInstr->m_fromProv = army->m_provIn;
 				newInstr->m_toProv = provCanGo[map->m_historyRNG->RollRandomIntLessThan( (int)provCanGo.size() )];
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}*/
 		}
 		else { // going to target
@@ -999,7 +999,7 @@ void Country::ExecuteCountryBehavior()
 				newInstr->m_army = army;
 				newInstr->m_fromProv = army->m_provIn;
 				newInstr->m_toProv = provToGo;
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}
 		}
 	}
@@ -1012,7 +1012,7 @@ void Country::ExecuteCountryBehavior()
 				InstructionAssimilate* newInstr = new InstructionAssimilate();
 				newInstr->m_province = prov;
 				newInstr->m_culture = m_countryCulture;
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}
 		}
 	}
@@ -1025,7 +1025,7 @@ void Country::ExecuteCountryBehavior()
 				InstructionConvert* newInstr = new InstructionConvert();
 				newInstr->m_province = prov;
 				newInstr->m_religion = m_countryReligion;
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}
 		}
 	}
@@ -1041,7 +1041,7 @@ void Country::ExecuteCountryBehavior()
 					SpendMoney( DEV_COST );
 					InstructionDevelop* newInstr = new InstructionDevelop();
 					newInstr->m_prov = prov;
-					map->AddInstructionToQueue( newInstr );
+					out_instructions.push_back( newInstr );
 				}
 			}
 		}
@@ -1055,7 +1055,7 @@ void Country::ExecuteCountryBehavior()
 				InstructionAssimilate* newInstr = new InstructionAssimilate();
 				newInstr->m_province = prov;
 				newInstr->m_culture = m_countryCulture;
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}
 		}
 	}
@@ -1067,7 +1067,7 @@ void Country::ExecuteCountryBehavior()
 				InstructionConvert* newInstr = new InstructionConvert();
 				newInstr->m_province = prov;
 				newInstr->m_religion = m_countryReligion;
-				map->AddInstructionToQueue( newInstr );
+				out_instructions.push_back( newInstr );
 			}
 		}
 	}
@@ -1078,7 +1078,7 @@ void Country::ExecuteCountryBehavior()
 			InstructionLegalize* newInstr = new InstructionLegalize();
 			newInstr->m_province = prov;
 			newInstr->m_country = this;
-			map->AddInstructionToQueue( newInstr );
+			out_instructions.push_back( newInstr );
 		}
 	}
 
@@ -1091,8 +1091,11 @@ void Country::ExecuteCountryBehavior()
 // 		m_countryReligion = m_religions[0].first;
 // 		m_funds /= 10;
 // 	}
+}
 
-
+void Country::ExecuteCountryDiplomacy()
+{
+	Map* map = GetCurMap();
 	// relationship
 	// chance to become worse
 	for (auto otherCountry : map->m_countries) {
@@ -7,6 +7,7 @@ class Religion;
 class Town;
 class City;
 class Army;
+class CountryInstruction;
 
 enum class CountryRelationType {
 	Friendly, Alliance, Hostile, War, Tributary, Suzerain, Vassal, Celestial, TribeUnion, None, Self
@@ -69,7 +70,10 @@ public:
 
 	// simulation
 	void SetUpSimulation();
-	void ExecuteCountryBehavior();
+	/// decisions about the country's own money, armies and provinces; only reads the rest of the map, so countries can plan at the same time
+	void PlanCountryBehavior( std::vector<CountryInstruction*>& out_instructions );
+	/// relations, wars and annexations; changes other countries and rolls the history rng, so countries run it one by one in order
+	void ExecuteCountryDiplomacy();
 	void BeginTurn();
 	void EndTurn();
 	void ReCalculateCultureAndReligion();
@@ -143,6 +147,9 @@ public:
 	std::vector<Country*> m_relationTributaries;
 
 	std::vector<Country*> m_tribeUnions;
+
+	// errors hit by PlanCountryBehavior on a worker thread, the map reports them on the main thread after planning
+	std::vector<std::string> m_planningErrors;
 protected:
 	bool IsFriendlyWith( Country* country ) const;
 	bool IsHostileWith( Country* country ) const;
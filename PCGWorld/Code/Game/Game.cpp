@@ -483,6 +483,9 @@ void Game::UpdateControlPanelUI()
 			m_generationSettings.m_townRichness = GetClamped( m_generationSettings.m_townRichness, 0.f, 1.f );
 			ImGui::Checkbox( "Use Western Country Names", &m_generationSettings.m_onlyUseWesternCountryPrefix );
 			ImGui::SameLine(); HelpMarker( "Only use Duchy Kingdom and Empire as country name prefix" );
+			ImGui::InputInt( "Polygon Relaxation Passes", &m_generationSettings.m_relaxIterations );
+			ImGui::SameLine(); HelpMarker( "Moves every polygon center to the middle of its polygon this many times, more passes give more even polygons" );
+			m_generationSettings.m_relaxIterations = GetClamped( m_generationSettings.m_relaxIterations, 0, 10 );
 		}
 		if (ImGui::Button( "Load Settings From File", ImVec2( 250.f, 40.f ) )) {
 			LoadGenerationSettings();
@@ -2344,6 +2347,7 @@ void Game::SaveCurrentGenerationSettings()
 	rootElem->SetAttribute( "NumOfCultures", m_map->m_generationSettings.m_numOfCultures );
 	rootElem->SetAttribute( "NumOfReligions", m_map->m_generationSettings.m_numOfReligions );
 	rootElem->SetAttribute( "UseWesternEuropeanCountryNames", m_map->m_generationSettings.m_onlyUseWesternCountryPrefix );
+	rootElem->SetAttribute( "RelaxIterations", m_map->m_generationSettings.m_relaxIterations );
 
 	std::filesystem::create_directory( Stringf( "Saves/%d", m_map->m_generationSettings.m_seed ).c_str() );
 	XmlError errorCode = savedSettings.SaveFile( Stringf( "Saves/%d/GenerationSettings.xml", m_map->m_generationSettings.m_seed ).c_str() );
@@ -2359,17 +2363,7 @@ void Game::LoadGenerationSettings() {
 	genDocument.LoadFile( filePath.c_str() );
 	XmlElement* rootElem = genDocument.RootElement();
 	if (rootElem) {
-		m_generationSettings.m_seed = ParseXmlAttribute( *rootElem, "Seed", m_generationSettings.m_seed );
-		m_generationSettings.m_basePolygons = ParseXmlAttribute( *rootElem, "PolygonAmount", m_generationSettings.m_basePolygons );
-		m_generationSettings.m_dimensions.x = ParseXmlAttribute( *rootElem, "DimensionsX", m_generationSettings.m_dimensions.x );
-		m_generationSettings.m_dimensions.y = ParseXmlAttribute( *rootElem, "DimensionsY", m_generationSettings.m_dimensions.y );
-		m_generationSettings.m_minHeight = ParseXmlAttribute( *rootElem, "MinHeight", m_generationSettings.m_minHeight );
-		m_generationSettings.m_maxHeight = ParseXmlAttribute( *rootElem, "MaxHeight", m_generationSettings.m_maxHeight );
-		m_generationSettings.m_fragmentFactor = ParseXmlAttribute( *rootElem, "FragmentFactor", m_generationSettings.m_fragmentFactor );
-		m_generationSettings.m_landRichnessFactor = ParseXmlAttribute( *rootElem, "OceanFactor", m_generationSettings.m_landRichnessFactor );
-		m_generationSettings.m_numOfCultures = ParseXmlAttribute( *rootElem, "NumOfCultures", m_generationSettings.m_numOfCultures );
-		m_generationSettings.m_numOfReligions = ParseXmlAttribute( *rootElem, "NumOfReligions", m_generationSettings.m_numOfReligions );
-		m_generationSettings.m_onlyUseWesternCountryPrefix = ParseXmlAttribute( *rootElem, "UseWesternEuropeanCountryNames", m_generationSettings.m_onlyUseWesternCountryPrefix );
+		m_generationSettings.PopulateFromXmlElementAttributes( *rootElem );
 	}
 }
 
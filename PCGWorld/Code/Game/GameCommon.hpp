@@ -84,6 +84,7 @@ constexpr int ARMY_COST = 4000;
 constexpr int BUILD_ARMY_COST = 100;
 constexpr int RECRUIT_SOLDIER_COST = 100;
 constexpr int MAX_SAVE_MONTH = 96;
+constexpr int MAX_POOLED_HISTORY_DATA = 4;
 constexpr int DEV_COST = 10000;
 constexpr int ASSIMILATE_COST = 10000;
 constexpr int CONVERT_COST = 10000;
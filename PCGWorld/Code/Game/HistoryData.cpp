@@ -7,119 +7,273 @@
 #include "Game/City.hpp"
 #include "Game/CountryInstructions.hpp"
 #include <filesystem>
+// zip.c already compiles miniz, only its declarations are needed here
+#define MINIZ_HEADER_FILE_ONLY
+#include "ThirdParty/zip/miniz.h"
+
+// copy the ids of a culture / religion list of the map into a pool, the span says where they went
+template<typename T>
+static HistorySpan AppendProportionsToPool( std::vector<std::pair<int, float>>& pool, std::vector<std::pair<T*, float>> const& list )
+{
+	HistorySpan span;
+	span.m_offset = (int)pool.size();
+	span.m_count = (int)list.size();
+	for (auto const& pair : list) {
+		pool.emplace_back( pair.first->m_id, pair.second );
+	}
+	return span;
+}
+
+static HistorySpan AppendCountryIDsToPool( std::vector<int>& pool, std::vector<Country*> const& list )
+{
+	HistorySpan span;
+	span.m_offset = (int)pool.size();
+	span.m_count = (int)list.size();
+	for (auto country : list) {
+		pool.push_back( country->m_id );
+	}
+	return span;
+}
+
+template<typename T>
+static HistorySpan AppendListToPool( std::vector<T>& pool, HistoryList<T> const& list )
+{
+	HistorySpan span;
+	span.m_offset = (int)pool.size();
+	span.m_count = list.size();
+	pool.insert( pool.end(), list.begin(), list.end() );
+	return span;
+}
+
+template<typename T>
+static HistoryList<T> GetListInPool( std::vector<T> const& pool, HistorySpan const& span )
+{
+	return HistoryList<T>( pool.data() + span.m_offset, span.m_count );
+}
+
+template<typename T>
+static HistoryList<T> GetListOfVector( std::vector<T> const& list )
+{
+	return HistoryList<T>( list.data(), (int)list.size() );
+}
+
+HistoryProvinceData HistoryProvinceTable::operator[]( int index ) const
+{
+	HistoryProvinceData data;
+	data.m_isWater = m_isWater[index] != 0;
+	data.m_population = m_population[index];
+	data.m_ownerCountryID = m_ownerCountryID[index];
+	data.m_cultures = GetListInPool( m_proportionPool, m_cultures[index] );
+	data.m_religions = GetListInPool( m_proportionPool, m_religions[index] );
+	data.m_legalCountriesID = GetListInPool( m_idPool, m_legalCountriesID[index] );
+	return data;
+}
+
+void HistoryProvinceTable::PushBack( HistoryProvinceData const& data )
+{
+	m_isWater.push_back( data.m_isWater ? 1 : 0 );
+	m_population.push_back( data.m_population );
+	m_ownerCountryID.push_back( data.m_ownerCountryID );
+	m_cultures.push_back( AppendListToPool( m_proportionPool, data.m_cultures ) );
+	m_religions.push_back( AppendListToPool( m_proportionPool, data.m_religions ) );
+	m_legalCountriesID.push_back( AppendListToPool( m_idPool, data.m_legalCountriesID ) );
+}
+
+void HistoryProvinceTable::Clear()
+{
+	m_isWater.clear();
+	m_population.clear();
+	m_ownerCountryID.clear();
+	m_cultures.clear();
+	m_religions.clear();
+	m_legalCountriesID.clear();
+	m_proportionPool.clear();
+	m_idPool.clear();
+}
+
+HistoryTownData HistoryTownTable::operator[]( int index ) const
+{
+	HistoryTownData data;
+	data.m_population = m_population[index];
+	data.m_ownerID = m_ownerID[index];
+	data.m_defenseValue = m_defenseValue[index];
+	data.m_cultures = GetListInPool( m_proportionPool, m_cultures[index] );
+	data.m_religions = GetListInPool( m_proportionPool, m_religions[index] );
+	return data;
+}
+
+void HistoryTownTable::PushBack( HistoryTownData const& data )
+{
+	m_population.push_back( data.m_population );
+	m_ownerID.push_back( data.m_ownerID );
+	m_defenseValue.push_back( data.m_defenseValue );
+	m_cultures.push_back( AppendListToPool( m_proportionPool, data.m_cultures ) );
+	m_religions.push_back( AppendListToPool( m_proportionPool, data.m_religions ) );
+}
+
+void HistoryTownTable::Clear()
+{
+	m_population.clear();
+	m_ownerID.clear();
+	m_defenseValue.clear();
+	m_cultures.clear();
+	m_religions.clear();
+	m_proportionPool.clear();
+}
+
+HistoryCityData HistoryCityTable::operator[]( int index ) const
+{
+	HistoryCityData data;
+	(HistoryTownData&)data = HistoryTownTable::operator[]( index );
+	data.m_type = m_type[index];
+	return data;
+}
+
+void HistoryCityTable::PushBack( HistoryCityData const& data )
+{
+	HistoryTownTable::PushBack( data );
+	m_type.push_back( data.m_type );
+}
+
+void HistoryCityTable::Clear()
+{
+	HistoryTownTable::Clear();
+	m_type.clear();
+}
+
+HistoryCountryData HistoryCountryTable::operator[]( int index ) const
+{
+	HistoryCountryData data;
+	data.m_exist = m_exist[index] != 0;
+	data.m_funds = m_funds[index];
+	data.m_countryCultureID = m_countryCultureID[index];
+	data.m_capitalProvID = m_capitalProvID[index];
+	data.m_countryReligionID = m_countryReligionID[index];
+	data.m_capitalCityID = m_capitalCityID[index];
+	data.m_suzerainCountryID = m_suzerainCountryID[index];
+	data.m_celestialCountryID = m_celestialCountryID[index];
+	data.m_isCelestial = m_isCelestial[index] != 0;
+	data.m_governmentType = m_governmentType[index];
+	data.m_friendlyCountriesID = GetListInPool( m_idPool, m_friendlyCountriesID[index] );
+	data.m_allianceCountriesID = GetListInPool( m_idPool, m_allianceCountriesID[index] );
+	data.m_hostileCountriesID = GetListInPool( m_idPool, m_hostileCountriesID[index] );
+	data.m_vassalCountriesID = GetListInPool( m_idPool, m_vassalCountriesID[index] );
+	data.m_tributaryCountriesID = GetListInPool( m_idPool, m_tributaryCountriesID[index] );
+	data.m_warCountriesID = GetListInPool( m_warPool, m_warCountriesID[index] );
+	return data;
+}
+
+void HistoryCountryTable::PushBack( HistoryCountryData const& data )
+{
+	m_exist.push_back( data.m_exist ? 1 : 0 );
+	m_funds.push_back( data.m_funds );
+	m_countryCultureID.push_back( data.m_countryCultureID );
+	m_capitalProvID.push_back( data.m_capitalProvID );
+	m_countryReligionID.push_back( data.m_countryReligionID );
+	m_capitalCityID.push_back( data.m_capitalCityID );
+	m_suzerainCountryID.push_back( data.m_suzerainCountryID );
+	m_celestialCountryID.push_back( data.m_celestialCountryID );
+	m_isCelestial.push_back( data.m_isCelestial ? 1 : 0 );
+	m_governmentType.push_back( data.m_governmentType );
+	m_friendlyCountriesID.push_back( AppendListToPool( m_idPool, data.m_friendlyCountriesID ) );
+	m_allianceCountriesID.push_back( AppendListToPool( m_idPool, data.m_allianceCountriesID ) );
+	m_hostileCountriesID.push_back( AppendListToPool( m_idPool, data.m_hostileCountriesID ) );
+	m_vassalCountriesID.push_back( AppendListToPool( m_idPool, data.m_vassalCountriesID ) );
+	m_tributaryCountriesID.push_back( AppendListToPool( m_idPool, data.m_tributaryCountriesID ) );
+	m_warCountriesID.push_back( AppendListToPool( m_warPool, data.m_warCountriesID ) );
+}
+
+void HistoryCountryTable::Clear()
+{
+	m_exist.clear();
+	m_funds.clear();
+	m_countryCultureID.clear();
+	m_capitalProvID.clear();
+	m_countryReligionID.clear();
+	m_capitalCityID.clear();
+	m_suzerainCountryID.clear();
+	m_celestialCountryID.clear();
+	m_isCelestial.clear();
+	m_governmentType.clear();
+	m_friendlyCountriesID.clear();
+	m_allianceCountriesID.clear();
+	m_hostileCountriesID.clear();
+	m_vassalCountriesID.clear();
+	m_tributaryCountriesID.clear();
+	m_warCountriesID.clear();
+	m_idPool.clear();
+	m_warPool.clear();
+}
+
+static void RecordTown( HistoryTownTable& towns, Town* town )
+{
+	towns.m_population.push_back( town->m_totalPopulation );
+	towns.m_ownerID.push_back( town->m_owner->m_id );
+	towns.m_defenseValue.push_back( town->m_defense );
+	towns.m_cultures.push_back( AppendProportionsToPool( towns.m_proportionPool, town->m_cultures ) );
+	towns.m_religions.push_back( AppendProportionsToPool( towns.m_proportionPool, town->m_religions ) );
+}
 
 HistoryData::HistoryData( Map* map )
 {
-	m_provinceData.resize( map->m_mapPolygonUnits.size() );
-	for (int i = 0; i < (int)map->m_mapPolygonUnits.size(); i++) {
-		Province* prov = map->m_mapPolygonUnits[i];
+	Record( map );
+}
+
+void HistoryData::Record( Map* map )
+{
+	// columns are only cleared, a reused snapshot only allocates when the map grew past what it held before
+	Clear();
+	HistoryProvinceData waterProvince;
+	waterProvince.m_isWater = true;
+	for (auto prov : map->m_mapPolygonUnits) {
 		if (prov->IsWater()) {
-			m_provinceData[i].m_isWater = true;
-		}
-		else {
-			m_provinceData[i].m_isWater = false;
-			if (prov->m_owner) {
-				m_provinceData[i].m_ownerCountryID = prov->m_owner->m_id;
-			}
-			else {
-				m_provinceData[i].m_ownerCountryID = -1;
-			}
-			m_provinceData[i].m_population = prov->m_totalPopulation;
-			m_provinceData[i].m_cultures.resize( prov->m_cultures.size() );
-			for (int j = 0; j < (int)prov->m_cultures.size(); ++j) {
-				m_provinceData[i].m_cultures[j] = std::pair<int, float>( prov->m_cultures[j].first->m_id, prov->m_cultures[j].second );
-			}
-			m_provinceData[i].m_religions.resize( prov->m_religions.size() );
-			for (int j = 0; j < (int)prov->m_religions.size(); ++j) {
-				m_provinceData[i].m_religions[j] = std::pair<int, float>( prov->m_religions[j].first->m_id, prov->m_religions[j].second );
-			}
-			for (int j = 0; j < (int)prov->m_legitimateCountries.size(); ++j) {
-				//if (prov->m_legitimateCountries[j]->IsExist()) {
-				m_provinceData[i].m_legalCountriesID.push_back( prov->m_legitimateCountries[j]->m_id );
-				//}
-			}
+			m_provinceData.PushBack( waterProvince );
+			continue;
 		}
+		m_provinceData.m_isWater.push_back( 0 );
+		m_provinceData.m_population.push_back( prov->m_totalPopulation );
+		m_provinceData.m_ownerCountryID.push_back( prov->m_owner ? prov->m_owner->m_id : -1 );
+		m_provinceData.m_cultures.push_back( AppendProportionsToPool( m_provinceData.m_proportionPool, prov->m_cultures ) );
+		m_provinceData.m_religions.push_back( AppendProportionsToPool( m_provinceData.m_proportionPool, prov->m_religions ) );
+		m_provinceData.m_legalCountriesID.push_back( AppendCountryIDsToPool( m_provinceData.m_idPool, prov->m_legitimateCountries ) );
 	}
-	m_cityData.resize( map->m_cities.size() );
-	for (int i = 0; i < (int)map->m_cities.size(); i++) {
-		City* city = map->m_cities[i];
-		m_cityData[i].m_population = city->m_totalPopulation;
-		m_cityData[i].m_cultures.resize( city->m_cultures.size() );
-		for (int j = 0; j < (int)city->m_cultures.size(); ++j) {
-			m_cityData[i].m_cultures[j] = std::pair<int, float>( city->m_cultures[j].first->m_id, city->m_cultures[j].second );
-		}
-		m_cityData[i].m_religions.resize( city->m_religions.size() );
-		for (int j = 0; j < (int)city->m_religions.size(); ++j) {
-			m_cityData[i].m_religions[j] = std::pair<int, float>( city->m_religions[j].first->m_id, city->m_religions[j].second );
-		}
-		m_cityData[i].m_defenseValue = city->m_defense;
-		m_cityData[i].m_ownerID = city->m_owner->m_id;
-		m_cityData[i].m_type = city->GetRawAttribute();
+	for (auto city : map->m_cities) {
+		RecordTown( m_cityData, city );
+		m_cityData.m_type.push_back( city->GetRawAttribute() );
 	}
-	m_townData.resize( map->m_towns.size() );
-	for (int i = 0; i < (int)map->m_towns.size(); i++) {
-		Town* town = map->m_towns[i];
-		m_townData[i].m_population = town->m_totalPopulation;
-		m_townData[i].m_cultures.resize( town->m_cultures.size() );
-		for (int j = 0; j < (int)town->m_cultures.size(); ++j) {
-			m_townData[i].m_cultures[j] = std::pair<int, float>( town->m_cultures[j].first->m_id, town->m_cultures[j].second );
-		}
-		m_townData[i].m_religions.resize( town->m_religions.size() );
-		for (int j = 0; j < (int)town->m_religions.size(); ++j) {
-			m_townData[i].m_religions[j] = std::pair<int, float>( town->m_religions[j].first->m_id, town->m_religions[j].second );
-		}
-		m_townData[i].m_defenseValue = town->m_defense;
-		m_townData[i].m_ownerID = town->m_owner->m_id;
+	for (auto town : map->m_towns) {
+		RecordTown( m_townData, town );
 	}
-	m_countryData.resize( map->m_countries.size() );
-	for (int i = 0; i < (int)map->m_countries.size(); i++) {
-		Country* country = map->m_countries[i];
-		m_countryData[i].m_exist = country->IsExist();
-		if (!m_countryData[i].m_exist) {
+	HistoryCountryData nonExistentCountry;
+	nonExistentCountry.m_exist = false;
+	for (auto country : map->m_countries) {
+		if (!country->IsExist()) {
+			m_countryData.PushBack( nonExistentCountry );
 			continue;
 		}
-		
-		if (country->m_capitalCity) {
-			m_countryData[i].m_capitalCityID = country->m_capitalCity->m_id;
-		}
-		else {
-			m_countryData[i].m_capitalCityID = -1;
-		}
-		if (country->m_capitalProv) {
-			m_countryData[i].m_capitalProvID = country->m_capitalProv->m_id;
-		}
-		else {
-			m_countryData[i].m_capitalProvID = -1;
-		}
-		for (auto iterCountry : country->m_relationAllianceCountries) {
-			m_countryData[i].m_allianceCountriesID.push_back( iterCountry->m_id );
-		}
-		for (auto iterCountry : country->m_relationFriendlyCountries) {
-			m_countryData[i].m_friendlyCountriesID.push_back( iterCountry->m_id );
-		}
-		for (auto iterCountry : country->m_relationHostileCountries) {
-			m_countryData[i].m_hostileCountriesID.push_back( iterCountry->m_id );
-		}
+		HistoryCountryTable& countries = m_countryData;
+		countries.m_exist.push_back( 1 );
+		countries.m_funds.push_back( country->m_funds );
+		countries.m_countryCultureID.push_back( country->m_countryCulture->m_id );
+		countries.m_capitalProvID.push_back( country->m_capitalProv ? country->m_capitalProv->m_id : -1 );
+		countries.m_countryReligionID.push_back( country->m_countryReligion->m_id );
+		countries.m_capitalCityID.push_back( country->m_capitalCity ? country->m_capitalCity->m_id : -1 );
+		countries.m_suzerainCountryID.push_back( country->m_relationSuzerain ? country->m_relationSuzerain->m_id : -1 );
+		countries.m_celestialCountryID.push_back( country->m_relationCelestialEmpire ? country->m_relationCelestialEmpire->m_id : -1 );
+		countries.m_isCelestial.push_back( country->m_isCelestial ? 1 : 0 );
+		countries.m_governmentType.push_back( (int)country->m_governmentType );
+		countries.m_friendlyCountriesID.push_back( AppendCountryIDsToPool( countries.m_idPool, country->m_relationFriendlyCountries ) );
+		countries.m_allianceCountriesID.push_back( AppendCountryIDsToPool( countries.m_idPool, country->m_relationAllianceCountries ) );
+		countries.m_hostileCountriesID.push_back( AppendCountryIDsToPool( countries.m_idPool, country->m_relationHostileCountries ) );
+		countries.m_vassalCountriesID.push_back( AppendCountryIDsToPool( countries.m_idPool, country->m_relationVassals ) );
+		countries.m_tributaryCountriesID.push_back( AppendCountryIDsToPool( countries.m_idPool, country->m_relationTributaries ) );
+		HistorySpan warSpan;
+		warSpan.m_offset = (int)countries.m_warPool.size();
+		warSpan.m_count = (int)country->m_relationWarCountries.size();
 		for (auto iterCountry : country->m_relationWarCountries) {
-			m_countryData[i].m_warCountriesID.push_back( std::pair<int, int>( iterCountry->m_id, country->GetWarTimeWith( iterCountry ) ) );
+			countries.m_warPool.emplace_back( iterCountry->m_id, country->GetWarTimeWith( iterCountry ) );
 		}
-		for (auto iterCountry : country->m_relationTributaries) {
-			m_countryData[i].m_tributaryCountriesID.push_back( iterCountry->m_id );
-		}
-		for (auto iterCountry : country->m_relationVassals) {
-			m_countryData[i].m_vassalCountriesID.push_back( iterCountry->m_id );
-		}
-		m_countryData[i].m_isCelestial = country->m_isCelestial;
-		if (country->m_relationCelestialEmpire) {
-			m_countryData[i].m_celestialCountryID = country->m_relationCelestialEmpire->m_id;
-		}
-		if (country->m_relationSuzerain) {
-			m_countryData[i].m_suzerainCountryID = country->m_relationSuzerain->m_id;
-		}
-		m_countryData[i].m_funds = country->m_funds;
-		m_countryData[i].m_countryCultureID = country->m_countryCulture->m_id;
-		m_countryData[i].m_countryReligionID = country->m_countryReligion->m_id;
-		m_countryData[i].m_governmentType = (int)country->m_governmentType;
+		countries.m_warCountriesID.push_back( warSpan );
 	}
 	for (auto country : map->m_countries) {
 		for (int i = 0; i < (int)country->m_armies.size(); i++) {
@@ -132,28 +286,34 @@ HistoryData::HistoryData( Map* map )
 			}
 		}
 	}
-	std::vector<HistoryCrisis*> copyedCrisisList;
 	for (auto crisis : map->m_crisis) {
-		if (crisis) {
-			copyedCrisisList.push_back( crisis );
+		if (crisis == nullptr) {
+			continue;
 		}
-	}
-	m_crisisData.resize( copyedCrisisList.size() );
-	for (int i = 0; i < (int)copyedCrisisList.size(); ++i) {
-		HistoryCrisis* crisis = copyedCrisisList[i];
-		m_crisisData[i].m_countryID = crisis->m_country->m_id;
-		m_crisisData[i].m_type = (int)crisis->m_type;
+		HistoryCrisisData& crisisData = m_crisisData.emplace_back();
+		crisisData.m_countryID = crisis->m_country->m_id;
+		crisisData.m_type = (int)crisis->m_type;
 		if (crisis->m_type == CrisisType::CultureConflict) {
-			m_crisisData[i].m_cultureOrReligionID = ((Culture*)crisis->m_cultureOrReligion)->m_id;
+			crisisData.m_cultureOrReligionID = ((Culture*)crisis->m_cultureOrReligion)->m_id;
 		}
 		else if (crisis->m_type == CrisisType::ReligionConflict) {
-			m_crisisData[i].m_cultureOrReligionID = ((Religion*)crisis->m_cultureOrReligion)->m_id;
+			crisisData.m_cultureOrReligionID = ((Religion*)crisis->m_cultureOrReligion)->m_id;
 		}
-		m_crisisData[i].m_globalID = crisis->m_globalID;
-		m_crisisData[i].m_progress = crisis->m_progress;
+		crisisData.m_globalID = crisis->m_globalID;
+		crisisData.m_progress = crisis->m_progress;
 	}
 }
 
+void HistoryData::Clear()
+{
+	m_provinceData.Clear();
+	m_countryData.Clear();
+	m_armyData.clear();
+	m_cityData.Clear();
+	m_townData.Clear();
+	m_crisisData.clear();
+}
+
 void HistoryData::PrintOutHistory( XmlDocument* document, XmlElement* rootElem, HistoryData* provMonth ) const
 {
 	XmlElement* elem = document->NewElement( "HistoryMonth" );
@@ -162,478 +322,438 @@ void HistoryData::PrintOutHistory( XmlDocument* document, XmlElement* rootElem,
 
 }
 
+// every column of a month in the order they are written, func gets each std::vector
+template<typename Data, typename Func>
+static void ForEachHistoryColumn( Data& data, Func const& func )
+{
+	auto& provinces = data.m_provinceData;
+	func( provinces.m_isWater );
+	func( provinces.m_population );
+	func( provinces.m_ownerCountryID );
+	func( provinces.m_cultures );
+	func( provinces.m_religions );
+	func( provinces.m_legalCountriesID );
+	func( provinces.m_proportionPool );
+	func( provinces.m_idPool );
+	auto& cities = data.m_cityData;
+	func( cities.m_population );
+	func( cities.m_ownerID );
+	func( cities.m_defenseValue );
+	func( cities.m_cultures );
+	func( cities.m_religions );
+	func( cities.m_proportionPool );
+	func( cities.m_type );
+	auto& towns = data.m_townData;
+	func( towns.m_population );
+	func( towns.m_ownerID );
+	func( towns.m_defenseValue );
+	func( towns.m_cultures );
+	func( towns.m_religions );
+	func( towns.m_proportionPool );
+	auto& countries = data.m_countryData;
+	func( countries.m_exist );
+	func( countries.m_funds );
+	func( countries.m_countryCultureID );
+	func( countries.m_capitalProvID );
+	func( countries.m_countryReligionID );
+	func( countries.m_capitalCityID );
+	func( countries.m_suzerainCountryID );
+	func( countries.m_celestialCountryID );
+	func( countries.m_isCelestial );
+	func( countries.m_governmentType );
+	func( countries.m_friendlyCountriesID );
+	func( countries.m_allianceCountriesID );
+	func( countries.m_hostileCountriesID );
+	func( countries.m_vassalCountriesID );
+	func( countries.m_tributaryCountriesID );
+	func( countries.m_warCountriesID );
+	func( countries.m_idPool );
+	func( countries.m_warPool );
+	func( data.m_armyData );
+	func( data.m_crisisData );
+}
+
 void HistoryData::DumpToBinaryFormat( std::vector<uint8_t>& bin ) const
 {
-	size_t writePtr = 0;
-	bin.clear();
-	bin.reserve( 10000 );
-	// count how much data it needs
+	// the column lengths give the size of the buffer, no need to walk the entries
 	size_t sizeOfBuffer = 0;
-	sizeOfBuffer += 24;
-	for (auto const& provHistory : m_provinceData) {
-		if (provHistory.m_isWater) {
-			sizeOfBuffer += 1;
+	ForEachHistoryColumn( *this, [&sizeOfBuffer]( auto const& column ) {
+		sizeOfBuffer += sizeof( int ) + column.size() * sizeof( column[0] );
+		} );
+	bin.resize( sizeOfBuffer );
+
+	size_t writePtr = 0;
+	ForEachHistoryColumn( *this, [&bin, &writePtr]( auto const& column ) {
+		int size = (int)column.size();
+		memcpy( bin.data() + writePtr, &size, sizeof( int ) );
+		writePtr += sizeof( int );
+		if (size > 0) {
+			memcpy( bin.data() + writePtr, column.data(), column.size() * sizeof( column[0] ) );
+			writePtr += column.size() * sizeof( column[0] );
 		}
-		else {
-			sizeOfBuffer += 9;// stand alone values
-			sizeOfBuffer += 12;// size
-			sizeOfBuffer += provHistory.m_legalCountriesID.size() * 4;
-			sizeOfBuffer += provHistory.m_cultures.size() * 8;
-			sizeOfBuffer += provHistory.m_religions.size() * 8;
+		} );
+}
+
+void HistoryData::LoadFromBinaryFormat( std::vector<uint8_t> const& bin )
+{
+	size_t readPtr = 0;
+	ForEachHistoryColumn( *this, [&bin, &readPtr]( auto& column ) {
+		int size = *(int*)(bin.data() + readPtr);
+		readPtr += sizeof( int );
+		column.resize( size );
+		if (size > 0) {
+			memcpy( column.data(), bin.data() + readPtr, column.size() * sizeof( column[0] ) );
+			readPtr += column.size() * sizeof( column[0] );
 		}
+		} );
+}
+
+// flags of one entry in a month delta, a set bit means the field changed since the month before and follows the flags
+constexpr uint8_t HISTORY_DELTA_POPULATION = 0x01;
+constexpr uint8_t HISTORY_DELTA_OWNER = 0x02;
+constexpr uint8_t HISTORY_DELTA_CULTURES = 0x04;
+constexpr uint8_t HISTORY_DELTA_RELIGIONS = 0x08;
+constexpr uint8_t HISTORY_DELTA_LEGAL_COUNTRIES = 0x10;
+constexpr uint8_t HISTORY_DELTA_DEFENSE = 0x20;
+constexpr uint8_t HISTORY_DELTA_CITY_TYPE = 0x40;
+constexpr uint8_t HISTORY_DELTA_WATER = 0x80;
+
+constexpr uint8_t HISTORY_DELTA_EXIST = 0x01;
+constexpr uint8_t HISTORY_DELTA_FUNDS = 0x02;
+constexpr uint8_t HISTORY_DELTA_COUNTRY_STATE = 0x04; // capital, culture, religion, overlords and government
+constexpr uint8_t HISTORY_DELTA_RELATIONS = 0x08;
+constexpr uint8_t HISTORY_DELTA_WARS = 0x10;
+
+static void AppendIntList( BufferWriter& writer, HistoryList<int> const& list )
+{
+	writer.AppendInt32( (int)list.size() );
+	for (int value : list) {
+		writer.AppendInt32( value );
 	}
-	for (auto const& cityHistory : m_cityData) {
-		sizeOfBuffer += 14;// stand alone values
-		sizeOfBuffer += 8;// size
-		sizeOfBuffer += cityHistory.m_cultures.size() * 8;
-		sizeOfBuffer += cityHistory.m_religions.size() * 8;
+}
+
+static void ParseIntList( BufferReader& reader, std::vector<int>& out_list )
+{
+	out_list.resize( reader.ParseInt32() );
+	for (int& value : out_list) {
+		value = reader.ParseInt32();
 	}
-	for (auto const& townHistory : m_townData) {
-		sizeOfBuffer += 12;// stand alone values
-		sizeOfBuffer += 8;// size
-		sizeOfBuffer += townHistory.m_cultures.size() * 8;
-		sizeOfBuffer += townHistory.m_religions.size() * 8;
+}
+
+static void AppendProportionList( BufferWriter& writer, HistoryList<std::pair<int, float>> const& list )
+{
+	writer.AppendInt32( (int)list.size() );
+	for (auto const& pair : list) {
+		writer.AppendInt32( pair.first );
+		writer.AppendFloat( pair.second );
 	}
-	for (auto const& countryHistory : m_countryData) {
-		if (!countryHistory.m_exist) {
-			sizeOfBuffer += 1;
-		}
-		else {
-			sizeOfBuffer += 31;
-			sizeOfBuffer += 24;// size
-			sizeOfBuffer += countryHistory.m_friendlyCountriesID.size() * 4;
-			sizeOfBuffer += countryHistory.m_allianceCountriesID.size() * 4;
-			sizeOfBuffer += countryHistory.m_warCountriesID.size() * 8;
-			sizeOfBuffer += countryHistory.m_hostileCountriesID.size() * 4;
-			sizeOfBuffer += countryHistory.m_vassalCountriesID.size() * 4;
-			sizeOfBuffer += countryHistory.m_tributaryCountriesID.size() * 4;
-		}
+}
+
+static void ParseProportionList( BufferReader& reader, std::vector<std::pair<int, float>>& out_list )
+{
+	out_list.resize( reader.ParseInt32() );
+	for (auto& pair : out_list) {
+		pair.first = reader.ParseInt32();
+		pair.second = reader.ParseFloat();
 	}
-	sizeOfBuffer += m_armyData.size() * 24;
-	sizeOfBuffer += m_crisisData.size() * 20;
-	bin.resize( sizeOfBuffer );
+}
 
-	int size = (int)m_provinceData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
-	for (auto const& provHistory : m_provinceData) {
-		if (provHistory.m_isWater) {
-			memcpy( bin.data() + writePtr, &provHistory.m_isWater, sizeof( bool ) );
-			writePtr += sizeof( bool );
-		}
-		else {
-			memcpy( bin.data() + writePtr, &provHistory.m_isWater, sizeof( bool ) );
-			writePtr += sizeof( bool );
-			memcpy( bin.data() + writePtr, &provHistory.m_population, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &provHistory.m_ownerCountryID, sizeof( int ) );
-			writePtr += sizeof( int );
-			size = (int)provHistory.m_legalCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)provHistory.m_legalCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &provHistory.m_legalCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
-			}
-			size = (int)provHistory.m_cultures.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)provHistory.m_cultures.size(); ++i) {
-				memcpy( bin.data() + writePtr, &provHistory.m_cultures[i], sizeof( std::pair<int, float> ) );
-				writePtr += sizeof( std::pair<int, float> );
-			}
-			size = (int)provHistory.m_religions.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)provHistory.m_religions.size(); ++i) {
-				memcpy( bin.data() + writePtr, &provHistory.m_religions[i], sizeof( std::pair<int, float> ) );
-				writePtr += sizeof( std::pair<int, float> );
-			}
-		}
+static uint8_t GetTownDeltaFlags( HistoryTownData const& cur, HistoryTownData const& prev )
+{
+	uint8_t flags = 0;
+	flags |= cur.m_population != prev.m_population ? HISTORY_DELTA_POPULATION : 0;
+	flags |= cur.m_ownerID != prev.m_ownerID ? HISTORY_DELTA_OWNER : 0;
+	flags |= cur.m_cultures != prev.m_cultures ? HISTORY_DELTA_CULTURES : 0;
+	flags |= cur.m_religions != prev.m_religions ? HISTORY_DELTA_RELIGIONS : 0;
+	flags |= cur.m_defenseValue != prev.m_defenseValue ? HISTORY_DELTA_DEFENSE : 0;
+	return flags;
+}
+
+static void AppendTownDelta( BufferWriter& writer, uint8_t flags, HistoryTownData const& cur, HistoryTownData const& prev )
+{
+	if (flags & HISTORY_DELTA_POPULATION) {
+		// the change is small and deflates much better than the population itself
+		writer.AppendInt32( cur.m_population - prev.m_population );
 	}
-	size = (int)m_cityData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
-	for (auto const& cityHistory : m_cityData) {
-		memcpy( bin.data() + writePtr, &cityHistory.m_population, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &cityHistory.m_ownerID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &cityHistory.m_defenseValue, sizeof( float ) );
-		writePtr += sizeof( float );
-		memcpy( bin.data() + writePtr, &cityHistory.m_type, sizeof( uint16_t ) );
-		writePtr += sizeof( uint16_t );
+	if (flags & HISTORY_DELTA_OWNER) {
+		writer.AppendInt32( cur.m_ownerID );
+	}
+	if (flags & HISTORY_DELTA_CULTURES) {
+		AppendProportionList( writer, cur.m_cultures );
+	}
+	if (flags & HISTORY_DELTA_RELIGIONS) {
+		AppendProportionList( writer, cur.m_religions );
+	}
+	if (flags & HISTORY_DELTA_DEFENSE) {
+		writer.AppendFloat( cur.m_defenseValue );
+	}
+}
 
-		size =(int) cityHistory.m_cultures.size();
-		memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-		writePtr += sizeof( int );
-		for (int i = 0; i < (int)cityHistory.m_cultures.size(); ++i) {
-			memcpy( bin.data() + writePtr, &cityHistory.m_cultures[i], sizeof( std::pair<int, float> ) );
-			writePtr += sizeof( std::pair<int, float> );
-		}
-		size = (int)cityHistory.m_religions.size();
-		memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-		writePtr += sizeof( int );
-		for (int i = 0; i < (int)cityHistory.m_religions.size(); ++i) {
-			memcpy( bin.data() + writePtr, &cityHistory.m_religions[i], sizeof( std::pair<int, float> ) );
-			writePtr += sizeof( std::pair<int, float> );
-		}
+// changed lists are parsed into the scratch vectors, inout_data points at them until it is pushed into its table
+static void ParseTownDelta( BufferReader& reader, uint8_t flags, HistoryTownData& inout_data,
+	std::vector<std::pair<int, float>>& scratchCultures, std::vector<std::pair<int, float>>& scratchReligions )
+{
+	if (flags & HISTORY_DELTA_POPULATION) {
+		inout_data.m_population += reader.ParseInt32();
 	}
-	size = (int)m_townData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
-	for (auto const& townHistory : m_townData) {
-		memcpy( bin.data() + writePtr, &townHistory.m_population, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &townHistory.m_ownerID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &townHistory.m_defenseValue, sizeof( float ) );
-		writePtr += sizeof( float );
+	if (flags & HISTORY_DELTA_OWNER) {
+		inout_data.m_ownerID = reader.ParseInt32();
+	}
+	if (flags & HISTORY_DELTA_CULTURES) {
+		ParseProportionList( reader, scratchCultures );
+		inout_data.m_cultures = GetListOfVector( scratchCultures );
+	}
+	if (flags & HISTORY_DELTA_RELIGIONS) {
+		ParseProportionList( reader, scratchReligions );
+		inout_data.m_religions = GetListOfVector( scratchReligions );
+	}
+	if (flags & HISTORY_DELTA_DEFENSE) {
+		inout_data.m_defenseValue = reader.ParseFloat();
+	}
+}
 
-		size = (int)townHistory.m_cultures.size();
-		memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-		writePtr += sizeof( int );
-		for (int i = 0; i < (int)townHistory.m_cultures.size(); ++i) {
-			memcpy( bin.data() + writePtr, &townHistory.m_cultures[i], sizeof( std::pair<int, float> ) );
-			writePtr += sizeof( std::pair<int, float> );
+void HistoryData::DumpDeltaToBinaryFormat( HistoryData const& prevMonth, std::vector<uint8_t>& bin ) const
+{
+	bin.clear();
+	BufferWriter writer( bin );
+	// entries the month before did not have are compared with default ones
+	writer.AppendInt32( m_provinceData.size() );
+	for (int i = 0; i < m_provinceData.size(); ++i) {
+		HistoryProvinceData cur = m_provinceData[i];
+		HistoryProvinceData prev = i < prevMonth.m_provinceData.size() ? prevMonth.m_provinceData[i] : HistoryProvinceData();
+		uint8_t flags = 0;
+		flags |= cur.m_isWater != prev.m_isWater ? HISTORY_DELTA_WATER : 0;
+		flags |= cur.m_population != prev.m_population ? HISTORY_DELTA_POPULATION : 0;
+		flags |= cur.m_ownerCountryID != prev.m_ownerCountryID ? HISTORY_DELTA_OWNER : 0;
+		flags |= cur.m_cultures != prev.m_cultures ? HISTORY_DELTA_CULTURES : 0;
+		flags |= cur.m_religions != prev.m_religions ? HISTORY_DELTA_RELIGIONS : 0;
+		flags |= cur.m_legalCountriesID != prev.m_legalCountriesID ? HISTORY_DELTA_LEGAL_COUNTRIES : 0;
+		writer.AppendByte( flags );
+		if (flags & HISTORY_DELTA_WATER) {
+			writer.AppendBool( cur.m_isWater );
+		}
+		if (flags & HISTORY_DELTA_POPULATION) {
+			writer.AppendInt32( cur.m_population - prev.m_population );
+		}
+		if (flags & HISTORY_DELTA_OWNER) {
+			writer.AppendInt32( cur.m_ownerCountryID );
+		}
+		if (flags & HISTORY_DELTA_CULTURES) {
+			AppendProportionList( writer, cur.m_cultures );
+		}
+		if (flags & HISTORY_DELTA_RELIGIONS) {
+			AppendProportionList( writer, cur.m_religions );
+		}
+		if (flags & HISTORY_DELTA_LEGAL_COUNTRIES) {
+			AppendIntList( writer, cur.m_legalCountriesID );
 		}
-		size = (int)townHistory.m_religions.size();
-		memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-		writePtr += sizeof( int );
-		for (int i = 0; i < (int)townHistory.m_religions.size(); ++i) {
-			memcpy( bin.data() + writePtr, &townHistory.m_religions[i], sizeof( std::pair<int, float> ) );
-			writePtr += sizeof( std::pair<int, float> );
+	}
+	writer.AppendInt32( m_cityData.size() );
+	for (int i = 0; i < m_cityData.size(); ++i) {
+		HistoryCityData cur = m_cityData[i];
+		HistoryCityData prev = i < prevMonth.m_cityData.size() ? prevMonth.m_cityData[i] : HistoryCityData();
+		uint8_t flags = GetTownDeltaFlags( cur, prev );
+		flags |= cur.m_type != prev.m_type ? HISTORY_DELTA_CITY_TYPE : 0;
+		writer.AppendByte( flags );
+		AppendTownDelta( writer, flags, cur, prev );
+		if (flags & HISTORY_DELTA_CITY_TYPE) {
+			writer.AppendUshort( cur.m_type );
 		}
 	}
-	size = (int)m_countryData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
-	for (auto const& countryHistory : m_countryData) {
-		memcpy( bin.data() + writePtr, &countryHistory.m_exist, sizeof( bool ) );
-		writePtr += sizeof( bool );
-		if (countryHistory.m_exist) {
-			memcpy( bin.data() + writePtr, &countryHistory.m_capitalCityID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_capitalProvID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_celestialCountryID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_countryCultureID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_countryReligionID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_funds, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_suzerainCountryID, sizeof( int ) );
-			writePtr += sizeof( int );
-			memcpy( bin.data() + writePtr, &countryHistory.m_isCelestial, sizeof( bool ) );
-			writePtr += sizeof( bool );
-			memcpy( bin.data() + writePtr, &countryHistory.m_governmentType, sizeof( unsigned char ) );
-			writePtr += sizeof( unsigned char );
-
-			size = (int)countryHistory.m_friendlyCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_friendlyCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_friendlyCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
-			}
-			size = (int)countryHistory.m_allianceCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_allianceCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_allianceCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
-			}
-			size = (int)countryHistory.m_hostileCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_hostileCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_hostileCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
-			}
-			size = (int)countryHistory.m_warCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_warCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_warCountriesID[i], sizeof( std::pair<int, int> ) );
-				writePtr += sizeof( std::pair<int, int> );
-			}
-			size = (int)countryHistory.m_vassalCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_vassalCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_vassalCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
-			}
-			size = (int)countryHistory.m_tributaryCountriesID.size();
-			memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-			writePtr += sizeof( int );
-			for (int i = 0; i < (int)countryHistory.m_tributaryCountriesID.size(); ++i) {
-				memcpy( bin.data() + writePtr, &countryHistory.m_tributaryCountriesID[i], sizeof( int ) );
-				writePtr += sizeof( int );
+	writer.AppendInt32( m_townData.size() );
+	for (int i = 0; i < m_townData.size(); ++i) {
+		HistoryTownData cur = m_townData[i];
+		HistoryTownData prev = i < prevMonth.m_townData.size() ? prevMonth.m_townData[i] : HistoryTownData();
+		uint8_t flags = GetTownDeltaFlags( cur, prev );
+		writer.AppendByte( flags );
+		AppendTownDelta( writer, flags, cur, prev );
+	}
+	writer.AppendInt32( m_countryData.size() );
+	for (int i = 0; i < m_countryData.size(); ++i) {
+		HistoryCountryData cur = m_countryData[i];
+		HistoryCountryData prev = i < prevMonth.m_countryData.size() ? prevMonth.m_countryData[i] : HistoryCountryData();
+		uint8_t flags = 0;
+		flags |= cur.m_exist != prev.m_exist ? HISTORY_DELTA_EXIST : 0;
+		flags |= cur.m_funds != prev.m_funds ? HISTORY_DELTA_FUNDS : 0;
+		if (cur.m_countryCultureID != prev.m_countryCultureID || cur.m_capitalProvID != prev.m_capitalProvID
+			|| cur.m_countryReligionID != prev.m_countryReligionID || cur.m_capitalCityID != prev.m_capitalCityID
+			|| cur.m_suzerainCountryID != prev.m_suzerainCountryID || cur.m_celestialCountryID != prev.m_celestialCountryID
+			|| cur.m_isCelestial != prev.m_isCelestial || cur.m_governmentType != prev.m_governmentType) {
+			flags |= HISTORY_DELTA_COUNTRY_STATE;
+		}
+		if (cur.m_friendlyCountriesID != prev.m_friendlyCountriesID || cur.m_allianceCountriesID != prev.m_allianceCountriesID
+			|| cur.m_hostileCountriesID != prev.m_hostileCountriesID || cur.m_vassalCountriesID != prev.m_vassalCountriesID
+			|| cur.m_tributaryCountriesID != prev.m_tributaryCountriesID) {
+			flags |= HISTORY_DELTA_RELATIONS;
+		}
+		flags |= cur.m_warCountriesID != prev.m_warCountriesID ? HISTORY_DELTA_WARS : 0;
+		writer.AppendByte( flags );
+		if (flags & HISTORY_DELTA_EXIST) {
+			writer.AppendBool( cur.m_exist );
+		}
+		if (flags & HISTORY_DELTA_FUNDS) {
+			writer.AppendInt32( cur.m_funds - prev.m_funds );
+		}
+		if (flags & HISTORY_DELTA_COUNTRY_STATE) {
+			writer.AppendInt32( cur.m_countryCultureID );
+			writer.AppendInt32( cur.m_capitalProvID );
+			writer.AppendInt32( cur.m_countryReligionID );
+			writer.AppendInt32( cur.m_capitalCityID );
+			writer.AppendInt32( cur.m_suzerainCountryID );
+			writer.AppendInt32( cur.m_celestialCountryID );
+			writer.AppendBool( cur.m_isCelestial );
+			writer.AppendInt32( cur.m_governmentType );
+		}
+		if (flags & HISTORY_DELTA_RELATIONS) {
+			AppendIntList( writer, cur.m_friendlyCountriesID );
+			AppendIntList( writer, cur.m_allianceCountriesID );
+			AppendIntList( writer, cur.m_hostileCountriesID );
+			AppendIntList( writer, cur.m_vassalCountriesID );
+			AppendIntList( writer, cur.m_tributaryCountriesID );
+		}
+		if (flags & HISTORY_DELTA_WARS) {
+			writer.AppendInt32( cur.m_warCountriesID.size() );
+			for (auto const& war : cur.m_warCountriesID) {
+				writer.AppendInt32( war.first );
+				writer.AppendInt32( war.second );
 			}
 		}
 	}
-	size = (int)m_armyData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
+	// armies move every month and crises are few, both are written in full
+	writer.AppendInt32( (int)m_armyData.size() );
 	for (auto const& armyHistory : m_armyData) {
-		memcpy( bin.data() + writePtr, &armyHistory.m_size, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &armyHistory.m_globalID, sizeof( unsigned int ) );
-		writePtr += sizeof( unsigned int );
-		memcpy( bin.data() + writePtr, &armyHistory.m_combatValue, sizeof( float ) );
-		writePtr += sizeof( float );
-		memcpy( bin.data() + writePtr, &armyHistory.m_ownerID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &armyHistory.m_provInID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &armyHistory.m_targetProvID, sizeof( int ) );
-		writePtr += sizeof( int );
+		writer.AppendInt32( armyHistory.m_size );
+		writer.AppendInt32( armyHistory.m_globalID );
+		writer.AppendFloat( armyHistory.m_combatValue );
+		writer.AppendInt32( armyHistory.m_ownerID );
+		writer.AppendInt32( armyHistory.m_provInID );
+		writer.AppendInt32( armyHistory.m_targetProvID );
 	}
-	size = (int)m_crisisData.size();
-	memcpy( bin.data() + writePtr, &size, sizeof( int ) );
-	writePtr += sizeof( int );
+	writer.AppendInt32( (int)m_crisisData.size() );
 	for (auto const& crisisHistory : m_crisisData) {
-		memcpy( bin.data() + writePtr, &crisisHistory.m_countryID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &crisisHistory.m_globalID, sizeof( unsigned int ) );
-		writePtr += sizeof( unsigned int );
-		memcpy( bin.data() + writePtr, &crisisHistory.m_cultureOrReligionID, sizeof( int ) );
-		writePtr += sizeof( int );
-		memcpy( bin.data() + writePtr, &crisisHistory.m_progress, sizeof( float ) );
-		writePtr += sizeof( float );
-		memcpy( bin.data() + writePtr, &crisisHistory.m_type, sizeof( int ) );
-		writePtr += sizeof( int );
+		writer.AppendInt32( crisisHistory.m_countryID );
+		writer.AppendUint32( crisisHistory.m_globalID );
+		writer.AppendInt32( crisisHistory.m_cultureOrReligionID );
+		writer.AppendFloat( crisisHistory.m_progress );
+		writer.AppendInt32( crisisHistory.m_type );
 	}
 }
 
-void HistoryData::LoadFromBinaryFormat( std::vector<uint8_t> const& bin )
+void HistoryData::LoadDeltaFromBinaryFormat( HistoryData const& prevMonth, std::vector<uint8_t> const& bin )
 {
-	size_t readPtr = 0;
-	int size = 0;
-	int totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	// province
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryProvinceData data;
-		data.m_isWater = *(bool*)(bin.data() + readPtr);
-		readPtr += sizeof( bool );
-		if (!data.m_isWater) {
-			data.m_population = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_ownerCountryID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_legalCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				std::pair<int, float> pair;
-				pair.first = *(int*)(bin.data() + readPtr);
-				readPtr += sizeof( int );
-				pair.second = *(float*)(bin.data() + readPtr);
-				readPtr += sizeof( float );
-				data.m_cultures.push_back( pair );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				std::pair<int, float> pair;
-				pair.first = *(int*)(bin.data() + readPtr);
-				readPtr += sizeof( int );
-				pair.second = *(float*)(bin.data() + readPtr);
-				readPtr += sizeof( float );
-				data.m_religions.push_back( pair );
-			}
-		}
-		m_provinceData.push_back( data );
+	// rows start as views of the month before, changed lists point at these until PushBack copies them into the pools
+	std::vector<std::pair<int, float>> cultures;
+	std::vector<std::pair<int, float>> religions;
+	std::vector<int> legalCountriesID;
+	std::vector<int> friendlyCountriesID;
+	std::vector<int> allianceCountriesID;
+	std::vector<int> hostileCountriesID;
+	std::vector<int> vassalCountriesID;
+	std::vector<int> tributaryCountriesID;
+	std::vector<std::pair<int, int>> warCountriesID;
+	BufferReader reader( bin );
+	Clear();
+	int numOfProvinces = reader.ParseInt32();
+	for (int i = 0; i < numOfProvinces; ++i) {
+		HistoryProvinceData data = i < prevMonth.m_provinceData.size() ? prevMonth.m_provinceData[i] : HistoryProvinceData();
+		uint8_t flags = reader.ParseByte();
+		if (flags & HISTORY_DELTA_WATER) {
+			data.m_isWater = reader.ParseBool();
+		}
+		if (flags & HISTORY_DELTA_POPULATION) {
+			data.m_population += reader.ParseInt32();
+		}
+		if (flags & HISTORY_DELTA_OWNER) {
+			data.m_ownerCountryID = reader.ParseInt32();
+		}
+		if (flags & HISTORY_DELTA_CULTURES) {
+			ParseProportionList( reader, cultures );
+			data.m_cultures = GetListOfVector( cultures );
+		}
+		if (flags & HISTORY_DELTA_RELIGIONS) {
+			ParseProportionList( reader, religions );
+			data.m_religions = GetListOfVector( religions );
+		}
+		if (flags & HISTORY_DELTA_LEGAL_COUNTRIES) {
+			ParseIntList( reader, legalCountriesID );
+			data.m_legalCountriesID = GetListOfVector( legalCountriesID );
+		}
+		m_provinceData.PushBack( data );
 	}
-	// city
-	totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryCityData data;
-		data.m_population = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_ownerID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_defenseValue = *(float*)(bin.data() + readPtr);
-		readPtr += sizeof( float );
-		data.m_type = *(uint16_t*)(bin.data() + readPtr);
-		readPtr += sizeof( uint16_t );
-
-		size = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		for (int j = 0; j < size; ++j) {
-			std::pair<int, float> pair;
-			pair.first = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			pair.second = *(float*)(bin.data() + readPtr);
-			readPtr += sizeof( float );
-			data.m_cultures.push_back( pair );
-		}
-		size = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		for (int j = 0; j < size; ++j) {
-			std::pair<int, float> pair;
-			pair.first = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			pair.second = *(float*)(bin.data() + readPtr);
-			readPtr += sizeof( float );
-			data.m_religions.push_back( pair );
-		}
-		m_cityData.push_back( data );
+	int numOfCities = reader.ParseInt32();
+	for (int i = 0; i < numOfCities; ++i) {
+		HistoryCityData data = i < prevMonth.m_cityData.size() ? prevMonth.m_cityData[i] : HistoryCityData();
+		uint8_t flags = reader.ParseByte();
+		ParseTownDelta( reader, flags, data, cultures, religions );
+		if (flags & HISTORY_DELTA_CITY_TYPE) {
+			data.m_type = reader.ParseUshort();
+		}
+		m_cityData.PushBack( data );
 	}
-
-	// town
-	totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryTownData data;
-		data.m_population = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_ownerID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_defenseValue = *(float*)(bin.data() + readPtr);
-		readPtr += sizeof( float );
-
-		size = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		for (int j = 0; j < size; ++j) {
-			std::pair<int, float> pair;
-			pair.first = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			pair.second = *(float*)(bin.data() + readPtr);
-			readPtr += sizeof( float );
-			data.m_cultures.push_back( pair );
-		}
-		size = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		for (int j = 0; j < size; ++j) {
-			std::pair<int, float> pair;
-			pair.first = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			pair.second = *(float*)(bin.data() + readPtr);
-			readPtr += sizeof( float );
-			data.m_religions.push_back( pair );
-		}
-		m_townData.push_back( data );
+	int numOfTowns = reader.ParseInt32();
+	for (int i = 0; i < numOfTowns; ++i) {
+		HistoryTownData data = i < prevMonth.m_townData.size() ? prevMonth.m_townData[i] : HistoryTownData();
+		ParseTownDelta( reader, reader.ParseByte(), data, cultures, religions );
+		m_townData.PushBack( data );
 	}
-
-	// country
-	totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryCountryData data;
-		data.m_exist = *(bool*)(bin.data() + readPtr);
-		readPtr += sizeof( bool );
-		if (data.m_exist) {
-			data.m_capitalCityID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_capitalProvID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_celestialCountryID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_countryCultureID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_countryReligionID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_funds = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_suzerainCountryID = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			data.m_isCelestial = *(bool*)(bin.data() + readPtr);
-			readPtr += sizeof( bool );
-			data.m_governmentType = (int)*(unsigned char*)(bin.data() + readPtr);
-			readPtr += sizeof( unsigned char );
-
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_friendlyCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_allianceCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_hostileCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				//data.m_warCountriesID.push_back( std::pair<int, int>( *(int*)(bin.data() + readPtr), *(int*)(bin.data() + readPtr + sizeof( int )) ) );
-				std::pair<int, int> pair;
-				pair.first = *(int*)(bin.data() + readPtr);
-				readPtr += sizeof( int );
-				pair.second = *(int*)(bin.data() + readPtr);
-				readPtr += sizeof( int );
-				data.m_warCountriesID.push_back( pair );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_vassalCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
-			}
-			size = *(int*)(bin.data() + readPtr);
-			readPtr += sizeof( int );
-			for (int j = 0; j < size; ++j) {
-				data.m_tributaryCountriesID.push_back( *(int*)(bin.data() + readPtr) );
-				readPtr += sizeof( int );
+	int numOfCountries = reader.ParseInt32();
+	for (int i = 0; i < numOfCountries; ++i) {
+		HistoryCountryData data = i < prevMonth.m_countryData.size() ? prevMonth.m_countryData[i] : HistoryCountryData();
+		uint8_t flags = reader.ParseByte();
+		if (flags & HISTORY_DELTA_EXIST) {
+			data.m_exist = reader.ParseBool();
+		}
+		if (flags & HISTORY_DELTA_FUNDS) {
+			data.m_funds += reader.ParseInt32();
+		}
+		if (flags & HISTORY_DELTA_COUNTRY_STATE) {
+			data.m_countryCultureID = reader.ParseInt32();
+			data.m_capitalProvID = reader.ParseInt32();
+			data.m_countryReligionID = reader.ParseInt32();
+			data.m_capitalCityID = reader.ParseInt32();
+			data.m_suzerainCountryID = reader.ParseInt32();
+			data.m_celestialCountryID = reader.ParseInt32();
+			data.m_isCelestial = reader.ParseBool();
+			data.m_governmentType = reader.ParseInt32();
+		}
+		if (flags & HISTORY_DELTA_RELATIONS) {
+			ParseIntList( reader, friendlyCountriesID );
+			ParseIntList( reader, allianceCountriesID );
+			ParseIntList( reader, hostileCountriesID );
+			ParseIntList( reader, vassalCountriesID );
+			ParseIntList( reader, tributaryCountriesID );
+			data.m_friendlyCountriesID = GetListOfVector( friendlyCountriesID );
+			data.m_allianceCountriesID = GetListOfVector( allianceCountriesID );
+			data.m_hostileCountriesID = GetListOfVector( hostileCountriesID );
+			data.m_vassalCountriesID = GetListOfVector( vassalCountriesID );
+			data.m_tributaryCountriesID = GetListOfVector( tributaryCountriesID );
+		}
+		if (flags & HISTORY_DELTA_WARS) {
+			warCountriesID.resize( reader.ParseInt32() );
+			for (auto& war : warCountriesID) {
+				war.first = reader.ParseInt32();
+				war.second = reader.ParseInt32();
 			}
+			data.m_warCountriesID = GetListOfVector( warCountriesID );
 		}
-		m_countryData.push_back( data );
+		m_countryData.PushBack( data );
 	}
-
-	// army
-	totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryArmyData data;
-		data.m_size = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_globalID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_combatValue = *(float*)(bin.data() + readPtr);
-		readPtr += sizeof( float );
-		data.m_ownerID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_provInID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_targetProvID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		m_armyData.push_back( data );
+	m_armyData.resize( reader.ParseInt32() );
+	for (auto& armyHistory : m_armyData) {
+		armyHistory.m_size = reader.ParseInt32();
+		armyHistory.m_globalID = reader.ParseInt32();
+		armyHistory.m_combatValue = reader.ParseFloat();
+		armyHistory.m_ownerID = reader.ParseInt32();
+		armyHistory.m_provInID = reader.ParseInt32();
+		armyHistory.m_targetProvID = reader.ParseInt32();
 	}
-
-
-	totalArraySize = *(int*)(bin.data() + readPtr);
-	readPtr += sizeof( int );
-	for (int i = 0; i < totalArraySize; ++i) {
-		HistoryCrisisData data;
-		data.m_countryID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_globalID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_cultureOrReligionID = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		data.m_progress = *(float*)(bin.data() + readPtr);
-		readPtr += sizeof( float );
-		data.m_type = *(int*)(bin.data() + readPtr);
-		readPtr += sizeof( int );
-		m_crisisData.push_back( data );
+	m_crisisData.resize( reader.ParseInt32() );
+	for (auto& crisisHistory : m_crisisData) {
+		crisisHistory.m_countryID = reader.ParseInt32();
+		crisisHistory.m_globalID = reader.ParseUint32();
+		crisisHistory.m_cultureOrReligionID = reader.ParseInt32();
+		crisisHistory.m_progress = reader.ParseFloat();
+		crisisHistory.m_type = reader.ParseInt32();
 	}
 }
 
@@ -984,8 +1104,8 @@ void SaveSingleMonthHistoryJob::Execute()
 				if (countryFwd.m_friendlyCountriesID != countryPrev.m_friendlyCountriesID) {
 					std::vector<int> loseRelationCountries;
 					std::vector<int> gainRelationCountries;
-					std::vector<int> prevCountryID = countryPrev.m_friendlyCountriesID;
-					std::vector<int> fwdCountryID = countryFwd.m_friendlyCountriesID;
+					std::vector<int> prevCountryID( countryPrev.m_friendlyCountriesID.begin(), countryPrev.m_friendlyCountriesID.end() );
+					std::vector<int> fwdCountryID( countryFwd.m_friendlyCountriesID.begin(), countryFwd.m_friendlyCountriesID.end() );
 					GetCountryRelationDifference( loseRelationCountries, gainRelationCountries, prevCountryID, fwdCountryID );
 					for (auto id : loseRelationCountries) {
 						XmlElement* countryRelation = history.NewElement( "LoseRelation" );
@@ -1005,8 +1125,8 @@ void SaveSingleMonthHistoryJob::Execute()
 				if (countryFwd.m_allianceCountriesID != countryPrev.m_allianceCountriesID) {
 					std::vector<int> loseRelationCountries;
 					std::vector<int> gainRelationCountries;
-					std::vector<int> prevCountryID = countryPrev.m_allianceCountriesID;
-					std::vector<int> fwdCountryID = countryFwd.m_allianceCountriesID;
+					std::vector<int> prevCountryID( countryPrev.m_allianceCountriesID.begin(), countryPrev.m_allianceCountriesID.end() );
+					std::vector<int> fwdCountryID( countryFwd.m_allianceCountriesID.begin(), countryFwd.m_allianceCountriesID.end() );
 					GetCountryRelationDifference( loseRelationCountries, gainRelationCountries, prevCountryID, fwdCountryID );
 					for (auto id : loseRelationCountries) {
 						XmlElement* countryRelation = history.NewElement( "LoseRelation" );
@@ -1026,8 +1146,8 @@ void SaveSingleMonthHistoryJob::Execute()
 				if (countryFwd.m_hostileCountriesID != countryPrev.m_hostileCountriesID) {
 					std::vector<int> loseRelationCountries;
 					std::vector<int> gainRelationCountries;
-					std::vector<int> prevCountryID = countryPrev.m_hostileCountriesID;
-					std::vector<int> fwdCountryID = countryFwd.m_hostileCountriesID;
+					std::vector<int> prevCountryID( countryPrev.m_hostileCountriesID.begin(), countryPrev.m_hostileCountriesID.end() );
+					std::vector<int> fwdCountryID( countryFwd.m_hostileCountriesID.begin(), countryFwd.m_hostileCountriesID.end() );
 					GetCountryRelationDifference( loseRelationCountries, gainRelationCountries, prevCountryID, fwdCountryID );
 					for (auto id : loseRelationCountries) {
 						XmlElement* countryRelation = history.NewElement( "LoseRelation" );
@@ -1103,8 +1223,8 @@ void SaveSingleMonthHistoryJob::Execute()
 				if (countryFwd.m_vassalCountriesID != countryPrev.m_vassalCountriesID) {
 					std::vector<int> loseRelationCountries;
 					std::vector<int> gainRelationCountries;
-					std::vector<int> prevCountryID = countryPrev.m_vassalCountriesID;
-					std::vector<int> fwdCountryID = countryFwd.m_vassalCountriesID;
+					std::vector<int> prevCountryID( countryPrev.m_vassalCountriesID.begin(), countryPrev.m_vassalCountriesID.end() );
+					std::vector<int> fwdCountryID( countryFwd.m_vassalCountriesID.begin(), countryFwd.m_vassalCountriesID.end() );
 					GetCountryRelationDifference( loseRelationCountries, gainRelationCountries, prevCountryID, fwdCountryID );
 					for (auto id : loseRelationCountries) {
 						XmlElement* countryRelation = history.NewElement( "LoseRelation" );
@@ -1149,8 +1269,8 @@ void SaveSingleMonthHistoryJob::Execute()
 				if (countryFwd.m_tributaryCountriesID != countryPrev.m_tributaryCountriesID) {
 					std::vector<int> loseRelationCountries;
 					std::vector<int> gainRelationCountries;
-					std::vector<int> prevCountryID = countryPrev.m_tributaryCountriesID;
-					std::vector<int> fwdCountryID = countryFwd.m_tributaryCountriesID;
+					std::vector<int> prevCountryID( countryPrev.m_tributaryCountriesID.begin(), countryPrev.m_tributaryCountriesID.end() );
+					std::vector<int> fwdCountryID( countryFwd.m_tributaryCountriesID.begin(), countryFwd.m_tributaryCountriesID.end() );
 					GetCountryRelationDifference( loseRelationCountries, gainRelationCountries, prevCountryID, fwdCountryID );
 					for (auto id : loseRelationCountries) {
 						XmlElement* countryRelation = history.NewElement( "LoseRelation" );
@@ -1369,7 +1489,7 @@ HistorySavingSolver::HistorySavingSolver( Map* map )
 
 }
 
-void HistorySavingSolver::StartSave()
+void HistorySavingSolver::StartSave( Job* continuation )
 {
 	m_isSaving = true;
 	while (m_savingFlag.size() < m_map->GetTotalMonthCount()) {
@@ -1381,10 +1501,15 @@ void HistorySavingSolver::StartSave()
 			m_map->GetYearAndMonthFromTotalMonth( year, month, i );
 			SaveSingleMonthHistoryJob* job = new SaveSingleMonthHistoryJob( this, year, month );
 			//job->m_type = Loading_Job;
-			g_theJobSystem->AddJob( job );
+			// the continuation runs when every month is written, no one needs to retrieve the month jobs
+			job->m_needsRetrieving = false;
+			job->AddChild( continuation );
 			m_jobList.push_back( job );
 		}
 	}
+	for (Job* job : m_jobList) {
+		g_theJobSystem->AddJob( job );
+	}
 }
 
 bool HistorySavingSolver::IsSaving() const
@@ -1407,16 +1532,204 @@ void HistorySavingSolver::GetSavingProgress( int& curHistory, int& totalHistory
 
 void HistorySavingSolver::Update()
 {
-	for (;;) {
-		if (!m_jobList.empty()) {
-			if (g_theJobSystem->RetrieveJob( m_jobList[0] )) {
-				delete m_jobList[0];
-				m_jobList.pop_front();
+	// called by the continuation of all month jobs, they are all completed here
+	for (Job* job : m_jobList) {
+		delete job;
+	}
+	m_jobList.clear();
+	m_isSaving = false;
+}
+
+//-----------------------------------------------------------------------------------------------
+// the file starts with a magic and a version, then every month is a record header followed by its deflated bytes
+// record header: month index, raw size, compressed size, keyframe flag
+static char const HISTORY_TIMELINE_MAGIC[8] = { 'P', 'C', 'G', 'H', 'I', 'S', 'T', 'L' };
+constexpr unsigned int HISTORY_TIMELINE_VERSION = 2;
+constexpr size_t HISTORY_TIMELINE_RECORD_HEADER_SIZE = 13;
+
+bool HistoryTimeline::Open( std::string const& filePath )
+{
+	m_mutex.lock();
+	m_records.clear();
+	bool succeeded = m_file.Open( filePath, true );
+	if (succeeded) {
+		std::vector<uint8_t> header;
+		BufferWriter writer( header );
+		for (char magicChar : HISTORY_TIMELINE_MAGIC) {
+			writer.AppendChar( magicChar );
+		}
+		writer.AppendUint32( HISTORY_TIMELINE_VERSION );
+		succeeded = m_file.Append( header.data(), header.size() ) >= 0;
+	}
+	m_mutex.unlock();
+	return succeeded;
+}
+
+void HistoryTimeline::AppendMonth( HistoryData const& data, HistoryData const* prevMonth )
+{
+	// only the main thread appends, so the buffers are shared between appends and only the file write is locked
+	int monthIndex = GetNumOfMonths();
+	bool isKeyframe = prevMonth == nullptr || monthIndex % HISTORY_KEYFRAME_INTERVAL == 0;
+	if (isKeyframe) {
+		data.DumpToBinaryFormat( m_rawBuffer );
+	}
+	else {
+		data.DumpDeltaToBinaryFormat( *prevMonth, m_rawBuffer );
+	}
+
+	mz_ulong compressedSize = mz_compressBound( (mz_ulong)m_rawBuffer.size() );
+	m_compressedBuffer.resize( HISTORY_TIMELINE_RECORD_HEADER_SIZE + compressedSize );
+	int result = mz_compress2( m_compressedBuffer.data() + HISTORY_TIMELINE_RECORD_HEADER_SIZE, &compressedSize, m_rawBuffer.data(), (mz_ulong)m_rawBuffer.size(), MZ_DEFAULT_LEVEL );
+	GUARANTEE_OR_DIE( result == MZ_OK, "Cannot compress a history month!" );
+	m_compressedBuffer.resize( HISTORY_TIMELINE_RECORD_HEADER_SIZE + compressedSize );
+	uint32_t rawSize = (uint32_t)m_rawBuffer.size();
+	uint32_t compressedSize32 = (uint32_t)compressedSize;
+	memcpy( m_compressedBuffer.data(), &monthIndex, sizeof( int ) );
+	memcpy( m_compressedBuffer.data() + 4, &rawSize, sizeof( uint32_t ) );
+	memcpy( m_compressedBuffer.data() + 8, &compressedSize32, sizeof( uint32_t ) );
+	m_compressedBuffer[12] = isKeyframe ? 1 : 0;
+
+	m_mutex.lock();
+	int64_t offset = m_file.Append( m_compressedBuffer.data(), m_compressedBuffer.size() );
+	if (offset >= 0) {
+		HistoryTimelineRecord record;
+		record.m_offset = (uint64_t)offset + HISTORY_TIMELINE_RECORD_HEADER_SIZE;
+		record.m_compressedSize = compressedSize32;
+		record.m_rawSize = rawSize;
+		record.m_keyframeIndex = isKeyframe ? monthIndex : m_records.back().m_keyframeIndex;
+		m_records.push_back( record );
+	}
+	m_mutex.unlock();
+	GUARANTEE_OR_DIE( offset >= 0, "Cannot write a history month to the timeline file!" );
+}
+
+bool HistoryTimeline::DecodeMonth( int monthIndex, HistoryData& out_data, HistoryData const* prevMonth )
+{
+	if (prevMonth) {
+		std::vector<uint8_t> raw;
+		bool isKeyframe = false;
+		if (!ReadRawRecord( monthIndex, raw, isKeyframe )) {
+			return false;
+		}
+		// both loads overwrite every column, so out_data keeps the memory it already has
+		if (isKeyframe) {
+			out_data.LoadFromBinaryFormat( raw );
+		}
+		else {
+			out_data.LoadDeltaFromBinaryFormat( *prevMonth, raw );
+		}
+		return true;
+	}
+	int keyframeIndex = GetKeyframeIndex( monthIndex );
+	if (keyframeIndex < 0) {
+		return false;
+	}
+	// every step is loaded into out_data or one scratch month, starting so that the asked month lands in out_data;
+	// loads keep the columns' memory, so a pooled out_data does not allocate again
+	HistoryData scratchData;
+	HistoryData* stepData[2] = { &out_data, &scratchData };
+	std::vector<uint8_t> raw;
+	for (int index = keyframeIndex; index <= monthIndex; ++index) {
+		bool isKeyframe = false;
+		if (!ReadRawRecord( index, raw, isKeyframe )) {
+			return false;
+		}
+		HistoryData* data = stepData[(monthIndex - index) & 1];
+		if (isKeyframe || index == keyframeIndex) {
+			data->LoadFromBinaryFormat( raw );
+		}
+		else {
+			data->LoadDeltaFromBinaryFormat( *stepData[(monthIndex - index + 1) & 1], raw );
+		}
+	}
+	return true;
+}
+
+bool HistoryTimeline::DecodeMonths( int firstMonthIndex, int lastMonthIndex, std::vector<HistoryData*>& out_months )
+{
+	int monthIndex = GetKeyframeIndex( firstMonthIndex );
+	if (monthIndex < 0 || lastMonthIndex < firstMonthIndex || lastMonthIndex >= GetNumOfMonths()) {
+		return false;
+	}
+	std::vector<uint8_t> raw;
+	HistoryData* prevMonth = nullptr;
+	for (; monthIndex <= lastMonthIndex; ++monthIndex) {
+		bool isKeyframe = false;
+		if (!ReadRawRecord( monthIndex, raw, isKeyframe )) {
+			// months already in out_months are still good
+			if (prevMonth && monthIndex - 1 < firstMonthIndex) {
+				delete prevMonth;
 			}
+			return false;
+		}
+		HistoryData* month = new HistoryData();
+		if (isKeyframe || prevMonth == nullptr) {
+			month->LoadFromBinaryFormat( raw );
 		}
 		else {
-			break;
+			month->LoadDeltaFromBinaryFormat( *prevMonth, raw );
+		}
+		// months before the first asked one are only steps on the way
+		if (prevMonth && monthIndex - 1 < firstMonthIndex) {
+			delete prevMonth;
+		}
+		if (monthIndex >= firstMonthIndex) {
+			out_months.push_back( month );
 		}
+		prevMonth = month;
 	}
-	m_isSaving = false;
+	return true;
+}
+
+int HistoryTimeline::GetNumOfMonths() const
+{
+	m_mutex.lock();
+	int numOfMonths = (int)m_records.size();
+	m_mutex.unlock();
+	return numOfMonths;
+}
+
+int HistoryTimeline::GetKeyframeIndex( int monthIndex ) const
+{
+	int keyframeIndex = -1;
+	m_mutex.lock();
+	if (monthIndex >= 0 && monthIndex < (int)m_records.size()) {
+		keyframeIndex = m_records[monthIndex].m_keyframeIndex;
+	}
+	m_mutex.unlock();
+	return keyframeIndex;
+}
+
+uint64_t HistoryTimeline::GetFileSize() const
+{
+	m_mutex.lock();
+	uint64_t fileSize = m_file.GetSize();
+	m_mutex.unlock();
+	return fileSize;
+}
+
+bool HistoryTimeline::ReadRawRecord( int monthIndex, std::vector<uint8_t>& out_raw, bool& out_isKeyframe )
+{
+	// copy the compressed bytes out under the lock, an append may remap the view as soon as it is released
+	std::vector<uint8_t> compressed;
+	HistoryTimelineRecord record;
+	m_mutex.lock();
+	bool isInFile = monthIndex >= 0 && monthIndex < (int)m_records.size();
+	if (isInFile) {
+		record = m_records[monthIndex];
+		uint8_t const* bytes = m_file.GetReadPointer( record.m_offset, record.m_compressedSize );
+		isInFile = bytes != nullptr;
+		if (isInFile) {
+			compressed.assign( bytes, bytes + record.m_compressedSize );
+		}
+	}
+	m_mutex.unlock();
+	if (!isInFile) {
+		return false;
+	}
+	out_isKeyframe = record.m_keyframeIndex == monthIndex;
+	out_raw.resize( record.m_rawSize );
+	mz_ulong rawSize = record.m_rawSize;
+	int result = mz_uncompress( out_raw.data(), &rawSize, compressed.data(), record.m_compressedSize );
+	return result == MZ_OK && rawSize == record.m_rawSize;
 }
@@ -1,14 +1,45 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Engine/Core/AppendOnlyMappedFile.hpp"
+#include <algorithm>
 class Map;
 
+// where the list of one entry starts in a pool of its table and how long it is
+struct HistorySpan {
+	int m_offset = 0;
+	int m_count = 0;
+};
+
+// read-only list inside a pool of a history table, only valid while the HistoryData it came from is alive and unchanged
+// compares by contents like the vectors it replaces
+template<typename T>
+struct HistoryList {
+	HistoryList() {};
+	HistoryList( T const* data, int count ) :m_data( data ), m_count( count ) {};
+	int size() const { return m_count; }
+	bool empty() const { return m_count == 0; }
+	T const* begin() const { return m_data; }
+	T const* end() const { return m_data + m_count; }
+	T const& operator[]( int index ) const { return m_data[index]; }
+	bool operator==( HistoryList const& other ) const { return m_count == other.m_count && std::equal( begin(), end(), other.begin() ); }
+	bool operator!=( HistoryList const& other ) const { return !(*this == other); }
+
+	T const* m_data = nullptr;
+	int m_count = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// A month is stored as tables of columns, one element per province / city / town / country
+// Variable length lists live in pools owned by the table and every entry keeps a span into them,
+// so a snapshot is a few dozen vectors however many provinces there are, and keeps its capacity when it is recorded again
+// operator[] puts one row back together as a value with the old field names, lists point into the pools
 struct HistoryProvinceData {
 	bool m_isWater = false;
 	int m_population = 0;
-	std::vector<std::pair<int, float>> m_cultures;
-	std::vector<std::pair<int, float>> m_religions;
+	HistoryList<std::pair<int, float>> m_cultures;
+	HistoryList<std::pair<int, float>> m_religions;
 	int m_ownerCountryID = -1;
-	std::vector<int> m_legalCountriesID;
+	HistoryList<int> m_legalCountriesID;
 };
 
 struct HistoryCountryData {
@@ -18,14 +49,14 @@ struct HistoryCountryData {
 	int m_capitalProvID = -1;
 	int m_countryReligionID = -1;
 	int m_capitalCityID = -1;
-	std::vector<int> m_friendlyCountriesID;
-	std::vector<int> m_allianceCountriesID;
-	std::vector<int> m_hostileCountriesID;
-	std::vector<std::pair<int, int>> m_warCountriesID;
+	HistoryList<int> m_friendlyCountriesID;
+	HistoryList<int> m_allianceCountriesID;
+	HistoryList<int> m_hostileCountriesID;
+	HistoryList<std::pair<int, int>> m_warCountriesID;
 	int m_suzerainCountryID = -1;
-	std::vector<int> m_vassalCountriesID;
+	HistoryList<int> m_vassalCountriesID;
 	int m_celestialCountryID = -1;
-	std::vector<int> m_tributaryCountriesID;
+	HistoryList<int> m_tributaryCountriesID;
 	bool m_isCelestial = false;
 	int m_governmentType = (int)CountryGovernmentType::None;
 };
@@ -43,8 +74,8 @@ struct HistoryArmyData {
 
 struct HistoryTownData {
 	int m_population = 0;
-	std::vector<std::pair<int, float>> m_cultures;
-	std::vector<std::pair<int, float>> m_religions;
+	HistoryList<std::pair<int, float>> m_cultures;
+	HistoryList<std::pair<int, float>> m_religions;
 	int m_ownerID = -1;
 	float m_defenseValue = 0.f;
 };
@@ -61,26 +92,138 @@ struct HistoryCrisisData {
 	unsigned int m_globalID = (unsigned int)-1;
 };
 
+struct HistoryProvinceTable {
+	int size() const { return (int)m_isWater.size(); }
+	HistoryProvinceData operator[]( int index ) const;
+	/// Append a row, its lists are copied into the pools so they must not point into this table
+	void PushBack( HistoryProvinceData const& data );
+	/// Empty every column and pool but keep their memory
+	void Clear();
+
+	std::vector<uint8_t> m_isWater;
+	std::vector<int> m_population;
+	std::vector<int> m_ownerCountryID;
+	std::vector<HistorySpan> m_cultures; // into m_proportionPool
+	std::vector<HistorySpan> m_religions; // into m_proportionPool
+	std::vector<HistorySpan> m_legalCountriesID; // into m_idPool
+	std::vector<std::pair<int, float>> m_proportionPool;
+	std::vector<int> m_idPool;
+};
+
+struct HistoryTownTable {
+	int size() const { return (int)m_population.size(); }
+	HistoryTownData operator[]( int index ) const;
+	void PushBack( HistoryTownData const& data );
+	void Clear();
+
+	std::vector<int> m_population;
+	std::vector<int> m_ownerID;
+	std::vector<float> m_defenseValue;
+	std::vector<HistorySpan> m_cultures; // into m_proportionPool
+	std::vector<HistorySpan> m_religions; // into m_proportionPool
+	std::vector<std::pair<int, float>> m_proportionPool;
+};
+
+struct HistoryCityTable : public HistoryTownTable {
+	HistoryCityData operator[]( int index ) const;
+	void PushBack( HistoryCityData const& data );
+	void Clear();
+
+	std::vector<uint16_t> m_type;
+};
+
+struct HistoryCountryTable {
+	int size() const { return (int)m_exist.size(); }
+	HistoryCountryData operator[]( int index ) const;
+	void PushBack( HistoryCountryData const& data );
+	void Clear();
+
+	std::vector<uint8_t> m_exist;
+	std::vector<int> m_funds;
+	std::vector<int> m_countryCultureID;
+	std::vector<int> m_capitalProvID;
+	std::vector<int> m_countryReligionID;
+	std::vector<int> m_capitalCityID;
+	std::vector<int> m_suzerainCountryID;
+	std::vector<int> m_celestialCountryID;
+	std::vector<uint8_t> m_isCelestial;
+	std::vector<int> m_governmentType;
+	std::vector<HistorySpan> m_friendlyCountriesID; // into m_idPool
+	std::vector<HistorySpan> m_allianceCountriesID; // into m_idPool
+	std::vector<HistorySpan> m_hostileCountriesID; // into m_idPool
+	std::vector<HistorySpan> m_vassalCountriesID; // into m_idPool
+	std::vector<HistorySpan> m_tributaryCountriesID; // into m_idPool
+	std::vector<HistorySpan> m_warCountriesID; // into m_warPool
+	std::vector<int> m_idPool;
+	std::vector<std::pair<int, int>> m_warPool;
+};
+
 struct HistoryData {
 	HistoryData() {};
 	HistoryData( Map* map );
-	std::vector<HistoryProvinceData> m_provinceData;
-	std::vector<HistoryCountryData> m_countryData;
+	/// Take a snapshot of the map, reusing the memory of whatever this held before
+	void Record( Map* map );
+	void Clear();
+
+	HistoryProvinceTable m_provinceData;
+	HistoryCountryTable m_countryData;
 	std::vector<HistoryArmyData> m_armyData;
-	std::vector<HistoryCityData> m_cityData;
-	std::vector<HistoryTownData> m_townData;
+	HistoryCityTable m_cityData;
+	HistoryTownTable m_townData;
 	std::vector<HistoryCrisisData> m_crisisData;
 
 	void PrintOutHistory( XmlDocument* document,  XmlElement* rootElem, HistoryData* provMonth ) const;
+	/// Every column goes in as one block: its length then its bytes
 	void DumpToBinaryFormat( std::vector<uint8_t>& bin ) const;
 	void LoadFromBinaryFormat( std::vector<uint8_t> const& bin );
+	/// Write only what changed since prevMonth, LoadDeltaFromBinaryFormat with the same prevMonth gives this month back
+	/// prevMonth has to be another HistoryData, this one is cleared before it is read
+	void DumpDeltaToBinaryFormat( HistoryData const& prevMonth, std::vector<uint8_t>& bin ) const;
+	void LoadDeltaFromBinaryFormat( HistoryData const& prevMonth, std::vector<uint8_t> const& bin );
+};
+
+//-----------------------------------------------------------------------------------------------
+// Every recorded month in one append-only file that is read back through a memory mapping
+// A month is stored as a keyframe (the full snapshot) or as a delta against the month before it, both deflated
+// The index of the records stays in memory, so the file is only readable by the map that wrote it
+constexpr int HISTORY_KEYFRAME_INTERVAL = 12;
+
+struct HistoryTimelineRecord {
+	uint64_t m_offset = 0; // where the compressed bytes start
+	uint32_t m_compressedSize = 0;
+	uint32_t m_rawSize = 0;
+	int m_keyframeIndex = 0; // the month decoding starts from, itself for keyframes
+};
+
+class HistoryTimeline {
+public:
+	bool Open( std::string const& filePath );
+	/// Append the next month, prevMonth is the month appended before it and nullptr forces a keyframe
+	void AppendMonth( HistoryData const& data, HistoryData const* prevMonth );
+	/// Decode one month, from prevMonth when it is the month before a delta, otherwise from the keyframe
+	/// Safe to call from jobs while the main thread appends
+	bool DecodeMonth( int monthIndex, HistoryData& out_data, HistoryData const* prevMonth = nullptr );
+	/// Decode every month in [firstMonthIndex, lastMonthIndex] in one walk from the keyframe of the first one
+	bool DecodeMonths( int firstMonthIndex, int lastMonthIndex, std::vector<HistoryData*>& out_months );
+	int GetNumOfMonths() const;
+	int GetKeyframeIndex( int monthIndex ) const;
+	uint64_t GetFileSize() const;
+
+protected:
+	bool ReadRawRecord( int monthIndex, std::vector<uint8_t>& out_raw, bool& out_isKeyframe );
+
+	mutable std::mutex m_mutex;
+	AppendOnlyMappedFile m_file;
+	std::vector<HistoryTimelineRecord> m_records;
+	std::vector<uint8_t> m_rawBuffer;
+	std::vector<uint8_t> m_compressedBuffer;
 };
 
 
 class HistorySavingSolver {
 public:
 	HistorySavingSolver( Map* map );
-	void StartSave();
+	void StartSave( Job* continuation );
 	bool IsSaving() const;
 	void GetSavingProgress( int& curHistory, int& totalHistory );
 	void Update();
@@ -1,6 +1,6 @@
 #include "Game/Map.hpp"
 #include "Game/Game.hpp"
-#include "Game/VoronoiHelper.hpp"
+#include "Engine/Math/VoronoiDiagram.hpp"
 #include "Game/MapPolygonUnit.hpp"
 #include "Game/River.hpp"
 #include "Game/Culture.hpp"
@@ -16,7 +16,9 @@
 #include "Game/Army.hpp"
 #include "Game/CountryInstructions.hpp"
 #include "Game/Battle.hpp"
+#include "Engine/Core/ParallelFor.hpp"
 #include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <chrono>
 #include <iostream>
@@ -33,7 +35,6 @@ public:
 
 void SaveHistoryJob::Execute()
 {
-	m_solver->StartSave();
 	m_solver->Update();
 }
 
@@ -106,30 +107,50 @@ void FindCountryForProvinceJob::Execute()
 	}
 }
 
-class LoadHistoryFromDiskJob : public Job {
+// decodes the months of one keyframe span that are missing from the cache
+// the main thread moves them into the cache when it retrieves the job, the job never touches the map
+class PrefetchHistoryJob : public Job {
 public:
-	LoadHistoryFromDiskJob( std::string const& path, int year, int month, Map* map )
-		: m_path( path )
-		, m_year( year )
-		, m_month( month )
-		, m_map( map ) {
+	PrefetchHistoryJob( HistoryTimeline* timeline, int firstMonthIndex, int lastMonthIndex )
+		: m_timeline( timeline )
+		, m_firstMonthIndex( firstMonthIndex )
+		, m_lastMonthIndex( lastMonthIndex ) {
 		m_type = Loading_Job;
 	};
-	virtual ~LoadHistoryFromDiskJob() {};
+	virtual ~PrefetchHistoryJob();
 	virtual void Execute() override;
-	std::string m_path;
-	int m_year = 0;
-	int m_month = 0;
-	Map* m_map = nullptr;
+	HistoryTimeline* m_timeline = nullptr;
+	int m_firstMonthIndex = 0;
+	int m_lastMonthIndex = 0;
+	std::vector<HistoryData*> m_months; // month m_firstMonthIndex + i, nullptr once the map takes it
 };
 
-void LoadHistoryFromDiskJob::Execute()
+PrefetchHistoryJob::~PrefetchHistoryJob()
 {
-	HistoryData* data = new HistoryData();
-	m_map->LoadHistoryCacheFromDisk( *data, m_year, m_month );
-	m_map->m_saveLoadMutex.lock();
-	m_map->m_historyData[m_year * 12 + m_month - 1] = data;
-	m_map->m_saveLoadMutex.unlock();
+	for (auto month : m_months) {
+		delete month;
+	}
+}
+
+void PrefetchHistoryJob::Execute()
+{
+	m_timeline->DecodeMonths( m_firstMonthIndex, m_lastMonthIndex, m_months );
+}
+
+void MapGenerationSettings::PopulateFromXmlElementAttributes( XmlElement const& element )
+{
+	m_seed = ParseXmlAttribute( element, "Seed", m_seed );
+	m_basePolygons = ParseXmlAttribute( element, "PolygonAmount", m_basePolygons );
+	m_dimensions.x = ParseXmlAttribute( element, "DimensionsX", m_dimensions.x );
+	m_dimensions.y = ParseXmlAttribute( element, "DimensionsY", m_dimensions.y );
+	m_minHeight = ParseXmlAttribute( element, "MinHeight", m_minHeight );
+	m_maxHeight = ParseXmlAttribute( element, "MaxHeight", m_maxHeight );
+	m_fragmentFactor = ParseXmlAttribute( element, "FragmentFactor", m_fragmentFactor );
+	m_landRichnessFactor = ParseXmlAttribute( element, "OceanFactor", m_landRichnessFactor );
+	m_numOfCultures = ParseXmlAttribute( element, "NumOfCultures", m_numOfCultures );
+	m_numOfReligions = ParseXmlAttribute( element, "NumOfReligions", m_numOfReligions );
+	m_onlyUseWesternCountryPrefix = ParseXmlAttribute( element, "UseWesternEuropeanCountryNames", m_onlyUseWesternCountryPrefix );
+	m_relaxIterations = ParseXmlAttribute( element, "RelaxIterations", m_relaxIterations );
 }
 
 Map::Map( MapGenerationSettings const& settings )
@@ -208,9 +229,23 @@ Map::~Map()
 	for (int i = 0; i < (int)m_continentLabels.size(); i++) {
 		delete m_continentLabels[i];
 	}
+	for (auto job : m_historyPrefetchJobs) {
+		// a queued job is taken out of the queue, a running one has to finish before it can be deleted
+		g_theJobSystem->CancelJob( job );
+		if (job->m_status != JobStatus::NoRecord) {
+			while (!g_theJobSystem->RetrieveJob( job )) {
+				std::this_thread::yield();
+			}
+		}
+		delete job;
+	}
 	for (auto historyData : m_historyData) {
 		delete historyData;
 	}
+	for (auto historyData : m_historyDataPool) {
+		delete historyData;
+	}
+	delete m_historyTimeline;
 
 	delete m_polygonuv3DVertexBuffer;
 	delete m_mapBorderVertexBuffer;
@@ -252,18 +287,21 @@ void Map::Startup()
 	PopulateMapWithPolygons( m_generationSettings.m_basePolygons );
 	double endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Populating Map finished, time: %.3fs", endTime - startTime ) );
+	m_generationStageSeconds.emplace_back( "Populating Map", endTime - startTime );
 
 	PCGWorld_Log( "Calculating Polygon Data..." );
 	startTime = GetCurrentTimeSeconds();
 	CalculateBiomeDataForPolygons();
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Calculating Polygon Data finished, time: %.3fs", endTime - startTime ) );
+	m_generationStageSeconds.emplace_back( "Calculating Polygon Data", endTime - startTime );
 
 	PCGWorld_Log( "Generating Rivers..." );
 	startTime = GetCurrentTimeSeconds();
 	GenerateRivers();
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Generating Rivers finished, time: %.3fs", endTime - startTime ) );
+	m_generationStageSeconds.emplace_back( "Generating Rivers", endTime - startTime );
 
 	/*PCGWorld_Log("Generating Forests...");
 	startTime = GetCurrentTimeSeconds();
@@ -276,23 +314,30 @@ void Map::Startup()
 	GenerateContinents();
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Generating Continents finished, time: %.3fs", endTime - startTime ) );
+	m_generationStageSeconds.emplace_back( "Generating Continents", endTime - startTime );
 
 	PCGWorld_Log( "Generating Humans..." );
 	startTime = GetCurrentTimeSeconds();
 	GenerateHumanDataForPolygons();
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Generating Humans finished, time: %.3fs", endTime - startTime ) );
+	m_generationStageSeconds.emplace_back( "Generating Humans", endTime - startTime );
 
-	PCGWorld_Log( "Creating Vertex Buffers..." );
-	startTime = GetCurrentTimeSeconds();
-	GenerateVertexBuffers();
-	InitializeLabels();
-	endTime = GetCurrentTimeSeconds();
-	PCGWorld_Log( Stringf( "Creating Vertex Buffers finished, time: %.3fs", endTime - startTime ) );
+	if (!m_generationSettings.m_isHeadless) {
+		PCGWorld_Log( "Creating Vertex Buffers..." );
+		startTime = GetCurrentTimeSeconds();
+		GenerateVertexBuffers();
+		InitializeLabels();
+		endTime = GetCurrentTimeSeconds();
+		PCGWorld_Log( Stringf( "Creating Vertex Buffers finished, time: %.3fs", endTime - startTime ) );
+		m_generationStageSeconds.emplace_back( "Creating Vertex Buffers", endTime - startTime );
 
-	SetRenderCountryMapMode();
+		RefreshProvinceModeColors( true );
+		SetRenderCountryMapMode();
+	}
 	double allEndTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "All generation finished, time: %.3fs", allEndTime - allStartTime ) );
+	m_generationStageSeconds.emplace_back( "All generation", allEndTime - allStartTime );
 
 	for (auto country : m_countries) {
 		country->CalculateEconomicValue();
@@ -324,6 +369,8 @@ void Map::Update()
 	UpdateAutoSimulation();
 
 	UpdateSaveStatus();
+
+	RetrieveHistoryPrefetchJobs();
 }
 
 void Map::Render() const
@@ -361,9 +408,7 @@ void Map::SetRenderHeightMapMode( bool setRender )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_HEIGHT_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_HEIGHT_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderHeightColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Height );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -380,9 +425,7 @@ void Map::SetRenderClimateMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_CLIMATE_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_CLIMATE_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderClimateColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Climate );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -400,9 +443,7 @@ void Map::SetRenderPrecipitationMapMode( bool setRender /*= true */, bool summer
 	if (summer) {
 		if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_SUMMER_PRECIPITATION_MAP)) {
 			m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_SUMMER_PRECIPITATION_MAP;
-			for (auto unit : m_mapPolygonUnits) {
-				unit->SetRenderPrecipitationColor( summer );
-			}
+			SetAllPolygonsRenderColor( ProvinceColorMode::SummerPrecipitation );
 			if (m_curViewingUnit) {
 				m_curViewingUnit->SetRenderViewingColor( true );
 			}
@@ -417,9 +458,7 @@ void Map::SetRenderPrecipitationMapMode( bool setRender /*= true */, bool summer
 	else {
 		if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_WINTER_PRECIPITATION_MAP)) {
 			m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_WINTER_PRECIPITATION_MAP;
-			for (auto unit : m_mapPolygonUnits) {
-				unit->SetRenderPrecipitationColor( summer );
-			}
+			SetAllPolygonsRenderColor( ProvinceColorMode::WinterPrecipitation );
 			if (m_curViewingUnit) {
 				m_curViewingUnit->SetRenderViewingColor( true );
 			}
@@ -438,9 +477,7 @@ void Map::SetRenderTemperatureMapMode( bool setRender /*= true*/, bool summer /*
 	if (summer) {
 		if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_SUMMER_TEMPERATURE_MAP)) {
 			m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_SUMMER_TEMPERATURE_MAP;
-			for (auto unit : m_mapPolygonUnits) {
-				unit->SetRenderTemperatureColor( summer );
-			}
+			SetAllPolygonsRenderColor( ProvinceColorMode::SummerTemperature );
 			if (m_curViewingUnit) {
 				m_curViewingUnit->SetRenderViewingColor( true );
 			}
@@ -455,9 +492,7 @@ void Map::SetRenderTemperatureMapMode( bool setRender /*= true*/, bool summer /*
 	else {
 		if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_WINTER_TEMPERATURE_MAP)) {
 			m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_WINTER_TEMPERATURE_MAP;
-			for (auto unit : m_mapPolygonUnits) {
-				unit->SetRenderTemperatureColor( summer );
-			}
+			SetAllPolygonsRenderColor( ProvinceColorMode::WinterTemperature );
 			if (m_curViewingUnit) {
 				m_curViewingUnit->SetRenderViewingColor( true );
 			}
@@ -475,9 +510,7 @@ void Map::SetRenderLandformMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_LANDFORM_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_LANDFORM_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderLandformColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Landform );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -494,9 +527,7 @@ void Map::SetRenderPopulationMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_POPULATION_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_POPULATION_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderPopulationColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Population );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -513,9 +544,7 @@ void Map::SetRenderCultureMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_CULTURE_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_CULTURE_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderCultureColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Culture );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -532,9 +561,7 @@ void Map::SetRenderReligionMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_RELIGION_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_RELIGION_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderReligionColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Religion );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -551,9 +578,7 @@ void Map::SetRenderContinentMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_CONTINENT_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_CONTINENT_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderContinentColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Continent );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -570,9 +595,7 @@ void Map::SetRenderProductMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_PRODUCT_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_PRODUCT_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderProductColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Product );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -589,9 +612,7 @@ void Map::SetRenderCountryMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_COUNTRIES_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_COUNTRIES_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderCountryColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Country );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -608,9 +629,7 @@ void Map::SetRenderRegionMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_REGIONS_MAP)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_REGIONS_MAP;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderRegionColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Region );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -646,9 +665,7 @@ void Map::SetRenderProvEditMapMode( bool setRender /*= true */ )
 {
 	if (setRender && !(m_showingSettings.m_mapShowConfig & SHOW_CONFIG_PROVINCE_EDIT)) {
 		m_showingSettings.m_mapShowConfig = (m_showingSettings.m_mapShowConfig & ~SHOW_CONFIG_COLORFUL_MAP) | SHOW_CONFIG_PROVINCE_EDIT;
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderProvEditColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Country );
 		if (m_curViewingUnit) {
 			m_curViewingUnit->SetRenderViewingColor( true );
 		}
@@ -709,8 +726,14 @@ MapPolygonUnit* Map::GetUnitByPos( Vec2 const& pos ) const
 	if (!m_bounds.IsPointInside( pos )) {
 		return nullptr;
 	}
-	for (auto unit : m_mapPolygonUnits) {
-		if (!unit->m_isFarAwayFakeUnit && unit->IsPointInsideConcavePolygon( pos )) {
+	if (!m_useProvinceGrid || m_provinceGrid.IsEmpty()) {
+		return GetUnitByPosLinearScan( pos, false );
+	}
+	int numOfCandidates = 0;
+	int const* candidates = m_provinceGrid.GetItemsAtPoint( pos, numOfCandidates );
+	for (int i = 0; i < numOfCandidates; i++) {
+		MapPolygonUnit* unit = m_provinceGridUnits[candidates[i]];
+		if (m_provinceGrid.GetItemBounds( candidates[i] ).IsPointInsideOrOn( pos ) && unit->IsPointInsideConcavePolygon( pos )) {
 			return unit;
 		}
 	}
@@ -722,16 +745,70 @@ MapPolygonUnit* Map::GetUnitByPosFast( Vec2 const& pos ) const
 	if (!m_bounds.IsPointInside( pos )) {
 		return nullptr;
 	}
+	if (!m_useProvinceGrid || m_provinceGrid.IsEmpty()) {
+		return GetUnitByPosLinearScan( pos, true );
+	}
+	int numOfCandidates = 0;
+	int const* candidates = m_provinceGrid.GetItemsAtPoint( pos, numOfCandidates );
+	for (int i = 0; i < numOfCandidates; i++) {
+		MapPolygonUnit* unit = m_provinceGridUnits[candidates[i]];
+		if (IsPointInsideDisc2D( pos, unit->m_centerPosition, unit->m_roughRadius ) && unit->IsPointInsideConvexPolygon( pos )) {
+			return unit;
+		}
+	}
+	return nullptr;
+}
+
+MapPolygonUnit* Map::GetUnitByPosLinearScan( Vec2 const& pos, bool fast ) const
+{
 	for (auto unit : m_mapPolygonUnits) {
-		if (!unit->m_isFarAwayFakeUnit && IsPointInsideDisc2D( pos, unit->m_centerPosition, unit->m_roughRadius )) {
-			if (unit->IsPointInsideConvexPolygon( pos )) {
+		if (unit->m_isFarAwayFakeUnit) {
+			continue;
+		}
+		if (fast) {
+			if (IsPointInsideDisc2D( pos, unit->m_centerPosition, unit->m_roughRadius ) && unit->IsPointInsideConvexPolygon( pos )) {
 				return unit;
 			}
 		}
+		else if (unit->IsPointInsideConcavePolygon( pos )) {
+			return unit;
+		}
 	}
 	return nullptr;
 }
 
+void Map::GetUnitsByPos( std::vector<Vec2> const& positions, std::vector<MapPolygonUnit*>& out_units, bool fast ) const
+{
+	out_units.resize( positions.size() );
+	ParallelFor( 0, (int)positions.size(), PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		out_units[i] = fast ? GetUnitByPosFast( positions[i] ) : GetUnitByPos( positions[i] );
+		} );
+}
+
+void Map::BuildProvinceGrid()
+{
+	// a province's bounds hold its rough radius disc and every point of its edges, noisy ones included once there are any
+	m_provinceGridUnits.clear();
+	std::vector<AABB2> provinceBounds;
+	provinceBounds.reserve( m_mapPolygonUnits.size() );
+	for (auto unit : m_mapPolygonUnits) {
+		if (unit->m_isFarAwayFakeUnit) {
+			continue;
+		}
+		AABB2 bounds( unit->m_centerPosition - Vec2( unit->m_roughRadius, unit->m_roughRadius ), unit->m_centerPosition + Vec2( unit->m_roughRadius, unit->m_roughRadius ) );
+		for (auto edge : unit->m_edges) {
+			bounds.StretchToIncludePoint( edge->m_startPos );
+			bounds.StretchToIncludePoint( edge->m_endPos );
+			for (auto const& noisyPoint : edge->m_noisyEdges) {
+				bounds.StretchToIncludePoint( noisyPoint );
+			}
+		}
+		m_provinceGridUnits.push_back( unit );
+		provinceBounds.push_back( bounds );
+	}
+	m_provinceGrid.Build( m_bounds, UniformGrid2D::GetSuggestedNumOfCells( m_bounds, (int)provinceBounds.size() ), provinceBounds );
+}
+
 MapPolygonUnit* Map::GetCurHoveringAtUnit3D( Vec3 const& mouseWorldPos ) const
 {
 	Vec3 forwardVec = (mouseWorldPos - g_theGame->m_worldCamera.m_position).GetNormalized();
@@ -1123,13 +1200,37 @@ void Map::CountriesEndTurn()
 
 void Map::PutCountryInstructions()
 {
-	for (auto country : m_countries) {
+	// every country plans its own armies and provinces at the same time into its own buffer
+	int numOfCountries = (int)m_countries.size();
+	m_countryInstructionBuffers.resize( numOfCountries );
+	ParallelFor( 0, numOfCountries, 1, [&]( int i ) {
+		if (m_countries[i]->IsExist()) {
+			m_countries[i]->PlanCountryBehavior( m_countryInstructionBuffers[i] );
+		}
+	} );
+	// then the buffers are queued in country order with each country's diplomacy right after its own instructions,
+	// so the queue and the history rng rolls are the same at any number of threads
+	for (int i = 0; i < numOfCountries; i++) {
+		Country* country = m_countries[i];
+		// a modal error box is only safe on the main thread
+		for (auto const& error : country->m_planningErrors) {
+			ERROR_RECOVERABLE( error );
+		}
+		country->m_planningErrors.clear();
 		if (country->IsExist()) {
-			country->ExecuteCountryBehavior();
+			for (auto instr : m_countryInstructionBuffers[i]) {
+				AddInstructionToQueue( instr );
+			}
+			country->ExecuteCountryDiplomacy();
 		}
 		else {
+			// annexed by a country before it in this month
+			for (auto instr : m_countryInstructionBuffers[i]) {
+				delete instr;
+			}
 			country->RemoveAllRelations();
 		}
+		m_countryInstructionBuffers[i].clear();
 	}
 }
 
@@ -1555,11 +1656,38 @@ void Map::ExecuteInstruction( CountryInstruction const* instr )
 void Map::MapEndTurn()
 {
 	// population growth
-	for (auto prov : m_mapPolygonUnits) {
+	// the epidemic rolls are taken in province order first, then every province grows on its own,
+	// then picks where its people move from the grown populations, and the moves are applied in province order
+	int numOfUnits = (int)m_mapPolygonUnits.size();
+	m_provinceGrowthRolls.resize( numOfUnits );
+	m_provincePopulationMovedOut.resize( numOfUnits );
+	m_provinceSpreadTargets.resize( numOfUnits );
+	for (int i = 0; i < numOfUnits; i++) {
+		MapPolygonUnit* prov = m_mapPolygonUnits[i];
+		if (!prov->IsWater() && !prov->m_isFarAwayFakeUnit) {
+			m_provinceGrowthRolls[i] = m_historyRNG->RollRandomFloatZeroToOne();
+		}
+	}
+	ParallelFor( 0, numOfUnits, PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		MapPolygonUnit* prov = m_mapPolygonUnits[i];
+		m_provincePopulationMovedOut[i] = 0;
 		if (!prov->IsWater() && !prov->m_isFarAwayFakeUnit) {
-			prov->GrowPopulationOneMonth();
+			m_provincePopulationMovedOut[i] = prov->GrowPopulationOneMonth( m_provinceGrowthRolls[i] );
+		}
+	} );
+	ParallelFor( 0, numOfUnits, PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		m_provinceSpreadTargets[i] = nullptr;
+		if (m_provincePopulationMovedOut[i] > 0) {
+			m_provinceSpreadTargets[i] = m_mapPolygonUnits[i]->GetPopulationSpreadTarget( m_provincePopulationMovedOut[i] );
+		}
+	} );
+	for (int i = 0; i < numOfUnits; i++) {
+		if (m_provinceSpreadTargets[i]) {
+			m_mapPolygonUnits[i]->m_totalPopulation -= m_provincePopulationMovedOut[i];
+			m_provinceSpreadTargets[i]->m_totalPopulation += m_provincePopulationMovedOut[i];
 		}
 	}
+	// cities take people from the provinces around them, so they stay in order
 	for (auto city : m_cities) {
 		city->GrowPopulationOneMonth();
 	}
@@ -1638,58 +1766,53 @@ void Map::MapEndTurn()
 
 void Map::RecordHistory()
 {
+	// every month goes into the timeline, months near the viewing month also stay in memory
 	m_historyData.reserve( m_historyData.size() + 2 );
-	if (std::abs( GetMonthDiffBetweenTwoTimes( m_viewingYear, m_viewingMonth, m_year, m_month ) ) <= MAX_SAVE_MONTH) {
-		HistoryData* data = new HistoryData( this );
-		//std::vector<uint8_t> binData;
-		//data->DumpToBinaryFormat( binData );
-		m_historyData.push_back( data );
+	HistoryData* data = AcquireHistoryData();
+	data->Record( this );
+	HistoryData const* prevMonth = m_historyData.empty() ? nullptr : m_historyData.back();
+	m_historyTimeline->AppendMonth( *data, prevMonth );
 #ifdef DEBUG_COMPARE_HISTORY
-		// check history correctness
-  		if (m_year != 0 || m_month != 1) {
-  			HistoryData prevData;
-  			int curYear = m_year;
-  			int curMonth = m_month;
-//   			++curMonth;
-//   			if (curMonth == 13) {
-//   				curMonth = 1;
-//   				++curYear;
-//   			}
-  			LoadHistoryCacheFromDisk( prevData, curYear, curMonth );
-			DebugCompareHistory( prevData, *data );
-		}
+	// check the timeline gives back what was recorded
+	HistoryData decodedData;
+	m_historyTimeline->DecodeMonth( (int)m_historyData.size(), decodedData );
+	DebugCompareHistory( decodedData, *data );
 #endif
+	if (std::abs( GetMonthDiffBetweenTwoTimes( m_viewingYear, m_viewingMonth, m_year, m_month ) ) <= MAX_SAVE_MONTH) {
+		m_historyData.push_back( data );
 	}
 	else {
-		HistoryData data( this );
-		std::vector<uint8_t> binData;
-		data.DumpToBinaryFormat( binData );
-		std::filesystem::create_directory( Stringf( "Saves/%d", m_generationSettings.m_seed ).c_str() );
-		std::filesystem::create_directory( Stringf( "Saves/%d/HistoryCache", m_generationSettings.m_seed ).c_str() );
-		BufferWriteToFile( binData, Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, m_viewingYear, m_viewingMonth ) );
+		ReleaseHistoryData( data );
 		m_historyData.push_back( nullptr );
 	}
 }
 
-void Map::LoadHistoryCacheFromDisk( HistoryData& data, int year, int month ) const
+HistoryData* Map::AcquireHistoryData()
 {
-	std::vector<uint8_t> binData;
-	size_t size = 10 * (size_t)std::filesystem::file_size( Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, year, month ) );
-	binData.resize( size );
+	if (m_historyDataPool.empty()) {
+		return new HistoryData();
+	}
+	HistoryData* data = m_historyDataPool.back();
+	m_historyDataPool.pop_back();
+	return data;
+}
 
-	struct zip_t* zip = zip_open( Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, year, month ).c_str(),
-		0, 'r' );
-	{
-		zip_entry_open( zip, "History.his" );
-		{
-			zip_entry_noallocread( zip, binData.data(), size );
-		}
-		zip_entry_close( zip );
+void Map::ReleaseHistoryData( HistoryData* data )
+{
+	// the columns keep their memory, so the next snapshot recorded into it does not allocate
+	if ((int)m_historyDataPool.size() < MAX_POOLED_HISTORY_DATA) {
+		m_historyDataPool.push_back( data );
+	}
+	else {
+		delete data;
 	}
-	zip_close( zip );
+}
 
-	//FileReadToBuffer( binData, Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, year, month ) );
-	data.LoadFromBinaryFormat( binData );
+void Map::LoadHistoryFromTimeline( HistoryData& data, int year, int month ) const
+{
+	if (!m_historyTimeline->DecodeMonth( 12 * year + month - 1, data )) {
+		ERROR_RECOVERABLE( Stringf( "Cannot read the history of year %d month %d from the timeline!", year, month ) );
+	}
 }
 
 void Map::AddHistoryLog( std::string const& log )
@@ -1829,40 +1952,29 @@ void Map::UpdateColorfulMaps()
 
 	RefreshAllLabels();
 
+	// every view mode is brought up to date here in one pass, switching modes later only copies the cached colors
+	// and only the provinces whose color really changed are uploaded by UpdateBufferColors
+	RefreshProvinceModeColors();
 	if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_POPULATION_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderPopulationColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Population, false );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_CULTURE_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderCultureColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Culture, false );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_RELATION_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderRelationColor();
-		}
+		SetAllPolygonsRenderColor( &MapPolygonUnit::SetRenderRelationColor );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_RELIGION_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderReligionColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Religion, false );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_PRODUCT_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderProductColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Product, false );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_COUNTRIES_MAP) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderCountryColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Country, false );
 	}
 	else if (m_showingSettings.m_mapShowConfig & SHOW_CONFIG_PROVINCE_EDIT) {
-		for (auto unit : m_mapPolygonUnits) {
-			unit->SetRenderProvEditColor();
-		}
+		SetAllPolygonsRenderColor( ProvinceColorMode::Country, false );
 		GenerateProvinceEditUI();
 	}
 
@@ -1871,6 +1983,387 @@ void Map::UpdateColorfulMaps()
 	}
 }
 
+void Map::SetAllPolygonsRenderColor( void (MapPolygonUnit::* setRenderColorFunction)() )
+{
+	// each unit only writes its own range of m_colorVertexArray, so units can be recolored in parallel
+	ParallelFor( 0, (int)m_mapPolygonUnits.size(), PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		(m_mapPolygonUnits[i]->*setRenderColorFunction)();
+		} );
+}
+
+void Map::SetAllPolygonsRenderColor( ProvinceColorMode mode, bool refreshColors )
+{
+	// provinces can be edited between two months, refreshing is cheap when nothing changed
+	ParallelFor( 0, (int)m_mapPolygonUnits.size(), PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		if (refreshColors) {
+			m_mapPolygonUnits[i]->RefreshModeColors();
+		}
+		m_mapPolygonUnits[i]->SetRenderModeColor( mode );
+		} );
+}
+
+int Map::RefreshProvinceModeColors( bool refreshAll )
+{
+	std::atomic<int> numOfChangedProvinces = 0;
+	ParallelFor( 0, (int)m_mapPolygonUnits.size(), PARALLEL_FOR_AUTO_GRAIN_SIZE, [&]( int i ) {
+		if (m_mapPolygonUnits[i]->RefreshModeColors( refreshAll )) {
+			++numOfChangedProvinces;
+		}
+		} );
+	return numOfChangedProvinces;
+}
+
+bool Map::Command_ColorMapBenchmark( EventArgs& args )
+{
+	Map* map = GetCurMap();
+	if (map == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ColorMapBenchmark: no map generated" );
+		return false;
+	}
+	int repeat = atoi( args.GetValue( "repeat", "20" ).c_str() );
+	double startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		for (auto unit : map->m_mapPolygonUnits) {
+			unit->SetRenderPopulationColor();
+		}
+	}
+	double serialTime = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		map->SetAllPolygonsRenderColor( &MapPolygonUnit::SetRenderPopulationColor );
+	}
+	double parallelTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "UpdateColorfulMaps recolor %d polygons: serial %.3fms parallel %.3fms (x%.2f)",
+		(int)map->m_mapPolygonUnits.size(), serialTime * 1000.0 / repeat, parallelTime * 1000.0 / repeat, serialTime / parallelTime ) );
+
+	// what a month and a mode switch cost with the cached colors
+	startTime = GetCurrentTimeSeconds();
+	int numOfChangedProvinces = 0;
+	for (int r = 0; r < repeat; r++) {
+		numOfChangedProvinces = map->RefreshProvinceModeColors();
+	}
+	double refreshTime = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int r = 0; r < repeat; r++) {
+		map->SetAllPolygonsRenderColor( r % 2 == 0 ? ProvinceColorMode::Culture : ProvinceColorMode::Country, false );
+	}
+	double switchTime = GetCurrentTimeSeconds() - startTime;
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "Cached colors: refresh all modes %.3fms (%d provinces changed), switch mode %.3fms",
+		refreshTime * 1000.0 / repeat, numOfChangedProvinces, switchTime * 1000.0 / repeat ) );
+	map->UpdateColorfulMaps();
+	return true;
+}
+
+bool Map::Command_ProvincePickingBenchmark( EventArgs& args )
+{
+	Map* map = GetCurMap();
+	if (map == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ProvincePickingBenchmark: no map generated" );
+		return false;
+	}
+	int numOfQueries = atoi( args.GetValue( "queries", "100000" ).c_str() );
+	for (int i = 0; i < 2; i++) {
+		bool fast = i == 1;
+		double gridSeconds, linearSeconds, batchSeconds;
+		int numOfMismatches;
+		map->MeasureProvincePicking( numOfQueries, fast, gridSeconds, linearSeconds, batchSeconds, numOfMismatches );
+		g_devConsole->AddLine( numOfMismatches == 0 ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR,
+			Stringf( "%s %d queries on %d polygons: linear %.3fus grid %.3fus (x%.1f) batch %.3fus, %d mismatches", fast ? "GetUnitByPosFast" : "GetUnitByPos",
+			numOfQueries, (int)map->m_provinceGridUnits.size(), linearSeconds * 1e6 / numOfQueries, gridSeconds * 1e6 / numOfQueries,
+			linearSeconds / gridSeconds, batchSeconds * 1e6 / numOfQueries, numOfMismatches ) );
+	}
+	return true;
+}
+
+void Map::MeasureProvincePicking( int numOfQueries, bool fast, double& out_gridSeconds, double& out_linearSeconds, double& out_batchSeconds, int& out_numOfMismatches ) const
+{
+	// the map's own generator is not touched, so measuring does not change what is generated next
+	RandomNumberGenerator rng( 271 );
+	std::vector<Vec2> positions;
+	positions.reserve( numOfQueries );
+	for (int i = 0; i < numOfQueries; i++) {
+		positions.emplace_back( rng.RollRandomFloatInRange( m_bounds.m_mins.x, m_bounds.m_maxs.x ), rng.RollRandomFloatInRange( m_bounds.m_mins.y, m_bounds.m_maxs.y ) );
+	}
+	std::vector<MapPolygonUnit*> gridResults;
+	gridResults.reserve( numOfQueries );
+	double startTime = GetCurrentTimeSeconds();
+	for (auto const& pos : positions) {
+		gridResults.push_back( fast ? GetUnitByPosFast( pos ) : GetUnitByPos( pos ) );
+	}
+	out_gridSeconds = GetCurrentTimeSeconds() - startTime;
+
+	std::vector<MapPolygonUnit*> batchResults;
+	startTime = GetCurrentTimeSeconds();
+	GetUnitsByPos( positions, batchResults, fast );
+	out_batchSeconds = GetCurrentTimeSeconds() - startTime;
+
+	out_numOfMismatches = 0;
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfQueries; i++) {
+		if (GetUnitByPosLinearScan( positions[i], fast ) != gridResults[i]) {
+			++out_numOfMismatches;
+		}
+	}
+	out_linearSeconds = GetCurrentTimeSeconds() - startTime;
+	for (int i = 0; i < numOfQueries; i++) {
+		if (batchResults[i] != gridResults[i]) {
+			++out_numOfMismatches;
+		}
+	}
+}
+
+bool Map::Command_PathfindingBenchmark( EventArgs& args )
+{
+	int numOfPolygons = atoi( args.GetValue( "polygons", "40000" ).c_str() );
+	int numOfQueries = atoi( args.GetValue( "queries", "2000" ).c_str() );
+	bool useMap = args.GetValue( "useMap", "false" ) == "true";
+	int clusterSize = atoi( args.GetValue( "clusterSize", "32" ).c_str() );
+	if (numOfPolygons < 4 || numOfQueries <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "PathfindingBenchmark: need at least 4 polygons and 1 query" );
+		return false;
+	}
+	AStarHelper* helper = nullptr;
+	AStarHelper* ownedHelper = nullptr;
+	if (useMap) {
+		if (GetCurMap() == nullptr) {
+			g_devConsole->AddLine( DevConsole::INFO_ERROR, "PathfindingBenchmark: no map generated" );
+			return false;
+		}
+		helper = &GetCurMap()->m_aStarHelper;
+	}
+	else {
+		// jittered grid with the map's 2:1 shape, each site linked to 6 neighbors like an average voronoi cell
+		int numX = RoundDownToInt( sqrtf( 2.f * (float)numOfPolygons ) );
+		int numY = numOfPolygons / numX;
+		RandomNumberGenerator rng( 147 );
+		std::vector<Vec2> positions;
+		std::vector<std::vector<int>> adjacentNodes;
+		positions.reserve( (size_t)numX * numY );
+		adjacentNodes.resize( (size_t)numX * numY );
+		for (int y = 0; y < numY; y++) {
+			for (int x = 0; x < numX; x++) {
+				positions.emplace_back( ((float)x + rng.RollRandomFloatInRange( 0.2f, 0.8f )) * 300.f / (float)numX,
+					((float)y + rng.RollRandomFloatInRange( 0.2f, 0.8f )) * 150.f / (float)numY );
+				int index = x + y * numX;
+				IntVec2 const offsets[6] = { IntVec2( 1, 0 ), IntVec2( -1, 0 ), IntVec2( 0, 1 ), IntVec2( 0, -1 ), IntVec2( 1, 1 ), IntVec2( -1, -1 ) };
+				for (IntVec2 const& offset : offsets) {
+					if (x + offset.x >= 0 && x + offset.x < numX && y + offset.y >= 0 && y + offset.y < numY) {
+						adjacentNodes[index].push_back( x + offset.x + (y + offset.y) * numX );
+					}
+				}
+			}
+		}
+		ownedHelper = new AStarHelper();
+		ownedHelper->AStarHelperInit( positions, adjacentNodes, std::vector<bool>() );
+		helper = ownedHelper;
+	}
+	// the grid has no regions, every cluster comes from the flood; building the map's hierarchy again gives the same one
+	double hierarchyStartTime = GetCurrentTimeSeconds();
+	if (useMap) {
+		GetCurMap()->BuildRouteHierarchy();
+	}
+	else {
+		helper->BuildHierarchy( std::vector<int>( helper->GetNumOfNodes(), -1 ), clusterSize );
+	}
+	double hierarchySeconds = GetCurrentTimeSeconds() - hierarchyStartTime;
+
+	int numOfNodes = helper->GetNumOfNodes();
+	RandomNumberGenerator rng( 4242 );
+	std::vector<AStarQuery> queries;
+	queries.resize( numOfQueries );
+	for (AStarQuery& query : queries) {
+		query.m_startNode = rng.RollRandomIntLessThan( numOfNodes );
+		query.m_endNode = rng.RollRandomIntLessThan( numOfNodes );
+	}
+
+	// index 0: full reset each query, 1: generation stamps on one thread, 2: generation stamps on the job workers,
+	// 3: hierarchical route, 4: hierarchical next node only
+	double seconds[5] = {};
+	std::vector<float> routeDists[4];
+	std::vector<int> nodeRoute;
+	for (int mode = 0; mode < 2; mode++) {
+		routeDists[mode].resize( numOfQueries, -1.f );
+		double startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < numOfQueries; i++) {
+			bool hasRoute = mode == 0 ? helper->CalculateNodeRouteByFullReset( queries[i].m_startNode, queries[i].m_endNode, nodeRoute )
+				: helper->CalculateNodeRoute( queries[i].m_startNode, queries[i].m_endNode, false, nodeRoute );
+			routeDists[mode][i] = hasRoute ? helper->GetNodeRouteDistance( nodeRoute ) : -1.f;
+		}
+		seconds[mode] = GetCurrentTimeSeconds() - startTime;
+	}
+	double startTime = GetCurrentTimeSeconds();
+	helper->CalculateRoutes( queries );
+	seconds[2] = GetCurrentTimeSeconds() - startTime;
+	routeDists[2].resize( numOfQueries );
+	for (int i = 0; i < numOfQueries; i++) {
+		routeDists[2][i] = queries[i].m_hasRoute ? helper->GetNodeRouteDistance( queries[i].m_nodeRoute ) : -1.f;
+	}
+	routeDists[3].resize( numOfQueries );
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfQueries; i++) {
+		bool hasRoute = helper->CalculateHierarchicalNodeRoute( queries[i].m_startNode, queries[i].m_endNode, false, nodeRoute );
+		routeDists[3][i] = hasRoute ? helper->GetNodeRouteDistance( nodeRoute ) : -1.f;
+	}
+	seconds[3] = GetCurrentTimeSeconds() - startTime;
+	std::vector<int> nextNodes( numOfQueries );
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfQueries; i++) {
+		nextNodes[i] = helper->CalculateNextNodeOnRoute( queries[i].m_startNode, queries[i].m_endNode, false );
+	}
+	seconds[4] = GetCurrentTimeSeconds() - startTime;
+
+	// ties may pick different routes, so compare lengths: the batch has to match the stamped search,
+	// the full reset search edits costs inside its std::priority_queue and can stop on a longer route
+	int numOfMismatches = 0;
+	int numOfLongerFullResetRoutes = 0;
+	for (int i = 0; i < numOfQueries; i++) {
+		float tolerance = 0.001f * (1.f + fabsf( routeDists[1][i] ));
+		if (fabsf( routeDists[2][i] - routeDists[1][i] ) > tolerance || (routeDists[0][i] < 0.f) != (routeDists[1][i] < 0.f)
+			|| routeDists[0][i] < routeDists[1][i] - tolerance) {
+			numOfMismatches++;
+		}
+		else if (routeDists[0][i] > routeDists[1][i] + tolerance) {
+			numOfLongerFullResetRoutes++;
+		}
+		// hierarchical routes may be longer but never shorter, and they must exist whenever a route exists
+		bool hasNextNode = queries[i].m_startNode == queries[i].m_endNode || nextNodes[i] >= 0;
+		if ((routeDists[3][i] < 0.f) != (routeDists[1][i] < 0.f) || routeDists[3][i] < routeDists[1][i] - tolerance || hasNextNode != (routeDists[1][i] >= 0.f)) {
+			numOfMismatches++;
+		}
+	}
+	double shortestDistSum = 0.0;
+	double hierarchicalDistSum = 0.0;
+	for (int i = 0; i < numOfQueries; i++) {
+		if (routeDists[1][i] > 0.f && routeDists[3][i] > 0.f) {
+			shortestDistSum += routeDists[1][i];
+			hierarchicalDistSum += routeDists[3][i];
+		}
+	}
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "PathfindingBenchmark: %d nodes (%s), %d queries, %d workers", numOfNodes, useMap ? "current map" : "jittered grid",
+		numOfQueries, g_theJobSystem->GetWorkersCount() ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-20s %10s %12s", "search", "ms", "queries/s" ) );
+	char const* modeNames[5] = { "full reset", "generation stamps", "stamps batch", "hierarchical", "hierarchical next" };
+	for (int mode = 0; mode < 5; mode++) {
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-20s %10.2f %12.1f", modeNames[mode], seconds[mode] * 1000.0, (double)numOfQueries / seconds[mode] ) );
+	}
+	g_devConsole->AddLine( numOfMismatches == 0 ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR,
+		numOfMismatches == 0 ? "stamped searches found the same route lengths" : Stringf( "%d route lengths differ!", numOfMismatches ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "full reset search found a longer route in %d of %d queries", numOfLongerFullResetRoutes, numOfQueries ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "hierarchy: %d clusters, %d portal nodes, built in %.2f ms, routes %.2f%% longer than the shortest", helper->GetNumOfClusters(),
+		helper->GetNumOfPortalNodes(), hierarchySeconds * 1000.0, shortestDistSum > 0.0 ? (hierarchicalDistSum / shortestDistSum - 1.0) * 100.0 : 0.0 ) );
+	delete ownedHelper;
+	return true;
+}
+
+bool Map::Command_VoronoiBenchmark( EventArgs& args )
+{
+	Map* map = GetCurMap();
+	if (map == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "VoronoiBenchmark: no map generated" );
+		return false;
+	}
+	Strings sizeStrings = SplitStringOnDelimiter( args.GetValue( "sites", "10000,100000,1000000" ), ',' );
+	int relaxIterations = atoi( args.GetValue( "relax", "1" ).c_str() );
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%10s %12s %12s %12s %12s %12s", "sites", "vertices", "half edges", "solve ms", "reused ms", "relax ms" ) );
+	VoronoiSolver solver;
+	VoronoiDiagram diagram;
+	for (std::string const& sizeString : sizeStrings) {
+		int numOfSites = atoi( sizeString.c_str() );
+		if (numOfSites <= 0) {
+			continue;
+		}
+		// jittered grid over the map bounds plus the four far away guard sites, like PopulateMapWithPolygons
+		RandomNumberGenerator rng( 147 );
+		int numOfBoxes = RoundDownToInt( sqrtf( (float)numOfSites ) );
+		Vec2 boxSize = (map->m_bounds.m_maxs - map->m_bounds.m_mins) / (float)numOfBoxes;
+		std::vector<Vec2> sitesPos;
+		sitesPos.reserve( (size_t)numOfSites + 4 );
+		for (int i = 0; i < numOfSites; i++) {
+			int boxIndex = i % (numOfBoxes * numOfBoxes);
+			sitesPos.push_back( map->m_bounds.m_mins + Vec2( ((float)(boxIndex / numOfBoxes) + rng.RollRandomFloatZeroToOne()) * boxSize.x,
+				((float)(boxIndex % numOfBoxes) + rng.RollRandomFloatZeroToOne()) * boxSize.y ) );
+		}
+		std::vector<Vec2> relaxedSitesPos( sitesPos );
+		sitesPos.push_back( Vec2( -EDGE_GUARD_X, (map->m_bounds.m_mins.y + map->m_bounds.m_maxs.y) * 0.5f ) );
+		sitesPos.push_back( Vec2( EDGE_GUARD_X, (map->m_bounds.m_mins.y + map->m_bounds.m_maxs.y) * 0.5f ) );
+		sitesPos.push_back( Vec2( (map->m_bounds.m_mins.x + map->m_bounds.m_maxs.x) * 0.5f, -EDGE_GUARD_Y ) );
+		sitesPos.push_back( Vec2( (map->m_bounds.m_mins.x + map->m_bounds.m_maxs.x) * 0.5f, EDGE_GUARD_Y ) );
+
+		// a fresh solver and diagram allocate everything, the second solve reuses their buffers
+		double startTime = GetCurrentTimeSeconds();
+		SolveVoronoiDiagram( sitesPos, diagram, &rng );
+		double solveSeconds = GetCurrentTimeSeconds() - startTime;
+		startTime = GetCurrentTimeSeconds();
+		solver.Solve( sitesPos, diagram, &rng );
+		double reusedSeconds = GetCurrentTimeSeconds() - startTime;
+		startTime = GetCurrentTimeSeconds();
+		RelaxVoronoiSites( relaxedSitesPos, map->m_bounds, relaxIterations, &rng );
+		double relaxSeconds = GetCurrentTimeSeconds() - startTime;
+
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%10d %12d %12d %12.2f %12.2f %12.2f", numOfSites, (int)diagram.m_vertices.size(), (int)diagram.m_halfEdges.size(),
+			solveSeconds * 1000.0, reusedSeconds * 1000.0, relaxSeconds * 1000.0 ) );
+	}
+	return true;
+}
+
+bool Map::Command_SimulationBenchmark( EventArgs& args )
+{
+	Map* map = GetCurMap();
+	if (map == nullptr || !map->m_generationSettings.m_enableHistorySimulation) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "SimulationBenchmark: no map with history simulation generated" );
+		return false;
+	}
+	int numOfYears = atoi( args.GetValue( "years", "10" ).c_str() );
+	if (numOfYears <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "SimulationBenchmark: need at least 1 year" );
+		return false;
+	}
+	if (map->m_viewingYear != map->m_year || map->m_viewingMonth != map->m_month) {
+		map->m_viewingMonth = map->m_month;
+		map->m_viewingYear = map->m_year;
+		map->RearrangeHistoryCache();
+		map->ReadHistoryCache( map->GetHistoryData( map->m_year, map->m_month ) );
+	}
+	int startYear = map->m_year;
+	int startMonth = map->m_month;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfYears * 12; i++) {
+		map->SimulateNextMonthWithoutRefresh();
+	}
+	double seconds = GetCurrentTimeSeconds() - startTime;
+	if (!map->m_generationSettings.m_isHeadless) {
+		map->UpdateColorfulMaps();
+	}
+
+	// same seed and same years must give the same checksum at any number of workers
+	uint64_t checksum = 14695981039346656037ULL;
+	auto hashInt = [&checksum]( int value ) {
+		checksum = (checksum ^ (uint64_t)(uint32_t)value) * 1099511628211ULL;
+		};
+	for (auto prov : map->m_mapPolygonUnits) {
+		hashInt( prov->m_totalPopulation );
+		hashInt( prov->m_owner ? prov->m_owner->m_id : -1 );
+	}
+	for (auto city : map->m_cities) {
+		hashInt( city->m_totalPopulation );
+	}
+	for (auto country : map->m_countries) {
+		hashInt( country->m_funds );
+		hashInt( (int)country->m_armies.size() );
+	}
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "SimulationBenchmark: %d provinces, %d countries, %d workers, year %d month %d to year %d month %d",
+		(int)map->m_mapPolygonUnits.size(), (int)map->m_countries.size(), g_theJobSystem->GetWorkersCount(), startYear, startMonth, map->m_year, map->m_month ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%d years in %.3f s, %.2f years/s, %.2f ms/month", numOfYears, seconds, (double)numOfYears / seconds, seconds * 1000.0 / (double)(numOfYears * 12) ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "state checksum %016llx", (unsigned long long)checksum ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "history timeline %d months, %.2f MB on disk", map->m_historyTimeline->GetNumOfMonths(),
+		(double)map->m_historyTimeline->GetFileSize() / (1024.0 * 1024.0) ) );
+	return true;
+}
+
 void Map::ReadHistoryCache( HistoryData const& data )
 {
 	for (auto country : m_countries) {
@@ -2114,40 +2607,74 @@ void Map::ReadHistoryCache( HistoryData const& data )
 
 void Map::RearrangeHistoryCache()
 {
-	int curViewingYearIndex = 12 * m_viewingYear + m_viewingMonth - 1;
+	RetrieveHistoryPrefetchJobs();
+	int curViewingMonthIndex = 12 * m_viewingYear + m_viewingMonth - 1;
+	// every month is already in the timeline, leaving the window only frees the memory
 	for (int i = 0; i < (int)m_historyData.size(); ++i) {
-		// load from file
-		if (std::abs( i - curViewingYearIndex ) <= MAX_SAVE_MONTH && m_historyData[i] == nullptr) {
-			int year = (i + 1) % 12 == 0 ? (i + 1) / 12 - 1 : (i + 1) / 12;
-			int month = (i + 1) % 12 == 0 ? 12 : (i + 1) % 12;
-			m_historyData[i] = new HistoryData();
-			LoadHistoryCacheFromDisk( *m_historyData[i], year, month);
-
-			//LoadHistoryFromDiskJob* job = new LoadHistoryFromDiskJob( Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, year, month ), year, month, this );
-			//g_theJobSystem->AddJob( job );
-		}
-		// save to file
-		else if (std::abs( i - curViewingYearIndex ) >= MAX_SAVE_MONTH && m_historyData[i] != nullptr) {
-			std::vector<uint8_t> binData;
-			m_historyData[i]->DumpToBinaryFormat( binData );
-			std::filesystem::create_directory( Stringf( "Saves/%d", m_generationSettings.m_seed ).c_str() );
-			std::filesystem::create_directory( Stringf( "Saves/%d/HistoryCache", m_generationSettings.m_seed ).c_str() );
-			std::string filePath = Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, (i + 1) % 12 == 0 ? (i + 1) / 12 - 1 : (i + 1) / 12, (i + 1) % 12 == 0 ? 12 : (i + 1) % 12 );
-			struct zip_t* zip = zip_open( filePath.c_str(),
-				ZIP_DEFAULT_COMPRESSION_LEVEL, 'w' );
-			{
-				zip_entry_open( zip, "History.his" );
-				{
-					zip_entry_write( zip, binData.data(), binData.size() );
-				}
-				zip_entry_close( zip );
-			}
-			zip_close( zip );
-			//BufferWriteToFile( binData, Stringf( "Saves/%d/HistoryCache/Year%d_Month%d_History.his", m_generationSettings.m_seed, (i + 1) % 12 == 0 ? (i + 1) / 12 - 1: (i + 1) / 12, (i + 1) % 12 == 0 ? 12 : (i + 1) % 12 ) );
-			delete m_historyData[i];
+		if (std::abs( i - curViewingMonthIndex ) > MAX_SAVE_MONTH && m_historyData[i] != nullptr) {
+			ReleaseHistoryData( m_historyData[i] );
 			m_historyData[i] = nullptr;
 		}
 	}
+
+	// decode the missing months of the window in the background, one job per keyframe span, nearest span first
+	int windowStart = curViewingMonthIndex - MAX_SAVE_MONTH < 0 ? 0 : curViewingMonthIndex - MAX_SAVE_MONTH;
+	int windowEnd = curViewingMonthIndex + MAX_SAVE_MONTH < (int)m_historyData.size() - 1 ? curViewingMonthIndex + MAX_SAVE_MONTH : (int)m_historyData.size() - 1;
+	std::vector<PrefetchHistoryJob*> newJobs;
+	for (int i = windowStart; i <= windowEnd; ++i) {
+		if (m_historyData[i] != nullptr || IsHistoryMonthPrefetching( i )) {
+			continue;
+		}
+		int keyframeIndex = m_historyTimeline->GetKeyframeIndex( i );
+		int lastMissingIndex = i;
+		while (lastMissingIndex + 1 <= windowEnd && m_historyData[lastMissingIndex + 1] == nullptr && !IsHistoryMonthPrefetching( lastMissingIndex + 1 )
+			&& m_historyTimeline->GetKeyframeIndex( lastMissingIndex + 1 ) == keyframeIndex) {
+			++lastMissingIndex;
+		}
+		newJobs.push_back( new PrefetchHistoryJob( m_historyTimeline, i, lastMissingIndex ) );
+		i = lastMissingIndex;
+	}
+	std::sort( newJobs.begin(), newJobs.end(), [curViewingMonthIndex]( PrefetchHistoryJob* a, PrefetchHistoryJob* b ) {
+		int distanceA = a->m_lastMonthIndex < curViewingMonthIndex ? curViewingMonthIndex - a->m_lastMonthIndex : a->m_firstMonthIndex - curViewingMonthIndex;
+		int distanceB = b->m_lastMonthIndex < curViewingMonthIndex ? curViewingMonthIndex - b->m_lastMonthIndex : b->m_firstMonthIndex - curViewingMonthIndex;
+		return (distanceA > 0 ? distanceA : 0) < (distanceB > 0 ? distanceB : 0);
+		} );
+	for (auto job : newJobs) {
+		m_historyPrefetchJobs.push_back( job );
+		g_theJobSystem->AddJob( job );
+	}
+}
+
+void Map::RetrieveHistoryPrefetchJobs()
+{
+	int curViewingMonthIndex = 12 * m_viewingYear + m_viewingMonth - 1;
+	for (int i = 0; i < (int)m_historyPrefetchJobs.size();) {
+		PrefetchHistoryJob* job = m_historyPrefetchJobs[i];
+		if (!g_theJobSystem->RetrieveJob( job )) {
+			++i;
+			continue;
+		}
+		// the month may have been decoded on the spot meanwhile, or the window may have moved away from it
+		for (int k = 0; k < (int)job->m_months.size(); ++k) {
+			int monthIndex = job->m_firstMonthIndex + k;
+			if (m_historyData[monthIndex] == nullptr && std::abs( monthIndex - curViewingMonthIndex ) <= MAX_SAVE_MONTH) {
+				m_historyData[monthIndex] = job->m_months[k];
+				job->m_months[k] = nullptr;
+			}
+		}
+		delete job;
+		m_historyPrefetchJobs.erase( m_historyPrefetchJobs.begin() + i );
+	}
+}
+
+bool Map::IsHistoryMonthPrefetching( int monthIndex ) const
+{
+	for (auto job : m_historyPrefetchJobs) {
+		if (monthIndex >= job->m_firstMonthIndex && monthIndex <= job->m_lastMonthIndex) {
+			return true;
+		}
+	}
+	return false;
 }
 
 bool Map::DoHistoryExist( int year, int month ) const
@@ -2543,27 +3070,27 @@ void Map::AddNewCrisisToList( HistoryCrisis* crisis )
 
 HistoryData const& Map::GetHistoryData( int year, int month )
 {
-	//HistoryData* hisData = new HistoryData();
-	//LoadHistoryCacheFromDisk( *hisData, year, month );
-	//m_historyData.push_back( hisData );
 	int index = 12 * year + month - 1;
-	while (m_historyData[index] == nullptr) {
-		//std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
-		m_historyData[index] = new HistoryData();
-		int const& i = index;
-		LoadHistoryCacheFromDisk( *m_historyData[index], (i + 1) % 12 == 0 ? (i + 1) / 12 - 1: (i + 1) / 12, (i + 1) % 12 == 0 ? 12 : (i + 1) % 12);
+	if (m_historyData[index] == nullptr) {
+		RetrieveHistoryPrefetchJobs();
+	}
+	if (m_historyData[index] == nullptr) {
+		// not prefetched yet: one delta on top of the month before if that one is here, otherwise a walk from the keyframe
+		HistoryData* data = AcquireHistoryData();
+		HistoryData const* prevMonth = index > 0 ? m_historyData[index - 1] : nullptr;
+		if (!m_historyTimeline->DecodeMonth( index, *data, prevMonth )) {
+			ERROR_RECOVERABLE( Stringf( "Cannot read the history of year %d month %d from the timeline!", year, month ) );
+		}
+		m_historyData[index] = data;
 	}
-	//while (g_theJobSystem->RetriveOldestCompletedJob());
 	return *m_historyData[index];
-	//return *m_historyData[m_historyData.size() - 1];
 }
 
 void Map::GetHistoryData( int year, int month, HistoryData& data )
 {
 	int index = 12 * year + month - 1;
 	if (m_historyData[index] == nullptr) {
-		int const& i = index;
-		LoadHistoryCacheFromDisk( data, (i + 1) % 12 == 0 ? (i + 1) / 12 - 1 : (i + 1) / 12, (i + 1) % 12 == 0 ? 12 : (i + 1) % 12 );
+		LoadHistoryFromTimeline( data, year, month );
 	}
 	else {
 		data = *m_historyData[index];
@@ -2614,7 +3141,9 @@ Country* Map::CreateNewCountry( std::vector<Province*> const& initialProvince, C
 	newCountry->SetUpSimulation();
 	newCountry->m_funds *= 3;
 	m_countryLabels.push_back( new Label( newCountry, LabelType::Country ) );
-	m_countryLabels[m_countryLabels.size() - 1]->ReCalculateVertexData();
+	if (!m_generationSettings.m_isHeadless) {
+		m_countryLabels[m_countryLabels.size() - 1]->ReCalculateVertexData();
+	}
 	return newCountry;
 }
 
@@ -3079,7 +3608,9 @@ void Map::SaveCurrentWorldToXml() const
 
 void Map::SaveHistoryToXml()
 {
+	// every month job is a parent of the finishing job, it is queued as soon as the last month is written
 	SaveHistoryJob* job = new SaveHistoryJob( m_historySavingModule );
+	m_historySavingModule->StartSave( job );
 	g_theJobSystem->AddJob( job );
 	m_saveHistoryJob = job;
 }
@@ -3207,27 +3738,28 @@ void Map::StartUpMap()
 	m_2D3DSwitchTimer = new Timer( 0.8f, Clock::GetSystemClock() );
 	m_generationSettings.m_seed = m_mapRNG->GetSeed();
 	m_historyRNG = new RandomNumberGenerator( m_generationSettings.m_seed - 1 );
-	m_bounds = g_theGame->m_worldCamera.m_cameraBox;
 	m_dimensions = m_generationSettings.m_dimensions;
 	m_diagonalLength = m_dimensions.GetLength();
 	m_bounds = AABB2( Vec2(), Vec2( m_dimensions.x, m_dimensions.y ) );
-	g_theGame->m_cameraCenter = m_bounds.GetCenter();
-	float cameraScale = Maxf( m_dimensions.x / WORLD_SIZE_X, m_dimensions.y / WORLD_SIZE_Y ) * 1.1f;
-
-	g_theGame->m_worldCamera.SetRenderBasis( Vec3( 0.f, 0.f, 1.f ), Vec3( -1.f, 0.f, 0.f ), Vec3( 0.f, 1.f, 0.f ) );
-	g_theGame->m_worldCamera.m_mode = CameraMode::Perspective;
-	g_theGame->m_worldCamera.SetPerspectiveView( g_window->GetAspect(), 90.f, 0.1f, 50000.f );
-	g_theGame->m_worldCamera.m_position = Vec3( m_dimensions.x * 0.5f, m_dimensions.y * 0.5f, 10.f * cameraScale );
-	//g_theGame->m_worldCamera2D.m_orientation = EulerAngles( 90.f, 60.f, 0.f );
-	g_theGame->m_worldCamera.m_orientation = EulerAngles( 90.f, 90.f, 0.f );
-	//g_theGame->m_worldCamera.SetOrthoView( Vec2( 0, 0 ), Vec2( WORLD_SIZE_X, WORLD_SIZE_Y ), 1.f, -1.f );
-	//g_theGame->m_worldCamera.Scale2D( cameraScale, cameraScale );
-	//g_theGame->m_worldCamera.m_mode = CameraMode::Orthographic;
-	m_polygonFaceShader = g_theRenderer->CreateShader( "Data/Shaders/BasicShader", VertexType::PCU_SEPARATED );
-	m_2DTextureShader = g_theRenderer->CreateShader( "Data/Shaders/2DTextureShader", VertexType::PCU );
-	m_3DShader = g_theRenderer->CreateShader( "Data/Shaders/3DModeShader", VertexType::PCUN_SEPARATED );
-	m_sphereShader = g_theRenderer->CreateShader( "Data/Shaders/SphereModeShader", VertexType::PCU );
-	m_2DPolygonTextureShader = g_theRenderer->CreateShader( "Data/Shaders/2DPolygonTextureShader", VertexType::PCU_SEPARATED );
+	if (!m_generationSettings.m_isHeadless) {
+		g_theGame->m_cameraCenter = m_bounds.GetCenter();
+		float cameraScale = Maxf( m_dimensions.x / WORLD_SIZE_X, m_dimensions.y / WORLD_SIZE_Y ) * 1.1f;
+
+		g_theGame->m_worldCamera.SetRenderBasis( Vec3( 0.f, 0.f, 1.f ), Vec3( -1.f, 0.f, 0.f ), Vec3( 0.f, 1.f, 0.f ) );
+		g_theGame->m_worldCamera.m_mode = CameraMode::Perspective;
+		g_theGame->m_worldCamera.SetPerspectiveView( g_window->GetAspect(), 90.f, 0.1f, 50000.f );
+		g_theGame->m_worldCamera.m_position = Vec3( m_dimensions.x * 0.5f, m_dimensions.y * 0.5f, 10.f * cameraScale );
+		//g_theGame->m_worldCamera2D.m_orientation = EulerAngles( 90.f, 60.f, 0.f );
+		g_theGame->m_worldCamera.m_orientation = EulerAngles( 90.f, 90.f, 0.f );
+		//g_theGame->m_worldCamera.SetOrthoView( Vec2( 0, 0 ), Vec2( WORLD_SIZE_X, WORLD_SIZE_Y ), 1.f, -1.f );
+		//g_theGame->m_worldCamera.Scale2D( cameraScale, cameraScale );
+		//g_theGame->m_worldCamera.m_mode = CameraMode::Orthographic;
+		m_polygonFaceShader = g_theRenderer->CreateShader( "Data/Shaders/BasicShader", VertexType::PCU_SEPARATED );
+		m_2DTextureShader = g_theRenderer->CreateShader( "Data/Shaders/2DTextureShader", VertexType::PCU );
+		m_3DShader = g_theRenderer->CreateShader( "Data/Shaders/3DModeShader", VertexType::PCUN_SEPARATED );
+		m_sphereShader = g_theRenderer->CreateShader( "Data/Shaders/SphereModeShader", VertexType::PCU );
+		m_2DPolygonTextureShader = g_theRenderer->CreateShader( "Data/Shaders/2DPolygonTextureShader", VertexType::PCU_SEPARATED );
+	}
 
 	m_heightSeed = m_generationSettings.m_seed + 1;
 	m_precipitationSeed = m_generationSettings.m_seed + 2;
@@ -3271,6 +3803,10 @@ void Map::StartUpMap()
 
 	std::filesystem::create_directory( Stringf( "Saves" ) );
 	std::filesystem::create_directory( Stringf( "Saves/%d", m_generationSettings.m_seed ) );
+	if (m_generationSettings.m_enableHistorySimulation) {
+		m_historyTimeline = new HistoryTimeline();
+		GUARANTEE_OR_DIE( m_historyTimeline->Open( Stringf( "Saves/%d/History.timeline", m_generationSettings.m_seed ) ), "Cannot open the history timeline file!" );
+	}
 }
 
 void Map::ReadMapRenderingPreferences()
@@ -3593,13 +4129,16 @@ void Map::PopulateMapWithPolygons( int numOfPolygons )
 	}
 ExitLoop:
 	
-	FortuneAlgorithmSolverClass fortuneSolver;
-	std::vector<FortuneHalfEdge*> outEdges;
+	// optional Lloyd passes even out the points, cells are clipped to the map bounds so the points stay inside
+	if (m_generationSettings.m_relaxIterations > 0) {
+		RelaxVoronoiSites( randomPoints, m_bounds, m_generationSettings.m_relaxIterations, m_mapRNG );
+	}
 	//for (int i = 0; i < numOfPolygons; i++) {
 	//	randomPoints.push_back( MP_GetRandomPointInAABB2D( m_bounds ) );
 	//}
 
 	// push back 4 far away points 
+	int numOfRealSites = (int)randomPoints.size();
 	randomPoints.push_back( Vec2( -EDGE_GUARD_X, (m_bounds.m_mins.y + m_bounds.m_maxs.y) * 0.5f ) );
 	randomPoints.push_back( Vec2( EDGE_GUARD_X, (m_bounds.m_mins.y + m_bounds.m_maxs.y) * 0.5f ) );
 	randomPoints.push_back( Vec2( (m_bounds.m_mins.x + m_bounds.m_maxs.x) * 0.5f, -EDGE_GUARD_Y ) );
@@ -3611,45 +4150,30 @@ ExitLoop:
 	// solve Voronoi diagram
 
 	startTime = GetCurrentTimeSeconds();
-	fortuneSolver.FortuneAlgorithmSolver( randomPoints, outEdges );
+	VoronoiDiagram diagram;
+	SolveVoronoiDiagram( randomPoints, diagram, m_mapRNG );
 
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Generating Voronoi Diagram finished, time: %.3fs", endTime - startTime ) );
 
 	startTime = GetCurrentTimeSeconds();
-	// create star edge map
-	std::map<Vec2, MapPolygonUnit*> polygonUnitsMap;
+	// create star edges, units are numbered in the order their sites first show up in the half edges
+	std::vector<MapPolygonUnit*> siteUnits( diagram.m_sites.size(), nullptr );
+	std::vector<StarEdge*> starEdges( diagram.m_halfEdges.size(), nullptr );
+	m_mapPolygonUnits.reserve( diagram.m_sites.size() );
 	int index = 0;
-	for (auto& edge : outEdges) {
-		Vec2 sitePos = FortuneVec2dToVec2f( edge->m_sitePos );
-		auto iter = polygonUnitsMap.find( sitePos );
-		// find a site position already in map: insert that edge to that position
-		if (iter != polygonUnitsMap.end()) {
-			PM_AddEdgeToPolygonUnit( iter->second, edge );
-		}
-		// do not find a site position: create a new one and push it back in the vector
-		else if(sitePos.x != EDGE_GUARD_X && sitePos.x != -EDGE_GUARD_X && sitePos.y != EDGE_GUARD_Y && sitePos.y != -EDGE_GUARD_Y) {
-			MapPolygonUnit* unit = new MapPolygonUnit( sitePos );
-			m_mapPolygonUnits.emplace_back( unit );
-			unit->m_id = index;
-			++index;
-			polygonUnitsMap[sitePos] = unit;
-			PM_AddEdgeToPolygonUnit( unit, edge );
-		}
-		else {
-			MapPolygonUnit* unit = new MapPolygonUnit( sitePos );
+	for (int i = 0; i < (int)diagram.m_halfEdges.size(); i++) {
+		int siteIndex = diagram.m_halfEdges[i].m_site;
+		MapPolygonUnit* unit = siteUnits[siteIndex];
+		if (unit == nullptr) {
+			unit = new MapPolygonUnit( diagram.m_sites[siteIndex] );
 			m_mapPolygonUnits.emplace_back( unit );
 			unit->m_id = index;
 			++index;
-			polygonUnitsMap[sitePos] = unit;
-			unit->m_isFarAwayFakeUnit = true;
-			PM_AddEdgeToPolygonUnit( unit, edge );
+			unit->m_isFarAwayFakeUnit = siteIndex >= numOfRealSites;
+			siteUnits[siteIndex] = unit;
 		}
-	}
-
-	// delete the output edges
-	for (auto edges : outEdges) {
-		delete edges;
+		PM_AddEdgeToPolygonUnit( unit, diagram, i, starEdges );
 	}
 
 	// sort the edges (to form a circular order)
@@ -3814,6 +4338,8 @@ void Map::CalculateBiomeDataForPolygons()
 	startTime = GetCurrentTimeSeconds();
 	std::sort( m_mapPolygonUnits.begin(), m_mapPolygonUnits.end(), []( MapPolygonUnit* a, MapPolygonUnit* b ) 
 		{ return a->m_centerPosition.y < b->m_centerPosition.y; } );
+	// built after the sort, so a grid query finds the same province as a scan of m_mapPolygonUnits
+	BuildProvinceGrid();
 	m_oceanDirtySet.clear();
 	m_islandDirtySet.clear();
 	for (auto unit : m_mapPolygonUnits) {
@@ -4108,6 +4634,11 @@ void Map::GenerateHumanDataForPolygons()
 	endTime = GetCurrentTimeSeconds();
 	PCGWorld_Log( Stringf( "Regions Generation finished, time: %.3fs", endTime - startTime ) );
 
+	startTime = GetCurrentTimeSeconds();
+	BuildRouteHierarchy();
+	endTime = GetCurrentTimeSeconds();
+	PCGWorld_Log( Stringf( "Route Hierarchy Generation finished, time: %.3fs", endTime - startTime ) );
+
 	startTime = GetCurrentTimeSeconds();
 	GenerateRoads();
 	endTime = GetCurrentTimeSeconds();
@@ -5123,6 +5654,19 @@ void Map::GenerateRegions()
 	}
 }
 
+void Map::BuildRouteHierarchy()
+{
+	std::vector<int> nodeClusters( m_aStarHelper.GetNumOfNodes(), -1 );
+	for (auto unit : m_mapPolygonUnits) {
+		int nodeIndex = m_aStarHelper.GetNodeIndex( unit );
+		if (nodeIndex >= 0 && unit->m_region) {
+			nodeClusters[nodeIndex] = unit->m_region->m_id;
+		}
+	}
+	// open water has few choke points, its clusters can be larger than the regions
+	m_aStarHelper.BuildHierarchy( nodeClusters, GetClamped( m_generationSettings.m_basePolygons / 1500, 16, 10000 ) );
+}
+
 static inline auto const cityDistCmp =
 []( std::pair<City*, float>const& a, std::pair<City*, float> const& b ) {
 	return a.second > b.second;
@@ -5271,6 +5815,8 @@ void Map::GenerateVertexBuffers()
 			}
 		}
 	}
+	// the noisy edges reach out of the straight polygons, hover picking needs them inside the province bounds
+	BuildProvinceGrid();
 	// re-arrange and correct noisy edges
 // 	for (auto unit : m_mapPolygonUnits) {
 // 		if (!unit->m_isFarAwayFakeUnit) {
@@ -6354,7 +6900,37 @@ void Map::UpdateAutoSimulation()
 
 void Map::UpdateBufferColors()
 {
-	g_theRenderer->CopyCPUToGPU( m_colorVertexArray.data(), m_colorVertexArray.size() * sizeof( Rgba8 ), m_polygonFacesColorVertexBuffer );
+	// provinces are laid out in the buffer in the order of m_mapPolygonUnits, so neighbouring dirty ones merge into one range
+	m_dirtyColorRanges.clear();
+	size_t numOfDirtyVertexes = 0;
+	for (auto unit : m_mapPolygonUnits) {
+		if (!unit->m_isColorDirty) {
+			continue;
+		}
+		unit->m_isColorDirty = false;
+		if (unit->m_sizeInVertexBuffer == 0) {
+			continue;
+		}
+		size_t rangeBegin = unit->m_startInVertexBuffer * sizeof( Rgba8 );
+		size_t rangeEnd = rangeBegin + unit->m_sizeInVertexBuffer * sizeof( Rgba8 );
+		if (!m_dirtyColorRanges.empty() && m_dirtyColorRanges.back().second == rangeBegin) {
+			m_dirtyColorRanges.back().second = rangeEnd;
+		}
+		else {
+			m_dirtyColorRanges.emplace_back( rangeBegin, rangeEnd );
+		}
+		numOfDirtyVertexes += unit->m_sizeInVertexBuffer;
+	}
+	if (m_dirtyColorRanges.empty()) {
+		return;
+	}
+	// past some point one copy of everything is cheaper than many small ones
+	constexpr int maxNumOfUploadRanges = 64;
+	if ((int)m_dirtyColorRanges.size() > maxNumOfUploadRanges || numOfDirtyVertexes * 2 > m_colorVertexArray.size()) {
+		g_theRenderer->CopyCPUToGPU( m_colorVertexArray.data(), m_colorVertexArray.size() * sizeof( Rgba8 ), m_polygonFacesColorVertexBuffer );
+		return;
+	}
+	g_theRenderer->CopyCPUToGPURanges( m_colorVertexArray.data(), m_colorVertexArray.size() * sizeof( Rgba8 ), m_polygonFacesColorVertexBuffer, m_dirtyColorRanges );
 }
 
 void Map::UpdateSaveStatus()
@@ -7629,25 +8205,28 @@ void Map::DebugCompareHistory( HistoryData const& prev, HistoryData const& cur )
 	}
 }
 
-void Map::PM_AddEdgeToPolygonUnit( MapPolygonUnit* polygonUnit, FortuneHalfEdge* edge )
+void Map::PM_AddEdgeToPolygonUnit( MapPolygonUnit* polygonUnit, VoronoiDiagram const& diagram, int halfEdgeIndex, std::vector<StarEdge*>& starEdges )
 {
+	VoronoiHalfEdge const& halfEdge = diagram.m_halfEdges[halfEdgeIndex];
 	StarEdge* newEdge = new StarEdge();
-	edge->m_addrInProj = newEdge;
-	newEdge->m_startPos = FortuneVec2dToVec2f( edge->m_vertexPos );
-	newEdge->m_endPos = FortuneVec2dToVec2f( edge->m_opposite->m_vertexPos );
+	starEdges[halfEdgeIndex] = newEdge;
+	// open ends only show up on the far away fake units
+	int endVertex = diagram.m_halfEdges[halfEdge.m_twin].m_origin;
+	newEdge->m_startPos = halfEdge.m_origin >= 0 ? diagram.m_vertices[halfEdge.m_origin] : Vec2();
+	newEdge->m_endPos = endVertex >= 0 ? diagram.m_vertices[endVertex] : Vec2();
 	newEdge->m_owner = polygonUnit;
-	if (edge->m_opposite && edge->m_opposite->m_addrInProj) {
-		StarEdge* oppoEdge = (StarEdge*)edge->m_opposite->m_addrInProj;
+	if (starEdges[halfEdge.m_twin]) {
+		StarEdge* oppoEdge = starEdges[halfEdge.m_twin];
 		newEdge->m_opposite = oppoEdge;
 		oppoEdge->m_opposite = newEdge;
 	}
-	if (edge->m_next && edge->m_next->m_addrInProj) {
-		StarEdge* nextEdge = (StarEdge*)edge->m_next->m_addrInProj;
+	if (halfEdge.m_next >= 0 && starEdges[halfEdge.m_next]) {
+		StarEdge* nextEdge = starEdges[halfEdge.m_next];
 		newEdge->m_next = nextEdge;
 		nextEdge->m_prev = newEdge;
 	}
-	if (edge->m_prev && edge->m_prev->m_addrInProj) {
-		StarEdge* prevEdge = (StarEdge*)edge->m_prev->m_addrInProj;
+	if (halfEdge.m_prev >= 0 && starEdges[halfEdge.m_prev]) {
+		StarEdge* prevEdge = starEdges[halfEdge.m_prev];
 		newEdge->m_prev = prevEdge;
 		prevEdge->m_next = newEdge;
 	}
@@ -3,6 +3,7 @@
 #include "Game/MapPolygonUnit.hpp"
 #include "Game/AStarHelper.hpp"
 #include "Game/HistoryData.hpp"
+#include "Engine/Math/UniformGrid2D.hpp"
 #include <set>
 
 class River;
@@ -21,10 +22,11 @@ class Army;
 class CountryInstruction;
 class HistoryCrisis;
 class SaveHistoryJob;
+class PrefetchHistoryJob;
 
 bool operator<( Vec2 const& a, Vec2 const& b );
 
-struct FortuneHalfEdge;
+struct VoronoiDiagram;
 class PolyUnitDataCalculationJob;
 class FindCountryForProvinceJob;
 
@@ -56,6 +58,9 @@ struct MapRenderingPreference {
 };
 
 struct MapGenerationSettings {
+	/// read the attributes of a saved GenerationSettings.xml, missing ones keep their values
+	void PopulateFromXmlElementAttributes( XmlElement const& element );
+
 	Vec2 m_dimensions = Vec2( 300.f, 150.f );
 	int m_basePolygons = 10000;
 	unsigned int m_seed = 147;
@@ -66,12 +71,14 @@ struct MapGenerationSettings {
 	int m_numOfUnitsToHaveLake = 6;
 	int m_numOfUnitsToHaveIsland = 6;
 	int m_sqrtBasePolygons = 0;
+	int m_relaxIterations = 0;
 	int m_numOfCultures = 25;
 	int m_numOfReligions = 6;
 	float m_cityRichness = 0.1f;
 	float m_townRichness = 0.5f;
 	bool m_onlyUseWesternCountryPrefix = false;
 	bool m_enableHistorySimulation = true;
+	bool m_isHeadless = false; // no window or renderer: no camera, shaders, vertex buffers or labels
 };
 
 enum class MapViewMode {
@@ -140,12 +147,29 @@ public:
 	void SetRenderRegionMapMode( bool setRender = true );
 	void SetRenderRelationMapMode( bool setRender = true );
 	void SetRenderProvEditMapMode( bool setRender = true );
+
+	// console command: ColorMapBenchmark repeat=20
+	static bool Command_ColorMapBenchmark( EventArgs& args );
+	// console command: PathfindingBenchmark polygons=40000 queries=2000 useMap=false clusterSize=32, A* queries/sec on a jittered grid graph or the current map
+	static bool Command_PathfindingBenchmark( EventArgs& args );
+	// console command: VoronoiBenchmark sites=10000,100000,1000000 relax=1, times the Voronoi solve, a solve on reused buffers and the Lloyd passes
+	static bool Command_VoronoiBenchmark( EventArgs& args );
+	// console command: SimulationBenchmark years=10, simulates the current map's history without refreshing the view, prints years/sec and a checksum of the state
+	static bool Command_SimulationBenchmark( EventArgs& args );
+	// console command: ProvincePickingBenchmark queries=100000, times hover picking and the fast point query with the province grid and with linear scans
+	static bool Command_ProvincePickingBenchmark( EventArgs& args );
 	void Reset2DCameraMode();
 	void Reset3DCameraMode();
 	void ResetSphereCameraMode();
 
+	/// the province whose noisy polygon contains the position, for hover picking
 	MapPolygonUnit* GetUnitByPos( Vec2 const& pos ) const;
+	/// the province whose straight polygon contains the position, cheaper and good enough for generation
 	MapPolygonUnit* GetUnitByPosFast( Vec2 const& pos ) const;
+	/// GetUnitByPos or GetUnitByPosFast for every position, the queries are spread over the job workers
+	void GetUnitsByPos( std::vector<Vec2> const& positions, std::vector<MapPolygonUnit*>& out_units, bool fast = false ) const;
+	/// time numOfQueries random point queries with the province grid and with linear scans, also counts the queries they disagree on
+	void MeasureProvincePicking( int numOfQueries, bool fast, double& out_gridSeconds, double& out_linearSeconds, double& out_batchSeconds, int& out_numOfMismatches ) const;
 	MapPolygonUnit* GetCurHoveringAtUnit3D( Vec3 const& mouseWorldPos ) const;
 	City* GetCityByPos( Vec2 const& pos ) const;
 	City* GetCurHoveringCity3D( Vec3 const& mouseWorldPos ) const;
@@ -171,7 +195,7 @@ public:
 	int GetMonthDiffBetweenTwoTimes( int year1, int month1, int year2, int month2 );
 	int GetTotalMonthCount() const;
 	void GetYearAndMonthFromTotalMonth( int& year, int& month, int totalMonth ) const;
-	void LoadHistoryCacheFromDisk( HistoryData& data, int year, int month ) const;
+	void LoadHistoryFromTimeline( HistoryData& data, int year, int month ) const;
 	void AddHistoryLog( std::string const& log );
 
 	void SaveCurrentWorldToXml() const;
@@ -210,10 +234,14 @@ public:
 	MapGenerationSettings m_generationSettings;
 	MapRenderingPreference m_renderPreference;
 	std::vector<Rgba8> m_colorVertexArray;
+	std::vector<std::pair<size_t, size_t>> m_dirtyColorRanges; // [start, end) bytes of m_colorVertexArray that changed this frame
 
 	Vec2 m_dimensions;
 	AABB2 m_bounds;
 	float m_diagonalLength = 0.f;
+	UniformGrid2D m_provinceGrid; // item i is m_provinceGridUnits[i], built by BuildProvinceGrid
+	std::vector<MapPolygonUnit*> m_provinceGridUnits;
+	bool m_useProvinceGrid = true; // false answers point queries with linear scans, to compare against
 	unsigned int m_heightSeed;
 	unsigned int m_precipitationSeed;
 	unsigned int m_temperatureSeed;
@@ -256,7 +284,15 @@ public:
 	bool m_simulationJumpToCurrent = true;
 	bool m_autoRunSimulation = false;
 	std::deque<CountryInstruction*> m_instructionQueue;
-	std::vector<HistoryData*> m_historyData;
+	std::vector<std::vector<CountryInstruction*>> m_countryInstructionBuffers; // this month's plans of m_countries[i], queued in country order
+	// month end scratch of m_mapPolygonUnits[i]
+	std::vector<float> m_provinceGrowthRolls;
+	std::vector<int> m_provincePopulationMovedOut;
+	std::vector<MapPolygonUnit*> m_provinceSpreadTargets;
+	std::vector<HistoryData*> m_historyData; // cache of the months within MAX_SAVE_MONTH of the viewing month, nullptr for the others
+	HistoryTimeline* m_historyTimeline = nullptr; // every recorded month
+	std::vector<PrefetchHistoryJob*> m_historyPrefetchJobs;
+	std::vector<HistoryData*> m_historyDataPool; // evicted months kept for RecordHistory to record into again
 	std::vector<HistoryCrisis*> m_crisis;
 
 	static const unsigned int INVALID_ARMY_ID = (unsigned int)-1;
@@ -264,9 +300,9 @@ public:
 
 	Strings m_historyLog;
 	std::string m_generationLog;
+	std::vector<std::pair<std::string, double>> m_generationStageSeconds; // stage name and seconds of each Startup stage
 	//std::string m_runTimeLog;
 
-	std::mutex m_saveLoadMutex;
 
 	HistorySavingSolver* m_historySavingModule = nullptr;
 	SaveHistoryJob* m_saveHistoryJob = nullptr;
@@ -289,9 +325,18 @@ protected:
 	void ExecuteInstruction( CountryInstruction const* instr );
 	void MapEndTurn();
 	void RecordHistory();
+	HistoryData* AcquireHistoryData();
+	void ReleaseHistoryData( HistoryData* data );
 	void UpdateColorfulMaps();
+	void SetAllPolygonsRenderColor( void (MapPolygonUnit::* setRenderColorFunction)() );
+	/// paint every province with its cached color of the mode, refreshColors updates the simulated colors first
+	void SetAllPolygonsRenderColor( ProvinceColorMode mode, bool refreshColors = true );
+	/// update the cached colors of all view modes, return how many provinces changed owner, culture, religion or population band
+	int RefreshProvinceModeColors( bool refreshAll = false );
 	void ReadHistoryCache( HistoryData const& data );
 	void RearrangeHistoryCache();
+	void RetrieveHistoryPrefetchJobs();
+	bool IsHistoryMonthPrefetching( int monthIndex ) const;
 	bool DoHistoryExist( int year, int month ) const;
 	void ProcessHistoryCrisis();
 	void AddNewCrisisToList( HistoryCrisis* crisis );
@@ -316,8 +361,13 @@ protected:
 	void ConnectCountries();
 	void GenerateProvinceProducts();
 	void GenerateRegions();
+	/// regions are the land clusters of the hierarchical routes, water is grouped by the helper
+	/// only army moves use those routes, roads and distances keep the exact search
+	void BuildRouteHierarchy();
 	void GenerateRoads();
 	void GenerateArmies();
+	void BuildProvinceGrid();
+	MapPolygonUnit* GetUnitByPosLinearScan( Vec2 const& pos, bool fast ) const;
 	void GenerateVertexBuffers();
 	void InitializeLabels();
 
@@ -340,7 +390,7 @@ protected:
 	void DebugCompareHistory( HistoryData const& prev, HistoryData const& cur ) const;
 	
 	// populate map stage helper functions
-	void PM_AddEdgeToPolygonUnit( MapPolygonUnit* polygonUnit, FortuneHalfEdge* edge );
+	void PM_AddEdgeToPolygonUnit( MapPolygonUnit* polygonUnit, VoronoiDiagram const& diagram, int halfEdgeIndex, std::vector<StarEdge*>& starEdges );
 	VertexBuffer* m_polygonsEdgesVertexBuffer = nullptr;
 	IndexBuffer* m_polygonEdgesIndexBuffer = nullptr;
 	VertexBuffer* m_polygonsEdgesVertexBuffer3D = nullptr;
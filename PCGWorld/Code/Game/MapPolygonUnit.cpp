@@ -469,78 +469,22 @@ void MapPolygonUnit::SetRenderNoColor()
 
 void MapPolygonUnit::SetRenderHeightColor()
 {
-	Map* map = GetCurMap();
-	float seaLevel = map->m_seaLevel;
-	if (IsWater()) {
-		SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestOceanHeightColor, map->m_renderPreference.m_highestOceanHeightColor, RangeMapClamped( m_height, GetCurMap()->m_generationSettings.m_minHeight, seaLevel, 0.f, 1.f ) ) );
-	}
-	else {
-		SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestLandHeightColor, map->m_renderPreference.m_highestLandHeightColor, RangeMapClamped( m_height, seaLevel, GetCurMap()->m_generationSettings.m_maxHeight, 0.f, 1.f ) ) );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Height );
 }
 
 void MapPolygonUnit::SetRenderClimateColor()
 {
-	if (IsOcean()) {
-		Map* map = GetCurMap();
-		SetColorOfPolygonFace( map->m_renderPreference.m_oceanColor );
-		return;
-	}
-	SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_climateColorMap[(int)m_climate] );
+	SetRenderFreshModeColor( ProvinceColorMode::Climate );
 }
 
 void MapPolygonUnit::SetRenderPrecipitationColor( bool summer )
 {
-	Map* map = GetCurMap();
-	if (IsWater()) {
-		SetColorOfPolygonFace( map->m_renderPreference.m_oceanColor );
-		return;
-	}
-	if (summer) {
-		if (m_latitude < 0.f) {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestPrecipitationColor, map->m_renderPreference.m_highestPrecipitationColor, RangeMapClamped( m_summerPrecipitation, 0.f, 2000.f, 0.f, 1.f ) ) );
-		}
-		else {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestPrecipitationColor, map->m_renderPreference.m_highestPrecipitationColor, RangeMapClamped( m_winterPrecipitation, 0.f, 2000.f, 0.f, 1.f ) ) );
-		}
-	}
-	else {
-		if (m_latitude < 0.f) {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestPrecipitationColor, map->m_renderPreference.m_highestPrecipitationColor, RangeMapClamped( m_winterPrecipitation, 0.f, 2000.f, 0.f, 1.f ) ) );
-
-		}
-		else {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestPrecipitationColor, map->m_renderPreference.m_highestPrecipitationColor, RangeMapClamped( m_summerPrecipitation, 0.f, 2000.f, 0.f, 1.f ) ) );
-
-		}
-	}
+	SetRenderFreshModeColor( summer ? ProvinceColorMode::SummerPrecipitation : ProvinceColorMode::WinterPrecipitation );
 }
 
 void MapPolygonUnit::SetRenderTemperatureColor( bool summer )
 {
-	Map* map = GetCurMap();
-	if (IsWater()) {
-		SetColorOfPolygonFace( map->m_renderPreference.m_oceanColor );
-		return;
-	}
-	if (summer) {
-		if (m_latitude < 0.f) {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestTemperatureColor, map->m_renderPreference.m_highestTemperatureColor, RangeMapClamped( m_summerAvgTemperature, -10.f, 30.f, 0.f, 1.f ) ) );
-
-		}
-		else {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestTemperatureColor, map->m_renderPreference.m_highestTemperatureColor, RangeMapClamped( m_winterAvgTemperature, -10.f, 30.f, 0.f, 1.f ) ) );
-
-		}
-	}
-	else {
-		if (m_latitude < 0.f) {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestTemperatureColor, map->m_renderPreference.m_highestTemperatureColor, RangeMapClamped( m_winterAvgTemperature, -10.f, 30.f, 0.f, 1.f ) ) );
-		}
-		else {
-			SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestTemperatureColor, map->m_renderPreference.m_highestTemperatureColor, RangeMapClamped( m_summerAvgTemperature, -10.f, 30.f, 0.f, 1.f ) ) );
-		}
-	}
+	SetRenderFreshModeColor( summer ? ProvinceColorMode::SummerTemperature : ProvinceColorMode::WinterTemperature );
 }
 
 void MapPolygonUnit::SetRenderViewingColor( bool isViewing )
@@ -564,85 +508,42 @@ void MapPolygonUnit::SetRenderViewingColor( bool isViewing )
 
 void MapPolygonUnit::SetRenderLandformColor()
 {
-	SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_landformColorMap[(int)m_landform] );
+	SetRenderFreshModeColor( ProvinceColorMode::Landform );
 }
 
 void MapPolygonUnit::SetRenderPopulationColor()
 {
-	Map* map = GetCurMap();
-	if (IsWater()) {
-		SetColorOfPolygonFace( map->m_renderPreference.m_oceanColor );
-	}
-	else {
-		SetColorOfPolygonFace( Rgba8::Interpolate( map->m_renderPreference.m_lowestPopulationColor, map->m_renderPreference.m_highestPopulationColor, RangeMapClamped( (float)m_totalPopulation, 0.f, 80000.f, 0.f, 1.f ) ) );
-		//SetColorOfPolygonFace( Rgba8::Interpolate( Rgba8( 90, 25, 50 ), Rgba8( 50, 255, 50 ), RangeMapClamped( (float)m_totalPopulation, 0.f, 30000.f, 0.f, 1.f ) ) );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Population );
 }
 
 void MapPolygonUnit::SetRenderCultureColor()
 {
-	if (IsWater()) {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_oceanColor );
-	}
-	else if (m_majorCulture) {
-		SetColorOfPolygonFace( m_majorCulture->m_color );
-	}
-	else {
-		SetColorOfPolygonFace( Rgba8( 0, 0, 0 ) );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Culture );
 }
 
 void MapPolygonUnit::SetRenderReligionColor()
 {
-	if (IsWater()) {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_oceanColor );
-	}
-	else if (m_majorCulture) {
-		SetColorOfPolygonFace( m_majorReligion->m_color );
-	}
-	else {
-		SetColorOfPolygonFace( Rgba8( 0, 0, 0 ) );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Religion );
 }
 
 void MapPolygonUnit::SetRenderContinentColor()
 {
-	if (m_continent) {
-		SetColorOfPolygonFace( m_continent->m_color );
-	}
-	else {
-		SetColorOfPolygonFace( Rgba8( 48, 48, 48 ) );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Continent );
 }
 
 void MapPolygonUnit::SetRenderProductColor()
 {
-	if (m_productType == ProductType::None) {
-		SetColorOfPolygonFace( Rgba8( 48, 48, 48 ) );
-	}
-	else {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_productColorMap[(int)m_productType] );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Product );
 }
 
 void MapPolygonUnit::SetRenderCountryColor()
 {
-	if (m_owner == nullptr) {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_oceanColor );
-	}
-	else {
-		SetColorOfPolygonFace( m_owner->m_color );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Country );
 }
 
 void MapPolygonUnit::SetRenderRegionColor()
 {
-	if (m_region == nullptr) {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_oceanColor );
-	}
-	else {
-		SetColorOfPolygonFace( m_region->m_color );
-	}
+	SetRenderFreshModeColor( ProvinceColorMode::Region );
 }
 
 void MapPolygonUnit::SetRenderRelationColor()
@@ -666,21 +567,154 @@ void MapPolygonUnit::SetRenderRelationColor()
 
 void MapPolygonUnit::SetRenderProvEditColor()
 {
-	if (m_owner == nullptr) {
-		SetColorOfPolygonFace( GetCurMap()->m_renderPreference.m_oceanColor );
+	SetRenderFreshModeColor( ProvinceColorMode::Country );
+}
+
+void MapPolygonUnit::SetRenderModeColor( ProvinceColorMode mode )
+{
+	SetColorOfPolygonFace( m_modeColors[(int)mode] );
+}
+
+void MapPolygonUnit::SetRenderFreshModeColor( ProvinceColorMode mode )
+{
+	// whoever calls this may just have edited the province, so the cache is brought up to date too
+	m_modeColors[(int)mode] = CalculateModeColor( mode );
+	SetColorOfPolygonFace( m_modeColors[(int)mode] );
+}
+
+bool MapPolygonUnit::RefreshModeColors( bool refreshAll )
+{
+	if (refreshAll || !m_hasStaticModeColors) {
+		for (int i = 0; i < (int)ProvinceColorMode::FIRST_SIMULATED; i++) {
+			m_modeColors[i] = CalculateModeColor( (ProvinceColorMode)i );
+		}
+		m_hasStaticModeColors = true;
 	}
-	else {
-		SetColorOfPolygonFace( m_owner->m_color );
+	// the simulated colors are compared instead of the owner/culture/religion pointers,
+	// so a country taking over another one's color or a recycled pointer is still noticed
+	bool hasChanged = refreshAll;
+	int populationBand = GetPopulationColorBand();
+	if (refreshAll || populationBand != m_populationColorBand) {
+		m_populationColorBand = populationBand;
+		m_modeColors[(int)ProvinceColorMode::Population] = CalculateModeColor( ProvinceColorMode::Population );
+		hasChanged = true;
+	}
+	for (int i = (int)ProvinceColorMode::Culture; i < (int)ProvinceColorMode::NUM; i++) {
+		Rgba8 color = CalculateModeColor( (ProvinceColorMode)i );
+		if (color != m_modeColors[i]) {
+			m_modeColors[i] = color;
+			hasChanged = true;
+		}
+	}
+	return hasChanged;
+}
+
+int MapPolygonUnit::GetPopulationColorBand() const
+{
+	if (IsWater()) {
+		return -1;
+	}
+	return GetClamped( (int)RangeMapClamped( (float)m_totalPopulation, 0.f, 80000.f, 0.f, (float)NUM_OF_POPULATION_COLOR_BANDS ), 0, NUM_OF_POPULATION_COLOR_BANDS - 1 );
+}
+
+Rgba8 MapPolygonUnit::CalculateModeColor( ProvinceColorMode mode ) const
+{
+	Map* map = GetCurMap();
+	MapRenderingPreference const& preference = map->m_renderPreference;
+	switch (mode) {
+	case ProvinceColorMode::Height:
+		if (IsWater()) {
+			return Rgba8::Interpolate( preference.m_lowestOceanHeightColor, preference.m_highestOceanHeightColor, RangeMapClamped( m_height, map->m_generationSettings.m_minHeight, map->m_seaLevel, 0.f, 1.f ) );
+		}
+		return Rgba8::Interpolate( preference.m_lowestLandHeightColor, preference.m_highestLandHeightColor, RangeMapClamped( m_height, map->m_seaLevel, map->m_generationSettings.m_maxHeight, 0.f, 1.f ) );
+	case ProvinceColorMode::Climate:
+		if (IsOcean()) {
+			return preference.m_oceanColor;
+		}
+		return preference.m_climateColorMap[(int)m_climate];
+	case ProvinceColorMode::SummerPrecipitation:
+	case ProvinceColorMode::WinterPrecipitation: {
+		if (IsWater()) {
+			return preference.m_oceanColor;
+		}
+		// the two hemispheres have their summer at opposite ends of the year
+		bool useSummerValue = (mode == ProvinceColorMode::SummerPrecipitation) == (m_latitude < 0.f);
+		float precipitation = useSummerValue ? m_summerPrecipitation : m_winterPrecipitation;
+		return Rgba8::Interpolate( preference.m_lowestPrecipitationColor, preference.m_highestPrecipitationColor, RangeMapClamped( precipitation, 0.f, 2000.f, 0.f, 1.f ) );
+	}
+	case ProvinceColorMode::SummerTemperature:
+	case ProvinceColorMode::WinterTemperature: {
+		if (IsWater()) {
+			return preference.m_oceanColor;
+		}
+		bool useSummerValue = (mode == ProvinceColorMode::SummerTemperature) == (m_latitude < 0.f);
+		float temperature = useSummerValue ? m_summerAvgTemperature : m_winterAvgTemperature;
+		return Rgba8::Interpolate( preference.m_lowestTemperatureColor, preference.m_highestTemperatureColor, RangeMapClamped( temperature, -10.f, 30.f, 0.f, 1.f ) );
+	}
+	case ProvinceColorMode::Landform:
+		return preference.m_landformColorMap[(int)m_landform];
+	case ProvinceColorMode::Continent:
+		if (m_continent) {
+			return m_continent->m_color;
+		}
+		return Rgba8( 48, 48, 48 );
+	case ProvinceColorMode::Product:
+		if (m_productType == ProductType::None) {
+			return Rgba8( 48, 48, 48 );
+		}
+		return preference.m_productColorMap[(int)m_productType];
+	case ProvinceColorMode::Region:
+		if (m_region == nullptr) {
+			return preference.m_oceanColor;
+		}
+		return m_region->m_color;
+	case ProvinceColorMode::Population: {
+		if (IsWater()) {
+			return preference.m_oceanColor;
+		}
+		// drawn by bands so a province only needs recoloring when it moves to another band
+		float bandFraction = (float)GetPopulationColorBand() / (float)(NUM_OF_POPULATION_COLOR_BANDS - 1);
+		return Rgba8::Interpolate( preference.m_lowestPopulationColor, preference.m_highestPopulationColor, bandFraction );
+	}
+	case ProvinceColorMode::Culture:
+		if (IsWater()) {
+			return preference.m_oceanColor;
+		}
+		if (m_majorCulture) {
+			return m_majorCulture->m_color;
+		}
+		return Rgba8( 0, 0, 0 );
+	case ProvinceColorMode::Religion:
+		if (IsWater()) {
+			return preference.m_oceanColor;
+		}
+		if (m_majorReligion) {
+			return m_majorReligion->m_color;
+		}
+		return Rgba8( 0, 0, 0 );
+	case ProvinceColorMode::Country:
+		if (m_owner == nullptr) {
+			return preference.m_oceanColor;
+		}
+		return m_owner->m_color;
+	default:
+		ERROR_RECOVERABLE( "Province color mode has no color" );
+		return Rgba8::WHITE;
 	}
 }
 
 void MapPolygonUnit::SetColorOfPolygonFace( Rgba8 color )
 {
+	// the array is only touched when the color really changes, so Map::UpdateBufferColors only uploads what changed
+	if (color == m_curColor) {
+		return;
+	}
+	std::vector<Rgba8>& colorVertexArray = GetCurMap()->m_colorVertexArray;
 	for (size_t i = m_startInVertexBuffer; i < m_startInVertexBuffer + m_sizeInVertexBuffer; i++) {
-		GetCurMap()->m_colorVertexArray[i] = color;
+		colorVertexArray[i] = color;
 	}
 	m_curColor = color;
-	//m_isColorDirty = true;
+	m_isColorDirty = true;
 }
 
 float MapPolygonUnit::EvaluateProvinceArmyScore()
@@ -1595,11 +1629,11 @@ void MapPolygonUnit::CalculateMetalProduct()
 	}
 }
 
-void MapPolygonUnit::GrowPopulationOneMonth()
+int MapPolygonUnit::GrowPopulationOneMonth( float epidemicRoll )
 {
 	int numOfGrowth = 0;
 	float epidemicValue = 0.f;
-	if (GetCurMap()->m_historyRNG->RollRandomFloatZeroToOne() < 0.06f) {
+	if (epidemicRoll < 0.06f) {
 		epidemicValue = -0.002f;
 	}
 	float ratio = SmoothStop2( RangeMapClamped( (float)m_totalPopulation, 0.f, 100000.f, 1.f, 0.1f ) );
@@ -1649,6 +1683,18 @@ void MapPolygonUnit::GrowPopulationOneMonth()
 		m_totalPopulation += numOfGrowth;
 	}
 
+	int populationMovedOut = int( m_totalPopulation * 0.0003f * (1.f - ratio) );
+	if (populationMovedOut == 0) {
+		populationMovedOut = 1;
+	}
+	/*m_owner->m_totalPopulation += numOfGrowth;
+	m_owner->AddCulturePopulation( numOfGrowth, m_cultures );
+	m_owner->AddReligionPopulation( numOfGrowth, m_religions );*/
+	return populationMovedOut;
+}
+
+MapPolygonUnit* MapPolygonUnit::GetPopulationSpreadTarget( int& inout_populationMovedOut ) const
+{
 	// spread population
 	MapPolygonUnit* minPopulationProv = nullptr;
 	int minPopulation = INT_MAX;
@@ -1659,19 +1705,13 @@ void MapPolygonUnit::GrowPopulationOneMonth()
 		}
 	}
 	if (minPopulationProv && minPopulation < 30000 && m_totalPopulation / minPopulation > 5) {
-		int populationMovedOut = int( m_totalPopulation * 0.0003f * (1.f - ratio) );
-		if (populationMovedOut == 0) {
-			populationMovedOut = 1;
-		}
-		if (populationMovedOut >= m_totalPopulation) {
-			populationMovedOut = m_totalPopulation - 1;
+		if (inout_populationMovedOut >= m_totalPopulation) {
+			inout_populationMovedOut = m_totalPopulation - 1;
 		}
-		m_totalPopulation -= populationMovedOut;
-		minPopulationProv->m_totalPopulation += populationMovedOut;
+		return minPopulationProv;
 	}
-	/*m_owner->m_totalPopulation += numOfGrowth;
-	m_owner->AddCulturePopulation( numOfGrowth, m_cultures );
-	m_owner->AddReligionPopulation( numOfGrowth, m_religions );*/
+	inout_populationMovedOut = 0;
+	return nullptr;
 }
 
 bool MapPolygonUnit::IsBeingSieged() const
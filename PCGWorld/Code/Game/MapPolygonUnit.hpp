@@ -107,6 +107,30 @@ enum class ProductType {
 	Num,
 };
 
+// the view modes a province keeps a precalculated color for, see MapPolygonUnit::RefreshModeColors
+// relation is not one of them because it depends on the province being viewed
+enum class ProvinceColorMode {
+	Height,
+	Climate,
+	SummerPrecipitation,
+	WinterPrecipitation,
+	SummerTemperature,
+	WinterTemperature,
+	Landform,
+	Continent,
+	Product,
+	Region,
+	// the ones below change while the history is simulated
+	Population,
+	Culture,
+	Religion,
+	Country,
+	NUM,
+	FIRST_SIMULATED = Population,
+};
+
+constexpr int NUM_OF_POPULATION_COLOR_BANDS = 32;
+
 #define Prov_Dirty_Flag_Populaton			0x0001
 #define Prov_Dirty_Flag_Major_Culture		0x0002
 #define Prov_Dirty_Flag_Cultures			0x0004
@@ -180,7 +204,15 @@ public:
 	void SetRenderRegionColor();
 	void SetRenderRelationColor();
 	void SetRenderProvEditColor();
-
+	/// paint the color cached by RefreshModeColors
+	void SetRenderModeColor( ProvinceColorMode mode );
+	/// update the cached view mode colors, the geographic ones are only calculated the first time or with refreshAll
+	/// return true if the owner, culture or religion color or the population band changed since the last call
+	bool RefreshModeColors( bool refreshAll = false );
+	Rgba8 CalculateModeColor( ProvinceColorMode mode ) const;
+	int GetPopulationColorBand() const;
+
+	/// write the color into the map's color array and mark the province for upload if it changed
 	void SetColorOfPolygonFace( Rgba8 color );
 
 	float EvaluateProvinceArmyScore();
@@ -212,7 +244,10 @@ public:
 	void CalculateMetalProduct();
 
 	// simulation
-	void GrowPopulationOneMonth();
+	/// grow the province's own population, epidemicRoll is its [0,1) roll of the month; returns how many people are ready to move out
+	int GrowPopulationOneMonth( float epidemicRoll );
+	/// the least crowded neighbour the people move to after every province grew, nullptr if none; clamps inout_populationMovedOut
+	MapPolygonUnit* GetPopulationSpreadTarget( int& inout_populationMovedOut ) const;
 	bool IsBeingSieged() const;
 	bool IsConnectedByRoad( MapPolygonUnit* other ) const;
 	void RemoveUnqualifiedLegitimateCountry();
@@ -282,7 +317,7 @@ public:
 
 	bool m_developmentFlag = false;
 	bool m_warFlag = false;
-	//bool m_isColorDirty = true;
+	bool m_isColorDirty = false;
 	//bool m_isColorDirty2 = false;
 
 	uint16_t m_dirtyBits = 0xffff;
@@ -295,7 +330,11 @@ protected:
 	void CalculateTemperature();
 	void SetLandform();
 	float GetDistanceToSeaFromThisUnit( Vec2 const& pos ) const;
+	void SetRenderFreshModeColor( ProvinceColorMode mode );
 	Rgba8 m_curColor = Rgba8::WHITE;
 	Rgba8 m_colorBeforeClick = Rgba8::WHITE;
+	Rgba8 m_modeColors[(int)ProvinceColorMode::NUM];
+	bool m_hasStaticModeColors = false;
+	int m_populationColorBand = -2;
 
 };
\ No newline at end of file
@@ -0,0 +1,438 @@
+#define WIN32_LEAN_AND_MEAN		// Always #define this before #including <windows.h>
+#include <windows.h>			// #include this (massive, platform-specific) header in VERY few places (and .CPPs only)
+#include <psapi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <filesystem>
+#include <atomic>
+#include <new>
+#include "Game/Game.hpp"
+#include "Game/Map.hpp"
+#include "Game/Army.hpp"
+#include "Game/City.hpp"
+#include "Game/Country.hpp"
+#include "Game/CountryInstructions.hpp"
+#include "Game/Culture.hpp"
+#include "Game/Religion.hpp"
+#include "Engine/Core/XmlUtils.hpp"
+#include "Engine/Core/StringUtils.hpp"
+
+#pragma comment( lib, "Psapi.lib" )
+
+// headless batch runner: generate a world from the command line, simulate some years, print where the time and memory went
+// usage: PCGWorldCmd [Settings=GenerationSettings.xml] [Seed=N] [PolygonAmount=N] [NumOfCultures=N] ... [Years=N] [Workers=N]
+//        [ProvinceGrid=0] generates with linear scans instead of the province grid, [PickingQueries=N] point queries to time after generation
+// every other key is read like an attribute of a saved GenerationSettings.xml and overrides the file
+
+// no window, renderer, input or audio in this target, the game code only sees them as nullptr
+App* g_theApp = nullptr;
+Game* g_theGame = nullptr;
+Renderer* g_theRenderer = nullptr;
+InputSystem* g_theInput = nullptr;
+AudioSystem* g_theAudio = nullptr;
+Window* g_window = nullptr;
+BitmapFont* g_ASCIIFont = nullptr;
+
+// every allocation of the runner goes through here so the snapshot measurement can count them
+static std::atomic<uint64_t> g_numOfAllocations = 0;
+
+void* operator new( size_t size )
+{
+	++g_numOfAllocations;
+	void* memory = malloc( size > 0 ? size : 1 );
+	if (memory == nullptr) {
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+void operator delete( void* memory ) noexcept
+{
+	free( memory );
+}
+
+void operator delete( void* memory, size_t ) noexcept
+{
+	free( memory );
+}
+
+static void PrintPeakMemory( char const* when )
+{
+	PROCESS_MEMORY_COUNTERS counters = {};
+	counters.cb = sizeof( counters );
+	if (GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) )) {
+		printf( "peak memory %s: working set %.1f MB, committed %.1f MB\n", when,
+			(double)counters.PeakWorkingSetSize / (1024.0 * 1024.0), (double)counters.PeakPagefileUsage / (1024.0 * 1024.0) );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+// The snapshot before the column tables, kept as it was so MeasureHistorySnapshots compares against what RecordHistory used to do:
+// one struct per entry, each with its own culture, religion and relation lists, and a new snapshot every month
+struct BaselineHistoryProvinceData {
+	bool m_isWater = false;
+	int m_population = 0;
+	std::vector<std::pair<int, float>> m_cultures;
+	std::vector<std::pair<int, float>> m_religions;
+	int m_ownerCountryID = -1;
+	std::vector<int> m_legalCountriesID;
+};
+
+struct BaselineHistoryCountryData {
+	bool m_exist = true;
+	int m_funds = 0;
+	int m_countryCultureID = -1;
+	int m_capitalProvID = -1;
+	int m_countryReligionID = -1;
+	int m_capitalCityID = -1;
+	std::vector<int> m_friendlyCountriesID;
+	std::vector<int> m_allianceCountriesID;
+	std::vector<int> m_hostileCountriesID;
+	std::vector<std::pair<int, int>> m_warCountriesID;
+	int m_suzerainCountryID = -1;
+	std::vector<int> m_vassalCountriesID;
+	int m_celestialCountryID = -1;
+	std::vector<int> m_tributaryCountriesID;
+	bool m_isCelestial = false;
+	int m_governmentType = (int)CountryGovernmentType::None;
+};
+
+struct BaselineHistoryArmyData {
+	BaselineHistoryArmyData( int size, float combatValue, int provInID, int globalID, int ownerID, int targetProvID )
+		:m_size(size), m_combatValue(combatValue), m_provInID(provInID), m_globalID(globalID), m_ownerID(ownerID), m_targetProvID(targetProvID)
+	{
+	}
+	int m_size = 0;
+	float m_combatValue = 0.5f;
+	int m_provInID = -1;
+	int m_globalID = -1;
+	int m_ownerID = -1;
+	int m_targetProvID = -1;
+};
+
+struct BaselineHistoryTownData {
+	int m_population = 0;
+	std::vector<std::pair<int, float>> m_cultures;
+	std::vector<std::pair<int, float>> m_religions;
+	int m_ownerID = -1;
+	float m_defenseValue = 0.f;
+};
+
+struct BaselineHistoryCityData : public BaselineHistoryTownData {
+	uint16_t m_type = 0;
+};
+
+struct BaselineHistoryCrisisData {
+	int m_type = 3;
+	float m_progress = 0.f;
+	int m_countryID = -1;
+	int m_cultureOrReligionID = -1;
+	unsigned int m_globalID = (unsigned int)-1;
+};
+
+struct BaselineHistoryData {
+	BaselineHistoryData( Map* map );
+	std::vector<BaselineHistoryProvinceData> m_provinceData;
+	std::vector<BaselineHistoryCountryData> m_countryData;
+	std::vector<BaselineHistoryArmyData> m_armyData;
+	std::vector<BaselineHistoryCityData> m_cityData;
+	std::vector<BaselineHistoryTownData> m_townData;
+	std::vector<BaselineHistoryCrisisData> m_crisisData;
+};
+
+BaselineHistoryData::BaselineHistoryData( Map* map )
+{
+	m_provinceData.resize( map->m_mapPolygonUnits.size() );
+	for (int i = 0; i < (int)map->m_mapPolygonUnits.size(); i++) {
+		Province* prov = map->m_mapPolygonUnits[i];
+		if (prov->IsWater()) {
+			m_provinceData[i].m_isWater = true;
+		}
+		else {
+			m_provinceData[i].m_isWater = false;
+			if (prov->m_owner) {
+				m_provinceData[i].m_ownerCountryID = prov->m_owner->m_id;
+			}
+			else {
+				m_provinceData[i].m_ownerCountryID = -1;
+			}
+			m_provinceData[i].m_population = prov->m_totalPopulation;
+			m_provinceData[i].m_cultures.resize( prov->m_cultures.size() );
+			for (int j = 0; j < (int)prov->m_cultures.size(); ++j) {
+				m_provinceData[i].m_cultures[j] = std::pair<int, float>( prov->m_cultures[j].first->m_id, prov->m_cultures[j].second );
+			}
+			m_provinceData[i].m_religions.resize( prov->m_religions.size() );
+			for (int j = 0; j < (int)prov->m_religions.size(); ++j) {
+				m_provinceData[i].m_religions[j] = std::pair<int, float>( prov->m_religions[j].first->m_id, prov->m_religions[j].second );
+			}
+			for (int j = 0; j < (int)prov->m_legitimateCountries.size(); ++j) {
+				m_provinceData[i].m_legalCountriesID.push_back( prov->m_legitimateCountries[j]->m_id );
+			}
+		}
+	}
+	m_cityData.resize( map->m_cities.size() );
+	for (int i = 0; i < (int)map->m_cities.size(); i++) {
+		City* city = map->m_cities[i];
+		m_cityData[i].m_population = city->m_totalPopulation;
+		m_cityData[i].m_cultures.resize( city->m_cultures.size() );
+		for (int j = 0; j < (int)city->m_cultures.size(); ++j) {
+			m_cityData[i].m_cultures[j] = std::pair<int, float>( city->m_cultures[j].first->m_id, city->m_cultures[j].second );
+		}
+		m_cityData[i].m_religions.resize( city->m_religions.size() );
+		for (int j = 0; j < (int)city->m_religions.size(); ++j) {
+			m_cityData[i].m_religions[j] = std::pair<int, float>( city->m_religions[j].first->m_id, city->m_religions[j].second );
+		}
+		m_cityData[i].m_defenseValue = city->m_defense;
+		m_cityData[i].m_ownerID = city->m_owner->m_id;
+		m_cityData[i].m_type = city->GetRawAttribute();
+	}
+	m_townData.resize( map->m_towns.size() );
+	for (int i = 0; i < (int)map->m_towns.size(); i++) {
+		Town* town = map->m_towns[i];
+		m_townData[i].m_population = town->m_totalPopulation;
+		m_townData[i].m_cultures.resize( town->m_cultures.size() );
+		for (int j = 0; j < (int)town->m_cultures.size(); ++j) {
+			m_townData[i].m_cultures[j] = std::pair<int, float>( town->m_cultures[j].first->m_id, town->m_cultures[j].second );
+		}
+		m_townData[i].m_religions.resize( town->m_religions.size() );
+		for (int j = 0; j < (int)town->m_religions.size(); ++j) {
+			m_townData[i].m_religions[j] = std::pair<int, float>( town->m_religions[j].first->m_id, town->m_religions[j].second );
+		}
+		m_townData[i].m_defenseValue = town->m_defense;
+		m_townData[i].m_ownerID = town->m_owner->m_id;
+	}
+	m_countryData.resize( map->m_countries.size() );
+	for (int i = 0; i < (int)map->m_countries.size(); i++) {
+		Country* country = map->m_countries[i];
+		m_countryData[i].m_exist = country->IsExist();
+		if (!m_countryData[i].m_exist) {
+			continue;
+		}
+		if (country->m_capitalCity) {
+			m_countryData[i].m_capitalCityID = country->m_capitalCity->m_id;
+		}
+		else {
+			m_countryData[i].m_capitalCityID = -1;
+		}
+		if (country->m_capitalProv) {
+			m_countryData[i].m_capitalProvID = country->m_capitalProv->m_id;
+		}
+		else {
+			m_countryData[i].m_capitalProvID = -1;
+		}
+		for (auto iterCountry : country->m_relationAllianceCountries) {
+			m_countryData[i].m_allianceCountriesID.push_back( iterCountry->m_id );
+		}
+		for (auto iterCountry : country->m_relationFriendlyCountries) {
+			m_countryData[i].m_friendlyCountriesID.push_back( iterCountry->m_id );
+		}
+		for (auto iterCountry : country->m_relationHostileCountries) {
+			m_countryData[i].m_hostileCountriesID.push_back( iterCountry->m_id );
+		}
+		for (auto iterCountry : country->m_relationWarCountries) {
+			m_countryData[i].m_warCountriesID.push_back( std::pair<int, int>( iterCountry->m_id, country->GetWarTimeWith( iterCountry ) ) );
+		}
+		for (auto iterCountry : country->m_relationTributaries) {
+			m_countryData[i].m_tributaryCountriesID.push_back( iterCountry->m_id );
+		}
+		for (auto iterCountry : country->m_relationVassals) {
+			m_countryData[i].m_vassalCountriesID.push_back( iterCountry->m_id );
+		}
+		m_countryData[i].m_isCelestial = country->m_isCelestial;
+		if (country->m_relationCelestialEmpire) {
+			m_countryData[i].m_celestialCountryID = country->m_relationCelestialEmpire->m_id;
+		}
+		if (country->m_relationSuzerain) {
+			m_countryData[i].m_suzerainCountryID = country->m_relationSuzerain->m_id;
+		}
+		m_countryData[i].m_funds = country->m_funds;
+		m_countryData[i].m_countryCultureID = country->m_countryCulture->m_id;
+		m_countryData[i].m_countryReligionID = country->m_countryReligion->m_id;
+		m_countryData[i].m_governmentType = (int)country->m_governmentType;
+	}
+	for (auto country : map->m_countries) {
+		for (int i = 0; i < (int)country->m_armies.size(); i++) {
+			Army* army = country->m_armies[i];
+			if (army->m_goingTarget) {
+				m_armyData.emplace_back( army->m_size, army->m_combatValue, army->m_provIn->m_id, army->m_globalID, army->m_owner->m_id, army->m_goingTarget->m_id );
+			}
+			else {
+				m_armyData.emplace_back( army->m_size, army->m_combatValue, army->m_provIn->m_id, army->m_globalID, army->m_owner->m_id, -1 );
+			}
+		}
+	}
+	std::vector<HistoryCrisis*> copyedCrisisList;
+	for (auto crisis : map->m_crisis) {
+		if (crisis) {
+			copyedCrisisList.push_back( crisis );
+		}
+	}
+	m_crisisData.resize( copyedCrisisList.size() );
+	for (int i = 0; i < (int)copyedCrisisList.size(); ++i) {
+		HistoryCrisis* crisis = copyedCrisisList[i];
+		m_crisisData[i].m_countryID = crisis->m_country->m_id;
+		m_crisisData[i].m_type = (int)crisis->m_type;
+		if (crisis->m_type == CrisisType::CultureConflict) {
+			m_crisisData[i].m_cultureOrReligionID = ((Culture*)crisis->m_cultureOrReligion)->m_id;
+		}
+		else if (crisis->m_type == CrisisType::ReligionConflict) {
+			m_crisisData[i].m_cultureOrReligionID = ((Religion*)crisis->m_cultureOrReligion)->m_id;
+		}
+		m_crisisData[i].m_globalID = crisis->m_globalID;
+		m_crisisData[i].m_progress = crisis->m_progress;
+	}
+}
+
+// the snapshot step of RecordHistory, before and after the column tables: the old per-entry structs in a new snapshot every month,
+// the column tables in a new snapshot, and the column tables recorded again into a pooled snapshot as RecordHistory does now
+static void MeasureHistorySnapshots( Map* map )
+{
+	constexpr int numOfSnapshots = 50;
+	uint64_t allocationsBefore = g_numOfAllocations;
+	double startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfSnapshots; i++) {
+		BaselineHistoryData* data = new BaselineHistoryData( map );
+		delete data;
+	}
+	double seconds = GetCurrentTimeSeconds() - startTime;
+	printf( "%-28s %9.1f us, %.1f allocations\n", "History snapshot (baseline)", seconds * 1000000.0 / numOfSnapshots,
+		(double)(g_numOfAllocations - allocationsBefore) / numOfSnapshots );
+
+	allocationsBefore = g_numOfAllocations;
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfSnapshots; i++) {
+		HistoryData* data = new HistoryData( map );
+		delete data;
+	}
+	seconds = GetCurrentTimeSeconds() - startTime;
+	printf( "%-28s %9.1f us, %.1f allocations\n", "History snapshot (new)", seconds * 1000000.0 / numOfSnapshots,
+		(double)(g_numOfAllocations - allocationsBefore) / numOfSnapshots );
+
+	HistoryData pooledData( map );
+	allocationsBefore = g_numOfAllocations;
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfSnapshots; i++) {
+		pooledData.Record( map );
+	}
+	seconds = GetCurrentTimeSeconds() - startTime;
+	printf( "%-28s %9.1f us, %.1f allocations\n", "History snapshot (pooled)", seconds * 1000000.0 / numOfSnapshots,
+		(double)(g_numOfAllocations - allocationsBefore) / numOfSnapshots );
+
+	std::vector<uint8_t> bin;
+	pooledData.DumpToBinaryFormat( bin );
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfSnapshots; i++) {
+		pooledData.DumpToBinaryFormat( bin );
+	}
+	seconds = GetCurrentTimeSeconds() - startTime;
+	printf( "%-28s %9.1f us, %.1f KB\n", "History keyframe dump", seconds * 1000000.0 / numOfSnapshots, (double)bin.size() / 1024.0 );
+}
+
+//-----------------------------------------------------------------------------------------------
+int main( int argc, char** argv )
+{
+	MapGenerationSettings settings;
+	int numOfYears = 10;
+	int numOfWorkers = -1;
+	bool useProvinceGrid = true;
+	int numOfPickingQueries = 2000;
+
+	// the settings file goes first so the other keys can override it wherever they are
+	XmlDocument argDocument;
+	XmlElement* argElem = argDocument.NewElement( "GenerationSettings" );
+	for (int i = 1; i < argc; i++) {
+		Strings keyValue = SplitStringOnDelimiter( std::string( argv[i] ), '=' );
+		if ((int)keyValue.size() != 2) {
+			printf( "ignoring argument \"%s\", expected Key=Value\n", argv[i] );
+			continue;
+		}
+		if (keyValue[0] == "Settings") {
+			XmlDocument settingsDocument;
+			if (settingsDocument.LoadFile( keyValue[1].c_str() ) != tinyxml2::XML_SUCCESS || settingsDocument.RootElement() == nullptr) {
+				printf( "cannot load settings file \"%s\"\n", keyValue[1].c_str() );
+				return 1;
+			}
+			settings.PopulateFromXmlElementAttributes( *settingsDocument.RootElement() );
+		}
+		else if (keyValue[0] == "Years") {
+			numOfYears = atoi( keyValue[1].c_str() );
+		}
+		else if (keyValue[0] == "Workers") {
+			numOfWorkers = atoi( keyValue[1].c_str() );
+		}
+		else if (keyValue[0] == "ProvinceGrid") {
+			useProvinceGrid = atoi( keyValue[1].c_str() ) != 0;
+		}
+		else if (keyValue[0] == "PickingQueries") {
+			numOfPickingQueries = atoi( keyValue[1].c_str() );
+		}
+		else {
+			argElem->SetAttribute( keyValue[0].c_str(), keyValue[1].c_str() );
+		}
+	}
+	settings.PopulateFromXmlElementAttributes( *argElem );
+	settings.m_isHeadless = true;
+
+	std::filesystem::create_directory( "Saves" );
+	std::filesystem::create_directory( "Log" );
+	Clock::TickSystemClock();
+
+	JobSystemConfig jConfig;
+	jConfig.m_numOfWorkers = numOfWorkers;
+	g_theJobSystem = new JobSystem( jConfig );
+	g_theJobSystem->StartUp();
+
+	EventSystemConfig eConfig;
+	g_theEventSystem = new EventSystem( eConfig );
+	g_theEventSystem->Startup();
+
+	printf( "seed %u, %d base polygons, %.0fx%.0f, %d cultures, %d religions, %d workers\n", settings.m_seed, settings.m_basePolygons,
+		settings.m_dimensions.x, settings.m_dimensions.y, settings.m_numOfCultures, settings.m_numOfReligions, g_theJobSystem->GetWorkersCount() );
+
+	g_theGame = new Game();
+	g_theGame->m_map = new Map( settings );
+	Map* map = g_theGame->m_map;
+	map->m_useProvinceGrid = useProvinceGrid;
+	map->Startup();
+	for (auto const& stage : map->m_generationStageSeconds) {
+		printf( "%-28s %9.3f s\n", stage.first.c_str(), stage.second );
+	}
+	PrintPeakMemory( "after generation" );
+	map->m_useProvinceGrid = true;
+	if (numOfPickingQueries > 0) {
+		for (int i = 0; i < 2; i++) {
+			bool fast = i == 1;
+			double gridSeconds, linearSeconds, batchSeconds;
+			int numOfMismatches;
+			map->MeasureProvincePicking( numOfPickingQueries, fast, gridSeconds, linearSeconds, batchSeconds, numOfMismatches );
+			printf( "%-28s linear %.3f us, grid %.3f us, batch %.3f us per query, %d mismatches\n", fast ? "Point query (fast)" : "Point query (hover)",
+				linearSeconds * 1e6 / numOfPickingQueries, gridSeconds * 1e6 / numOfPickingQueries, batchSeconds * 1e6 / numOfPickingQueries, numOfMismatches );
+		}
+	}
+
+	if (numOfYears > 0 && settings.m_enableHistorySimulation) {
+		double startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < numOfYears * 12; i++) {
+			map->SimulateNextMonthWithoutRefresh();
+		}
+		double seconds = GetCurrentTimeSeconds() - startTime;
+		printf( "%-28s %9.3f s, %.2f years/s, %.2f ms/month, %d countries left\n", Stringf( "Simulating %d years", numOfYears ).c_str(), seconds,
+			(double)numOfYears / seconds, seconds * 1000.0 / (double)(numOfYears * 12), (int)map->m_countries.size() );
+		printf( "history timeline %d months, %.2f MB on disk\n", map->m_historyTimeline->GetNumOfMonths(),
+			(double)map->m_historyTimeline->GetFileSize() / (1024.0 * 1024.0) );
+		PrintPeakMemory( "after simulation" );
+		MeasureHistorySnapshots( map );
+	}
+
+	delete g_theGame;
+	g_theGame = nullptr;
+
+	g_theEventSystem->Shutdown();
+	delete g_theEventSystem;
+	g_theEventSystem = nullptr;
+
+	g_theJobSystem->ShutDown();
+	delete g_theJobSystem;
+	g_theJobSystem = nullptr;
+	return 0;
+}
@@ -2369,56 +2369,9 @@ bool Map::DoEntitiesHaveInteraction( Entity* a, Entity* b ) const
 
 void Map::PopulateTileHeatMapDistanceField( TileHeatMap& out_distanceField, IntVec2 const& startCoords, float maxCost, float minCost, bool treatBuildingsAsSolid ) const
 {
-	// bfs
-	int maxQueueLength = m_dimensions.x * m_dimensions.y;
-	IntVec2* queue = new IntVec2[maxQueueLength];
-	int start = 0;
-	int end = 1;
-	out_distanceField.SetAllValues( maxCost );
-	queue[start] = startCoords;
-	out_distanceField.SetTileValue( startCoords, minCost );
-	while (start < end) {
-		IntVec2 const& thisTile = queue[start];
-		float thisTileValue = out_distanceField.GetTileValue( thisTile );
-		if (thisTile.x >= 1) {
-			IntVec2 nextTile = thisTile + IntVec2( -1, 0 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost
-				&& !IsTileSolid( nextTile ) && !(treatBuildingsAsSolid && IsTileBuilding( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.y >= 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 0, -1 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost
-				&& !IsTileSolid( nextTile ) && !(treatBuildingsAsSolid && IsTileBuilding( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.x < m_dimensions.x - 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 1, 0 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost
-				&& !IsTileSolid( nextTile ) && !(treatBuildingsAsSolid && IsTileBuilding( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		if (thisTile.y < m_dimensions.y - 1) {
-			IntVec2 nextTile = thisTile + IntVec2( 0, 1 );
-			if (out_distanceField.GetTileValue( nextTile ) == maxCost && out_distanceField.GetTileValue( nextTile ) != minCost
-				&& !IsTileSolid( nextTile ) && !(treatBuildingsAsSolid && IsTileBuilding( nextTile ))) {
-				queue[end] = nextTile;
-				end = (end + 1);//% maxQueueLength;
-				out_distanceField.SetTileValue( nextTile, thisTileValue + 1.f );
-			}
-		}
-		start++;//= (start + 1) % maxQueueLength;
-	}
-	delete[] queue;
+	out_distanceField.PopulateDistanceField( startCoords, [&]( IntVec2 const& tileCoords ) {
+		return !IsTileSolid( tileCoords ) && !(treatBuildingsAsSolid && IsTileBuilding( tileCoords ));
+		}, minCost, maxCost );
 }
 
 void Map::DoConstruction( IntVec2 const& coords )
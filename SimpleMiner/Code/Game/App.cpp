@@ -1,5 +1,6 @@
 #include "Game/App.hpp"
 #include "Game/Game.hpp"
+#include "Game/World.hpp"
 #include "Engine/Core/XmlUtils.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include <filesystem>
@@ -79,6 +80,12 @@ void App::Startup() {
 	//m_theGame->Startup();
 
 	SubscribeEventCallbackFunction( "quit", App::SetQuitting );
+	SubscribeEventCallbackFunction( "Command_ChunkMeshHistogram", World::Command_ChunkMeshHistogram );
+	SubscribeEventCallbackFunction( "Command_ChunkStorageBenchmark", World::Command_ChunkStorageBenchmark );
+	SubscribeEventCallbackFunction( "Command_ChunkGenerationBenchmark", World::Command_ChunkGenerationBenchmark );
+	SubscribeEventCallbackFunction( "Command_LightingBenchmark", World::Command_LightingBenchmark );
+	SubscribeEventCallbackFunction( "Command_ChunkRegistryStressTest", World::Command_ChunkRegistryStressTest );
+	SubscribeEventCallbackFunction( "Command_RayCastBenchmark", World::Command_RayCastBenchmark );
 	g_devConsole->AddLine( DevConsole::INFO_MINOR, "Initializing..." );
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Successfully Initialized!" );
 
@@ -86,6 +93,8 @@ void App::Startup() {
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "W: Forward S: Backward A: Left D: Right Q&E: Roll" );
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Mouse move: Camera Rotation H: Return to world position (0,0,0)" );
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Z/C: Move world up/down Shift: Speed * 10" );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "M: Toggle chunk meshing in jobs/on main thread, ChunkMeshHistogram: compare frame times" );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "G: Toggle greedy meshing with packed verts/one quad per block face" );
 
 	m_attractModeCamera->SetOrthoView( Vec2( 0, 0 ), Vec2( UI_SIZE_X, UI_SIZE_Y ), 1.f, -1.f );
 	m_attractModeCamera->m_mode = CameraMode::Orthographic;
@@ -94,6 +103,9 @@ void App::Startup() {
 	g_chunkActivationDist = g_gameConfigBlackboard.GetValue( "chunkActivationDistance", g_chunkActivationDist );
 	g_saveModifiedChunks = g_gameConfigBlackboard.GetValue( "saveModifiedChunks", g_saveModifiedChunks );
 	g_autoCreateChunks = g_gameConfigBlackboard.GetValue( "autoCreateChunks", g_autoCreateChunks );
+	g_asyncChunkMeshing = g_gameConfigBlackboard.GetValue( "asyncChunkMeshing", g_asyncChunkMeshing );
+	g_greedyChunkMeshing = g_gameConfigBlackboard.GetValue( "greedyChunkMeshing", g_greedyChunkMeshing );
+	g_parallelLighting = g_gameConfigBlackboard.GetValue( "parallelLighting", g_parallelLighting );
 }
 
 void App::Shutdown() {
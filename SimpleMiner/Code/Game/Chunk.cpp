@@ -1,11 +1,10 @@
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <fileapi.h>
-
 #include "Game/Chunk.hpp"
 #include "Game/Game.hpp"
 #include "Game/World.hpp"
+#include "Game/RegionFile.hpp"
 #include "Game/BlockTemplates.hpp"
+#include "Engine/Math/BatchNoise.hpp"
+#include <algorithm>
 
 Chunk::Chunk( IntVec2 const& coords )
 	:m_coords(coords)
@@ -97,9 +96,17 @@ void Chunk::Render() const
 		g_theRenderer->SetSamplerMode( SamplerMode::POINT_CLAMP );
 		g_theRenderer->SetDepthMode( DepthMode::ENABLED );
 		g_theRenderer->SetBlendMode( BlendMode::OPAQUE );
-		g_theRenderer->BindShader( g_theWorld->m_worldShader );
 		g_theRenderer->BindTexture( &g_sprite->GetTexture() );
-		g_theRenderer->SetModelConstants();
+		if (m_isMeshPacked) {
+			// packed positions are local to the chunk
+			g_theRenderer->BindShader( g_theWorld->m_worldPackedShader );
+			g_theRenderer->SetModelConstants( Mat44::CreateTranslation3D( Vec3( m_chunkOriginWorldCoords ) ) );
+			g_theRenderer->BindConstantBuffer( SIMPLE_MINER_BLOCK_UV_CONSTANTS_SLOT, g_theWorld->m_blockUVCBO );
+		}
+		else {
+			g_theRenderer->BindShader( g_theWorld->m_worldShader );
+			g_theRenderer->SetModelConstants();
+		}
 		g_theRenderer->SetShadowMode( ShadowMode::DISABLE );
 		g_theRenderer->SetCustomConstantBuffer( const_cast<ConstantBuffer*&>(g_theWorld->m_worldCBO), (void*)&g_theWorld->m_worldConstans, sizeof( g_theWorld->m_worldConstans ), SIMPLE_MINER_WORLD_CONSTANTS_SLOT );
 		g_theRenderer->DrawVertexBuffer( m_vertexBuffer, m_vertexBuffer->GetVertexCount() );
@@ -112,7 +119,60 @@ struct PerlinWormStartPosInfo {
 	IntVec3 m_startBlockLocalCoords;
 };
 
-void Chunk::GenerateBlocks()
+constexpr int SEA_LEVEL = (int)((unsigned int)ZSIZE >> 1);
+constexpr int RIVER_HEIGHT = 5;
+constexpr int MAX_MOUNTAIN_HEIGHT = ZSIZE - SEA_LEVEL - 20;
+constexpr float MAX_OCEAN_DEPTH = 40.f;
+
+void ChunkNoiseFields::Compute( IntVec3 const& chunkOriginWorldCoords, bool useBatchNoise )
+{
+	auto computeField = [useBatchNoise]( float* out_noise, int originX, int originY, int numX, int numY, float scale, unsigned int numOctaves, bool renormalize, unsigned int seed ) {
+		if (useBatchNoise) {
+			Compute2dPerlinNoiseGrid( out_noise, originX, originY, numX, numY, scale, numOctaves, 0.5f, 2.f, renormalize, seed );
+			return;
+		}
+		for (int y = 0; y < numY; y++) {
+			for (int x = 0; x < numX; x++) {
+				out_noise[x + y * numX] = Compute2dPerlinNoise( float( originX + x ), float( originY + y ), scale, numOctaves, 0.5f, 2.f, renormalize, seed );
+			}
+		}
+	};
+	int borderOriginX = chunkOriginWorldCoords.x - CHUNK_NOISE_BORDER;
+	int borderOriginY = chunkOriginWorldCoords.y - CHUNK_NOISE_BORDER;
+	computeField( m_hilliness, borderOriginX, borderOriginY, CHUNK_NOISE_SIZE_X, CHUNK_NOISE_SIZE_Y, 2000.f, 3, false, g_hillinessSeed );
+	// the world seed has always gone to the renormalize parameter of this call, kept so existing worlds do not change
+	computeField( m_terrainHeight, borderOriginX, borderOriginY, CHUNK_NOISE_SIZE_X, CHUNK_NOISE_SIZE_Y, 150.f, 7, g_terrainSeed != 0, 0 );
+	computeField( m_oceanness, borderOriginX, borderOriginY, CHUNK_NOISE_SIZE_X, CHUNK_NOISE_SIZE_Y, 500.f, 3, false, g_oceannessSeed );
+	computeField( m_forestness, borderOriginX, borderOriginY, CHUNK_NOISE_SIZE_X, CHUNK_NOISE_SIZE_Y, 100.f, 7, false, g_treeDensitySeed );
+	computeField( m_humidity, chunkOriginWorldCoords.x, chunkOriginWorldCoords.y, XSIZE, YSIZE, 800.f, 7, false, g_humiditySeed );
+	computeField( m_temperature, chunkOriginWorldCoords.x, chunkOriginWorldCoords.y, XSIZE, YSIZE, 800.f, 7, false, g_temperatureSeed );
+}
+
+static int GetTerrainHeightZ( ChunkNoiseFields const& noiseFields, int fieldIndex )
+{
+	// calculate the hilliness of the terrain, if the hilliness is high, terrain height is more relevant
+	float hilliness = 0.5f + 0.5f * noiseFields.m_hilliness[fieldIndex];
+	hilliness = SmoothStep3( SmoothStep3( hilliness ) );
+
+	int terrainPerlinHeightZ;
+	int rawPerlinTerrainHeight = int( (MAX_MOUNTAIN_HEIGHT + RIVER_HEIGHT) * Absf( noiseFields.m_terrainHeight[fieldIndex] ) );
+	if (rawPerlinTerrainHeight < RIVER_HEIGHT) {
+		terrainPerlinHeightZ = SEA_LEVEL - RIVER_HEIGHT + rawPerlinTerrainHeight;
+	}
+	else {
+		terrainPerlinHeightZ = SEA_LEVEL + int( hilliness * (rawPerlinTerrainHeight - RIVER_HEIGHT) );
+	}
+
+	// calculate the oceanness to decide the ocean area
+	float oceanness = 0.5f + 0.5f * noiseFields.m_oceanness[fieldIndex];
+	oceanness = RangeMapClamped( oceanness, 0.6f, 0.8f, 0.f, 1.f );
+	oceanness = SmoothStep3( SmoothStep3( oceanness ) );
+
+	// terrain height
+	return terrainPerlinHeightZ - int( oceanness * MAX_OCEAN_DEPTH );
+}
+
+void Chunk::GenerateBlocks( bool useBatchNoise )
 {
 	//double begin = GetCurrentTimeSeconds();
 	unsigned int seed = Get2dNoiseUint( m_coords.x, m_coords.y, g_terrainSeed );
@@ -133,10 +193,8 @@ void Chunk::GenerateBlocks()
 	BlockTemplate const& spruceTemp = BlockTemplate::GetBlockTemplate( "spruce" );
 	BlockTemplate const& cactusTemp = BlockTemplate::GetBlockTemplate( "cactus" );
 
-	constexpr int seaLevel = (int)((unsigned int)ZSIZE >> 1);
-	constexpr int riverHeight = 5;
-	constexpr int maxMountainHeight = ZSIZE - seaLevel - 20;
-	constexpr float maxOceanDepth = 40.f;
+	ChunkNoiseFields noiseFields;
+	noiseFields.Compute( m_chunkOriginWorldCoords, useBatchNoise );
 
 	std::vector<int> allTerrainHeightZ;
 	allTerrainHeightZ.resize( 1 << XBITS << YBITS );
@@ -145,44 +203,28 @@ void Chunk::GenerateBlocks()
 		for (int i = 0; i < XSIZE; i++) {
 			IntVec3 worldPosXY = GetBlockWorldCoords( IntVec3( i, j, 0 ) );
 
-			// calculate the hilliness of the terrain, if the hilliness is high, terrain height is more relevant
-			float hilliness = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 2000.f, 3, 0.5f, 2.f, false, g_hillinessSeed );
-			hilliness = SmoothStep3( SmoothStep3( hilliness ) );
-
-			int terrainPerlinHeightZ;
-			int rawPerlinTerrainHeight = int( (maxMountainHeight + riverHeight) * Absf( Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 150.f, 7, 0.5f, 2.f, g_terrainSeed ) ) );
-			if (rawPerlinTerrainHeight < riverHeight) {
-				terrainPerlinHeightZ = seaLevel - riverHeight + rawPerlinTerrainHeight;
-			}
-			else {
-				terrainPerlinHeightZ = seaLevel + int( hilliness * (rawPerlinTerrainHeight - riverHeight) );
-			}
-
-			// calculate the oceanness to decide the ocean area
-			float oceanness = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 500.f, 3, 0.5f, 2.f, false, g_oceannessSeed );
-			oceanness = RangeMapClamped( oceanness, 0.6f, 0.8f, 0.f, 1.f );
-			oceanness = SmoothStep3( SmoothStep3( oceanness ) );
+			int fieldIndex = ChunkNoiseFields::GetIndex( i, j );
+			int columnIndex = i + (j << XBITS);
 
 			// calculate the humidity
-			float humidity = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_humiditySeed );
+			float humidity = 0.5f + 0.5f * noiseFields.m_humidity[columnIndex];
 
 			constexpr int maxSandDepth = 10;
 			int sandHeightFromGround = int( RangeMapClamped( humidity, 0.f, 0.4f, 1.f, 0.f ) * maxSandDepth );
 
 			// calculate the temperature
-			float temperature = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_temperatureSeed );
+			float temperature = 0.5f + 0.5f * noiseFields.m_temperature[columnIndex];
 
 			constexpr int maxIceDepth = 10;
 			int iceHeightFromGround = int( RangeMapClamped( temperature, 0.f, 0.4f, 1.f, 0.f ) * maxIceDepth );
 
-			// terrain height
-			int terrainHeightZ = terrainPerlinHeightZ - int( oceanness * maxOceanDepth );
-			allTerrainHeightZ[i + (j << XBITS)] = terrainHeightZ;
+			int terrainHeightZ = GetTerrainHeightZ( noiseFields, fieldIndex );
+			allTerrainHeightZ[columnIndex] = terrainHeightZ;
 			int dirtDepth = rng.RollRandomIntInRange( 3, 4 );
 			for (int k = 0; k < ZSIZE; k++) {
 				int index = GetBlockIndex( IntVec3( i, j, k ) );
 				if (k == terrainHeightZ) {
-					if (k == seaLevel && humidity < 0.6f) {
+					if (k == SEA_LEVEL && humidity < 0.6f) {
 						m_blocks[index].SetType( beachType );
 					}
 					else if (sandHeightFromGround > 0) {
@@ -193,8 +235,8 @@ void Chunk::GenerateBlocks()
 					}
 				}
 				else if (k > terrainHeightZ) {
-					if (k <= seaLevel) {
-						if (iceHeightFromGround > seaLevel - k) {
+					if (k <= SEA_LEVEL) {
+						if (iceHeightFromGround > SEA_LEVEL - k) {
 							m_blocks[index].SetType( iceType );
 						}
 						else {
@@ -253,37 +295,14 @@ void Chunk::GenerateBlocks()
 	for (int y = -2; y < YSIZE + 2; y++) {
 		for (int x = -2; x < XSIZE + 2; x++) {
 			IntVec3 worldPosXY = GetBlockWorldCoords( IntVec3( x, y, 0 ) );
-			int terrainHeightZ;
-			if (x >= 0 && x < XSIZE && y >= 0 && y < YSIZE) {
-				terrainHeightZ = allTerrainHeightZ[x + (y << XBITS)];
-			}
-			else {
-				// calculate the hilliness of the terrain, if the hilliness is high, terrain height is more relevant
-				float hilliness = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 2000.f, 3, 0.5f, 2.f, false, g_hillinessSeed );
-				hilliness = SmoothStep3( SmoothStep3( hilliness ) );
-
-				int terrainPerlinHeightZ;
-				int rawPerlinTerrainHeight = int( (maxMountainHeight + riverHeight) * Absf( Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 150.f, 7, 0.5f, 2.f, g_terrainSeed ) ) );
-				if (rawPerlinTerrainHeight < riverHeight) {
-					terrainPerlinHeightZ = seaLevel - riverHeight + rawPerlinTerrainHeight;
-				}
-				else {
-					terrainPerlinHeightZ = seaLevel + int( hilliness * (rawPerlinTerrainHeight - riverHeight) );
-				}
-
-				// calculate the oceanness to decide the ocean area
-				float oceanness = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 500.f, 3, 0.5f, 2.f, false, g_oceannessSeed );
-				oceanness = RangeMapClamped( oceanness, 0.6f, 0.8f, 0.f, 1.f );
-				oceanness = SmoothStep3( SmoothStep3( oceanness ) );
-
-				// terrain height
-				terrainHeightZ = terrainPerlinHeightZ - int( oceanness * maxOceanDepth );
-			}
+			int fieldIndex = ChunkNoiseFields::GetIndex( x, y );
+			bool isInChunk = x >= 0 && x < XSIZE && y >= 0 && y < YSIZE;
+			int terrainHeightZ = isInChunk ? allTerrainHeightZ[x + (y << XBITS)] : GetTerrainHeightZ( noiseFields, fieldIndex );
 
 			constexpr float densityThreshold = 0.6f;
-			float forestness = 0.5f + 0.5f * Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 100.f, 7, 0.5f, 2.f, false, g_treeDensitySeed );
+			float forestness = 0.5f + 0.5f * noiseFields.m_forestness[fieldIndex];
 			float normalizedThreshold = RangeMapClamped( forestness, densityThreshold, 1.f, 1.f, 0.95f );
-			if (terrainHeightZ >= seaLevel && forestness > densityThreshold) {
+			if (terrainHeightZ >= SEA_LEVEL && forestness > densityThreshold) {
 				float thisNoise = Get2dNoiseZeroToOne( worldPosXY.x, worldPosXY.y, g_treeSeed );
 				if (thisNoise > normalizedThreshold && thisNoise == Maxf( thisNoise, Maxf( Get2dNoiseZeroToOne( worldPosXY.x - 1, worldPosXY.y - 1, g_treeSeed ),
 					Maxf( Get2dNoiseZeroToOne( worldPosXY.x - 1, worldPosXY.y, g_treeSeed ),
@@ -292,10 +311,11 @@ void Chunk::GenerateBlocks()
 								Maxf( Get2dNoiseZeroToOne( worldPosXY.x, worldPosXY.y + 1, g_treeSeed ),
 									Maxf( Get2dNoiseZeroToOne( worldPosXY.x + 1, worldPosXY.y - 1, g_treeSeed ),
 										Maxf( Get2dNoiseZeroToOne( worldPosXY.x + 1, worldPosXY.y, g_treeSeed ), Get2dNoiseZeroToOne( worldPosXY.x + 1, worldPosXY.y + 1, g_treeSeed ) ) ) ) ) ) ) ) )) {
-					if (Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_humiditySeed ) < -0.28f) {
+					float humidityNoise = isInChunk ? noiseFields.m_humidity[x + (y << XBITS)] : Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_humiditySeed );
+					if (humidityNoise < -0.28f) {
 						AddBlockTemplate( cactusTemp, IntVec3( x, y, terrainHeightZ + 1 ) );
 					}
-					else if (Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_temperatureSeed ) < -0.2f) {
+					else if ((isInChunk ? noiseFields.m_temperature[x + (y << XBITS)] : Compute2dPerlinNoise( float( worldPosXY.x ), float( worldPosXY.y ), 800.f, 7, 0.5f, 2.f, false, g_temperatureSeed )) < -0.2f) {
 						AddBlockTemplate( spruceTemp, IntVec3( x, y, terrainHeightZ + 1 ) );
 					}
 					else {
@@ -541,6 +561,96 @@ void Chunk::AddBlockTemplate( BlockTemplate const& temp, IntVec3 const& localOri
 	}
 }
 
+void Chunk::PropagateDirtyLighting( std::vector<ChunkLightPush>& out_pushes )
+{
+	constexpr int LAYER_SIZE = XSIZE * YSIZE;
+	// east, west, north, south, up, down
+	Chunk* neighborChunks[6];
+	int neighborIndices[6];
+	bool isLightChanged = false;
+	bool isEdgeLightChanged[4] = {};
+	while (!m_lightDirtyQueue.empty()) {
+		int blockIndex = m_lightDirtyQueue.front();
+		m_lightDirtyQueue.pop_front();
+		Block& block = m_blocks[blockIndex];
+
+		int localX = blockIndex & XBITS_MASK;
+		int localY = blockIndex & YBITS_MASK;
+		int localZ = blockIndex >> ZBITS_SHIFT;
+		neighborChunks[0] = localX == XBITS_MASK ? m_eastNeighbor : this;
+		neighborIndices[0] = localX == XBITS_MASK ? blockIndex & X_RESET_MASK : blockIndex + 1;
+		neighborChunks[1] = localX == 0 ? m_westNeighbor : this;
+		neighborIndices[1] = localX == 0 ? blockIndex | XBITS_MASK : blockIndex - 1;
+		neighborChunks[2] = localY == YBITS_MASK ? m_northNeighbor : this;
+		neighborIndices[2] = localY == YBITS_MASK ? blockIndex & Y_RESET_MASK : blockIndex + XSIZE;
+		neighborChunks[3] = localY == 0 ? m_southNeighbor : this;
+		neighborIndices[3] = localY == 0 ? blockIndex | YBITS_MASK : blockIndex - XSIZE;
+		neighborChunks[4] = localZ == ZSIZE - 1 ? nullptr : this;
+		neighborIndices[4] = blockIndex + LAYER_SIZE;
+		neighborChunks[5] = localZ == 0 ? nullptr : this;
+		neighborIndices[5] = blockIndex - LAYER_SIZE;
+
+		// indoor: own light source or the brightest neighbor that lets light through minus 1
+		// outdoor: 15 under the sky or the brightest neighbor minus 1
+		BlockDefinition const& def = block.GetDefinition();
+		bool isSky = block.IsSky();
+		int indoorLightStrength = def.m_lightStrength > 0 ? def.m_lightStrength : 0;
+		int outdoorLightStrength = isSky ? 15 : 0;
+		for (int i = 0; i < 6; i++) {
+			if (neighborChunks[i]) {
+				Block const& neighbor = neighborChunks[i]->m_blocks[neighborIndices[i]];
+				BlockDefinition const& neighborDef = neighbor.GetDefinition();
+				if (!neighborDef.m_opaque || neighborDef.m_lightStrength > 0) {
+					indoorLightStrength = std::max( indoorLightStrength, (int)neighbor.GetIndoorLightInfluence() - 1 );
+				}
+				if (!isSky) {
+					outdoorLightStrength = std::max( outdoorLightStrength, (int)neighbor.GetOutdoorLightInfluence() - 1 );
+				}
+			}
+		}
+
+		if (indoorLightStrength != block.GetIndoorLightInfluence() || outdoorLightStrength != block.GetOutdoorLightInfluence()) {
+			block.SetIndoorLightInfluence( (unsigned char)indoorLightStrength );
+			block.SetOutdoorLightInfluence( def.m_opaque ? (unsigned char)0 : (unsigned char)outdoorLightStrength );
+			isLightChanged = true;
+			for (int i = 0; i < 6; i++) {
+				Chunk* neighborChunk = neighborChunks[i];
+				if (neighborChunk == nullptr || neighborChunk->m_blocks[neighborIndices[i]].IsOpaque()) {
+					continue;
+				}
+				if (neighborChunk == this) {
+					Block& neighbor = m_blocks[neighborIndices[i]];
+					if (!neighbor.IsLightDirty()) {
+						neighbor.SetLightDirty( true );
+						m_lightDirtyQueue.push_back( neighborIndices[i] );
+					}
+				}
+				else {
+					// the dirty bit of another chunk's block is not ours to write
+					out_pushes.push_back( ChunkLightPush{ neighborChunk, neighborIndices[i] } );
+				}
+			}
+			for (int i = 0; i < 4; i++) {
+				if (neighborChunks[i] && neighborChunks[i] != this) {
+					isEdgeLightChanged[i] = true;
+				}
+			}
+		}
+		block.SetLightDirty( false );
+	}
+
+	if (isLightChanged) {
+		out_pushes.push_back( ChunkLightPush{ this, -1 } );
+	}
+	// light on an edge changes how the neighbor shades its faces toward this chunk
+	Chunk* edgeNeighbors[4] = { m_eastNeighbor, m_westNeighbor, m_northNeighbor, m_southNeighbor };
+	for (int i = 0; i < 4; i++) {
+		if (isEdgeLightChanged[i]) {
+			out_pushes.push_back( ChunkLightPush{ edgeNeighbors[i], -1 } );
+		}
+	}
+}
+
 bool Chunk::IsCoordsInBounds( IntVec3 const& coords ) const
 {
 	return coords.x >= 0 && coords.x < XSIZE && coords.y >= 0 && coords.y < YSIZE && coords.z >= 0 && coords.z < ZSIZE;
@@ -548,63 +658,19 @@ bool Chunk::IsCoordsInBounds( IntVec3 const& coords ) const
 
 void Chunk::BuildVertexArrayAndBuffer()
 {
-	m_verts.reserve( 100000 );
-	m_verts.clear();
-	for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
-		BlockDefinition const& def = m_blocks[i].GetDefinition();
-		if (def.m_visible) {
-			Vec3 worldPos = GetBlockWorldCoords( GetBlockLocalCoordsByIndex( i ) );
-			IntVec3 coords = GetBlockLocalCoordsByIndex( i );
-			BlockIter iter( i, this );
-			// sides
-			// south
-			BlockIter southBlock = iter.GetSouthNeighbor();
-			if (southBlock.IsValid() && !southBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos, worldPos + Vec3( 1.f, 0.f, 0.f ), 
-					worldPos + Vec3( 1.f, 0.f, 1.f ), worldPos + Vec3( 0.f, 0.f, 1.f ),
-					CalculateLightColorForBlock( southBlock ), def.m_sideUV );
-			}
-			// west
-			BlockIter westBlock = iter.GetWestNeighbor();
-			if (westBlock.IsValid() && !westBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos + Vec3( 0.f, 1.f, 0.f ), 
-					worldPos, worldPos + Vec3( 0.f, 0.f, 1.f ), 
-					worldPos + Vec3( 0.f, 1.f, 1.f ), CalculateLightColorForBlock( westBlock ), def.m_sideUV );
-			}
-			// north
-			BlockIter northBlock = iter.GetNorthNeighbor();
-			if (northBlock.IsValid() && !northBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos + Vec3( 1.f, 1.f, 0.f ),
-					worldPos + Vec3( 0.f, 1.f, 0.f ), worldPos + Vec3( 0.f, 1.f, 1.f ), 
-					worldPos + Vec3( 1.f, 1.f, 1.f ), CalculateLightColorForBlock( northBlock ), def.m_sideUV );
-			}
-			// east
-			BlockIter eastBlock = iter.GetEastNeighbor();
-			if (eastBlock.IsValid() && !eastBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos + Vec3( 1.f, 0.f, 0.f ), 
-					worldPos + Vec3( 1.f, 1.f, 0.f ), worldPos + Vec3( 1.f, 1.f, 1.f ), 
-					worldPos + Vec3( 1.f, 0.f, 1.f ), CalculateLightColorForBlock( eastBlock ), def.m_sideUV );
-			}
-			// top
-			BlockIter topBlock = iter.GetUpNeighbor();
-			if (topBlock.IsValid() && !topBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos + Vec3( 0.f, 0.f, 1.f ), 
-					worldPos + Vec3( 1.f, 0.f, 1.f ), worldPos + Vec3( 1.f, 1.f, 1.f ), 
-					worldPos + Vec3( 0.f, 1.f, 1.f ), CalculateLightColorForBlock( topBlock ), def.m_topUV );
-			}
-			// bottom
-			BlockIter bottomBlock = iter.GetDownNeighbor();
-			if (bottomBlock.IsValid() && !bottomBlock.GetBlock()->IsOpaque()) {
-				AddVertsForQuad3D( m_verts, worldPos + Vec3( 0.f, 1.f, 0.f ), 
-					worldPos + Vec3( 1.f, 1.f, 0.f ), worldPos + Vec3( 1.f, 0.f, 0.f ), 
-					worldPos, CalculateLightColorForBlock( bottomBlock ), def.m_bottomUV );
-			}
-		}
+	ChunkMeshSnapshot snapshot;
+	snapshot.TakeFrom( this );
+	if (g_greedyChunkMeshing) {
+		std::vector<Vertex_Block> verts;
+		int numOfPerFaceVerts = 0;
+		snapshot.BuildGreedyVertexArray( verts, numOfPerFaceVerts );
+		UploadVertexArray( verts, numOfPerFaceVerts );
+	}
+	else {
+		std::vector<Vertex_PCU> verts;
+		snapshot.BuildVertexArray( verts );
+		UploadVertexArray( verts );
 	}
-
-	delete m_vertexBuffer;
-	m_vertexBuffer = g_theRenderer->CreateVertexBuffer( m_verts.size() * sizeof( Vertex_PCU ), sizeof( Vertex_PCU ) );
-	g_theRenderer->CopyCPUToGPU( m_verts.data(), m_verts.size() * sizeof( Vertex_PCU ), m_vertexBuffer );
 }
 
 bool Chunk::IsBlockSurfaceHidden( IntVec3 const& coords, IntVec3 const& step ) const
@@ -629,17 +695,6 @@ bool Chunk::IsBlockSurfaceHidden( IntVec3 const& coords, IntVec3 const& step ) c
 	return false;
 }
 
-Rgba8 Chunk::CalculateLightColorForBlock( BlockIter const& blockIter ) const
-{
-	unsigned char indoorLightIntensity = 0;
-	unsigned char outdoorLightIntensity = 0;
-	indoorLightIntensity = blockIter.GetBlock()->GetIndoorLightInfluence();
-	indoorLightIntensity = indoorLightIntensity * 17;
-	outdoorLightIntensity = blockIter.GetBlock()->GetOutdoorLightInfluence();
-	outdoorLightIntensity = outdoorLightIntensity * 17;
-	return Rgba8( outdoorLightIntensity, indoorLightIntensity, 127 );
-}
-
 void Chunk::ClearBlocksOverlapSphere( Vec3 const& sphereCenter, float sphereRadius )
 {
 	// reject test
@@ -681,6 +736,38 @@ void Chunk::SaveToFile() const
 	if (!g_saveModifiedChunks) {
 		return;
 	}
+	std::vector<uint8_t> blockTypes;
+	GetBlockTypes( blockTypes );
+	g_theWorld->m_regionStorage->SaveChunk( m_coords, blockTypes );
+}
+
+bool Chunk::ReadFromFile()
+{
+	std::vector<uint8_t> blockTypes;
+	if (!g_theWorld->m_regionStorage->LoadChunk( m_coords, blockTypes ) && !ReadLegacyChunkFile( GetLegacyChunkFilePath( m_coords ), blockTypes )) {
+		return false;
+	}
+	SetBlockTypes( blockTypes );
+	return true;
+}
+
+void Chunk::GetBlockTypes( std::vector<uint8_t>& out_blockTypes ) const
+{
+	out_blockTypes.resize( BLOCK_COUNT_EACH_CHUNK );
+	for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+		out_blockTypes[i] = m_blocks[i].m_type;
+	}
+}
+
+void Chunk::SetBlockTypes( std::vector<uint8_t> const& blockTypes )
+{
+	for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+		m_blocks[i].SetType( blockTypes[i] );
+	}
+}
+
+void Chunk::WriteLegacyChunkFile( std::vector<uint8_t> const& blockTypes, std::string const& filePath )
+{
 	std::vector<uint8_t> buffer;
 	buffer.reserve( 10000 );
 	buffer.push_back( 'G' );
@@ -699,15 +786,15 @@ void Chunk::SaveToFile() const
 	buffer.push_back( seedArray[2] );
 	buffer.push_back( seedArray[3] );
 
-	uint8_t curBlockType = m_blocks[0].m_type;
+	uint8_t curBlockType = blockTypes[0];
 	int numOfThisType = 1;
 	for (int i = 1; i < BLOCK_COUNT_EACH_CHUNK; i++) {
-		if (m_blocks[i].m_type != curBlockType || numOfThisType == 255) {
+		if (blockTypes[i] != curBlockType || numOfThisType == 255) {
 			// push back data
 			buffer.push_back( curBlockType );
 			buffer.push_back( (uint8_t)numOfThisType );
 			numOfThisType = 1;
-			curBlockType = m_blocks[i].m_type;
+			curBlockType = blockTypes[i];
 		}
 		else {
 			numOfThisType++;
@@ -716,14 +803,13 @@ void Chunk::SaveToFile() const
 	buffer.push_back( curBlockType );
 	buffer.push_back( (uint8_t)numOfThisType );
 
-	CreateDirectoryA( Stringf( "Saves/World%u", g_terrainSeed ).c_str(), NULL );
-	BufferWriteToFile( buffer, Stringf( "Saves/World%u/Chunk(%d,%d).chunk", g_terrainSeed, m_coords.x, m_coords.y ) );
+	BufferWriteToFile( buffer, filePath );
 }
 
-bool Chunk::ReadFromFile()
+bool Chunk::ReadLegacyChunkFile( std::string const& filePath, std::vector<uint8_t>& out_blockTypes )
 {
 	std::vector<uint8_t> buffer;
-	int res = FileReadToBuffer( buffer, Stringf( "Saves/World%u/Chunk(%d,%d).chunk", g_terrainSeed, m_coords.x, m_coords.y ) );
+	int res = FileReadToBuffer( buffer, filePath );
 	if (res == -1) {
 		return false;
 	}
@@ -739,10 +825,12 @@ bool Chunk::ReadFromFile()
 		return false;
 	}
 	
+	out_blockTypes.resize( BLOCK_COUNT_EACH_CHUNK );
 	int counter = 0;
 	for (int i = 12; i < (int)buffer.size(); i+=2) {
 		for (int k = 0; k < (int)buffer[i + 1]; k++) {
-			m_blocks[counter].SetType( buffer[i] );
+			GUARANTEE_OR_DIE( counter < BLOCK_COUNT_EACH_CHUNK, "Error! Save file is not in right format!" );
+			out_blockTypes[counter] = buffer[i];
 			counter++;
 		}
 	}
@@ -751,6 +839,11 @@ bool Chunk::ReadFromFile()
 	return true;
 }
 
+std::string Chunk::GetLegacyChunkFilePath( IntVec2 const& chunkCoords )
+{
+	return Stringf( "Saves/World%u/Chunk(%d,%d).chunk", g_terrainSeed, chunkCoords.x, chunkCoords.y );
+}
+
 void Chunk::MarkDirty()
 {
 	if (!m_isDirty) {
@@ -758,3 +851,271 @@ void Chunk::MarkDirty()
 		g_theWorld->m_dirtyChunks.push_back( this );
 	}
 }
+
+void Chunk::UploadVertexArray( std::vector<Vertex_PCU>& verts )
+{
+	m_verts.swap( verts );
+	m_packedVerts.clear();
+	m_isMeshPacked = false;
+	m_numOfPerFaceVerts = (int)m_verts.size();
+	delete m_vertexBuffer;
+	m_vertexBuffer = g_theRenderer->CreateVertexBuffer( m_verts.size() * sizeof( Vertex_PCU ), sizeof( Vertex_PCU ) );
+	g_theRenderer->CopyCPUToGPU( m_verts.data(), m_verts.size() * sizeof( Vertex_PCU ), m_vertexBuffer );
+}
+
+void Chunk::UploadVertexArray( std::vector<Vertex_Block>& verts, int numOfPerFaceVerts )
+{
+	m_packedVerts.swap( verts );
+	m_verts.clear();
+	m_isMeshPacked = true;
+	m_numOfPerFaceVerts = numOfPerFaceVerts;
+	delete m_vertexBuffer;
+	m_vertexBuffer = g_theRenderer->CreateVertexBuffer( m_packedVerts.size() * sizeof( Vertex_Block ), sizeof( Vertex_Block ) );
+	g_theRenderer->CopyCPUToGPU( m_packedVerts.data(), m_packedVerts.size() * sizeof( Vertex_Block ), m_vertexBuffer );
+}
+
+size_t Chunk::GetVertexBufferBytes() const
+{
+	return m_isMeshPacked ? m_packedVerts.size() * sizeof( Vertex_Block ) : m_verts.size() * sizeof( Vertex_PCU );
+}
+
+void ChunkMeshSnapshot::TakeFrom( Chunk const* chunk )
+{
+	m_chunkOriginWorldCoords = chunk->m_chunkOriginWorldCoords;
+	m_blocks.assign( chunk->m_blocks, chunk->m_blocks + BLOCK_COUNT_EACH_CHUNK );
+
+	m_eastBorder.clear();
+	m_westBorder.clear();
+	m_northBorder.clear();
+	m_southBorder.clear();
+	if (chunk->m_eastNeighbor) {
+		m_eastBorder.resize( YSIZE * ZSIZE );
+		for (int z = 0; z < ZSIZE; z++) {
+			for (int y = 0; y < YSIZE; y++) {
+				m_eastBorder[y + z * YSIZE] = chunk->m_eastNeighbor->m_blocks[::GetBlockIndex( IntVec3( 0, y, z ) )];
+			}
+		}
+	}
+	if (chunk->m_westNeighbor) {
+		m_westBorder.resize( YSIZE * ZSIZE );
+		for (int z = 0; z < ZSIZE; z++) {
+			for (int y = 0; y < YSIZE; y++) {
+				m_westBorder[y + z * YSIZE] = chunk->m_westNeighbor->m_blocks[::GetBlockIndex( IntVec3( XSIZE - 1, y, z ) )];
+			}
+		}
+	}
+	if (chunk->m_northNeighbor) {
+		m_northBorder.resize( XSIZE * ZSIZE );
+		for (int z = 0; z < ZSIZE; z++) {
+			for (int x = 0; x < XSIZE; x++) {
+				m_northBorder[x + z * XSIZE] = chunk->m_northNeighbor->m_blocks[::GetBlockIndex( IntVec3( x, 0, z ) )];
+			}
+		}
+	}
+	if (chunk->m_southNeighbor) {
+		m_southBorder.resize( XSIZE * ZSIZE );
+		for (int z = 0; z < ZSIZE; z++) {
+			for (int x = 0; x < XSIZE; x++) {
+				m_southBorder[x + z * XSIZE] = chunk->m_southNeighbor->m_blocks[::GetBlockIndex( IntVec3( x, YSIZE - 1, z ) )];
+			}
+		}
+	}
+}
+
+Block const* ChunkMeshSnapshot::GetBlock( IntVec3 const& localCoords ) const
+{
+	if (localCoords.z < 0 || localCoords.z >= ZSIZE) {
+		return nullptr;
+	}
+	if (localCoords.x < 0) {
+		return m_westBorder.empty() ? nullptr : &m_westBorder[localCoords.y + localCoords.z * YSIZE];
+	}
+	if (localCoords.x >= XSIZE) {
+		return m_eastBorder.empty() ? nullptr : &m_eastBorder[localCoords.y + localCoords.z * YSIZE];
+	}
+	if (localCoords.y < 0) {
+		return m_southBorder.empty() ? nullptr : &m_southBorder[localCoords.x + localCoords.z * XSIZE];
+	}
+	if (localCoords.y >= YSIZE) {
+		return m_northBorder.empty() ? nullptr : &m_northBorder[localCoords.x + localCoords.z * XSIZE];
+	}
+	return &m_blocks[::GetBlockIndex( localCoords )];
+}
+
+void ChunkMeshSnapshot::BuildVertexArray( std::vector<Vertex_PCU>& verts ) const
+{
+	verts.reserve( 100000 );
+	verts.clear();
+	for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+		BlockDefinition const& def = m_blocks[i].GetDefinition();
+		if (def.m_visible) {
+			IntVec3 coords = ::GetBlockLocalCoordsByIndex( i );
+			Vec3 worldPos = Vec3( m_chunkOriginWorldCoords + coords );
+			// sides
+			// south
+			Block const* southBlock = GetBlock( coords + IntVec3( 0, -1, 0 ) );
+			if (southBlock && !southBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos, worldPos + Vec3( 1.f, 0.f, 0.f ), 
+					worldPos + Vec3( 1.f, 0.f, 1.f ), worldPos + Vec3( 0.f, 0.f, 1.f ),
+					CalculateLightColorForBlock( *southBlock ), def.m_sideUV );
+			}
+			// west
+			Block const* westBlock = GetBlock( coords + IntVec3( -1, 0, 0 ) );
+			if (westBlock && !westBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos + Vec3( 0.f, 1.f, 0.f ), 
+					worldPos, worldPos + Vec3( 0.f, 0.f, 1.f ), 
+					worldPos + Vec3( 0.f, 1.f, 1.f ), CalculateLightColorForBlock( *westBlock ), def.m_sideUV );
+			}
+			// north
+			Block const* northBlock = GetBlock( coords + IntVec3( 0, 1, 0 ) );
+			if (northBlock && !northBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos + Vec3( 1.f, 1.f, 0.f ),
+					worldPos + Vec3( 0.f, 1.f, 0.f ), worldPos + Vec3( 0.f, 1.f, 1.f ), 
+					worldPos + Vec3( 1.f, 1.f, 1.f ), CalculateLightColorForBlock( *northBlock ), def.m_sideUV );
+			}
+			// east
+			Block const* eastBlock = GetBlock( coords + IntVec3( 1, 0, 0 ) );
+			if (eastBlock && !eastBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos + Vec3( 1.f, 0.f, 0.f ), 
+					worldPos + Vec3( 1.f, 1.f, 0.f ), worldPos + Vec3( 1.f, 1.f, 1.f ), 
+					worldPos + Vec3( 1.f, 0.f, 1.f ), CalculateLightColorForBlock( *eastBlock ), def.m_sideUV );
+			}
+			// top
+			Block const* topBlock = GetBlock( coords + IntVec3( 0, 0, 1 ) );
+			if (topBlock && !topBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos + Vec3( 0.f, 0.f, 1.f ), 
+					worldPos + Vec3( 1.f, 0.f, 1.f ), worldPos + Vec3( 1.f, 1.f, 1.f ), 
+					worldPos + Vec3( 0.f, 1.f, 1.f ), CalculateLightColorForBlock( *topBlock ), def.m_topUV );
+			}
+			// bottom
+			Block const* bottomBlock = GetBlock( coords + IntVec3( 0, 0, -1 ) );
+			if (bottomBlock && !bottomBlock->IsOpaque()) {
+				AddVertsForQuad3D( verts, worldPos + Vec3( 0.f, 1.f, 0.f ), 
+					worldPos + Vec3( 1.f, 1.f, 0.f ), worldPos + Vec3( 1.f, 0.f, 0.f ), 
+					worldPos, CalculateLightColorForBlock( *bottomBlock ), def.m_bottomUV );
+			}
+		}
+	}
+}
+
+void ChunkMeshSnapshot::BuildGreedyVertexArray( std::vector<Vertex_Block>& verts, int& out_numOfPerFaceVerts ) const
+{
+	static IntVec3 const faceSteps[NUM_OF_BLOCK_FACES] = { IntVec3( 0, -1, 0 ), IntVec3( -1, 0, 0 ), IntVec3( 0, 1, 0 ), IntVec3( 1, 0, 0 ), IntVec3( 0, 0, 1 ), IntVec3( 0, 0, -1 ) };
+	int const sizes[3] = { XSIZE, YSIZE, ZSIZE };
+
+	verts.reserve( 20000 );
+	verts.clear();
+	int numOfFaces = 0;
+	// face key of every block in a slice: block type in the high byte, light in front of the face in the low byte, -1 for no face
+	std::vector<int> mask;
+	for (int face = 0; face < NUM_OF_BLOCK_FACES; face++) {
+		IntVec3 const& step = faceSteps[face];
+		int normalAxis = step.x != 0 ? 0 : (step.y != 0 ? 1 : 2);
+		int uAxis = normalAxis == 0 ? 1 : 0;
+		int vAxis = normalAxis == 2 ? 1 : 2;
+		int uSize = sizes[uAxis];
+		int vSize = sizes[vAxis];
+		bool isPositive = step.x + step.y + step.z > 0;
+		// keep the corner order (and so the winding and the texture direction) of the one quad per face mesh
+		bool flipU = face == BLOCK_FACE_WEST || face == BLOCK_FACE_NORTH;
+		bool flipV = face == BLOCK_FACE_BOTTOM;
+		mask.resize( uSize * vSize );
+
+		for (int slice = 0; slice < sizes[normalAxis]; slice++) {
+			// 1. find the visible faces of this slice
+			int coords[3];
+			coords[normalAxis] = slice;
+			for (int v = 0; v < vSize; v++) {
+				coords[vAxis] = v;
+				for (int u = 0; u < uSize; u++) {
+					coords[uAxis] = u;
+					IntVec3 localCoords( coords[0], coords[1], coords[2] );
+					Block const& block = m_blocks[::GetBlockIndex( localCoords )];
+					int key = -1;
+					if (block.GetDefinition().m_visible) {
+						Block const* frontBlock = GetBlock( localCoords + step );
+						if (frontBlock && !frontBlock->IsOpaque()) {
+							key = ((int)block.m_type << 8) | (int)frontBlock->m_lightInfluenceData;
+							numOfFaces++;
+						}
+					}
+					mask[u + v * uSize] = key;
+				}
+			}
+
+			// 2. grow each face as wide as possible along u, then as high as possible along v
+			for (int v = 0; v < vSize; v++) {
+				for (int u = 0; u < uSize;) {
+					int key = mask[u + v * uSize];
+					if (key == -1) {
+						u++;
+						continue;
+					}
+					int width = 1;
+					while (u + width < uSize && mask[u + width + v * uSize] == key) {
+						width++;
+					}
+					int height = 1;
+					for (; v + height < vSize; height++) {
+						bool isRowSame = true;
+						for (int k = u; k < u + width; k++) {
+							if (mask[k + (v + height) * uSize] != key) {
+								isRowSame = false;
+								break;
+							}
+						}
+						if (!isRowSame) {
+							break;
+						}
+					}
+					for (int j = v; j < v + height; j++) {
+						for (int k = u; k < u + width; k++) {
+							mask[k + j * uSize] = -1;
+						}
+					}
+
+					// 3. emit the merged quad
+					Vertex_Block corners[4];
+					int uLow = flipU ? u + width : u;
+					int uHigh = flipU ? u : u + width;
+					int vLow = flipV ? v + height : v;
+					int vHigh = flipV ? v : v + height;
+					int cornerUs[4] = { uLow, uHigh, uHigh, uLow };
+					int cornerVs[4] = { vLow, vLow, vHigh, vHigh };
+					for (int c = 0; c < 4; c++) {
+						int cornerCoords[3];
+						cornerCoords[normalAxis] = isPositive ? slice + 1 : slice;
+						cornerCoords[uAxis] = cornerUs[c];
+						cornerCoords[vAxis] = cornerVs[c];
+						corners[c].m_localX = (unsigned char)cornerCoords[0];
+						corners[c].m_localY = (unsigned char)cornerCoords[1];
+						corners[c].m_localZ = (unsigned char)cornerCoords[2];
+						corners[c].m_face = (unsigned char)face;
+						corners[c].m_blockType = (unsigned char)(key >> 8);
+						corners[c].m_light = (unsigned char)(key & 0xff);
+					}
+					// same triangles as AddVertsForQuad3D: BL BR TR, TL BL TR
+					verts.push_back( corners[0] );
+					verts.push_back( corners[1] );
+					verts.push_back( corners[2] );
+					verts.push_back( corners[3] );
+					verts.push_back( corners[0] );
+					verts.push_back( corners[2] );
+					u += width;
+				}
+			}
+		}
+	}
+	out_numOfPerFaceVerts = numOfFaces * 6;
+}
+
+Rgba8 ChunkMeshSnapshot::CalculateLightColorForBlock( Block const& block )
+{
+	unsigned char indoorLightIntensity = 0;
+	unsigned char outdoorLightIntensity = 0;
+	indoorLightIntensity = block.GetIndoorLightInfluence();
+	indoorLightIntensity = indoorLightIntensity * 17;
+	outdoorLightIntensity = block.GetOutdoorLightInfluence();
+	outdoorLightIntensity = outdoorLightIntensity * 17;
+	return Rgba8( outdoorLightIntensity, indoorLightIntensity, 127 );
+}
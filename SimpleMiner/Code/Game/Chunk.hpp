@@ -1,6 +1,7 @@
 #pragma once
 #include "Game/GameCommon.hpp"
 #include "Game/Block.hpp"
+#include <deque>
 
 constexpr int XBITS = 4;
 constexpr int YBITS = 4;
@@ -20,6 +21,14 @@ constexpr int ZBITS_SHIFT = XBITS + YBITS;
 
 struct BlockIter;
 class BlockTemplate;
+class Chunk;
+class ChunkMeshJob;
+
+// a change one chunk's lighting pass found for another chunk, the world applies it after the pass
+struct ChunkLightPush {
+	Chunk* m_chunk = nullptr;
+	int m_blockIndex = -1; // -1: only the mesh of m_chunk has to be rebuilt
+};
 
 enum class ChunkState {
 	MISSING, 
@@ -44,6 +53,72 @@ enum class ChunkState {
 	NUM,
 };
 
+// faces in the order they are meshed, Data/Shaders/WorldPacked.hlsl uses the same numbers
+constexpr unsigned char BLOCK_FACE_SOUTH = 0;
+constexpr unsigned char BLOCK_FACE_WEST = 1;
+constexpr unsigned char BLOCK_FACE_NORTH = 2;
+constexpr unsigned char BLOCK_FACE_EAST = 3;
+constexpr unsigned char BLOCK_FACE_TOP = 4;
+constexpr unsigned char BLOCK_FACE_BOTTOM = 5;
+constexpr int NUM_OF_BLOCK_FACES = 6;
+
+//-----------------------------------------------------------------------------------------------
+// 8 byte vertex of the greedy mesh (VertexType::BYTE4_BYTE4), decoded in Data/Shaders/WorldPacked.hlsl
+// UVs are not stored: the shader tiles the block's sprite over the quad from the position and the face
+struct Vertex_Block {
+	unsigned char m_localX = 0; // corner position inside the chunk, 0 to XSIZE
+	unsigned char m_localY = 0;
+	unsigned char m_localZ = 0;
+	unsigned char m_face = 0;
+	unsigned char m_blockType = 0;
+	unsigned char m_light = 0; // same nibbles as Block::m_lightInfluenceData of the block in front of the face
+	unsigned char m_pad0 = 0;
+	unsigned char m_pad1 = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Everything meshing reads: a copy of the chunk's blocks plus the one block thick border of each neighbor
+// Taken on the main thread, so the vertex array can be built on a worker while the world keeps editing the chunk
+struct ChunkMeshSnapshot {
+	void TakeFrom( Chunk const* chunk );
+	void BuildVertexArray( std::vector<Vertex_PCU>& verts ) const;
+	// merges coplanar faces with the same block type and light into one quad, out_numOfPerFaceVerts is what BuildVertexArray would have made
+	void BuildGreedyVertexArray( std::vector<Vertex_Block>& verts, int& out_numOfPerFaceVerts ) const;
+	// coords may be one block outside the chunk horizontally, returns nullptr if there is no block there
+	Block const* GetBlock( IntVec3 const& localCoords ) const;
+	static Rgba8 CalculateLightColorForBlock( Block const& block );
+
+	IntVec3 m_chunkOriginWorldCoords;
+	std::vector<Block> m_blocks;
+	// east/west borders are indexed by (y + z * YSIZE), north/south by (x + z * XSIZE); empty if the neighbor is not active
+	std::vector<Block> m_eastBorder;
+	std::vector<Block> m_westBorder;
+	std::vector<Block> m_northBorder;
+	std::vector<Block> m_southBorder;
+};
+
+//-----------------------------------------------------------------------------------------------
+// Raw 2D noise of every block column GenerateBlocks reads, computed once per chunk
+// The border columns are for trees planted in a neighbor whose leaves reach into this chunk
+constexpr int CHUNK_NOISE_BORDER = 2;
+constexpr int CHUNK_NOISE_SIZE_X = XSIZE + 2 * CHUNK_NOISE_BORDER;
+constexpr int CHUNK_NOISE_SIZE_Y = YSIZE + 2 * CHUNK_NOISE_BORDER;
+
+struct ChunkNoiseFields {
+	// useBatchNoise false: one Compute2dPerlinNoise call per column and field, same results, for comparison
+	void Compute( IntVec3 const& chunkOriginWorldCoords, bool useBatchNoise = true );
+	// local coords of the chunk, in [-CHUNK_NOISE_BORDER, XSIZE + CHUNK_NOISE_BORDER)
+	static int GetIndex( int localX, int localY ) { return (localX + CHUNK_NOISE_BORDER) + (localY + CHUNK_NOISE_BORDER) * CHUNK_NOISE_SIZE_X; }
+
+	float m_hilliness[CHUNK_NOISE_SIZE_X * CHUNK_NOISE_SIZE_Y];
+	float m_terrainHeight[CHUNK_NOISE_SIZE_X * CHUNK_NOISE_SIZE_Y];
+	float m_oceanness[CHUNK_NOISE_SIZE_X * CHUNK_NOISE_SIZE_Y];
+	float m_forestness[CHUNK_NOISE_SIZE_X * CHUNK_NOISE_SIZE_Y];
+	// only the border trees need these outside the chunk, they call Compute2dPerlinNoise themselves
+	float m_humidity[XSIZE * YSIZE];
+	float m_temperature[XSIZE * YSIZE];
+};
+
 class Chunk {
 public:
 	Chunk( IntVec2 const& coords );
@@ -52,7 +127,7 @@ public:
 	void Update( float deltaSeconds );
 	void Render() const;
 
-	void GenerateBlocks();
+	void GenerateBlocks( bool useBatchNoise = true );
 	void SetSkyLight();
 
 	IntVec3 GetBlockWorldCoords( IntVec3 const& localCoords ) const;
@@ -63,20 +138,35 @@ public:
 	void PutTopBlockOfStack( IntVec2 const& localCoords );
 	
 	void SetBlockType( int blockIndex, unsigned char blockType, bool isPut=true );
+	// region file first, chunks of the old one file per chunk format are still loaded
 	void SaveToFile() const;
 	bool ReadFromFile();
+	void GetBlockTypes( std::vector<uint8_t>& out_blockTypes ) const;
+	void SetBlockTypes( std::vector<uint8_t> const& blockTypes );
+	// old format: "GCHK", version, XBITS, YBITS, ZBITS, seed, then (type, count) pairs
+	static void WriteLegacyChunkFile( std::vector<uint8_t> const& blockTypes, std::string const& filePath );
+	static bool ReadLegacyChunkFile( std::string const& filePath, std::vector<uint8_t>& out_blockTypes );
+	static std::string GetLegacyChunkFilePath( IntVec2 const& chunkCoords );
 
 	void MarkDirty();
+	// main thread only, takes the verts and uploads them to a new vertex buffer
+	void UploadVertexArray( std::vector<Vertex_PCU>& verts );
+	void UploadVertexArray( std::vector<Vertex_Block>& verts, int numOfPerFaceVerts );
+	size_t GetVertexBufferBytes() const;
 
 	int GetBlockIndex( IntVec3 const& localCoords ) const;
 	IntVec3 GetBlockLocalCoordsByIndex( int index ) const;
 
 	void AddBlockTemplate( BlockTemplate const& temp, IntVec3 const& localOriginPos );
+
+	/// drain m_lightDirtyQueue, only writes blocks of this chunk and reads the border blocks of the neighbors,
+	/// so chunks that do not share a face can run it at the same time
+	/// dirty blocks and mesh rebuilds of other chunks (and of this one) go to out_pushes
+	void PropagateDirtyLighting( std::vector<ChunkLightPush>& out_pushes );
 protected:
 	bool IsCoordsInBounds( IntVec3 const& coords ) const;
 	void BuildVertexArrayAndBuffer();
 	bool IsBlockSurfaceHidden( IntVec3 const& coords, IntVec3 const& step ) const;
-	Rgba8 CalculateLightColorForBlock( BlockIter const& blockIter ) const;
 
 	void ClearBlocksOverlapSphere( Vec3 const& sphereCenter, float sphereRadius );
 	void ClearBlocksOverlapCapsule( Vec3 const& capsuleStart, Vec3 const& capsuleEnd, float capsuleRadius );
@@ -87,6 +177,9 @@ public:
 	AABB3 m_bounds;
 	IntVec2 m_coords;
 	std::vector<Vertex_PCU> m_verts;
+	std::vector<Vertex_Block> m_packedVerts;
+	bool m_isMeshPacked = false;
+	int m_numOfPerFaceVerts = 0; // verts of the one quad per face mesh, to show what greedy meshing saves
 	VertexBuffer* m_vertexBuffer = nullptr;
 	Block* m_blocks;
 
@@ -96,5 +189,10 @@ public:
 	Chunk* m_southNeighbor = nullptr;
 	Chunk* m_eastNeighbor = nullptr;
 	Chunk* m_westNeighbor = nullptr;
+	// mesh job in flight, the chunk is not meshed again until it comes back
+	ChunkMeshJob* m_meshJob = nullptr;
+	// block indices waiting for a lighting update, every block in it has the light dirty bit set
+	std::deque<int> m_lightDirtyQueue;
+	bool m_isInLightDirtyList = false;
 	std::atomic<ChunkState> m_state = ChunkState::CONSTRUCTING;
 };
\ No newline at end of file
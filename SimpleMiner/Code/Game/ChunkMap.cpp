@@ -0,0 +1,120 @@
+#include "Game/ChunkMap.hpp"
+
+ChunkMap::ChunkMap( int initialCapacity )
+{
+	int numOfSlots = 16;
+	while (numOfSlots < initialCapacity * 2) {
+		numOfSlots <<= 1;
+	}
+	Rehash( numOfSlots );
+}
+
+Chunk* ChunkMap::Find( IntVec2 const& coords ) const
+{
+	int slot = FindSlot( PackCoords( coords ) );
+	if (slot < 0) {
+		return nullptr;
+	}
+	return m_chunks[m_slots[slot].m_denseIndex];
+}
+
+bool ChunkMap::Contains( IntVec2 const& coords ) const
+{
+	return FindSlot( PackCoords( coords ) ) >= 0;
+}
+
+void ChunkMap::Insert( IntVec2 const& coords, Chunk* chunk )
+{
+	// keep the load factor at most 1/2 so probe sequences stay short
+	if (((int)m_chunks.size() + 1) * 2 > (int)m_slots.size()) {
+		Rehash( (int)m_slots.size() * 2 );
+	}
+	uint64_t key = PackCoords( coords );
+	int slot = GetHomeSlot( key );
+	while (m_slots[slot].m_denseIndex >= 0) {
+		if (m_slots[slot].m_key == key) {
+			m_chunks[m_slots[slot].m_denseIndex] = chunk;
+			return;
+		}
+		slot = (slot + 1) & m_slotMask;
+	}
+	m_slots[slot].m_key = key;
+	m_slots[slot].m_denseIndex = (int)m_chunks.size();
+	m_chunks.push_back( chunk );
+	m_coords.push_back( coords );
+}
+
+bool ChunkMap::Erase( IntVec2 const& coords )
+{
+	int slot = FindSlot( PackCoords( coords ) );
+	if (slot < 0) {
+		return false;
+	}
+
+	// fill the hole in the dense arrays with the last element
+	int denseIndex = m_slots[slot].m_denseIndex;
+	int lastIndex = (int)m_chunks.size() - 1;
+	if (denseIndex != lastIndex) {
+		m_chunks[denseIndex] = m_chunks[lastIndex];
+		m_coords[denseIndex] = m_coords[lastIndex];
+		m_slots[FindSlot( PackCoords( m_coords[denseIndex] ) )].m_denseIndex = denseIndex;
+	}
+	m_chunks.pop_back();
+	m_coords.pop_back();
+
+	// backward shift deletion: pull later entries of the probe run into the hole, no tombstones
+	int hole = slot;
+	int next = (hole + 1) & m_slotMask;
+	while (m_slots[next].m_denseIndex >= 0) {
+		int homeSlot = GetHomeSlot( m_slots[next].m_key );
+		// the entry can move back if its home slot is not between the hole and itself
+		if (((next - homeSlot) & m_slotMask) >= ((next - hole) & m_slotMask)) {
+			m_slots[hole] = m_slots[next];
+			hole = next;
+		}
+		next = (next + 1) & m_slotMask;
+	}
+	m_slots[hole].m_denseIndex = -1;
+	return true;
+}
+
+void ChunkMap::Clear()
+{
+	for (Slot& slot : m_slots) {
+		slot.m_denseIndex = -1;
+	}
+	m_chunks.clear();
+	m_coords.clear();
+}
+
+int ChunkMap::FindSlot( uint64_t key ) const
+{
+	int slot = GetHomeSlot( key );
+	while (m_slots[slot].m_denseIndex >= 0) {
+		if (m_slots[slot].m_key == key) {
+			return slot;
+		}
+		slot = (slot + 1) & m_slotMask;
+	}
+	return -1;
+}
+
+void ChunkMap::Rehash( int numOfSlots )
+{
+	m_slotBits = 0;
+	while ((1 << m_slotBits) < numOfSlots) {
+		m_slotBits++;
+	}
+	m_slots.clear();
+	m_slots.resize( (size_t)1 << m_slotBits );
+	m_slotMask = (1 << m_slotBits) - 1;
+	for (int i = 0; i < (int)m_coords.size(); i++) {
+		uint64_t key = PackCoords( m_coords[i] );
+		int slot = GetHomeSlot( key );
+		while (m_slots[slot].m_denseIndex >= 0) {
+			slot = (slot + 1) & m_slotMask;
+		}
+		m_slots[slot].m_key = key;
+		m_slots[slot].m_denseIndex = i;
+	}
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+
+class Chunk;
+
+// open addressing hash map from chunk coords to chunk, linear probing over a power of two table
+// the chunks are also kept in a dense array, so walking every chunk never touches the table
+// the map never dereferences the chunk pointers
+class ChunkMap {
+public:
+	ChunkMap( int initialCapacity = 1024 );
+
+	Chunk* Find( IntVec2 const& coords ) const;
+	bool Contains( IntVec2 const& coords ) const;
+	/// replace the chunk if the coords are already in the map
+	void Insert( IntVec2 const& coords, Chunk* chunk );
+	bool Erase( IntVec2 const& coords );
+	void Clear();
+
+	int GetSize() const;
+	bool IsEmpty() const;
+	/// dense arrays in the same order, erasing moves the last element into the hole
+	std::vector<Chunk*> const& GetChunks() const;
+	std::vector<IntVec2> const& GetCoords() const;
+	std::vector<Chunk*>::const_iterator begin() const;
+	std::vector<Chunk*>::const_iterator end() const;
+
+	static uint64_t PackCoords( IntVec2 const& coords );
+protected:
+	int GetHomeSlot( uint64_t key ) const;
+	/// slot that holds the key, -1 if the key is not in the map
+	int FindSlot( uint64_t key ) const;
+	void Rehash( int numOfSlots );
+protected:
+	struct Slot {
+		uint64_t m_key = 0;
+		int m_denseIndex = -1; // -1 means the slot is empty
+	};
+	std::vector<Slot> m_slots;
+	int m_slotMask = 0;
+	int m_slotBits = 0;
+	std::vector<Chunk*> m_chunks;
+	std::vector<IntVec2> m_coords;
+};
+
+inline int ChunkMap::GetSize() const
+{
+	return (int)m_chunks.size();
+}
+
+inline bool ChunkMap::IsEmpty() const
+{
+	return m_chunks.empty();
+}
+
+inline std::vector<Chunk*> const& ChunkMap::GetChunks() const
+{
+	return m_chunks;
+}
+
+inline std::vector<IntVec2> const& ChunkMap::GetCoords() const
+{
+	return m_coords;
+}
+
+inline std::vector<Chunk*>::const_iterator ChunkMap::begin() const
+{
+	return m_chunks.begin();
+}
+
+inline std::vector<Chunk*>::const_iterator ChunkMap::end() const
+{
+	return m_chunks.end();
+}
+
+inline uint64_t ChunkMap::PackCoords( IntVec2 const& coords )
+{
+	return ((uint64_t)(uint32_t)coords.x << 32) | (uint64_t)(uint32_t)coords.y;
+}
+
+inline int ChunkMap::GetHomeSlot( uint64_t key ) const
+{
+	// fibonacci hashing, the high bits of the product mix both coords
+	return (int)((key * 0x9E3779B97F4A7C15ull) >> (64 - m_slotBits));
+}
@@ -166,8 +166,9 @@ void Game::UpdateDebugRender()
 {
 	DebugAddScreenText( Stringf( "Time: %.2f FPS: %.2f Scale: %.1f", Clock::GetSystemClock()->GetTotalSeconds(), 1.f / Clock::GetSystemClock()->GetDeltaSeconds(), Clock::GetSystemClock()->GetTimeScale() ), m_screenCamera.m_cameraBox.m_maxs - Vec2( 400.f, 20.f ), 20.f, Vec2( 0.5f, 0.5f ), 0.f, Rgba8::WHITE, Rgba8::WHITE );
 	DebugAddMessage( Stringf( "Player Position: %.2f %.2f %.2f", m_world->GetPlayer()->m_position.x, m_world->GetPlayer()->m_position.y, m_world->GetPlayer()->m_position.z ), 0.f, Rgba8( 255, 255, 255 ), Rgba8( 255, 255, 255 ) );
-	DebugAddMessage( Stringf( "Chunks: %d/%d Blocks: %d Verts: %d", m_world->m_activeChunks.size(), m_world->m_maxChunks, m_world->m_activeChunks.size() * BLOCK_COUNT_EACH_CHUNK, m_world->GetVertsCount() ), 0.f, Rgba8( 255, 255, 255 ), Rgba8( 255, 255, 255 ) );
+	DebugAddMessage( Stringf( "Chunks: %d/%d Blocks: %d Verts: %d", m_world->m_activeChunks.GetSize(), m_world->m_maxChunks, m_world->m_activeChunks.GetSize() * BLOCK_COUNT_EACH_CHUNK, m_world->GetVertsCount() ), 0.f, Rgba8( 255, 255, 255 ), Rgba8( 255, 255, 255 ) );
 	DebugAddMessage( m_world->GetCurDayTimeText(), 0.f, Rgba8( 255, 255, 255 ), Rgba8( 255, 255, 255 ) );
+	DebugAddMessage( Stringf( "Meshing(M): %s Mesh jobs: %d Dirty chunks: %d", g_asyncChunkMeshing ? "jobs" : "main thread", (int)m_world->m_chunkMeshJobs.size(), (int)m_world->m_dirtyChunks.size() ), 0.f, Rgba8( 255, 255, 255 ), Rgba8( 255, 255, 255 ) );
 }
 
 void Game::SetupDefinitions()
@@ -7,6 +7,9 @@ bool g_hiddenSurfaceRemovalEnable = true;
 float g_chunkActivationDist = 250.f;
 bool g_autoCreateChunks = true;
 bool g_saveModifiedChunks = true;
+bool g_asyncChunkMeshing = true;
+bool g_greedyChunkMeshing = true;
+bool g_parallelLighting = true;
 
 void DebugDrawRing(Vec2 const& center, float radius, float thickness, Rgba8 const& color ) {
 	constexpr int NUM_SIDES = 16;
@@ -60,6 +60,9 @@ extern bool g_hiddenSurfaceRemovalEnable;
 extern float g_chunkActivationDist;
 extern bool g_autoCreateChunks;
 extern bool g_saveModifiedChunks;
+extern bool g_asyncChunkMeshing;
+extern bool g_greedyChunkMeshing;
+extern bool g_parallelLighting;
 
 // constant variables
 constexpr float UI_SIZE_X = 1600.f;
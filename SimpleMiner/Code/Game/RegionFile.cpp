@@ -0,0 +1,351 @@
+#include "Game/RegionFile.hpp"
+#include "Game/Chunk.hpp"
+#include "Game/World.hpp"
+#define MINIZ_HEADER_FILE_ONLY
+#include "ThirdParty/zip/miniz.h"
+#include <filesystem>
+
+RegionFile::RegionFile( std::string const& filePath )
+	:m_filePath(filePath)
+{
+}
+
+RegionFile::~RegionFile()
+{
+	Close();
+}
+
+bool RegionFile::Open( bool create )
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if (m_file) {
+		return true;
+	}
+	errno_t errNo = fopen_s( &m_file, m_filePath.c_str(), "r+b" );
+	if (errNo == 0 && m_file) {
+		std::vector<uint8_t> header;
+		header.resize( (size_t)REGION_HEADER_SECTORS * REGION_SECTOR_BYTES );
+		size_t numOfReadBytes = fread( header.data(), 1, header.size(), m_file );
+		BufferReader reader( header.data(), numOfReadBytes );
+		if (numOfReadBytes != header.size() || reader.ParseChar() != 'G' || reader.ParseChar() != 'R' || reader.ParseChar() != 'G' || reader.ParseChar() != 'N'
+			|| reader.ParseByte() != REGION_FILE_VERSION || reader.ParseByte() != XBITS || reader.ParseByte() != YBITS || reader.ParseByte() != ZBITS
+			|| reader.ParseUint32() != g_terrainSeed) {
+			// written by another build or world, its chunks are kept in a backup and a fresh file is created on the next save
+			fclose( m_file );
+			m_file = nullptr;
+			if (!create || !BackUpMismatchedFile()) {
+				return false;
+			}
+		}
+		else {
+			reader.SetCurReadPosition( REGION_HEADER_BYTES );
+			for (int i = 0; i < CHUNKS_EACH_REGION; i++) {
+				m_firstSectors[i] = reader.ParseUint32();
+				m_byteSizes[i] = reader.ParseUint32();
+			}
+			// rebuild the free list, sectors of overwritten payloads are reused by later saves
+			fseek( m_file, 0, SEEK_END );
+			int numOfSectors = (int)(ftell( m_file ) / REGION_SECTOR_BYTES);
+			m_usedSectors.clear();
+			m_usedSectors.resize( numOfSectors > REGION_HEADER_SECTORS ? numOfSectors : REGION_HEADER_SECTORS, false );
+			SetSectorsUsed( 0, REGION_HEADER_SECTORS, true );
+			for (int i = 0; i < CHUNKS_EACH_REGION; i++) {
+				if (m_byteSizes[i] > 0) {
+					SetSectorsUsed( (int)m_firstSectors[i], GetNumOfSectors( m_byteSizes[i] ), true );
+				}
+			}
+			return true;
+		}
+	}
+
+	m_file = nullptr;
+	if (!create) {
+		return false;
+	}
+	// a file that is there but could not be opened is never truncated
+	std::error_code errorCode;
+	if (std::filesystem::exists( m_filePath, errorCode )) {
+		DebuggerPrintf( "Region file %s exists but cannot be opened, its chunks are not saved\n", m_filePath.c_str() );
+		return false;
+	}
+	errNo = fopen_s( &m_file, m_filePath.c_str(), "w+b" );
+	if (errNo != 0 || !m_file) {
+		m_file = nullptr;
+		return false;
+	}
+	std::vector<uint8_t> header;
+	header.reserve( (size_t)REGION_HEADER_SECTORS * REGION_SECTOR_BYTES );
+	BufferWriter writer( header );
+	writer.AppendChar( 'G' );
+	writer.AppendChar( 'R' );
+	writer.AppendChar( 'G' );
+	writer.AppendChar( 'N' );
+	writer.AppendByte( REGION_FILE_VERSION );
+	writer.AppendByte( (uint8_t)XBITS );
+	writer.AppendByte( (uint8_t)YBITS );
+	writer.AppendByte( (uint8_t)ZBITS );
+	writer.AppendUint32( g_terrainSeed );
+	writer.AppendUint32( 0 );
+	header.resize( (size_t)REGION_HEADER_SECTORS * REGION_SECTOR_BYTES, 0 );
+	fwrite( header.data(), 1, header.size(), m_file );
+	fflush( m_file );
+
+	memset( m_firstSectors, 0, sizeof( m_firstSectors ) );
+	memset( m_byteSizes, 0, sizeof( m_byteSizes ) );
+	m_usedSectors.clear();
+	m_usedSectors.resize( REGION_HEADER_SECTORS, true );
+	return true;
+}
+
+bool RegionFile::BackUpMismatchedFile() const
+{
+	// never overwrite an older backup
+	std::string backupPath = m_filePath + ".bak";
+	for (int i = 1; std::filesystem::exists( backupPath ); i++) {
+		backupPath = Stringf( "%s.bak%d", m_filePath.c_str(), i );
+	}
+	std::error_code errorCode;
+	std::filesystem::rename( m_filePath, backupPath, errorCode );
+	if (errorCode) {
+		DebuggerPrintf( "Region file %s does not match this world and cannot be backed up, it is left untouched and its chunks are not saved\n", m_filePath.c_str() );
+		return false;
+	}
+	DebuggerPrintf( "Region file %s does not match this world, moved it to %s\n", m_filePath.c_str(), backupPath.c_str() );
+	return true;
+}
+
+void RegionFile::Close()
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if (m_file) {
+		fclose( m_file );
+		m_file = nullptr;
+	}
+}
+
+bool RegionFile::HasChunk( int chunkIndex )
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	return m_file && m_byteSizes[chunkIndex] > 0;
+}
+
+bool RegionFile::ReadChunk( int chunkIndex, std::vector<uint8_t>& out_payload )
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if (!m_file || m_byteSizes[chunkIndex] == 0) {
+		return false;
+	}
+	out_payload.resize( m_byteSizes[chunkIndex] );
+	fseek( m_file, (long)m_firstSectors[chunkIndex] * REGION_SECTOR_BYTES, SEEK_SET );
+	return fread( out_payload.data(), 1, out_payload.size(), m_file ) == out_payload.size();
+}
+
+bool RegionFile::WriteChunk( int chunkIndex, std::vector<uint8_t> const& payload )
+{
+	std::lock_guard<std::mutex> lock( m_mutex );
+	if (!m_file || payload.empty()) {
+		return false;
+	}
+	// give back the old sectors first, a payload that still fits is written in place
+	if (m_byteSizes[chunkIndex] > 0) {
+		SetSectorsUsed( (int)m_firstSectors[chunkIndex], GetNumOfSectors( m_byteSizes[chunkIndex] ), false );
+	}
+	int numOfSectors = GetNumOfSectors( (uint32_t)payload.size() );
+	int firstSector = FindFreeSectors( numOfSectors );
+	SetSectorsUsed( firstSector, numOfSectors, true );
+
+	// pad the last sector so the file always ends on a sector boundary
+	std::vector<uint8_t> padding;
+	padding.resize( (size_t)numOfSectors * REGION_SECTOR_BYTES - payload.size(), 0 );
+	fseek( m_file, (long)firstSector * REGION_SECTOR_BYTES, SEEK_SET );
+	fwrite( payload.data(), 1, payload.size(), m_file );
+	fwrite( padding.data(), 1, padding.size(), m_file );
+
+	m_firstSectors[chunkIndex] = (uint32_t)firstSector;
+	m_byteSizes[chunkIndex] = (uint32_t)payload.size();
+	std::vector<uint8_t> entry;
+	entry.reserve( REGION_TABLE_ENTRY_BYTES );
+	BufferWriter writer( entry );
+	writer.AppendUint32( m_firstSectors[chunkIndex] );
+	writer.AppendUint32( m_byteSizes[chunkIndex] );
+	fseek( m_file, (long)(REGION_HEADER_BYTES + chunkIndex * REGION_TABLE_ENTRY_BYTES), SEEK_SET );
+	fwrite( entry.data(), 1, entry.size(), m_file );
+	fflush( m_file );
+	return true;
+}
+
+int RegionFile::GetChunkIndexInRegion( IntVec2 const& chunkCoords )
+{
+	return (chunkCoords.x & (REGION_SIZE - 1)) | ((chunkCoords.y & (REGION_SIZE - 1)) << REGION_SIZE_BITS);
+}
+
+int RegionFile::FindFreeSectors( int numOfSectors ) const
+{
+	// first fit, append to the end of the file if no gap is big enough
+	int runStart = 0;
+	int runLength = 0;
+	for (int i = REGION_HEADER_SECTORS; i < (int)m_usedSectors.size(); i++) {
+		if (m_usedSectors[i]) {
+			runLength = 0;
+			continue;
+		}
+		if (runLength == 0) {
+			runStart = i;
+		}
+		runLength++;
+		if (runLength == numOfSectors) {
+			return runStart;
+		}
+	}
+	return runLength > 0 ? runStart : (int)m_usedSectors.size();
+}
+
+void RegionFile::SetSectorsUsed( int firstSector, int numOfSectors, bool isUsed )
+{
+	if ((int)m_usedSectors.size() < firstSector + numOfSectors) {
+		m_usedSectors.resize( (size_t)firstSector + numOfSectors, false );
+	}
+	for (int i = firstSector; i < firstSector + numOfSectors; i++) {
+		m_usedSectors[i] = isUsed;
+	}
+}
+
+int RegionFile::GetNumOfSectors( uint32_t numOfBytes )
+{
+	return (int)((numOfBytes + REGION_SECTOR_BYTES - 1) / REGION_SECTOR_BYTES);
+}
+
+RegionStorage::RegionStorage( std::string const& folderPath )
+	:m_folderPath(folderPath)
+{
+}
+
+RegionStorage::~RegionStorage()
+{
+	for (auto& pair : m_regions) {
+		delete pair.second;
+	}
+	m_regions.clear();
+}
+
+bool RegionStorage::HasChunk( IntVec2 const& chunkCoords )
+{
+	RegionFile* regionFile = GetRegionFile( GetRegionCoords( chunkCoords ), false );
+	return regionFile && regionFile->HasChunk( RegionFile::GetChunkIndexInRegion( chunkCoords ) );
+}
+
+bool RegionStorage::SaveChunk( IntVec2 const& chunkCoords, std::vector<uint8_t> const& blockTypes )
+{
+	// compress outside of the file lock
+	std::vector<uint8_t> payload;
+	EncodeChunkPayload( blockTypes, payload );
+	RegionFile* regionFile = GetRegionFile( GetRegionCoords( chunkCoords ), true );
+	return regionFile && regionFile->WriteChunk( RegionFile::GetChunkIndexInRegion( chunkCoords ), payload );
+}
+
+bool RegionStorage::LoadChunk( IntVec2 const& chunkCoords, std::vector<uint8_t>& out_blockTypes )
+{
+	RegionFile* regionFile = GetRegionFile( GetRegionCoords( chunkCoords ), false );
+	std::vector<uint8_t> payload;
+	if (!regionFile || !regionFile->ReadChunk( RegionFile::GetChunkIndexInRegion( chunkCoords ), payload )) {
+		return false;
+	}
+	return DecodeChunkPayload( payload, out_blockTypes );
+}
+
+void RegionStorage::CloseAll()
+{
+	// only safe when no job is reading or writing through this storage
+	std::lock_guard<std::mutex> lock( m_regionsMutex );
+	for (auto& pair : m_regions) {
+		delete pair.second;
+	}
+	m_regions.clear();
+	m_missingRegions.clear();
+}
+
+IntVec2 RegionStorage::GetRegionCoords( IntVec2 const& chunkCoords )
+{
+	// arithmetic shift keeps negative chunks in the right region
+	return IntVec2( chunkCoords.x >> REGION_SIZE_BITS, chunkCoords.y >> REGION_SIZE_BITS );
+}
+
+void RegionStorage::EncodeChunkPayload( std::vector<uint8_t> const& blockTypes, std::vector<uint8_t>& out_payload )
+{
+	out_payload.clear();
+	out_payload.reserve( CHUNK_PAYLOAD_HEADER_BYTES + (size_t)mz_compressBound( (mz_ulong)blockTypes.size() ) );
+	BufferWriter writer( out_payload );
+	writer.AppendByte( (uint8_t)ChunkCompression::Deflate );
+	writer.AppendByte( CHUNK_PAYLOAD_VERSION );
+	writer.AppendUshort( 0 );
+	writer.AppendUint32( (unsigned int)blockTypes.size() );
+
+	// fastest level, chunks are mostly long runs of stone, air and water so the ratio barely changes with higher levels
+	mz_ulong compressedSize = mz_compressBound( (mz_ulong)blockTypes.size() );
+	out_payload.resize( CHUNK_PAYLOAD_HEADER_BYTES + (size_t)compressedSize );
+	int res = mz_compress2( out_payload.data() + CHUNK_PAYLOAD_HEADER_BYTES, &compressedSize, blockTypes.data(), (mz_ulong)blockTypes.size(), MZ_BEST_SPEED );
+	if (res == MZ_OK && compressedSize < (mz_ulong)blockTypes.size()) {
+		out_payload.resize( CHUNK_PAYLOAD_HEADER_BYTES + (size_t)compressedSize );
+		return;
+	}
+	out_payload[0] = (uint8_t)ChunkCompression::None;
+	out_payload.resize( CHUNK_PAYLOAD_HEADER_BYTES );
+	out_payload.insert( out_payload.end(), blockTypes.begin(), blockTypes.end() );
+}
+
+bool RegionStorage::DecodeChunkPayload( std::vector<uint8_t> const& payload, std::vector<uint8_t>& out_blockTypes )
+{
+	if ((int)payload.size() < CHUNK_PAYLOAD_HEADER_BYTES) {
+		return false;
+	}
+	BufferReader reader( payload );
+	ChunkCompression compression = (ChunkCompression)reader.ParseByte();
+	uint8_t version = reader.ParseByte();
+	reader.ParseUshort();
+	unsigned int numOfBlocks = reader.ParseUint32();
+	if (version != CHUNK_PAYLOAD_VERSION || numOfBlocks != (unsigned int)BLOCK_COUNT_EACH_CHUNK) {
+		return false;
+	}
+	out_blockTypes.resize( numOfBlocks );
+	if (compression == ChunkCompression::None) {
+		if (payload.size() != CHUNK_PAYLOAD_HEADER_BYTES + (size_t)numOfBlocks) {
+			return false;
+		}
+		memcpy( out_blockTypes.data(), payload.data() + CHUNK_PAYLOAD_HEADER_BYTES, numOfBlocks );
+		return true;
+	}
+	else if (compression == ChunkCompression::Deflate) {
+		mz_ulong uncompressedSize = (mz_ulong)numOfBlocks;
+		int res = mz_uncompress( out_blockTypes.data(), &uncompressedSize, payload.data() + CHUNK_PAYLOAD_HEADER_BYTES, (mz_ulong)(payload.size() - CHUNK_PAYLOAD_HEADER_BYTES) );
+		return res == MZ_OK && uncompressedSize == (mz_ulong)numOfBlocks;
+	}
+	return false;
+}
+
+RegionFile* RegionStorage::GetRegionFile( IntVec2 const& regionCoords, bool create )
+{
+	std::lock_guard<std::mutex> lock( m_regionsMutex );
+	auto iter = m_regions.find( regionCoords );
+	if (iter != m_regions.end()) {
+		return iter->second;
+	}
+	// every chunk activation asks, only the first one for a region without a file touches the disk
+	if (!create && m_missingRegions.find( regionCoords ) != m_missingRegions.end()) {
+		return nullptr;
+	}
+	if (create) {
+		std::error_code errorCode;
+		std::filesystem::create_directories( m_folderPath, errorCode );
+	}
+	RegionFile* regionFile = new RegionFile( Stringf( "%s/Region(%d,%d).region", m_folderPath.c_str(), regionCoords.x, regionCoords.y ) );
+	if (!regionFile->Open( create )) {
+		delete regionFile;
+		if (!create) {
+			m_missingRegions.insert( regionCoords );
+		}
+		return nullptr;
+	}
+	m_missingRegions.erase( regionCoords );
+	m_regions[regionCoords] = regionFile;
+	return regionFile;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "Game/GameCommon.hpp"
+#include <map>
+#include <set>
+#include <mutex>
+#include <cstdio>
+
+// anvil style chunk storage, REGION_SIZE x REGION_SIZE chunks share one file:
+// | header 16B: "GRGN", version, XBITS, YBITS, ZBITS, seed, reserved | table: (first sector, byte size) per chunk | 4KB sectors ... |
+// every chunk payload starts at a sector boundary, a load or a save only touches its own sectors and its table entry
+constexpr int REGION_SIZE_BITS = 5;
+constexpr int REGION_SIZE = 1 << REGION_SIZE_BITS;
+constexpr int CHUNKS_EACH_REGION = REGION_SIZE * REGION_SIZE;
+constexpr int REGION_SECTOR_BYTES = 4096;
+constexpr int REGION_HEADER_BYTES = 16;
+constexpr int REGION_TABLE_ENTRY_BYTES = 8;
+constexpr int REGION_HEADER_SECTORS = (REGION_HEADER_BYTES + CHUNKS_EACH_REGION * REGION_TABLE_ENTRY_BYTES + REGION_SECTOR_BYTES - 1) / REGION_SECTOR_BYTES;
+constexpr uint8_t REGION_FILE_VERSION = 1;
+
+// chunk payload: compression, payload version, 2 reserved bytes, uncompressed size, then the block types
+constexpr int CHUNK_PAYLOAD_HEADER_BYTES = 8;
+constexpr uint8_t CHUNK_PAYLOAD_VERSION = 1;
+
+enum class ChunkCompression : uint8_t {
+	None,
+	Deflate,
+};
+
+class RegionFile {
+public:
+	RegionFile( std::string const& filePath );
+	~RegionFile();
+	/// create: write an empty header if the file does not exist, a file whose header does not match this world is renamed to a backup first
+	/// return false if there is no file or the header does not match this world
+	bool Open( bool create );
+	void Close();
+
+	bool HasChunk( int chunkIndex );
+	bool ReadChunk( int chunkIndex, std::vector<uint8_t>& out_payload );
+	bool WriteChunk( int chunkIndex, std::vector<uint8_t> const& payload );
+
+	static int GetChunkIndexInRegion( IntVec2 const& chunkCoords );
+protected:
+	/// rename the file out of the way instead of truncating it, false if it could not be moved
+	bool BackUpMismatchedFile() const;
+	int FindFreeSectors( int numOfSectors ) const;
+	void SetSectorsUsed( int firstSector, int numOfSectors, bool isUsed );
+	static int GetNumOfSectors( uint32_t numOfBytes );
+protected:
+	std::string m_filePath;
+	FILE* m_file = nullptr;
+	std::mutex m_mutex;
+	uint32_t m_firstSectors[CHUNKS_EACH_REGION] = {};
+	uint32_t m_byteSizes[CHUNKS_EACH_REGION] = {};
+	std::vector<bool> m_usedSectors;
+};
+
+// thread safe, save and load jobs of different regions never wait for each other
+class RegionStorage {
+public:
+	RegionStorage( std::string const& folderPath );
+	~RegionStorage();
+
+	bool HasChunk( IntVec2 const& chunkCoords );
+	bool SaveChunk( IntVec2 const& chunkCoords, std::vector<uint8_t> const& blockTypes );
+	bool LoadChunk( IntVec2 const& chunkCoords, std::vector<uint8_t>& out_blockTypes );
+	/// close every file handle, the next access opens them again
+	void CloseAll();
+
+	static IntVec2 GetRegionCoords( IntVec2 const& chunkCoords );
+	static void EncodeChunkPayload( std::vector<uint8_t> const& blockTypes, std::vector<uint8_t>& out_payload );
+	static bool DecodeChunkPayload( std::vector<uint8_t> const& payload, std::vector<uint8_t>& out_blockTypes );
+protected:
+	RegionFile* GetRegionFile( IntVec2 const& regionCoords, bool create );
+protected:
+	std::string m_folderPath;
+	std::mutex m_regionsMutex;
+	std::map<IntVec2, RegionFile*> m_regions;
+	std::set<IntVec2> m_missingRegions; // no usable file, reads skip them until a save creates the file
+};
@@ -3,7 +3,11 @@
 #include "Game/Game.hpp"
 #include "Game/Player.hpp"
 #include "Game/GameCommon.hpp"
+#include "Game/RegionFile.hpp"
+#include "Engine/Core/ParallelFor.hpp"
 #include <filesystem>
+#include <algorithm>
+#include <map>
 
 unsigned int g_terrainSeed = 0;
 unsigned int g_hillinessSeed = 0;
@@ -23,9 +27,21 @@ World::World()
 	m_maxChunksRadiusX = 1 + int( m_chunkActivationRange ) / XSIZE;
 	m_maxChunksRadiusY = 1 + int( m_chunkActivationRange ) / YSIZE;
 	m_maxChunks = (2 * m_maxChunksRadiusX) * (2 * m_maxChunksRadiusY);
+	BuildChunkActivationOrder( m_chunkActivationRange, m_activationOffsets );
+	// enough mesh jobs in flight to keep every worker busy
+	m_maxChunkMeshJobs = g_theJobSystem->GetWorkersCount() * 2 > 2 ? g_theJobSystem->GetWorkersCount() * 2 : 2;
 
 	m_worldCBO = g_theRenderer->CreateConstantBuffer( sizeof( SimplerMinerConstants ) );
 
+	BlockUVConstants blockUVConstants;
+	for (auto const& def : BlockDefinition::s_definitions) {
+		blockUVConstants.m_blockUVs[def.m_index * 3] = Vec4( def.m_topUV.m_mins.x, def.m_topUV.m_mins.y, def.m_topUV.m_maxs.x, def.m_topUV.m_maxs.y );
+		blockUVConstants.m_blockUVs[def.m_index * 3 + 1] = Vec4( def.m_sideUV.m_mins.x, def.m_sideUV.m_mins.y, def.m_sideUV.m_maxs.x, def.m_sideUV.m_maxs.y );
+		blockUVConstants.m_blockUVs[def.m_index * 3 + 2] = Vec4( def.m_bottomUV.m_mins.x, def.m_bottomUV.m_mins.y, def.m_bottomUV.m_maxs.x, def.m_bottomUV.m_maxs.y );
+	}
+	m_blockUVCBO = g_theRenderer->CreateConstantBuffer( sizeof( BlockUVConstants ) );
+	g_theRenderer->CopyCPUToGPU( &blockUVConstants, sizeof( BlockUVConstants ), m_blockUVCBO );
+
 	m_worldConstans.m_fogNearDist = m_chunkActivationRange * 0.5f;
 	m_worldConstans.m_fogFarDist = m_chunkActivationRange - 16.f;
 	//m_worldConstans.m_fogNearDist = 1000000.f;
@@ -40,14 +56,49 @@ World::World()
 	g_treeDensitySeed = g_terrainSeed + 3;
 	g_treeSeed = g_terrainSeed - 1;
 	g_wormSeed = g_terrainSeed + 4;
+
+	m_regionStorage = new RegionStorage( Stringf( "Saves/World%u", g_terrainSeed ) );
 }
 
 World::~World()
 {
+	// mesh jobs own their snapshot, wait for the running ones before deleting them
+	for (auto job : m_chunkMeshJobs) {
+		g_theJobSystem->CancelJob( job );
+		while ((job->m_status == JobStatus::Queued || job->m_status == JobStatus::Executing) && g_theJobSystem->GetWorkersCount() > 0) {
+			std::this_thread::yield();
+		}
+		if (job->m_status == JobStatus::Completed) {
+			g_theJobSystem->RetrieveJob( job );
+		}
+		if (job->m_chunk) {
+			job->m_chunk->m_meshJob = nullptr;
+		}
+		delete job;
+	}
+	m_chunkMeshJobs.clear();
+
+	// deactivated chunks still waiting for their save job are saved here
+	for (auto job : m_chunkSaveJobs) {
+		g_theJobSystem->CancelJob( job );
+		while ((job->m_status == JobStatus::Queued || job->m_status == JobStatus::Executing) && g_theJobSystem->GetWorkersCount() > 0) {
+			std::this_thread::yield();
+		}
+		if (job->m_status == JobStatus::Completed) {
+			g_theJobSystem->RetrieveJob( job );
+		}
+		else {
+			job->m_chunk->SaveToFile();
+		}
+		DeconstructChunk( job->m_chunk );
+		delete job;
+	}
+	m_chunkSaveJobs.clear();
+
 	std::vector<Chunk*> chunks;
 	chunks.reserve( 100 );
-	for (auto& chunkPair : m_activeChunks) {
-		chunks.push_back( chunkPair.second );
+	for (Chunk* chunk : m_activeChunks) {
+		chunks.push_back( chunk );
 	}
 	for (auto chunk : chunks) {
 		if (chunk->m_needsToSave) {
@@ -56,7 +107,10 @@ World::~World()
 		DeconstructChunk( chunk );
 		//DeactivateChunk( chunk );
 	}
+	delete m_regionStorage;
+	m_regionStorage = nullptr;
 	delete m_worldCBO;
+	delete m_blockUVCBO;
 }
 
 void World::StartUp()
@@ -71,12 +125,28 @@ void World::StartUp()
 	g_theGame->AddEntityToEntityArries( m_player );
 
 	m_worldShader = g_theRenderer->CreateShader( "Data/Shaders/World" );
+	m_worldPackedShader = g_theRenderer->CreateShader( "Data/Shaders/WorldPacked", VertexType::BYTE4_BYTE4 );
 }
 
 void World::Update()
 {
 	float deltaSeconds = g_theGame->m_gameClock->GetDeltaSeconds();
 
+	// the last frame was spent with the meshing mode it had, record it before the mode can be toggled
+	m_frameTimeHistograms[m_wasLastFrameMeshingAsync ? 1 : 0].AddFrame( Clock::GetSystemClock()->GetDeltaSeconds() );
+	if (g_theInput->WasKeyJustPressed( 'M' )) {
+		g_asyncChunkMeshing = !g_asyncChunkMeshing;
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, g_asyncChunkMeshing ? "Chunk meshing: jobs" : "Chunk meshing: main thread" );
+	}
+	m_wasLastFrameMeshingAsync = g_asyncChunkMeshing;
+	if (g_theInput->WasKeyJustPressed( 'G' )) {
+		g_greedyChunkMeshing = !g_greedyChunkMeshing;
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, g_greedyChunkMeshing ? "Chunk mesh: greedy, packed verts" : "Chunk mesh: one quad per face" );
+		for (Chunk* chunk : m_activeChunks) {
+			chunk->MarkDirty();
+		}
+	}
+
 	if (g_theInput->IsKeyDown( 'Y' )) {
 		m_worldTimeScale = 10000.f;
 	}
@@ -116,11 +186,11 @@ void World::Update()
 	//double begin = GetCurrentTimeSeconds();
 	int retrieveCount = 0;
 	for (int i = 0; i < (int)m_chunkGenerationJobs.size(); i++) {
-		if (m_chunkGenerationJobs[i]->m_status == JobStatus::Completed && (int)m_activeChunks.size() < m_maxChunks) {
+		if (m_chunkGenerationJobs[i]->m_status == JobStatus::Completed && m_activeChunks.GetSize() < m_maxChunks) {
 			retrieveCount++;
 			g_theJobSystem->RetrieveJob( m_chunkGenerationJobs[i] );
 			StartUpChunk( m_chunkGenerationJobs[i]->m_chunk );
-			m_queuedGenerateChunks.erase( m_chunkGenerationJobs[i]->m_chunk->m_coords );
+			m_queuedGenerateChunks.Erase( m_chunkGenerationJobs[i]->m_chunk->m_coords );
 			delete m_chunkGenerationJobs[i];
 			m_chunkGenerationJobs.erase( m_chunkGenerationJobs.begin() + i );
 			i--;
@@ -142,46 +212,13 @@ void World::Update()
 		}
 	}
 
-	float minDist = FLT_MAX;
-	float secondMinDist = FLT_MAX;
-	Chunk* firstMin = nullptr;
-	Chunk* secondMin = nullptr;
-
-	for (auto chunk : m_dirtyChunks) {
-		//if (chunk->m_westNeighbor && chunk->m_eastNeighbor && chunk->m_northNeighbor && chunk->m_southNeighbor) {
-			float dist = GetDistanceSquared2D( GetChunkWorldCenterXY( chunk->m_coords ), m_player->m_position );
-			// smaller than the first
-			if (dist < minDist) {
-				// set the first to be the second
-				secondMinDist = minDist;
-				secondMin = firstMin;
-				// set it to be the first
-				minDist = dist;
-				firstMin = chunk;
-			}
-			else if (dist < secondMinDist) {
-				secondMinDist = dist;
-				secondMin = chunk;
-			}
-		//}
-	}
-
-	if (firstMin) {
-		firstMin->Update( deltaSeconds );
-	}
-	if (secondMin) {
-		secondMin->Update( deltaSeconds );
+	// results of finished mesh jobs are uploaded in both modes, so switching modes never loses a mesh
+	RetrieveChunkMeshJobs();
+	if (g_asyncChunkMeshing) {
+		QueueChunkMeshJobs();
 	}
-
-	for (int i = 0; i < (int)m_dirtyChunks.size(); i++) {
-		if (m_dirtyChunks[i] == firstMin) {
-			m_dirtyChunks.erase( m_dirtyChunks.begin() + i );
-			i--;
-		}
-		if (i >= 0 && m_dirtyChunks[i] == secondMin) {
-			m_dirtyChunks.erase( m_dirtyChunks.begin() + i );
-			i--;
-		}
+	else {
+		UpdateDirtyChunksSync( deltaSeconds );
 	}
 	//for (auto& pair : m_activeChunks) {
 	//	pair.second->Update( deltaSeconds );
@@ -194,8 +231,8 @@ void World::Render() const
 {
 	//double begin = GetCurrentTimeSeconds();
 
-	for (auto chunkPair : m_activeChunks) {
-		chunkPair.second->Render();
+	for (Chunk* chunk : m_activeChunks) {
+		chunk->Render();
 	}
 
 	if (m_hasRayHitRes) {
@@ -308,6 +345,16 @@ void World::RenderUI() const
 
 	g_ASCIIFont->AddVertsForTextInBox2D( textVerts, AABB2( Vec2( 0.f, 10.f ), Vec2( 1600.f, 50.f ) ), 40.f, Stringf( "%s", BlockDefinition::GetDefinitionByIndex( (unsigned char)m_curBlockIDToPut ).m_name.c_str() ) );
 
+	// mesh size against one Vertex_PCU quad per visible face
+	size_t numOfVerts = GetVertsCount();
+	size_t numOfPerFaceVerts = GetPerFaceVertsCount();
+	size_t vertexBufferBytes = GetVertexBufferBytes();
+	size_t perFaceBytes = numOfPerFaceVerts * sizeof( Vertex_PCU );
+	g_ASCIIFont->AddVertsForTextInBox2D( textVerts, AABB2( Vec2( 0.f, 50.f ), Vec2( 1600.f, 70.f ) ), 16.f,
+		Stringf( "Mesh(G): %s Verts: %d/%d (x%.1f fewer) GPU: %.1fMB/%.1fMB (x%.1f less)", g_greedyChunkMeshing ? "greedy" : "per face",
+			(int)numOfVerts, (int)numOfPerFaceVerts, numOfVerts > 0 ? (float)numOfPerFaceVerts / (float)numOfVerts : 1.f,
+			(float)vertexBufferBytes / (1024.f * 1024.f), (float)perFaceBytes / (1024.f * 1024.f), vertexBufferBytes > 0 ? (float)perFaceBytes / (float)vertexBufferBytes : 1.f ) );
+
 	// render threading test game
 	/*std::vector<Vertex_PCU> verts;
 	Vec2 LeftTopPos( 25.f, 787.5f );
@@ -392,8 +439,26 @@ IntVec2 World::GetChunkCoordsByWorldPos( Vec2 const& worldXYPos ) const
 size_t World::GetVertsCount() const
 {
 	size_t res = 0;
-	for (auto& pair : m_activeChunks) {
-		res += pair.second->m_verts.size();
+	for (Chunk* chunk : m_activeChunks) {
+		res += chunk->m_verts.size() + chunk->m_packedVerts.size();
+	}
+	return res;
+}
+
+size_t World::GetPerFaceVertsCount() const
+{
+	size_t res = 0;
+	for (Chunk* chunk : m_activeChunks) {
+		res += (size_t)chunk->m_numOfPerFaceVerts;
+	}
+	return res;
+}
+
+size_t World::GetVertexBufferBytes() const
+{
+	size_t res = 0;
+	for (Chunk* chunk : m_activeChunks) {
+		res += chunk->GetVertexBufferBytes();
 	}
 	return res;
 }
@@ -416,8 +481,14 @@ void World::DoChunkDynamicActivation()
 {
 	bool m_isAChunkActivated = false;
 	IntVec2 playerChunkCoords = GetPlayerCurrentChunkCoords();
+	// the activation walk and the deactivation scan are keyed to the player's chunk, nothing changes until it does
+	if (playerChunkCoords != m_activationCenterCoords) {
+		m_activationCenterCoords = playerChunkCoords;
+		m_activationCursor = 0;
+		m_isDeactivationScanPending = true;
+	}
 	//double begin = GetCurrentTimeSeconds();
-	if ((int)m_activeChunks.size() < m_maxChunks) {
+	if (m_activeChunks.GetSize() < m_maxChunks) {
 		// activate is priority
 		if (g_autoCreateChunks) {
 			//constexpr int queueMaxSize = 4;
@@ -437,101 +508,104 @@ void World::DoChunkDynamicActivation()
 	//g_devConsole->AddLine( Rgba8::WHITE, Stringf( "%f", end - begin ) );
 }
 
-bool World::ActivateTheNearestInRangeChunk( IntVec2 const& playerChunkCoords )
+void World::BuildChunkActivationOrder( float activationRange, std::vector<IntVec2>& out_offsets )
 {
-	bool findNearest = false;
-	IntVec2 coords = playerChunkCoords;
-	float minDistSquared = m_chunkActivationRange * m_chunkActivationRange;
-	Chunk* chunkPtr = nullptr;
-	for (int y = playerChunkCoords.y - m_maxChunksRadiusY + 1; y <= playerChunkCoords.y + m_maxChunksRadiusY - 1; y++) {
-		for (int x = playerChunkCoords.x - m_maxChunksRadiusX + 1; x <= playerChunkCoords.x + m_maxChunksRadiusX - 1; x++) {
-			if (!GetChunkByCoords( IntVec2( x, y ), &chunkPtr ) && m_queuedGenerateChunks.find( IntVec2( x ,y ) ) == m_queuedGenerateChunks.end()
-				&& GetDistanceSquared2D( GetChunkWorldCenterXY( IntVec2( x, y ) ), m_player->m_position ) < minDistSquared) {
-				float dist = GetDistanceSquared2D( GetChunkWorldCenterXY( IntVec2( x, y ) ), m_player->m_position );
-				if (dist < minDistSquared) {
-					minDistSquared = dist;
-					coords = IntVec2( x, y );
-					findNearest = true;
-				}
+	// every chunk whose center is in range of the center of the player's chunk, nearest first
+	int radiusX = 1 + int( activationRange ) / XSIZE;
+	int radiusY = 1 + int( activationRange ) / YSIZE;
+	float rangeSquared = activationRange * activationRange;
+	out_offsets.clear();
+	for (int y = -radiusY; y <= radiusY; y++) {
+		for (int x = -radiusX; x <= radiusX; x++) {
+			if (GetChunkOffsetDistanceSquared( IntVec2( x, y ) ) < rangeSquared) {
+				out_offsets.emplace_back( x, y );
 			}
 		}
 	}
-	if (findNearest) {
-		Chunk* chunk = CreateChunk( coords );
-		m_queuedGenerateChunks.insert( coords );
-		Job* job = nullptr;
-		if (std::filesystem::exists( Stringf( "Saves/World%u/Chunk(%d,%d).chunk", g_terrainSeed, coords.x, coords.y ) )) {
-			job = new ChunkLoadJob( chunk );
+	// ties are broken by coords so the order does not depend on the sort implementation
+	std::sort( out_offsets.begin(), out_offsets.end(), []( IntVec2 const& a, IntVec2 const& b ) {
+		float distA = GetChunkOffsetDistanceSquared( a );
+		float distB = GetChunkOffsetDistanceSquared( b );
+		if (distA != distB) {
+			return distA < distB;
 		}
-		else {
-			job = new ChunkGenerateJob( chunk );
-		}
-		m_chunkGenerationJobs.push_back( (SimpleMinerJob*)job );
-		g_theJobSystem->AddJob( job );
-		return true;
+		return a.y != b.y ? a.y < b.y : a.x < b.x;
+		} );
+}
+
+float World::GetChunkOffsetDistanceSquared( IntVec2 const& chunkOffset )
+{
+	float x = (float)(chunkOffset.x * XSIZE);
+	float y = (float)(chunkOffset.y * YSIZE);
+	return x * x + y * y;
+}
+
+void World::QueueChunkActivation( IntVec2 const& coords )
+{
+	Chunk* chunk = CreateChunk( coords );
+	m_queuedGenerateChunks.Insert( coords, chunk );
+	Job* job = nullptr;
+	if (HasSavedChunk( coords )) {
+		job = new ChunkLoadJob( chunk );
 	}
 	else {
-		return false;
+		job = new ChunkGenerateJob( chunk );
+	}
+	m_chunkGenerationJobs.push_back( (SimpleMinerJob*)job );
+	g_theJobSystem->AddJob( job );
+}
+
+bool World::ActivateTheNearestInRangeChunk( IntVec2 const& playerChunkCoords )
+{
+	// offsets before the cursor are active or queued already
+	while (m_activationCursor < (int)m_activationOffsets.size()) {
+		IntVec2 coords = playerChunkCoords + m_activationOffsets[m_activationCursor];
+		m_activationCursor++;
+		if (!m_activeChunks.Contains( coords ) && !m_queuedGenerateChunks.Contains( coords )) {
+			QueueChunkActivation( coords );
+			return true;
+		}
 	}
+	return false;
 }
 
 bool World::ActivateAllInRangeChunks( IntVec2 const& playerChunkCoords )
 {
 	bool findNearest = false;
-	IntVec2 coords = playerChunkCoords;
-	float minDistSquared = m_chunkActivationRange * m_chunkActivationRange;
-	Chunk* chunkPtr = nullptr;
-	for (int y = playerChunkCoords.y - m_maxChunksRadiusY + 1; y <= playerChunkCoords.y + m_maxChunksRadiusY - 1; y++) {
-		for (int x = playerChunkCoords.x - m_maxChunksRadiusX + 1; x <= playerChunkCoords.x + m_maxChunksRadiusX - 1; x++) {
-			if (!GetChunkByCoords( IntVec2( x, y ), &chunkPtr ) && m_queuedGenerateChunks.find( IntVec2( x, y ) ) == m_queuedGenerateChunks.end()
-				&& GetDistanceSquared2D( GetChunkWorldCenterXY( IntVec2( x, y ) ), m_player->m_position ) < minDistSquared) {
-				coords = IntVec2( x, y );
-				findNearest = true;
-				Chunk* chunk = CreateChunk( coords );
-				m_queuedGenerateChunks.insert( coords );
-				Job* job = nullptr;
-				if (std::filesystem::exists( Stringf( "Saves/World%u/Chunk(%d,%d).chunk", g_terrainSeed, coords.x, coords.y ) )) {
-					job = new ChunkLoadJob( chunk );
-				}
-				else {
-					job = new ChunkGenerateJob( chunk );
-				}
-				m_chunkGenerationJobs.push_back( (SimpleMinerJob*)job );
-				g_theJobSystem->AddJob( job );
+	while (m_activationCursor < (int)m_activationOffsets.size()) {
+		IntVec2 coords = playerChunkCoords + m_activationOffsets[m_activationCursor];
+		if (!m_activeChunks.Contains( coords ) && !m_queuedGenerateChunks.Contains( coords )) {
+			// the cursor stays on a chunk that does not fit, the walk goes on from it once old chunks are deactivated
+			if (m_activeChunks.GetSize() + m_queuedGenerateChunks.GetSize() >= m_maxChunks) {
+				break;
 			}
+			QueueChunkActivation( coords );
+			findNearest = true;
 		}
+		m_activationCursor++;
 	}
-	if (findNearest) {
-		return true;
-	}
-	else {
-		return false;
-	}
+	return findNearest;
 }
 
 bool World::DeactivateTheFarthestOutRangeChunk( IntVec2 const& playerChunkCoords )
 {
+	if (!m_isDeactivationScanPending) {
+		return false;
+	}
+	m_isDeactivationScanPending = false;
 	bool findFarthest = false;
-	IntVec2 coords = playerChunkCoords;
 	float maxDistSquared = m_chunkDeactivationRange * m_chunkDeactivationRange;
-	Chunk* chunkPtr = nullptr;
-	std::map<IntVec2, Chunk*> copyedMap = m_activeChunks;
-	for (auto iter = copyedMap.begin(); iter != copyedMap.end(); ++iter) {
-		float dist = GetDistanceSquared2D( iter->second->GetWorldCenterXY(), m_player->m_position );
-		if (dist > maxDistSquared) {
-			chunkPtr = iter->second;
-			m_activeChunks.erase( iter->first );
+	// backward, erasing moves the last chunk into the hole and that one is checked already
+	std::vector<Chunk*> const& chunks = m_activeChunks.GetChunks();
+	for (int i = (int)chunks.size() - 1; i >= 0; i--) {
+		Chunk* chunkPtr = chunks[i];
+		if (GetChunkOffsetDistanceSquared( chunkPtr->m_coords - playerChunkCoords ) > maxDistSquared) {
+			m_activeChunks.Erase( chunkPtr->m_coords );
 			DeactivateChunk( chunkPtr );
 			findFarthest = true;
 		}
-		
-	}
-	if (findFarthest) {
-		return true;
-	}
-	else {
-		return false;
 	}
+	return findFarthest;
 }
 
 //void World::ActivateChunk( IntVec2 const& coords )
@@ -541,6 +615,7 @@ bool World::DeactivateTheFarthestOutRangeChunk( IntVec2 const& playerChunkCoords
 
 void World::DeactivateChunk( Chunk* chunk )
 {
+	UndirtyAllBlocksInChunk( chunk );
 	for (int i = 0; i < (int)m_dirtyChunks.size(); i++) {
 		if (m_dirtyChunks[i] == chunk) {
 			m_dirtyChunks.erase( i + m_dirtyChunks.begin() );
@@ -548,6 +623,12 @@ void World::DeactivateChunk( Chunk* chunk )
 		}
 	}
 
+	// the job only reads its snapshot, let it finish and throw the result away
+	if (chunk->m_meshJob) {
+		chunk->m_meshJob->m_chunk = nullptr;
+		chunk->m_meshJob = nullptr;
+	}
+
 	if (chunk->m_eastNeighbor) {
 		chunk->m_eastNeighbor->m_westNeighbor = nullptr;
 	}
@@ -597,15 +678,25 @@ void World::StartUpChunk( Chunk* chunk )
 		neighbor->m_northNeighbor = chunk;
 	}
 
-	m_activeChunks[chunkCoords] = chunk;
+	m_activeChunks.Insert( chunkCoords, chunk );
 	chunk->StartUp();
+	// queued for an older player chunk, the next scan throws it away
+	if (GetChunkOffsetDistanceSquared( chunkCoords - m_activationCenterCoords ) > m_chunkDeactivationRange * m_chunkDeactivationRange) {
+		m_isDeactivationScanPending = true;
+	}
+}
+
+bool World::HasSavedChunk( IntVec2 const& coords ) const
+{
+	// region tables are in memory once the region is opened, the old files only cost a lookup when the region has no such chunk
+	return m_regionStorage->HasChunk( coords ) || std::filesystem::exists( Chunk::GetLegacyChunkFilePath( coords ) );
 }
 
 bool World::GetChunkByCoords( IntVec2 const& coords, Chunk** out_chunkPtr ) const
 {
-	auto iter = m_activeChunks.find( coords );
-	if (iter != m_activeChunks.end()) {
-		*out_chunkPtr = iter->second;
+	Chunk* chunk = m_activeChunks.Find( coords );
+	if (chunk) {
+		*out_chunkPtr = chunk;
 		return true;
 	}
 	return false;
@@ -613,11 +704,7 @@ bool World::GetChunkByCoords( IntVec2 const& coords, Chunk** out_chunkPtr ) cons
 
 Chunk* World::GetChunkByCoords( IntVec2 const& coords ) const
 {
-	auto iter = m_activeChunks.find( coords );
-	if (iter != m_activeChunks.end()) {
-		return iter->second;
-	}
-	return nullptr;
+	return m_activeChunks.Find( coords );
 }
 
 IntVec2 World::GetPlayerCurrentChunkCoords() const
@@ -635,11 +722,10 @@ Vec2 World::GetChunkWorldCenterXY( IntVec2 const& chunkCoords ) const
 void World::DigTheTopBlock()
 {
 	IntVec2 chunkCoords = GetChunkCoordsByWorldPos( m_player->m_position );
-	auto iter = m_activeChunks.find( chunkCoords );
-	if (iter == m_activeChunks.end()) {
+	Chunk* chunk = m_activeChunks.Find( chunkCoords );
+	if (chunk == nullptr) {
 		return;
 	}
-	Chunk* chunk = iter->second;
 	IntVec3 blockWorldCoords = GetBlockCoordsByWorldPosition( m_player->m_position );
 	IntVec3 blockLocalCoords = chunk->GetBlockLocalCoords( blockWorldCoords );
 	chunk->DigTopBlockOfStack( blockLocalCoords );
@@ -648,11 +734,10 @@ void World::DigTheTopBlock()
 void World::PutTheTopBlock()
 {
 	IntVec2 chunkCoords = GetChunkCoordsByWorldPos( m_player->m_position );
-	auto iter = m_activeChunks.find( chunkCoords );
-	if (iter == m_activeChunks.end()) {
+	Chunk* chunk = m_activeChunks.Find( chunkCoords );
+	if (chunk == nullptr) {
 		return;
 	}
-	Chunk* chunk = iter->second;
 	IntVec3 blockWorldCoords = GetBlockCoordsByWorldPosition( m_player->m_position );
 	IntVec3 blockLocalCoords = chunk->GetBlockLocalCoords( blockWorldCoords );
 	chunk->PutTopBlockOfStack( blockLocalCoords );
@@ -721,131 +806,176 @@ void World::ChangeCurrentBlockType()
 
 void World::ProcessDirtyLighting()
 {
-	//g_devConsole->AddLine( Rgba8::WHITE, Stringf( "Num of dirty light this frame %d", m_blockLightingQueue.size() ) );
-	while (!m_blockLightingQueue.empty()) {
-		ProcessNextDirtyLightBlock();
+	// checkerboard passes: chunks of one color never share a face, so a pass can run them in parallel,
+	// each one writes only its own blocks and reads border blocks of chunks that are not running
+	int passColor = 0;
+	while (!m_lightDirtyChunks.empty()) {
+		m_lightPassChunks.clear();
+		for (int i = 0; i < (int)m_lightDirtyChunks.size(); i++) {
+			Chunk* chunk = m_lightDirtyChunks[i];
+			if (((chunk->m_coords.x + chunk->m_coords.y) & 1) == passColor) {
+				chunk->m_isInLightDirtyList = false;
+				m_lightPassChunks.push_back( chunk );
+				m_lightDirtyChunks[i] = m_lightDirtyChunks.back();
+				m_lightDirtyChunks.pop_back();
+				i--;
+			}
+		}
+		passColor ^= 1;
+		int numOfPassChunks = (int)m_lightPassChunks.size();
+		if (numOfPassChunks == 0) {
+			continue;
+		}
+
+		if ((int)m_lightPassPushes.size() < numOfPassChunks) {
+			m_lightPassPushes.resize( numOfPassChunks );
+		}
+		for (int i = 0; i < numOfPassChunks; i++) {
+			m_lightPassPushes[i].clear();
+		}
+		if (g_parallelLighting && numOfPassChunks > 1 && g_theJobSystem->GetWorkersCount() > 0) {
+			ParallelFor( 0, numOfPassChunks, 1, [this]( int i ) {
+				m_lightPassChunks[i]->PropagateDirtyLighting( m_lightPassPushes[i] );
+			} );
+		}
+		else {
+			for (int i = 0; i < numOfPassChunks; i++) {
+				m_lightPassChunks[i]->PropagateDirtyLighting( m_lightPassPushes[i] );
+			}
+		}
+
+		// cross chunk work is applied here on the main thread, it lands in the next pass of the other color
+		for (int i = 0; i < numOfPassChunks; i++) {
+			for (ChunkLightPush const& push : m_lightPassPushes[i]) {
+				if (push.m_blockIndex < 0) {
+					push.m_chunk->MarkDirty();
+				}
+				else {
+					MarkLightingDirty( BlockIter( push.m_blockIndex, push.m_chunk ) );
+				}
+			}
+		}
 	}
 }
 
-void World::ProcessNextDirtyLightBlock()
+void World::UpdateDirtyChunksSync( float deltaSeconds )
 {
-	BlockIter thisIter = m_blockLightingQueue.front();
-	m_blockLightingQueue.pop_front();
-	// compute lighting
-
-	// indoor lighting
-	// calculate how much light strength it should be
-	unsigned char indoorLightStrength = 0;
+	float minDist = FLT_MAX;
+	float secondMinDist = FLT_MAX;
+	Chunk* firstMin = nullptr;
+	Chunk* secondMin = nullptr;
 
-	// light source?
-	if (thisIter.GetBlock()->GetDefinition().m_lightStrength > 0) {
-		indoorLightStrength = (unsigned char)thisIter.GetBlock()->GetDefinition().m_lightStrength;
+	for (auto chunk : m_dirtyChunks) {
+		// still being meshed in a job, wait for it to come back
+		if (chunk->m_meshJob) {
+			continue;
+		}
+		//if (chunk->m_westNeighbor && chunk->m_eastNeighbor && chunk->m_northNeighbor && chunk->m_southNeighbor) {
+			float dist = GetDistanceSquared2D( GetChunkWorldCenterXY( chunk->m_coords ), m_player->m_position );
+			// smaller than the first
+			if (dist < minDist) {
+				// set the first to be the second
+				secondMinDist = minDist;
+				secondMin = firstMin;
+				// set it to be the first
+				minDist = dist;
+				firstMin = chunk;
+			}
+			else if (dist < secondMinDist) {
+				secondMinDist = dist;
+				secondMin = chunk;
+			}
+		//}
 	}
 
-	BlockIter westIter = thisIter.GetWestNeighbor();
-	if (westIter.m_chunk && (!westIter.GetBlock()->IsOpaque() || westIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = westIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? westIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+	if (firstMin) {
+		firstMin->Update( deltaSeconds );
 	}
-	BlockIter eastIter = thisIter.GetEastNeighbor();
-	if (eastIter.m_chunk && (!eastIter.GetBlock()->IsOpaque() || eastIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = eastIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? eastIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+	if (secondMin) {
+		secondMin->Update( deltaSeconds );
 	}
-	BlockIter southIter = thisIter.GetSouthNeighbor();
-	if (southIter.m_chunk && (!southIter.GetBlock()->IsOpaque() || southIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = southIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? southIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+
+	for (int i = 0; i < (int)m_dirtyChunks.size(); i++) {
+		if (m_dirtyChunks[i] == firstMin) {
+			m_dirtyChunks.erase( m_dirtyChunks.begin() + i );
+			i--;
+		}
+		if (i >= 0 && m_dirtyChunks[i] == secondMin) {
+			m_dirtyChunks.erase( m_dirtyChunks.begin() + i );
+			i--;
+		}
 	}
-	BlockIter northIter = thisIter.GetNorthNeighbor();
-	if (northIter.m_chunk && (!northIter.GetBlock()->IsOpaque() || northIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = northIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? northIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+}
+
+void World::QueueChunkMeshJobs()
+{
+	if ((int)m_chunkMeshJobs.size() >= m_maxChunkMeshJobs) {
+		return;
 	}
-	BlockIter upIter = thisIter.GetUpNeighbor();
-	if (upIter.m_chunk && (!upIter.GetBlock()->IsOpaque() || upIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = upIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? upIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+	// nearest dirty chunks first
+	std::vector<std::pair<float, Chunk*>> chunksToMesh;
+	chunksToMesh.reserve( m_dirtyChunks.size() );
+	for (auto chunk : m_dirtyChunks) {
+		if (chunk->m_meshJob == nullptr) {
+			chunksToMesh.emplace_back( GetDistanceSquared2D( GetChunkWorldCenterXY( chunk->m_coords ), m_player->m_position ), chunk );
+		}
 	}
-	BlockIter downIter = thisIter.GetDownNeighbor();
-	if (downIter.m_chunk && (!downIter.GetBlock()->IsOpaque() || downIter.GetBlock()->GetDefinition().m_lightStrength > 0)) {
-		indoorLightStrength = downIter.GetBlock()->GetIndoorLightInfluence() - 1 > indoorLightStrength ? downIter.GetBlock()->GetIndoorLightInfluence() - 1 : indoorLightStrength;
+	int numOfJobsToAdd = m_maxChunkMeshJobs - (int)m_chunkMeshJobs.size();
+	if (numOfJobsToAdd < (int)chunksToMesh.size()) {
+		std::partial_sort( chunksToMesh.begin(), chunksToMesh.begin() + numOfJobsToAdd, chunksToMesh.end(),
+			[]( std::pair<float, Chunk*> const& a, std::pair<float, Chunk*> const& b ) { return a.first < b.first; } );
+		chunksToMesh.resize( numOfJobsToAdd );
 	}
 
-	unsigned char outdoorLightStrength = 0;
-	if (thisIter.GetBlock()->IsSky()) {
-		outdoorLightStrength = 15;
-	}
-	else {
-		if (westIter.m_chunk) {
-			outdoorLightStrength = westIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? westIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
-		if (eastIter.m_chunk) {
-			outdoorLightStrength = eastIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? eastIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
-		if (southIter.m_chunk) {
-			outdoorLightStrength = southIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? southIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
-		if (northIter.m_chunk) {
-			outdoorLightStrength = northIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? northIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
-		if (upIter.m_chunk) {
-			outdoorLightStrength = upIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? upIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
-		if (downIter.m_chunk) {
-			outdoorLightStrength = downIter.GetBlock()->GetOutdoorLightInfluence() - 1 > outdoorLightStrength ? downIter.GetBlock()->GetOutdoorLightInfluence() - 1 : outdoorLightStrength;
-		}
+	for (auto& pair : chunksToMesh) {
+		Chunk* chunk = pair.second;
+		ChunkMeshJob* job = new ChunkMeshJob( chunk );
+		// edits after the snapshot mark the chunk dirty again and it is meshed once more after this job comes back
+		chunk->m_isDirty = false;
+		chunk->m_meshJob = job;
+		m_chunkMeshJobs.push_back( job );
+		g_theJobSystem->AddJob( job );
 	}
 
-	// need to reset the light strength?
-	if (indoorLightStrength != thisIter.GetBlock()->GetIndoorLightInfluence() || outdoorLightStrength != thisIter.GetBlock()->GetOutdoorLightInfluence()) {
-		thisIter.GetBlock()->SetIndoorLightInfluence( indoorLightStrength );
-		if (thisIter.GetBlock()->IsOpaque()) {
-			thisIter.GetBlock()->SetOutdoorLightInfluence( 0 );
-		}
-		else {
-			thisIter.GetBlock()->SetOutdoorLightInfluence( outdoorLightStrength );
-		}
-		// propagate
-		if (westIter.IsValid() && !westIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( westIter );
-		}
-		if (eastIter.IsValid() && !eastIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( eastIter );
-		}
-		if (northIter.IsValid() && !northIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( northIter );
-		}
-		if (southIter.IsValid() && !southIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( southIter );
-		}
-		if (upIter.IsValid() && !upIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( upIter );
-		}
-		if (downIter.IsValid() && !downIter.GetBlock()->IsOpaque()) {
-			MarkLightingDirty( downIter );
+	for (int i = 0; i < (int)m_dirtyChunks.size(); i++) {
+		if (!m_dirtyChunks[i]->m_isDirty) {
+			m_dirtyChunks.erase( m_dirtyChunks.begin() + i );
+			i--;
 		}
+	}
+}
 
-		// mark every neighbor dirty
-		if (westIter.IsValid() && thisIter.IsOnWestEdge()) {
-			westIter.m_chunk->MarkDirty();
-		}
-		if (eastIter.IsValid() && thisIter.IsOnEastEdge()) {
-			eastIter.m_chunk->MarkDirty();
-		}
-		if (northIter.IsValid() && thisIter.IsOnNorthEdge()) {
-			northIter.m_chunk->MarkDirty();
-		}
-		if (southIter.IsValid() && thisIter.IsOnSouthEdge()) {
-			southIter.m_chunk->MarkDirty();
+void World::RetrieveChunkMeshJobs()
+{
+	for (int i = 0; i < (int)m_chunkMeshJobs.size(); i++) {
+		ChunkMeshJob* job = m_chunkMeshJobs[i];
+		if (job->m_status == JobStatus::Completed) {
+			g_theJobSystem->RetrieveJob( job );
+			if (job->m_chunk) {
+				job->m_chunk->m_meshJob = nullptr;
+				if (job->m_isGreedy) {
+					job->m_chunk->UploadVertexArray( job->m_packedVerts, job->m_numOfPerFaceVerts );
+				}
+				else {
+					job->m_chunk->UploadVertexArray( job->m_verts );
+				}
+			}
+			delete job;
+			m_chunkMeshJobs.erase( m_chunkMeshJobs.begin() + i );
+			i--;
 		}
 	}
-
-	thisIter.GetBlock()->SetLightDirty( false );
 }
 
 void World::UndirtyAllBlocksInChunk( Chunk* chunk )
 {
-	for (auto iter = m_blockLightingQueue.begin(); iter != m_blockLightingQueue.end(); iter++) {
-		if (iter->m_chunk == chunk) {
-			m_blockLightingQueue.erase( iter );
-			iter--;
-		}
+	for (int blockIndex : chunk->m_lightDirtyQueue) {
+		chunk->m_blocks[blockIndex].SetLightDirty( false );
+	}
+	chunk->m_lightDirtyQueue.clear();
+	if (chunk->m_isInLightDirtyList) {
+		chunk->m_isInLightDirtyList = false;
+		m_lightDirtyChunks.erase( std::find( m_lightDirtyChunks.begin(), m_lightDirtyChunks.end(), chunk ) );
 	}
 }
 
@@ -854,7 +984,11 @@ void World::MarkLightingDirty( BlockIter const& iter )
 	if (!iter.GetBlock()->IsLightDirty()) {
 		iter.GetBlock()->SetLightDirty( true );
 		iter.m_chunk->MarkDirty();
-		m_blockLightingQueue.push_back( iter );
+		iter.m_chunk->m_lightDirtyQueue.push_back( iter.m_blockIndex );
+		if (!iter.m_chunk->m_isInLightDirtyList) {
+			iter.m_chunk->m_isInLightDirtyList = true;
+			m_lightDirtyChunks.push_back( iter.m_chunk );
+		}
 	}
 }
 
@@ -886,6 +1020,156 @@ std::string World::GetCurDayTimeText() const
 }
 
 bool World::RayCastVsWorld( GameRayCast3DRes& out_rayCastRes, Vec3 const& startPos, Vec3 const& forwardNormal, float maxDist ) const
+{
+	// Amanatides-Woo DDA over raw block indices, the chunk only changes when the ray crosses a chunk border
+	// same crossing order and distances as RayCastVsWorldByBlockIter, ties go to x, then y
+	out_rayCastRes.m_rayForwardNormal = forwardNormal;
+	out_rayCastRes.m_rayMaxLength = maxDist;
+	out_rayCastRes.m_rayStartPos = startPos;
+	IntVec3 blockCoords = GetBlockCoordsByWorldPosition( startPos );
+	Chunk* chunk = startPos.z >= (float)ZSIZE || startPos.z < 0.f ? nullptr : m_activeChunks.Find( IntVec2( blockCoords.x >> XBITS, blockCoords.y >> YBITS ) );
+	if (chunk == nullptr) {
+		out_rayCastRes.m_didImpact = false;
+		return false;
+	}
+	int blockIndex = (blockCoords.x & XBITS_MASK) | ((blockCoords.y << XBITS) & YBITS_MASK) | (blockCoords.z << ZBITS_SHIFT);
+	if (chunk->m_blocks[blockIndex].IsOpaque()) {
+		out_rayCastRes.m_didImpact = true;
+		out_rayCastRes.m_impactDist = 0.f;
+		out_rayCastRes.m_impactNormal = -forwardNormal;
+		out_rayCastRes.m_impactPos = startPos;
+		out_rayCastRes.m_res = BlockIter( blockIndex, chunk );
+		return true;
+	}
+
+	// per axis: step direction, index change of one step, the local bits of the last block before the chunk border,
+	// and the index change when the ray wraps into the neighbor chunk; z has no neighbor, the world ends there
+	int stepX = forwardNormal.x < 0 ? -1 : 1;
+	int stepY = forwardNormal.y < 0 ? -1 : 1;
+	int stepZ = forwardNormal.z < 0 ? -1 : 1;
+	int indexStepX = stepX;
+	int indexStepY = stepY * XSIZE;
+	int indexStepZ = stepZ * XSIZE * YSIZE;
+	int borderBitsX = stepX < 0 ? 0 : XBITS_MASK;
+	int borderBitsY = stepY < 0 ? 0 : YBITS_MASK;
+	int borderBitsZ = stepZ < 0 ? 0 : ZBITS_MASK;
+	int wrapIndexStepX = stepX < 0 ? XBITS_MASK : -XBITS_MASK;
+	int wrapIndexStepY = stepY < 0 ? YBITS_MASK : -YBITS_MASK;
+	Chunk* Chunk::* neighborX = stepX < 0 ? &Chunk::m_westNeighbor : &Chunk::m_eastNeighbor;
+	Chunk* Chunk::* neighborY = stepY < 0 ? &Chunk::m_southNeighbor : &Chunk::m_northNeighbor;
+
+	float fwdDistPerXCrossing = 1 / abs( forwardNormal.x );
+	float fwdDistPerYCrossing = 1 / abs( forwardNormal.y );
+	float fwdDistPerZCrossing = 1 / abs( forwardNormal.z );
+	float fwdDistAtNextXCrossing = abs( blockCoords.x + ((float)stepX + 1.f) * 0.5f - startPos.x ) * fwdDistPerXCrossing;
+	float fwdDistAtNextYCrossing = abs( blockCoords.y + ((float)stepY + 1.f) * 0.5f - startPos.y ) * fwdDistPerYCrossing;
+	float fwdDistAtNextZCrossing = abs( blockCoords.z + ((float)stepZ + 1.f) * 0.5f - startPos.z ) * fwdDistPerZCrossing;
+
+	float impactDist = 0.f;
+	Vec3 impactNormal;
+	for (;;) {
+		if (fwdDistAtNextXCrossing <= fwdDistAtNextYCrossing && fwdDistAtNextXCrossing <= fwdDistAtNextZCrossing) {
+			impactDist = fwdDistAtNextXCrossing;
+			if (impactDist > maxDist) {
+				break;
+			}
+			if ((blockIndex & XBITS_MASK) != borderBitsX) {
+				blockIndex += indexStepX;
+			}
+			else {
+				chunk = chunk->*neighborX;
+				if (chunk == nullptr) {
+					out_rayCastRes.m_didImpact = false;
+					return false;
+				}
+				blockIndex += wrapIndexStepX;
+			}
+			if (chunk->m_blocks[blockIndex].IsOpaque()) {
+				impactNormal = Vec3( -(float)stepX, 0.f, 0.f );
+				break;
+			}
+			fwdDistAtNextXCrossing += fwdDistPerXCrossing;
+		}
+		else if (fwdDistAtNextYCrossing <= fwdDistAtNextZCrossing) {
+			impactDist = fwdDistAtNextYCrossing;
+			if (impactDist > maxDist) {
+				break;
+			}
+			if ((blockIndex & YBITS_MASK) != borderBitsY) {
+				blockIndex += indexStepY;
+			}
+			else {
+				chunk = chunk->*neighborY;
+				if (chunk == nullptr) {
+					out_rayCastRes.m_didImpact = false;
+					return false;
+				}
+				blockIndex += wrapIndexStepY;
+			}
+			if (chunk->m_blocks[blockIndex].IsOpaque()) {
+				impactNormal = Vec3( 0.f, -(float)stepY, 0.f );
+				break;
+			}
+			fwdDistAtNextYCrossing += fwdDistPerYCrossing;
+		}
+		else {
+			impactDist = fwdDistAtNextZCrossing;
+			if (impactDist > maxDist) {
+				break;
+			}
+			if ((blockIndex & ZBITS_MASK) == borderBitsZ) {
+				out_rayCastRes.m_didImpact = false;
+				return false;
+			}
+			blockIndex += indexStepZ;
+			if (chunk->m_blocks[blockIndex].IsOpaque()) {
+				impactNormal = Vec3( 0.f, 0.f, -(float)stepZ );
+				break;
+			}
+			fwdDistAtNextZCrossing += fwdDistPerZCrossing;
+		}
+	}
+
+	if (impactDist > maxDist) {
+		out_rayCastRes.m_didImpact = false;
+		out_rayCastRes.m_impactDist = maxDist;
+		out_rayCastRes.m_impactNormal = Vec3( 0.f, 0.f, 0.f );
+		out_rayCastRes.m_impactPos = startPos + forwardNormal * maxDist;
+		return false;
+	}
+	out_rayCastRes.m_didImpact = true;
+	out_rayCastRes.m_impactDist = impactDist;
+	out_rayCastRes.m_impactNormal = impactNormal;
+	out_rayCastRes.m_impactPos = forwardNormal * impactDist + startPos;
+	out_rayCastRes.m_res = BlockIter( blockIndex, chunk );
+	return true;
+}
+
+int World::RayCastVsWorldBatch( std::vector<Ray3D> const& rays, std::vector<GameRayCast3DRes>& out_results ) const
+{
+	constexpr int RAYS_EACH_TASK = 64;
+	int numOfRays = (int)rays.size();
+	out_results.resize( rays.size() );
+	// rays only read blocks, so workers can share them as long as the caller does not change blocks meanwhile
+	auto castRay = [this, &rays, &out_results]( int i ) {
+		RayCastVsWorld( out_results[i], rays[i].m_startPos, rays[i].m_forwardNormal, rays[i].m_maxDist );
+		};
+	if (numOfRays > RAYS_EACH_TASK && g_theJobSystem->GetWorkersCount() > 0) {
+		ParallelFor( 0, numOfRays, RAYS_EACH_TASK, castRay );
+	}
+	else {
+		for (int i = 0; i < numOfRays; i++) {
+			castRay( i );
+		}
+	}
+	int numOfHits = 0;
+	for (GameRayCast3DRes const& result : out_results) {
+		numOfHits += result.m_didImpact ? 1 : 0;
+	}
+	return numOfHits;
+}
+
+bool World::RayCastVsWorldByBlockIter( GameRayCast3DRes& out_rayCastRes, Vec3 const& startPos, Vec3 const& forwardNormal, float maxDist ) const
 {
 	// record the ray information
 	out_rayCastRes.m_rayForwardNormal = forwardNormal;
@@ -1126,3 +1410,531 @@ void ChunkLoadJob::Execute()
 	m_chunk->SetSkyLight();
 	m_chunk->m_state = ChunkState::ACTIVATING_GENERATE_COMPLETED;
 }
+
+ChunkMeshJob::ChunkMeshJob( Chunk* chunk )
+	:m_chunk(chunk)
+	,m_isGreedy(g_greedyChunkMeshing)
+{
+	m_snapshot.TakeFrom( chunk );
+}
+
+void ChunkMeshJob::Execute()
+{
+	if (m_isGreedy) {
+		m_snapshot.BuildGreedyVertexArray( m_packedVerts, m_numOfPerFaceVerts );
+	}
+	else {
+		m_snapshot.BuildVertexArray( m_verts );
+	}
+}
+
+void FrameTimeHistogram::AddFrame( float deltaSeconds )
+{
+	float frameMS = deltaSeconds * 1000.f;
+	int bucketIndex = RoundDownToInt( frameMS );
+	if (bucketIndex < 0) {
+		bucketIndex = 0;
+	}
+	if (bucketIndex > NUM_OF_BUCKETS - 1) {
+		bucketIndex = NUM_OF_BUCKETS - 1;
+	}
+	m_buckets[bucketIndex]++;
+	m_numOfFrames++;
+	m_totalMS += (double)frameMS;
+	if (frameMS > m_maxMS) {
+		m_maxMS = frameMS;
+	}
+}
+
+void FrameTimeHistogram::Reset()
+{
+	*this = FrameTimeHistogram();
+}
+
+int FrameTimeHistogram::GetNumOfFramesInRange( float minMS, float maxMS ) const
+{
+	int numOfFrames = 0;
+	for (int i = 0; i < NUM_OF_BUCKETS; i++) {
+		if ((float)i >= minMS && (float)i < maxMS) {
+			numOfFrames += m_buckets[i];
+		}
+	}
+	return numOfFrames;
+}
+
+float FrameTimeHistogram::GetPercentileMS( float fraction ) const
+{
+	if (m_numOfFrames == 0) {
+		return 0.f;
+	}
+	int target = (int)((float)m_numOfFrames * fraction);
+	int numOfFrames = 0;
+	for (int i = 0; i < NUM_OF_BUCKETS; i++) {
+		numOfFrames += m_buckets[i];
+		if (numOfFrames > target) {
+			// upper edge of the bucket
+			return (float)(i + 1);
+		}
+	}
+	return m_maxMS;
+}
+
+bool World::Command_ChunkMeshHistogram( EventArgs& args )
+{
+	if (g_theWorld == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkMeshHistogram: no world" );
+		return false;
+	}
+	if (args.GetValue( "reset", "false" ) == "true") {
+		g_theWorld->m_frameTimeHistograms[0].Reset();
+		g_theWorld->m_frameTimeHistograms[1].Reset();
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, "ChunkMeshHistogram: reset, fly at max speed (Space + WASD) in each mode (M to toggle) and print again" );
+		return true;
+	}
+
+	constexpr int numOfRanges = 7;
+	constexpr float rangeEdgesMS[numOfRanges + 1] = { 0.f, 8.f, 17.f, 25.f, 34.f, 50.f, 100.f, 1000000.f };
+	char const* modeNames[2] = { "main thread", "jobs" };
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-12s %8s %8s %8s %8s %8s %8s", "meshing", "frames", "avg ms", "p50", "p90", "p99", "max" ) );
+	for (int mode = 0; mode < 2; mode++) {
+		FrameTimeHistogram const& histogram = g_theWorld->m_frameTimeHistograms[mode];
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-12s %8d %8.2f %8.0f %8.0f %8.0f %8.2f", modeNames[mode], histogram.m_numOfFrames,
+			histogram.m_numOfFrames > 0 ? histogram.m_totalMS / (double)histogram.m_numOfFrames : 0.0,
+			histogram.GetPercentileMS( 0.5f ), histogram.GetPercentileMS( 0.9f ), histogram.GetPercentileMS( 0.99f ), histogram.m_maxMS ) );
+	}
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-12s %20s %20s", "frame ms", modeNames[0], modeNames[1] ) );
+	for (int i = 0; i < numOfRanges; i++) {
+		std::string rangeText = i == numOfRanges - 1 ? Stringf( "%.0f+", rangeEdgesMS[i] ) : Stringf( "%.0f-%.0f", rangeEdgesMS[i], rangeEdgesMS[i + 1] );
+		std::string line = Stringf( "%-12s", rangeText.c_str() );
+		for (int mode = 0; mode < 2; mode++) {
+			FrameTimeHistogram const& histogram = g_theWorld->m_frameTimeHistograms[mode];
+			int numOfFrames = histogram.GetNumOfFramesInRange( rangeEdgesMS[i], rangeEdgesMS[i + 1] );
+			float percentage = histogram.m_numOfFrames > 0 ? 100.f * (float)numOfFrames / (float)histogram.m_numOfFrames : 0.f;
+			line += Stringf( " %8d (%6.2f%%)  ", numOfFrames, percentage );
+		}
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, line );
+	}
+	return true;
+}
+
+static size_t GetFolderBytes( std::string const& folderPath, size_t& out_allocatedBytes, int& out_numOfFiles )
+{
+	// allocated bytes assume 4KB clusters, every small chunk file takes at least one
+	size_t numOfBytes = 0;
+	out_allocatedBytes = 0;
+	out_numOfFiles = 0;
+	std::error_code errorCode;
+	for (auto const& entry : std::filesystem::directory_iterator( folderPath, errorCode )) {
+		if (entry.is_regular_file()) {
+			size_t fileSize = (size_t)entry.file_size();
+			numOfBytes += fileSize;
+			out_allocatedBytes += (fileSize + 4095) / 4096 * 4096;
+			out_numOfFiles++;
+		}
+	}
+	return numOfBytes;
+}
+
+bool World::Command_ChunkStorageBenchmark( EventArgs& args )
+{
+	if (g_theWorld == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkStorageBenchmark: no world" );
+		return false;
+	}
+	int numOfChunks = atoi( args.GetValue( "chunks", "256" ).c_str() );
+	std::vector<IntVec2> chunkCoords;
+	std::vector<std::vector<uint8_t>> chunkBlockTypes;
+	for (Chunk* chunk : g_theWorld->m_activeChunks) {
+		if ((int)chunkCoords.size() >= numOfChunks) {
+			break;
+		}
+		chunkCoords.push_back( chunk->m_coords );
+		chunkBlockTypes.emplace_back();
+		chunk->GetBlockTypes( chunkBlockTypes.back() );
+	}
+	numOfChunks = (int)chunkCoords.size();
+	if (numOfChunks == 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkStorageBenchmark: no active chunks" );
+		return false;
+	}
+
+	std::string legacyFolderPath = "Saves/Benchmark/Legacy";
+	std::string regionFolderPath = "Saves/Benchmark/Region";
+	std::error_code errorCode;
+	std::filesystem::remove_all( "Saves/Benchmark", errorCode );
+	std::filesystem::create_directories( legacyFolderPath, errorCode );
+	std::vector<uint8_t> loadedBlockTypes;
+	bool isLegacyCorrect = true;
+	bool isRegionCorrect = true;
+
+	double startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfChunks; i++) {
+		Chunk::WriteLegacyChunkFile( chunkBlockTypes[i], Stringf( "%s/Chunk(%d,%d).chunk", legacyFolderPath.c_str(), chunkCoords[i].x, chunkCoords[i].y ) );
+	}
+	double legacySaveSeconds = GetCurrentTimeSeconds() - startTime;
+	startTime = GetCurrentTimeSeconds();
+	for (int i = 0; i < numOfChunks; i++) {
+		isLegacyCorrect = Chunk::ReadLegacyChunkFile( Stringf( "%s/Chunk(%d,%d).chunk", legacyFolderPath.c_str(), chunkCoords[i].x, chunkCoords[i].y ), loadedBlockTypes )
+			&& loadedBlockTypes == chunkBlockTypes[i] && isLegacyCorrect;
+	}
+	double legacyLoadSeconds = GetCurrentTimeSeconds() - startTime;
+
+	double regionSaveSeconds = 0.0;
+	double regionLoadSeconds = 0.0;
+	{
+		RegionStorage regionStorage( regionFolderPath );
+		startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < numOfChunks; i++) {
+			isRegionCorrect = regionStorage.SaveChunk( chunkCoords[i], chunkBlockTypes[i] ) && isRegionCorrect;
+		}
+		regionSaveSeconds = GetCurrentTimeSeconds() - startTime;
+		// loads open the files and read the tables again
+		regionStorage.CloseAll();
+		startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < numOfChunks; i++) {
+			isRegionCorrect = regionStorage.LoadChunk( chunkCoords[i], loadedBlockTypes ) && loadedBlockTypes == chunkBlockTypes[i] && isRegionCorrect;
+		}
+		regionLoadSeconds = GetCurrentTimeSeconds() - startTime;
+	}
+
+	size_t legacyAllocatedBytes = 0;
+	size_t regionAllocatedBytes = 0;
+	int numOfLegacyFiles = 0;
+	int numOfRegionFiles = 0;
+	size_t legacyBytes = GetFolderBytes( legacyFolderPath, legacyAllocatedBytes, numOfLegacyFiles );
+	size_t regionBytes = GetFolderBytes( regionFolderPath, regionAllocatedBytes, numOfRegionFiles );
+	std::filesystem::remove_all( "Saves/Benchmark", errorCode );
+
+	// throughput in uncompressed block data
+	double numOfMB = (double)numOfChunks * (double)BLOCK_COUNT_EACH_CHUNK / (1024.0 * 1024.0);
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "ChunkStorageBenchmark: %d chunks, %.1f MB of block data", numOfChunks, numOfMB ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-8s %9s %10s %9s %10s %6s %10s %12s %8s", "format", "save ms", "save MB/s", "load ms", "load MB/s", "files", "KB", "KB on disk", "correct" ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-8s %9.2f %10.1f %9.2f %10.1f %6d %10.1f %12.1f %8s", "chunk", legacySaveSeconds * 1000.0, numOfMB / legacySaveSeconds,
+		legacyLoadSeconds * 1000.0, numOfMB / legacyLoadSeconds, numOfLegacyFiles, (double)legacyBytes / 1024.0, (double)legacyAllocatedBytes / 1024.0, isLegacyCorrect ? "yes" : "NO" ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-8s %9.2f %10.1f %9.2f %10.1f %6d %10.1f %12.1f %8s", "region", regionSaveSeconds * 1000.0, numOfMB / regionSaveSeconds,
+		regionLoadSeconds * 1000.0, numOfMB / regionLoadSeconds, numOfRegionFiles, (double)regionBytes / 1024.0, (double)regionAllocatedBytes / 1024.0, isRegionCorrect ? "yes" : "NO" ) );
+	return true;
+}
+
+bool World::Command_ChunkGenerationBenchmark( EventArgs& args )
+{
+	if (g_theWorld == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkGenerationBenchmark: no world" );
+		return false;
+	}
+	int numOfChunks = atoi( args.GetValue( "chunks", "64" ).c_str() );
+	if (numOfChunks <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkGenerationBenchmark: chunks must be positive" );
+		return false;
+	}
+	// far from the player so no active chunk is touched, in rows of 16 to cover different terrain
+	std::vector<IntVec2> chunkCoords;
+	chunkCoords.reserve( numOfChunks );
+	for (int i = 0; i < numOfChunks; i++) {
+		chunkCoords.emplace_back( 10000 + i % 16, 10000 + i / 16 );
+	}
+
+	// index 0: scalar noise, 1: batch noise
+	double noiseSeconds[2] = {};
+	double generateSeconds[2] = {};
+	std::vector<uint8_t> blockTypes[2];
+	bool isIdentical = true;
+	ChunkNoiseFields* noiseFields = new ChunkNoiseFields[2];
+	for (int i = 0; i < numOfChunks; i++) {
+		for (int mode = 0; mode < 2; mode++) {
+			IntVec3 chunkOriginWorldCoords( chunkCoords[i].x << XBITS, chunkCoords[i].y << YBITS, 0 );
+			double startTime = GetCurrentTimeSeconds();
+			noiseFields[mode].Compute( chunkOriginWorldCoords, mode == 1 );
+			noiseSeconds[mode] += GetCurrentTimeSeconds() - startTime;
+
+			Chunk* chunk = new Chunk( chunkCoords[i] );
+			startTime = GetCurrentTimeSeconds();
+			chunk->GenerateBlocks( mode == 1 );
+			generateSeconds[mode] += GetCurrentTimeSeconds() - startTime;
+			chunk->GetBlockTypes( blockTypes[mode] );
+			delete chunk;
+		}
+		isIdentical = isIdentical && blockTypes[0] == blockTypes[1] && memcmp( &noiseFields[0], &noiseFields[1], sizeof( ChunkNoiseFields ) ) == 0;
+	}
+	delete[] noiseFields;
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "ChunkGenerationBenchmark: %d chunks, one thread", numOfChunks ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-8s %14s %16s %14s", "noise", "fields us/chunk", "generate ms/chunk", "chunks/s" ) );
+	char const* modeNames[2] = { "scalar", "batch" };
+	for (int mode = 0; mode < 2; mode++) {
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-8s %14.1f %16.3f %14.1f", modeNames[mode], noiseSeconds[mode] * 1000000.0 / (double)numOfChunks,
+			generateSeconds[mode] * 1000.0 / (double)numOfChunks, (double)numOfChunks / generateSeconds[mode] ) );
+	}
+	g_devConsole->AddLine( isIdentical ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR, isIdentical ? "scalar and batch chunks are identical" : "scalar and batch chunks differ!" );
+	return true;
+}
+
+bool World::Command_LightingBenchmark( EventArgs& args )
+{
+	if (g_theWorld == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "LightingBenchmark: no world" );
+		return false;
+	}
+	int numOfChunks = atoi( args.GetValue( "chunks", "64" ).c_str() );
+	if (numOfChunks <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "LightingBenchmark: chunks must be positive" );
+		return false;
+	}
+	World* world = g_theWorld;
+	// nothing left from the frame, so the timed passes only do the relight
+	world->ProcessDirtyLighting();
+
+	// the chunks nearest to the player
+	IntVec2 playerChunkCoords = world->GetPlayerCurrentChunkCoords();
+	std::vector<Chunk*> chunks = world->m_activeChunks.GetChunks();
+	std::sort( chunks.begin(), chunks.end(), [&playerChunkCoords]( Chunk const* a, Chunk const* b ) {
+		return GetTaxicabDistance2D( a->m_coords, playerChunkCoords ) < GetTaxicabDistance2D( b->m_coords, playerChunkCoords );
+		} );
+	if ((int)chunks.size() > numOfChunks) {
+		chunks.resize( numOfChunks );
+	}
+	numOfChunks = (int)chunks.size();
+	if (numOfChunks == 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "LightingBenchmark: no active chunk" );
+		return false;
+	}
+
+	// both modes start from the same light in every active chunk, the relit chunks start dark
+	std::vector<unsigned char> originalLight;
+	originalLight.reserve( (size_t)world->m_activeChunks.GetSize() * BLOCK_COUNT_EACH_CHUNK );
+	for (Chunk* chunk : world->m_activeChunks) {
+		for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+			originalLight.push_back( chunk->m_blocks[i].m_lightInfluenceData );
+		}
+	}
+
+	// index 0: one thread, 1: job workers
+	double relightSeconds[2] = {};
+	int numOfDirtyBlocks = 0;
+	std::vector<unsigned char> resultLight[2];
+	bool isParallelLighting = g_parallelLighting;
+	for (int mode = 0; mode < 2; mode++) {
+		int lightIndex = 0;
+		for (Chunk* chunk : world->m_activeChunks) {
+			for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+				chunk->m_blocks[i].m_lightInfluenceData = originalLight[lightIndex++];
+			}
+		}
+		numOfDirtyBlocks = 0;
+		for (Chunk* chunk : chunks) {
+			for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+				chunk->m_blocks[i].m_lightInfluenceData = 0;
+			}
+			for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+				BlockDefinition const& def = chunk->m_blocks[i].GetDefinition();
+				if (!def.m_opaque || def.m_lightStrength > 0) {
+					world->MarkLightingDirty( BlockIter( i, chunk ) );
+					numOfDirtyBlocks++;
+				}
+			}
+		}
+
+		g_parallelLighting = mode == 1;
+		double startTime = GetCurrentTimeSeconds();
+		world->ProcessDirtyLighting();
+		relightSeconds[mode] = GetCurrentTimeSeconds() - startTime;
+
+		resultLight[mode].clear();
+		resultLight[mode].reserve( originalLight.size() );
+		for (Chunk* chunk : world->m_activeChunks) {
+			for (int i = 0; i < BLOCK_COUNT_EACH_CHUNK; i++) {
+				resultLight[mode].push_back( chunk->m_blocks[i].m_lightInfluenceData );
+			}
+		}
+	}
+	g_parallelLighting = isParallelLighting;
+	bool isIdentical = resultLight[0] == resultLight[1];
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "LightingBenchmark: %d chunks, %d dirty blocks, %d workers", numOfChunks, numOfDirtyBlocks, g_theJobSystem->GetWorkersCount() ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-8s %12s %14s %14s", "mode", "relight ms", "ms/chunk", "Mblocks/s" ) );
+	char const* modeNames[2] = { "serial", "parallel" };
+	for (int mode = 0; mode < 2; mode++) {
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-8s %12.2f %14.3f %14.2f", modeNames[mode], relightSeconds[mode] * 1000.0,
+			relightSeconds[mode] * 1000.0 / (double)numOfChunks, (double)numOfDirtyBlocks / relightSeconds[mode] / 1000000.0 ) );
+	}
+	g_devConsole->AddLine( isIdentical ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR, isIdentical ? "serial and parallel lighting are identical" : "serial and parallel lighting differ!" );
+	return true;
+}
+
+bool World::Command_ChunkRegistryStressTest( EventArgs& args )
+{
+	int radius = atoi( args.GetValue( "radius", "64" ).c_str() );
+	int numOfSteps = atoi( args.GetValue( "steps", "64" ).c_str() );
+	if (radius <= 0 || numOfSteps <= 0) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "ChunkRegistryStressTest: radius and steps must be positive" );
+		return false;
+	}
+	float activationRange = (float)(radius * XSIZE);
+	float deactivationRangeSquared = (activationRange + XSIZE + YSIZE) * (activationRange + XSIZE + YSIZE);
+	std::vector<IntVec2> offsets;
+	BuildChunkActivationOrder( activationRange, offsets );
+	// the player crosses a chunk border every few frames, like flying at full speed
+	constexpr int FRAMES_EACH_STEP = 8;
+	// both registries only hold coords here, no chunk is created
+	Chunk* const noChunk = nullptr;
+
+	// old way: ordered map, scan the whole square around the player every frame
+	std::map<IntVec2, Chunk*> mapRegistry;
+	int radiusX = 1 + int( activationRange ) / XSIZE;
+	int radiusY = 1 + int( activationRange ) / YSIZE;
+	double startTime = GetCurrentTimeSeconds();
+	for (int step = 0; step < numOfSteps; step++) {
+		IntVec2 playerChunkCoords( step, step / 2 );
+		for (int frame = 0; frame < FRAMES_EACH_STEP; frame++) {
+			bool isActivated = false;
+			for (int y = playerChunkCoords.y - radiusY; y <= playerChunkCoords.y + radiusY; y++) {
+				for (int x = playerChunkCoords.x - radiusX; x <= playerChunkCoords.x + radiusX; x++) {
+					IntVec2 coords( x, y );
+					if (mapRegistry.find( coords ) == mapRegistry.end() && GetChunkOffsetDistanceSquared( coords - playerChunkCoords ) < activationRange * activationRange) {
+						mapRegistry[coords] = noChunk;
+						isActivated = true;
+					}
+				}
+			}
+			if (!isActivated) {
+				std::map<IntVec2, Chunk*> copyedMap = mapRegistry;
+				for (auto& pair : copyedMap) {
+					if (GetChunkOffsetDistanceSquared( pair.first - playerChunkCoords ) > deactivationRangeSquared) {
+						mapRegistry.erase( pair.first );
+					}
+				}
+			}
+		}
+	}
+	double mapSeconds = GetCurrentTimeSeconds() - startTime;
+
+	// new way: hash map, walk the spiral once per player chunk and scan for deactivation once per player chunk
+	ChunkMap hashRegistry;
+	int activationCursor = 0;
+	bool isDeactivationScanPending = true;
+	IntVec2 activationCenterCoords( 0, 0 );
+	int numOfActivations = 0;
+	int numOfDeactivations = 0;
+	int maxNumOfChunks = 0;
+	startTime = GetCurrentTimeSeconds();
+	for (int step = 0; step < numOfSteps; step++) {
+		IntVec2 playerChunkCoords( step, step / 2 );
+		for (int frame = 0; frame < FRAMES_EACH_STEP; frame++) {
+			if (playerChunkCoords != activationCenterCoords) {
+				activationCenterCoords = playerChunkCoords;
+				activationCursor = 0;
+				isDeactivationScanPending = true;
+			}
+			bool isActivated = false;
+			while (activationCursor < (int)offsets.size()) {
+				IntVec2 coords = playerChunkCoords + offsets[activationCursor];
+				activationCursor++;
+				if (!hashRegistry.Contains( coords )) {
+					hashRegistry.Insert( coords, noChunk );
+					numOfActivations++;
+					isActivated = true;
+				}
+			}
+			maxNumOfChunks = std::max( maxNumOfChunks, hashRegistry.GetSize() );
+			if (!isActivated && isDeactivationScanPending) {
+				isDeactivationScanPending = false;
+				std::vector<IntVec2> const& coords = hashRegistry.GetCoords();
+				for (int i = (int)coords.size() - 1; i >= 0; i--) {
+					if (GetChunkOffsetDistanceSquared( coords[i] - playerChunkCoords ) > deactivationRangeSquared) {
+						hashRegistry.Erase( IntVec2( coords[i] ) );
+						numOfDeactivations++;
+					}
+				}
+			}
+		}
+	}
+	double hashSeconds = GetCurrentTimeSeconds() - startTime;
+
+	bool isIdentical = (int)mapRegistry.size() == hashRegistry.GetSize();
+	for (auto& pair : mapRegistry) {
+		isIdentical = isIdentical && hashRegistry.Contains( pair.first );
+	}
+
+	int numOfFrames = numOfSteps * FRAMES_EACH_STEP;
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "ChunkRegistryStressTest: radius %d chunks, %d chunks in range, %d frames, peak %d chunks, %d activated, %d deactivated",
+		radius, (int)offsets.size(), numOfFrames, maxNumOfChunks, numOfActivations, numOfDeactivations ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-10s %12s %12s", "registry", "total ms", "us/frame" ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-10s %12.2f %12.2f", "std::map", mapSeconds * 1000.0, mapSeconds * 1000000.0 / (double)numOfFrames ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-10s %12.2f %12.2f", "ChunkMap", hashSeconds * 1000.0, hashSeconds * 1000000.0 / (double)numOfFrames ) );
+	g_devConsole->AddLine( isIdentical ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR, isIdentical ? "both registries hold the same chunks" : "the registries differ!" );
+	return true;
+}
+
+bool World::Command_RayCastBenchmark( EventArgs& args )
+{
+	if (g_theWorld == nullptr) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "RayCastBenchmark: no world" );
+		return false;
+	}
+	int numOfRays = atoi( args.GetValue( "rays", "100000" ).c_str() );
+	float maxDist = (float)atof( args.GetValue( "maxDist", "64" ).c_str() );
+	if (numOfRays <= 0 || maxDist <= 0.f) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "RayCastBenchmark: rays and maxDist must be positive" );
+		return false;
+	}
+	World* world = g_theWorld;
+	// same rays every run, spread around the player so most of them start in active chunks
+	RandomNumberGenerator rng( 12345 );
+	Vec3 const& playerPos = world->m_player->m_position;
+	std::vector<Ray3D> rays;
+	rays.reserve( numOfRays );
+	for (int i = 0; i < numOfRays; i++) {
+		Vec3 startPos( playerPos.x + rng.RollRandomFloatInRange( -48.f, 48.f ), playerPos.y + rng.RollRandomFloatInRange( -48.f, 48.f ),
+			GetClamped( playerPos.z + rng.RollRandomFloatInRange( -16.f, 16.f ), 1.f, (float)ZSIZE - 1.f ) );
+		Vec3 forward;
+		do {
+			forward = Vec3( rng.RollRandomFloatInRange( -1.f, 1.f ), rng.RollRandomFloatInRange( -1.f, 1.f ), rng.RollRandomFloatInRange( -1.f, 1.f ) );
+		} while (forward.GetLengthSquared() < 0.01f || forward.GetLengthSquared() > 1.f);
+		rays.emplace_back( startPos, forward.GetNormalized(), maxDist );
+	}
+
+	// index 0: BlockIter steps, 1: DDA, 2: DDA batch
+	std::vector<GameRayCast3DRes> results[3];
+	double seconds[3] = {};
+	int numOfHits[3] = {};
+	for (int mode = 0; mode < 2; mode++) {
+		results[mode].resize( numOfRays );
+		double startTime = GetCurrentTimeSeconds();
+		for (int i = 0; i < numOfRays; i++) {
+			bool isHit = mode == 0 ? world->RayCastVsWorldByBlockIter( results[mode][i], rays[i].m_startPos, rays[i].m_forwardNormal, rays[i].m_maxDist )
+				: world->RayCastVsWorld( results[mode][i], rays[i].m_startPos, rays[i].m_forwardNormal, rays[i].m_maxDist );
+			numOfHits[mode] += isHit ? 1 : 0;
+		}
+		seconds[mode] = GetCurrentTimeSeconds() - startTime;
+	}
+	double batchStartTime = GetCurrentTimeSeconds();
+	numOfHits[2] = world->RayCastVsWorldBatch( rays, results[2] );
+	seconds[2] = GetCurrentTimeSeconds() - batchStartTime;
+
+	// the BlockIter version does not fill the hit block when the ray starts inside an opaque block
+	int numOfMismatches = 0;
+	for (int i = 0; i < numOfRays; i++) {
+		for (int mode = 0; mode < 2; mode++) {
+			GameRayCast3DRes const& a = results[mode == 0 ? 0 : 2][i];
+			GameRayCast3DRes const& b = results[1][i];
+			bool isSame = a.m_didImpact == b.m_didImpact;
+			if (isSame && a.m_didImpact) {
+				isSame = a.m_impactDist == b.m_impactDist && a.m_impactNormal == b.m_impactNormal;
+				if (isSame && (mode == 1 || a.m_impactDist > 0.f)) {
+					isSame = a.m_res.m_chunk == b.m_res.m_chunk && a.m_res.m_blockIndex == b.m_res.m_blockIndex;
+				}
+			}
+			numOfMismatches += isSame ? 0 : 1;
+		}
+	}
+
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "RayCastBenchmark: %d rays, max dist %.0f, %d workers", numOfRays, maxDist, g_theJobSystem->GetWorkersCount() ) );
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "%-10s %10s %14s %8s", "method", "ms", "Mrays/s", "hits" ) );
+	char const* modeNames[3] = { "BlockIter", "DDA", "DDA batch" };
+	for (int mode = 0; mode < 3; mode++) {
+		g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "%-10s %10.2f %14.3f %8d", modeNames[mode], seconds[mode] * 1000.0, (double)numOfRays / seconds[mode] / 1000000.0, numOfHits[mode] ) );
+	}
+	g_devConsole->AddLine( numOfMismatches == 0 ? DevConsole::INFO_MINOR : DevConsole::INFO_ERROR,
+		numOfMismatches == 0 ? "all methods hit the same blocks" : Stringf( "%d results differ!", numOfMismatches ) );
+	return true;
+}
@@ -1,11 +1,13 @@
 #pragma once
 #include "Game/GameCommon.hpp"
 #include "Game/BlockIter.hpp"
+#include "Game/Chunk.hpp"
+#include "Game/ChunkMap.hpp"
 #include <deque>
 #include <unordered_set>
-#include <set>
 class Chunk;
 class Player;
+class RegionStorage;
 struct BlockDefinition;
 
 extern unsigned int g_terrainSeed;
@@ -59,7 +61,41 @@ public:
 	virtual void Execute() override;
 };
 
+// builds the vertex array of an active chunk from a snapshot, only the GPU upload is left for the main thread
+class ChunkMeshJob : public Job {
+public:
+	ChunkMeshJob( Chunk* chunk );
+	virtual void Execute() override;
+	Chunk* m_chunk = nullptr; // main thread only, nullptr if the chunk is deactivated before the job comes back
+	ChunkMeshSnapshot m_snapshot;
+	bool m_isGreedy = false;
+	std::vector<Vertex_PCU> m_verts;
+	std::vector<Vertex_Block> m_packedVerts;
+	int m_numOfPerFaceVerts = 0;
+};
+
+//-----------------------------------------------------------------------------------------------
+// frame times in 1ms buckets, the last bucket takes every slower frame
+struct FrameTimeHistogram {
+	static constexpr int NUM_OF_BUCKETS = 101;
+	void AddFrame( float deltaSeconds );
+	void Reset();
+	int GetNumOfFramesInRange( float minMS, float maxMS ) const;
+	float GetPercentileMS( float fraction ) const;
+
+	int m_buckets[NUM_OF_BUCKETS] = {};
+	int m_numOfFrames = 0;
+	double m_totalMS = 0.0;
+	float m_maxMS = 0.f;
+};
+
 constexpr int SIMPLE_MINER_WORLD_CONSTANTS_SLOT = 8;
+constexpr int SIMPLE_MINER_BLOCK_UV_CONSTANTS_SLOT = 9;
+
+// sprite UVs of every block definition for the packed vertex shader, indexed by (blockType * 3 + 0 top / 1 side / 2 bottom)
+struct BlockUVConstants {
+	Vec4 m_blockUVs[256 * 3]; // (minU, minV, maxU, maxV)
+};
 
 class World {
 public:
@@ -74,22 +110,46 @@ public:
 	Chunk* CreateChunk( IntVec2 const& chunkCoords );
 	IntVec2 GetChunkCoordsByWorldPos( Vec2 const& worldXYPos ) const;
 	size_t GetVertsCount() const;
+	size_t GetPerFaceVertsCount() const;
+	size_t GetVertexBufferBytes() const;
 	IntVec3 GetBlockCoordsByWorldPosition( Vec3 const& worldPos ) const;
 	/// Note: this function is expensive
 	BlockIter CreatBlockIter( Vec3 const& worldPos ) const;
 	void MarkLightingDirty( BlockIter const& iter );
+	bool RayCastVsWorld( GameRayCast3DRes& out_rayCastRes, Vec3 const& startPos, Vec3 const& forwardNormal, float maxDist ) const;
+	/// out_results[i] is the result of rays[i], the job workers help when there are many rays; returns the number of hits
+	int RayCastVsWorldBatch( std::vector<Ray3D> const& rays, std::vector<GameRayCast3DRes>& out_results ) const;
 	float GetDayTimeFraction() const;
 	bool IsTimeInNight() const;
 	std::string GetCurDayTimeText() const;
+
+	// console command: ChunkMeshHistogram reset=false
+	static bool Command_ChunkMeshHistogram( EventArgs& args );
+	// console command: ChunkStorageBenchmark chunks=256, saves and loads active chunks in the old and the region format
+	static bool Command_ChunkStorageBenchmark( EventArgs& args );
+	// console command: ChunkGenerationBenchmark chunks=64, generates chunks on the main thread with scalar and batch noise
+	static bool Command_ChunkGenerationBenchmark( EventArgs& args );
+	// console command: LightingBenchmark chunks=64, relights the active chunks around the player on one thread and on the job workers
+	static bool Command_LightingBenchmark( EventArgs& args );
+	// console command: ChunkRegistryStressTest radius=64 steps=64, walks a player over a registry of that activation radius (in chunks)
+	static bool Command_ChunkRegistryStressTest( EventArgs& args );
+	// console command: RayCastBenchmark rays=100000, casts random rays around the player with every ray cast version
+	static bool Command_RayCastBenchmark( EventArgs& args );
+
+	/// chunk offsets from the player's chunk that are in activation range, nearest first
+	static void BuildChunkActivationOrder( float activationRange, std::vector<IntVec2>& out_offsets );
+	static float GetChunkOffsetDistanceSquared( IntVec2 const& chunkOffset );
 protected:
 	void DoChunkDynamicActivation();
 	bool ActivateTheNearestInRangeChunk( IntVec2 const& playerChunkCoords );
 	bool ActivateAllInRangeChunks( IntVec2 const& playerChunkCoords );
 	bool DeactivateTheFarthestOutRangeChunk( IntVec2 const& playerChunkCoords );
+	void QueueChunkActivation( IntVec2 const& coords );
 	//void ActivateChunk( IntVec2 const& coords );
 	void DeactivateChunk( Chunk* chunk );
 	void StartUpChunk( Chunk* chunk );
 
+	bool HasSavedChunk( IntVec2 const& coords ) const;
 	bool GetChunkByCoords( IntVec2 const& coords, Chunk** out_chunkPtr ) const;
 	Chunk* GetChunkByCoords( IntVec2 const& coords ) const;
 	IntVec2 GetPlayerCurrentChunkCoords() const;
@@ -101,22 +161,38 @@ protected:
 	void ChangeCurrentBlockType();
 
 	void ProcessDirtyLighting();
-	void ProcessNextDirtyLightBlock();
 	void UndirtyAllBlocksInChunk( Chunk* chunk );
 
-	bool RayCastVsWorld( GameRayCast3DRes& out_rayCastRes, Vec3 const& startPos, Vec3 const& forwardNormal, float maxDist ) const;
+	void UpdateDirtyChunksSync( float deltaSeconds );
+	void QueueChunkMeshJobs();
+	void RetrieveChunkMeshJobs();
+
+	/// the first step by BlockIter, kept to check and time RayCastVsWorld against
+	bool RayCastVsWorldByBlockIter( GameRayCast3DRes& out_rayCastRes, Vec3 const& startPos, Vec3 const& forwardNormal, float maxDist ) const;
 
 	void UpdateTimeAndSkyColor();
 
 	void DeconstructChunk(Chunk* chunk);
 public:
 	//std::vector<Chunk*> m_activeChunks;
-	std::map<IntVec2, Chunk*> m_activeChunks;
-	std::deque<BlockIter> m_blockLightingQueue;
+	ChunkMap m_activeChunks;
+	// chunks with a non-empty m_lightDirtyQueue
+	std::vector<Chunk*> m_lightDirtyChunks;
+	std::vector<Chunk*> m_lightPassChunks;
+	std::vector<std::vector<ChunkLightPush>> m_lightPassPushes;
 	std::vector<SimpleMinerJob*> m_chunkGenerationJobs;
 	std::vector<ChunkSaveJob*> m_chunkSaveJobs;
+	std::vector<ChunkMeshJob*> m_chunkMeshJobs;
+	int m_maxChunkMeshJobs = 2;
 	std::vector<Chunk*> m_dirtyChunks;
-	std::set<IntVec2> m_queuedGenerateChunks;
+	ChunkMap m_queuedGenerateChunks;
+	// spiral order around the player's chunk, offsets before the cursor are active or queued;
+	// the cursor only moves past a chunk once it is active or queued, so chunks held back by m_maxChunks are not skipped
+	std::vector<IntVec2> m_activationOffsets;
+	int m_activationCursor = 0;
+	IntVec2 m_activationCenterCoords;
+	bool m_isDeactivationScanPending = true;
+	RegionStorage* m_regionStorage = nullptr;
 
 	float m_chunkActivationRange;
 	float m_chunkDeactivationRange;
@@ -146,5 +222,11 @@ public:
 	SimplerMinerConstants m_worldConstans;
 	ConstantBuffer* m_worldCBO = nullptr;
 	Shader* m_worldShader = nullptr;
+	Shader* m_worldPackedShader = nullptr;
+	ConstantBuffer* m_blockUVCBO = nullptr;
+
+	// index 0: meshing on the main thread, 1: meshing in jobs
+	FrameTimeHistogram m_frameTimeHistograms[2];
+	bool m_wasLastFrameMeshingAsync = true;
 
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------------------------
+// Same lighting and fog as World.hlsl, for the greedy chunk mesh with 8 byte Vertex_Block verts
+struct vs_input_t
+{
+	uint4 localPosition : POSITION;	// x, y, z inside the chunk, face
+	uint4 blockData : TEXCOORD;		// block type, light (outdoor << 4 | indoor), unused, unused
+};
+
+//------------------------------------------------------------------------------------------------
+struct v2p_t
+{
+	float4 position : SV_Position;
+	float4 color : COLOR;
+	float2 tileUV : TEXCOORD;	// in blocks, repeats the sprite over merged faces
+	nointerpolation float4 spriteUVs : SPRITE_UVS;
+	float4 worldPosition: WORLD_POSITION;
+};
+
+//------------------------------------------------------------------------------------------------
+cbuffer CameraConstants : register(b2)
+{
+	float4x4 ViewMatrix;
+	float4x4 ProjectionMatrix;
+};
+
+//------------------------------------------------------------------------------------------------
+cbuffer ModelConstants : register(b3)
+{
+	float4x4 ModelMatrix;
+	float4 ModelColor;
+};
+
+cbuffer SimplerMinerConstants :  register(b8)
+{
+	float4 CameraWorldPos;
+	float4 IndoorLightColor;
+	float4 OutdoorLightColor;
+	float4 SkyColor;
+	float FogNearDist;
+	float FogFarDist;
+	float pad0;
+	float pad1;
+};
+
+// (minU, minV, maxU, maxV) at blockType * 3 + 0 top / 1 side / 2 bottom
+cbuffer BlockUVConstants : register(b9)
+{
+	float4 BlockUVs[256 * 3];
+};
+
+float4 DiminishingAdd( float4 a, float4 b ){
+	return float4(1, 1, 1, 1) - (float4(1, 1, 1, 1) - a) * (float4(1, 1, 1, 1) - b);
+}
+
+//------------------------------------------------------------------------------------------------
+Texture2D diffuseTexture : register(t0);
+
+//------------------------------------------------------------------------------------------------
+SamplerState diffuseSampler : register(s0);
+
+//------------------------------------------------------------------------------------------------
+v2p_t VertexMain(vs_input_t input)
+{
+	float3 position = float3(input.localPosition.xyz);
+	uint face = input.localPosition.w;
+	float4 worldPosition = mul(ModelMatrix, float4(position, 1));
+	float4 viewPosition = mul(ViewMatrix, worldPosition);
+	float4 clipPosition = mul(ProjectionMatrix, viewPosition);
+
+	// faces: 0 south, 1 west, 2 north, 3 east, 4 top, 5 bottom
+	// texture directions match the one quad per face mesh
+	float2 tileUV;
+	uint uvKind = 1;
+	if (face == 0) {
+		tileUV = float2(position.x, position.z);
+	}
+	else if (face == 1) {
+		tileUV = float2(-position.y, position.z);
+	}
+	else if (face == 2) {
+		tileUV = float2(-position.x, position.z);
+	}
+	else if (face == 3) {
+		tileUV = float2(position.y, position.z);
+	}
+	else if (face == 4) {
+		tileUV = float2(position.x, position.y);
+		uvKind = 0;
+	}
+	else {
+		tileUV = float2(position.x, -position.y);
+		uvKind = 2;
+	}
+
+	uint light = input.blockData.y;
+
+	v2p_t v2p;
+	v2p.position = clipPosition;
+	v2p.color = float4(float(light >> 4) / 15.0, float(light & 15) / 15.0, 0.5, 1.0);
+	v2p.tileUV = tileUV;
+	v2p.spriteUVs = BlockUVs[input.blockData.x * 3 + uvKind];
+	v2p.worldPosition = worldPosition;
+	return v2p;
+}
+
+//------------------------------------------------------------------------------------------------
+float4 PixelMain(v2p_t input) : SV_Target0
+{
+	float2 uv = lerp(input.spriteUVs.xy, input.spriteUVs.zw, frac(input.tileUV));
+	float4 textureColor = diffuseTexture.Sample(diffuseSampler, uv);
+	float4 modelColor = ModelColor;
+
+	float4 pixelOutdoorLightColor = input.color.r * OutdoorLightColor;
+	float4 pixelIndoorLightColor = input.color.g * IndoorLightColor;
+
+	float4 color = textureColor * modelColor * DiminishingAdd(pixelOutdoorLightColor, pixelIndoorLightColor);
+
+	float dist = distance(input.worldPosition.xyz, CameraWorldPos.xyz);
+	float fraction = saturate((dist - FogNearDist) / (FogFarDist - FogNearDist));
+	color.rgb = lerp(color.rgb, SkyColor.rgb, fraction);
+	color.a = color.a + fraction;
+	color.a = saturate(color.a);
+
+	return color;
+}
@@ -87,6 +87,7 @@ void App::Startup() {
 	//m_theGame->Startup();
 
 	SubscribeEventCallbackFunction( "quit", App::SetQuitting );
+	SubscribeEventCallbackFunction( "Command_CollisionBenchmark", Game::Event_CollisionBenchmark );
 	g_devConsole->AddLine( DevConsole::INFO_MINOR, "Initializing..." );
 
 	g_devConsole->AddLine( DevConsole::INFO_MAJOR, "Successfully Initialized!" );
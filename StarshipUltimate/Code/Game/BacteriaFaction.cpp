@@ -1431,7 +1431,7 @@ void BacteriaBossSister::Update( float deltaTime )
 			float arrowOrientation = (m_player->m_position - m_position).GetOrientationDegrees();
 			arrowOrientation = GetTurnedTowardDegrees( arrowOrientation, 90.f, GetRandGen()->RollRandomFloatInRange( 10.f, 30.f ) );
 			Projectile* projectile = g_theGame->SpawnProjectileToGame( m_arrowDef, m_position, arrowOrientation, Vec2::MakeFromPolarDegrees( arrowOrientation, m_arrowDef.m_speed ) );
-			projectile->m_faction = m_def.m_faction;
+			projectile->SetFaction( m_def.m_factionID );
 			m_changePositionTimer->Start();
 		}
 	}
@@ -1440,7 +1440,7 @@ void BacteriaBossSister::Update( float deltaTime )
 			float arrowOrientation = (m_player->m_position - m_position).GetOrientationDegrees();
 			arrowOrientation = GetTurnedTowardDegrees( arrowOrientation, 90.f, GetRandGen()->RollRandomFloatInRange( 10.f, 30.f ) );
 			Projectile* projectile = g_theGame->SpawnProjectileToGame( m_arrowDef, m_position, arrowOrientation, Vec2::MakeFromPolarDegrees( arrowOrientation, m_arrowDef.m_speed ) );
-			projectile->m_faction = m_def.m_faction;
+			projectile->SetFaction( m_def.m_factionID );
 		}
 	}
 	else if (m_state == 2) {
@@ -364,8 +364,8 @@ void ShotGunShooter::GunFire()
 	for (int i = 0; i < 7; i++) {
 		Vec2 shootForward = Vec2::MakeFromPolarDegrees( m_gunOrientationDegrees + i * stepOrientation );
 		Projectile* proj = m_mainWeapon->Fire( shootForward, m_position + Vec2::MakeFromPolarDegrees( m_orientationDegrees + GUN_RELATIVE_DEGREES, m_cosmeticRadius ) );
-		proj->m_lifeTimer->SetPeriodSeconds( 0.26f );
-		proj->m_velocity *= 3.5f;
+		proj->SetLifeSeconds( 0.26f );
+		proj->SetVelocity( proj->GetVelocity() * 3.5f );
 	}
 	AddImpulse( -Vec2::MakeFromPolarDegrees( m_gunOrientationDegrees ) * NORMAL_SHOOT_IMPULSE * 2.f );
 }
@@ -457,7 +457,7 @@ void Sniper::GunFire()
 {
 	Vec2 shootForward = Vec2::MakeFromPolarDegrees( m_gunOrientationDegrees );
 	Projectile* proj = m_mainWeapon->Fire( shootForward, m_position + Vec2::MakeFromPolarDegrees( m_orientationDegrees + GUN_RELATIVE_DEGREES, m_cosmeticRadius ) );
-	proj->m_velocity *= 5.f;
+	proj->SetVelocity( proj->GetVelocity() * 5.f );
 	AddImpulse( -shootForward * NORMAL_SHOOT_IMPULSE );
 }
 
@@ -557,7 +557,7 @@ void MissileShooter::BeAttacked( float hit, Vec2 const& hitNormal, bool directDa
 void MissileShooter::GunFire()
 {
 	Vec2 forward( 0.f, 0.f );
-	CurveMissile* proj = (CurveMissile*)m_mainWeapon->Fire( forward, m_position );
+	Projectile* proj = m_mainWeapon->Fire( forward, m_position );
 	proj->m_goUp = m_goUp;
 	proj->m_targetPosition = GetRandomPointInDisc2D( 20.f, m_target->m_position );
 	proj->BeginPlay();
@@ -711,8 +711,8 @@ void GunTwinElder::GunFire()
 		// AddImpulse( -shootForward * NORMAL_SHOOT_IMPULSE );
 	}
 	else if (m_state == 3) {
-		CurveMissile* proj = (CurveMissile*)g_theGame->SpawnProjectileToGame( m_missileDef, m_position, 0.f );
-		proj->m_faction = m_def.m_faction;
+		Projectile* proj = g_theGame->SpawnProjectileToGame( m_missileDef, m_position, 0.f );
+		proj->SetFaction( m_def.m_factionID );
 		proj->m_damage = GetMainWeaponDamage();
 		proj->m_goUp = m_goUp;
 		proj->m_targetPosition = GetRandomPointInDisc2D( 20.f, m_target->m_position );
@@ -960,8 +960,8 @@ void GunTwinYoung::GunFire()
 		// AddImpulse( -shootForward * NORMAL_SHOOT_IMPULSE );
 	}
 	else if (m_state == 3) {
-		CurveMissile* proj = (CurveMissile*)g_theGame->SpawnProjectileToGame( m_missileDef, m_position, 0.f );
-		proj->m_faction = m_def.m_faction;
+		Projectile* proj = g_theGame->SpawnProjectileToGame( m_missileDef, m_position, 0.f );
+		proj->SetFaction( m_def.m_factionID );
 		proj->m_damage = GetMainWeaponDamage();
 		proj->m_goUp = m_goUp;
 		proj->m_targetPosition = GetRandomPointInDisc2D( 20.f, m_target->m_position );
@@ -1322,9 +1322,9 @@ void BossDoubleGun::GunFire( int skill )
 	}
 	else if (skill == 2) {
 		Projectile* proj = m_mainWeapon->Fire( Vec2::MakeFromPolarDegrees( m_gunOrientationDegrees ), m_position + Vec2::MakeFromPolarDegrees( m_orientationDegrees + GUN_RELATIVE_DEGREES, m_cosmeticRadius ) );
-		proj->m_velocity *= 4.f;
+		proj->SetVelocity( proj->GetVelocity() * 4.f );
 		proj = m_mainWeapon->Fire( Vec2::MakeFromPolarDegrees( m_gunOrientationDegrees ), m_position + Vec2::MakeFromPolarDegrees( m_orientationDegrees - GUN_RELATIVE_DEGREES, m_cosmeticRadius ) );
-		proj->m_velocity *= 4.f;
+		proj->SetVelocity( proj->GetVelocity() * 4.f );
 	}
 }
 
@@ -1495,11 +1495,11 @@ void BossArmsMaster::Update( float deltaTime )
 					Vec2 fwdVec = GetForwardNormal();
 					Vec2 leftVec = fwdVec.GetRotated90Degrees();
 					Projectile* proj = m_playerBulletGun->Fire( fwdVec, m_position + fwdVec * m_cosmeticRadius * 0.5f );
-					proj->m_velocity *= 1.3f;
+					proj->SetVelocity( proj->GetVelocity() * 1.3f );
 					proj = m_playerBulletGun->Fire( fwdVec, m_position + leftVec * m_cosmeticRadius * 0.3f );
-					proj->m_velocity *= 1.3f;
+					proj->SetVelocity( proj->GetVelocity() * 1.3f );
 					proj = m_playerBulletGun->Fire( fwdVec, m_position - leftVec * m_cosmeticRadius * 0.3f );
-					proj->m_velocity *= 1.3f;
+					proj->SetVelocity( proj->GetVelocity() * 1.3f );
 				}
 			}
 			// ray
@@ -1621,8 +1621,8 @@ void BossArmsMaster::Update( float deltaTime )
 					m_position = newPos;
 					constexpr float stepPerI = 360.f / 30.f;
 					for (int i = 0; i < 30; i++) {
-						EnemyBullet* bullet = (EnemyBullet*)m_enemyBulletGun->Fire( Vec2::MakeFromPolarDegrees( m_orientationDegrees + i * stepPerI ), m_position );
-						bullet->m_lifeTimer->SetPeriodSeconds( 6.f );
+						Projectile* bullet = m_enemyBulletGun->Fire( Vec2::MakeFromPolarDegrees( m_orientationDegrees + i * stepPerI ), m_position );
+						bullet->SetLifeSeconds( 6.f );
 					}
 				}
 			}
@@ -1632,7 +1632,7 @@ void BossArmsMaster::Update( float deltaTime )
 				PerformWonder( deltaTime );
 				if (m_shootTimer->DecrementPeriodIfElapsed()) {
 					Vec2 forward( 0.f, 0.f );
-					CurveMissile* proj = (CurveMissile*)m_missileGun->Fire( forward, m_position );
+					Projectile* proj = m_missileGun->Fire( forward, m_position );
 					proj->m_goUp = m_missileGoUp;
 					Vec2 taegetVelFwd = m_target->m_velocity.GetNormalized();
 					proj->m_targetPosition = m_target->m_position + taegetVelFwd * GetRandGen()->RollRandomFloatInRange( 0.f, 50.f );
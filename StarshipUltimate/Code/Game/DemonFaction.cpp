@@ -81,7 +81,7 @@ void LittleDemon::Update( float deltaTime )
 			m_numOfBullets++;
 			Projectile* proj = g_theGame->SpawnProjectileToGame( ProjectileDefinition::GetDefinition( "DemonBullet" ), m_position, orientation, vecToPlayer * ProjectileDefinition::GetDefinition( "DemonBullet" ).m_speed );
 			proj->m_damage = 1.f;
-			proj->m_faction = m_def.m_faction;
+			proj->SetFaction( m_def.m_factionID );
 			if (m_numOfBullets == 6) {
 				m_state1ShootTimer->SetPeriodSeconds( 1.f );
 				m_state1ShootTimer->Start();
@@ -110,7 +110,7 @@ void LittleDemon::Update( float deltaTime )
 			for (int i = 0; i < 8; i++) {
 				Projectile* proj = g_theGame->SpawnProjectileToGame( ProjectileDefinition::GetDefinition( "DemonBullet" ), m_position, bulletOrientation, Vec2::MakeFromPolarDegrees( bulletOrientation ) * ProjectileDefinition::GetDefinition( "DemonBullet" ).m_speed );
 				proj->m_damage = 1.f;
-				proj->m_faction = m_def.m_faction;
+				proj->SetFaction( m_def.m_factionID );
 				bulletOrientation += degreesPerBullet;
 			}
 		}
@@ -763,7 +763,7 @@ void DiamondBossAssassin::Update( float deltaTime )
 				constexpr float stepDegrees = 360.f / 8.f;
 				for (int i = 0; i < 8; i++) {
 					Projectile* projectile = g_theGame->SpawnProjectileToGame( m_projDef, m_position, m_orientationDegrees + stepDegrees * i, Vec2::MakeFromPolarDegrees( m_orientationDegrees + stepDegrees * i ) * m_projDef.m_speed );
-					projectile->m_faction = m_def.m_faction;
+					projectile->SetFaction( m_def.m_factionID );
 				}
 				m_shurikenShootTimer->Start();
 			}
@@ -837,7 +837,7 @@ void DiamondBossAssassin::Update( float deltaTime )
 				// shoot shuriken
 				if (!m_shurikenShootTimer->HasStartedAndNotPeriodElapsed()) {
 					Projectile* projectile = g_theGame->SpawnProjectileToGame( m_projDef, m_position, m_orientationDegrees, Vec2::MakeFromPolarDegrees( m_orientationDegrees ) * m_projDef.m_speed );
-					projectile->m_faction = m_def.m_faction;
+					projectile->SetFaction( m_def.m_factionID );
 					m_shurikenShootTimer->Start();
 				}
 			}
@@ -1426,7 +1426,7 @@ void DiamondBossRayChannel::Update( float deltaTime )
 		if (m_shootTimer->DecrementPeriodIfElapsed()) {
 			float orientation = m_orientationDegrees + GetRandGen()->RollRandomFloatInRange( -60.f, 60.f );
 			Projectile* projectile = g_theGame->SpawnProjectileToGame( m_projDef, m_position, orientation, Vec2::MakeFromPolarDegrees( orientation ) * m_projDef.m_speed );
-			projectile->m_faction = m_def.m_faction;
+			projectile->SetFaction( m_def.m_factionID );
 		}
 	}
 
@@ -1435,15 +1435,17 @@ void DiamondBossRayChannel::Update( float deltaTime )
 		if (m_dodgeTimer->HasPeriodElapsed()) {
 			float dist = 400.f;
 			Projectile* projectileToDodge = nullptr;
-			for (auto proj : g_theGame->m_projectileArray) {
-				if (proj && proj->m_faction != m_def.m_faction && GetDistanceSquared2D( m_position, proj->m_position ) < dist
-					&& DotProduct2D( proj->m_velocity, forwardNormal ) < 0.f) {
-					dist = GetDistanceSquared2D( m_position, proj->m_position );
+			ProjectilePool const& projectilePool = g_theGame->m_projectilePool;
+			for (int i = 0; i < projectilePool.GetNumOfSlots(); i++) {
+				Projectile* proj = projectilePool.GetProjectile( i );
+				if (proj && proj->GetFaction() != m_def.m_factionID && GetDistanceSquared2D( m_position, proj->GetPosition() ) < dist
+					&& DotProduct2D( proj->GetVelocity(), forwardNormal ) < 0.f) {
+					dist = GetDistanceSquared2D( m_position, proj->GetPosition() );
 					projectileToDodge = proj;
 				}
 			}
 			if (projectileToDodge) {
-				float cross = CrossProduct2D( forwardNormal, (projectileToDodge->m_position - m_position) );
+				float cross = CrossProduct2D( forwardNormal, (projectileToDodge->GetPosition() - m_position) );
 				if (cross > 0) {
 					AddImpulse( forwardNormal.GetRotatedMinus90Degrees() * 30.f );
 				}
@@ -310,7 +310,7 @@ void SlashEffect::Update( float deltaTime )
 		point = m_modelMatrix.TransformPosition2D( point );
 		for (auto entity : g_theGame->m_entityArray) {
 			if (entity && entity->IsAlive() && !entity->IsInvincible() && entity != m_owner 
-				&& entity->m_def.m_faction != m_owner->m_def.m_faction
+				&& IsFactionHostile( m_owner->m_def.m_factionID, entity->m_def.m_factionID )
 				&& DoDiscsOverlap( point, 5.f, entity->m_position, entity->m_physicsRadius)) {
 				entity->BeAttackedOnce( m_owner->GetMainWeaponDamage(), Vec2( 0.f, 0.f ), m_stateTimer->GetPeriodSeconds(), this );
 			}
@@ -441,7 +441,7 @@ void Missle::BeginPlay()
 	}
 	m_stateTimer = new Timer( m_flyTime, GetGameClock() );
 	m_stateTimer->Start();
-	m_faction = m_owner->m_def.m_faction;
+	m_faction = m_owner->m_def.m_factionID;
 	m_damage = m_owner->GetMainWeaponDamage();
 }
 
@@ -475,7 +475,7 @@ void Missle::Update( float deltaTime )
 		m_currentRadius = m_maxRadius * SmoothStop2( m_stateTimer->GetElapsedFraction() );
 		for (auto entity : g_theGame->m_entityArray) {
 			if (entity && entity->IsAlive() && !entity->IsInvincible() && entity != m_owner
-				&& entity->m_def.m_faction != m_faction
+				&& IsFactionHostile( m_faction, entity->m_def.m_factionID )
 				&& IsPointInsideDisc2D( entity->m_position, m_targetPos, m_currentRadius )) {
 				entity->BeAttackedOnce( m_damage, Vec2( 0.f, 0.f ), m_stateTimer->GetPeriodSeconds(), this );
 			}
@@ -890,7 +890,7 @@ PersistentRay::~PersistentRay()
 
 void PersistentRay::BeginPlay()
 {
-	m_faction = m_owner->m_def.m_faction;
+	m_faction = m_owner->m_def.m_factionID;
 	if (m_updatePositionByOwner && m_owner) {
 		m_relativeOrientation = m_orientationDegrees - m_owner->m_orientationDegrees;
 	}
@@ -927,7 +927,7 @@ void PersistentRay::Update( float deltaTime )
 	}
 
 	for (auto entity : g_theGame->m_entityArray) {
-		if (entity && entity->m_def.m_faction != m_faction && entity->IsAlive() && !entity->IsInvincible() && entity != m_owner) {
+		if (entity && IsFactionHostile( m_faction, entity->m_def.m_factionID ) && entity->IsAlive() && !entity->IsInvincible() && entity != m_owner) {
 			Vec2 forwardVec = Vec2::MakeFromPolarDegrees( m_orientationDegrees );
 			Vec2 center = m_position + forwardVec * m_curLength * 0.5f;
 			OBB2 obbCollider( center, forwardVec, Vec2( m_curLength * 0.5f, m_width * 0.5f ) );
@@ -1221,7 +1221,7 @@ void SprayAttack::Update( float deltaTime )
 	}
 
 	for (auto entity : g_theGame->m_entityArray) {
-		if (entity && entity->m_def.m_faction != m_faction && DoDiscAndOBB2Overlap2D( entity->m_position, entity->m_physicsRadius, m_boundingBox )) {
+		if (entity && IsFactionHostile( m_faction, entity->m_def.m_factionID ) && DoDiscAndOBB2Overlap2D( entity->m_position, entity->m_physicsRadius, m_boundingBox )) {
 			entity->BeAttackedOnce( m_damage, -m_boundingBox.m_iBasisNormal, 1.f, this, false, m_boundingBox.m_iBasisNormal );
 			if (m_isPoisonous) {
 				entity->m_poisonTimer += 0.1f;
@@ -1299,7 +1299,7 @@ void SectorSprayAttack::Update( float deltaTime )
 	}
 
 	for (auto entity : g_theGame->m_entityArray) {
-		if (entity && entity->m_def.m_faction != m_faction && DoDiscAndSectorOverlap2D( entity->m_position, entity->m_physicsRadius, m_startPos, m_forwardDegrees, m_rangeDegrees, m_radius )) {
+		if (entity && IsFactionHostile( m_faction, entity->m_def.m_factionID ) && DoDiscAndSectorOverlap2D( entity->m_position, entity->m_physicsRadius, m_startPos, m_forwardDegrees, m_rangeDegrees, m_radius )) {
 			entity->BeAttackedOnce( m_damage, Vec2(), 1.f, this );
 			if (m_isPoisonous) {
 				entity->m_poisonTimer += 0.1f;
@@ -1351,7 +1351,7 @@ void SunFlame::Update( float deltaTime )
 	m_radius = m_dist * SmoothStop2( m_attackTimer->GetElapsedFraction() );
 
 	for (auto entity : g_theGame->m_entityArray) {
-		if (entity && entity->m_def.m_faction != m_faction && 
+		if (entity && IsFactionHostile( m_faction, entity->m_def.m_factionID ) && 
 			DoDiscsOverlap( entity->m_position, entity->m_physicsRadius, m_position, m_radius ) 
 			&& g_theGame->m_curRoom->m_bounds.IsPointInside(entity->m_position)) {
 			entity->BeAttackedOnce( m_damage, Vec2(), 10000.f, this );
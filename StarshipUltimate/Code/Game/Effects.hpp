@@ -187,7 +187,7 @@ protected:
 	int m_state = 0;
 	float m_currentRadius = 0.f;
 	float m_gravity = 300.f;
-	std::string m_faction = "Default";
+	FactionID m_faction = FACTION_ID_DEFAULT;
 };
 
 class PlayerShield : public StarshipEffect {
@@ -283,7 +283,7 @@ public:
 	float m_maxLength = 300.f;
 	float m_curLength = 0.f;
 	Entity* m_owner = nullptr;
-	std::string m_faction;
+	FactionID m_faction = FACTION_ID_NONE;
 	float m_lifeTimeSeconds = 0.f;
 	float m_width = 0.f;
 
@@ -371,7 +371,7 @@ public:
 	Timer* m_attackTimer = nullptr;
 	OBB2 m_boundingBox;
 	Vec2 m_startPos;
-	std::string m_faction;
+	FactionID m_faction = FACTION_ID_NONE;
 	Timer* m_sapTimer = nullptr;
 	bool m_isPoisonous = false;
 };
@@ -394,7 +394,7 @@ public:
 	float m_radius = 0.f;
 	Timer* m_attackTimer = nullptr;
 	Vec2 m_startPos;
-	std::string m_faction;
+	FactionID m_faction = FACTION_ID_NONE;
 	Timer* m_sapTimer = nullptr;
 	bool m_isPoisonous = false;
 };
@@ -413,7 +413,7 @@ public:
 	float m_damage = 1.f;
 	float m_radius = 0.f;
 	Timer* m_attackTimer = nullptr;
-	std::string m_faction;
+	FactionID m_faction = FACTION_ID_NONE;
 };
 
 class ElectricChain :public StarshipEffect {
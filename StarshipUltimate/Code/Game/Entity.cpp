@@ -251,6 +251,7 @@ EntityDefinition::EntityDefinition( XmlElement* xmlIter )
 	if (basicElement) {
 		m_name = ParseXmlAttribute( *basicElement, "name", "Default" );
 		m_faction = ParseXmlAttribute( *basicElement, "faction", "Default" );
+		m_factionID = GetFactionIDByName( m_faction );
 		m_physicsRadius = ParseXmlAttribute( *basicElement, "physicsRadius", m_physicsRadius );
 		m_cosmeticRadius = ParseXmlAttribute( *basicElement, "cosmeticRadius", m_cosmeticRadius );
 		m_turnSpeed = ParseXmlAttribute( *basicElement, "turnSpeed", m_turnSpeed );
@@ -318,6 +319,7 @@ void EntityDefinition::SetUpEntityDefinitions()
 			s_factionLevelMap[def.m_faction][def.m_enemyLevel].push_back( &def );
 		}
 	}
+	GUARANTEE_OR_DIE( DoFactionMasksMatchNames(), "Faction hostility masks do not match the faction names" );
 }
 
 EntityDefinition const& EntityDefinition::GetDefinition( std::string const& name )
@@ -14,6 +14,7 @@ class Projectile;
 struct EntityDefinition {
 	std::string m_name;
 	std::string m_faction;
+	FactionID m_factionID = 0;
 	float m_physicsRadius = 0.5f;
 	float m_cosmeticRadius = 0.5f;
 	float m_turnSpeed = 90.f;
@@ -4,7 +4,6 @@
 #include "Game/PlayerShip.hpp"
 #include "Game/PlayerController.hpp"
 #include "Game/AIController.hpp"
-#include "Game/PlayerBullet.hpp"
 #include "Game/DiamondFraction.hpp"
 #include "Game/Effects.hpp"
 #include "Game/Room.hpp"
@@ -20,9 +19,15 @@
 #include "Engine/Math/RandomNumberGenerator.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Clock.hpp"
+#include "Engine/Core/Time.hpp"
 
 static void* PlayerShieldDashDamageSource = (void*)1;
 
+static AABB2 GetDiscBounds( Vec2 const& center, float radius )
+{
+	return AABB2( center - Vec2( radius, radius ), center + Vec2( radius, radius ) );
+}
+
 Game::Game()
 {
 	// load random number generator
@@ -61,11 +66,6 @@ Game::~Game()
 		effect = nullptr;
 	}
 
-	for (auto& projectile : m_projectileArray) {
-		delete projectile;
-		projectile = nullptr;
-	}
-
 	for (auto& controller : m_controllers) {
 		delete controller;
 		controller = nullptr;
@@ -552,40 +552,7 @@ Entity* Game::SpawnEntityToGame( EntityDefinition const& def, Vec2 const& positi
 
 Projectile* Game::SpawnProjectileToGame( ProjectileDefinition const& def, Vec2 const& position, float orientationDegrees, Vec2 const& initialVelocity /*= Vec2( 0.f, 0.f ) */ )
 {
-	Projectile* newProjectile = nullptr;
-	if (def.m_name == "Bullet") {
-		newProjectile = new PlayerBullet( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "Shuriken") {
-		newProjectile = new Shuriken( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "Rocket") {
-		newProjectile = new Rocket( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "DemonBullet") {
-		newProjectile = new DemonBullet( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "EnemyBullet") {
-		newProjectile = new EnemyBullet( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "CurveMissile") {
-		newProjectile = new CurveMissile( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "CoinBullet") {
-		newProjectile = new CoinBullet( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "SharpenedObsidian") {
-		newProjectile = new SharpenedObsidian( def, position, orientationDegrees, initialVelocity );
-	}
-	else if (def.m_name == "Arrow") {
-		newProjectile = new Arrow( def, position, orientationDegrees, initialVelocity );
-	}
-	else {
-		ERROR_AND_DIE( Stringf( "No such projectile name %s", def.m_name.c_str() ) );
-	}
-
-	AddProjectileToGame( newProjectile );
-	return newProjectile;
+	return m_projectilePool.SpawnProjectile( def, position, orientationDegrees, initialVelocity );
 }
 
 StarshipEffect* Game::SpawnEffectToGame( EffectType type, Vec2 const& position, float orientationDegrees /*= 0.f*/, Vec2 const& initialVelocity /*= Vec2( 0.f, 0.f ) */, bool pushBack )
@@ -703,12 +670,12 @@ void Game::RemoveEntityFromGame( Entity* entityToRemove )
 	}
 }
 
-StarshipRayCastResult Game::RayCastVsEntities( Vec2 position, Vec2 direction, float maxDist, Entity* ignoreEntity, std::string const& targetFaction, bool targetReflector /*= false */ )
+StarshipRayCastResult Game::RayCastVsEntities( Vec2 position, Vec2 direction, float maxDist, Entity* ignoreEntity, FactionID targetFaction, bool targetReflector /*= false */ )
 {
 	RayCastResult2D res;
 	StarshipRayCastResult finalRes;
 	for (auto entity : m_entityArray) {
-		if(entity && entity->IsAlive() && entity != ignoreEntity && (entity->m_def.m_faction == targetFaction || (targetReflector && entity->m_def.m_isReflector)) 
+		if(entity && entity->IsAlive() && entity != ignoreEntity && (entity->m_def.m_factionID == targetFaction || (targetReflector && entity->m_def.m_isReflector)) 
 			&& RayCastVsDisc2D( res, position, direction, maxDist, entity->m_position, entity->m_physicsRadius )) {
 			if (res.m_impactDist < finalRes.m_impactDist || !finalRes.m_didImpact) {
 				finalRes = StarshipRayCastResult( res );
@@ -962,11 +929,7 @@ void Game::UpdateAllGameObjects( float deltaSeconds )
 			m_effectArray[i]->Update( deltaSeconds );
 		}
 	}
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i]) {
-			m_projectileArray[i]->Update( deltaSeconds );
-		}
-	}
+	m_projectilePool.Update( deltaSeconds );
 	for (int i = 0; i < (int)m_controllers.size(); i++) {
 		if (m_controllers[i]) {
 			m_controllers[i]->Update( deltaSeconds );
@@ -987,15 +950,10 @@ void Game::RemoveGarbageGameObjects()
 			m_effectArray[i] = nullptr;
 		}
 	}
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i] && m_projectileArray[i]->m_isGarbage) {
-			delete m_projectileArray[i];
-			m_projectileArray[i] = nullptr;
-		}
-	}
+	m_projectilePool.RemoveGarbageProjectiles();
 	for (int i = 0; i < (int)m_entityArray.size(); i++) {
 		if (m_entityArray[i] && m_entityArray[i]->m_isGarbage) {
-			if (m_playerShip->m_bloodThirst && m_entityArray[i]->m_hasReward && m_entityArray[i]->m_def.m_faction != "Player") {
+			if (m_playerShip->m_bloodThirst && m_entityArray[i]->m_hasReward && m_entityArray[i]->m_def.m_factionID != FACTION_ID_PLAYER) {
 				if (m_entityArray[i]->m_def.m_enemyLevel == 5) {
 					m_playerShip->m_mainWeaponDamage += 0.1f;
 				}
@@ -1003,7 +961,7 @@ void Game::RemoveGarbageGameObjects()
 					m_playerShip->m_mainWeaponDamage += 0.01f;
 				}
 			}
-			if (m_entityArray[i]->m_hasReward && m_entityArray[i]->m_def.m_faction != "Player") {
+			if (m_entityArray[i]->m_hasReward && m_entityArray[i]->m_def.m_factionID != FACTION_ID_PLAYER) {
 				GenerateHealthOrArmorPickup( m_entityArray[i]->m_position);
 			}
 			delete m_entityArray[i];
@@ -1021,11 +979,7 @@ void Game::RenderAllGameObjects() const
 			m_effectArray[i]->Render();
 		}
 	}
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i]) {
-			m_projectileArray[i]->Render();
-		}
-	}
+	m_projectilePool.Render();
 	for (int i = 0; i < (int)m_entityArray.size(); i++) {
 		if (m_entityArray[i]) {
 			m_entityArray[i]->Render();
@@ -1176,22 +1130,7 @@ void Game::DebugRenderAllGameObjects() const
 			m_entityArray[i]->DebugRender();
 		}
 	}
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i]) {
-			m_projectileArray[i]->DebugRender();
-		}
-	}
-}
-
-void Game::AddProjectileToGame( Projectile* projectile )
-{
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i] == nullptr) {
-			m_projectileArray[i] = projectile;
-			return;
-		}
-	}
-	m_projectileArray.push_back( projectile );
+	m_projectilePool.DebugRender();
 }
 
 void Game::RenderUI() const
@@ -1324,21 +1263,57 @@ void Game::RenderUI() const
 
 void Game::UpdateCollisions()
 {
-	for (int i = 0; i < (int)m_entityArray.size(); i++) {
-		if (m_entityArray[i] && m_entityArray[i]->IsAlive()) {
-			for (int j = i + 1; j < (int)m_entityArray.size(); j++) {
-				if (m_entityArray[j] && m_entityArray[j]->IsAlive()) {
-					CollideTwoEntities( m_entityArray[i], m_entityArray[j] );
+	if (m_useCollisionGrid) {
+		BuildCollisionGrids();
+		m_isEntityGridValid = true;
+		// only pairs sharing a cell are tested, in the same order as the full scan below
+		for (int i = 0; i < (int)m_gridEntityIndexes.size(); i++) {
+			Entity* entity = m_entityArray[m_gridEntityIndexes[i]];
+			if (entity && entity->IsAlive()) {
+				m_gridCandidates.clear();
+				m_entityGrid.GetItemsOverlappingBox( GetDiscBounds( entity->m_position, entity->m_physicsRadius ), m_gridCandidates );
+				for (int candidate : m_gridCandidates) {
+					Entity* other = m_entityArray[m_gridEntityIndexes[candidate]];
+					if (candidate > i && other && other->IsAlive()) {
+						CollideTwoEntities( entity, other );
+					}
 				}
 			}
 		}
+
+		for (int i = 0; i < (int)m_gridEntityIndexes.size(); i++) {
+			Entity* entity = m_entityArray[m_gridEntityIndexes[i]];
+			if (entity && entity->IsAlive()) {
+				m_gridCandidates.clear();
+				m_projectileGrid.GetItemsOverlappingBox( GetDiscBounds( entity->m_position, entity->m_physicsRadius ), m_gridCandidates );
+				for (int candidate : m_gridCandidates) {
+					Projectile* projectile = m_projectilePool.GetProjectile( m_gridProjectileIndexes[candidate] );
+					if (projectile && projectile->IsAlive()) {
+						CollideEntityAndProjectile( entity, projectile );
+					}
+				}
+			}
+		}
+		m_isEntityGridValid = false;
 	}
+	else {
+		for (int i = 0; i < (int)m_entityArray.size(); i++) {
+			if (m_entityArray[i] && m_entityArray[i]->IsAlive()) {
+				for (int j = i + 1; j < (int)m_entityArray.size(); j++) {
+					if (m_entityArray[j] && m_entityArray[j]->IsAlive()) {
+						CollideTwoEntities( m_entityArray[i], m_entityArray[j] );
+					}
+				}
+			}
+		}
 
-	for (int i = 0; i < (int)m_entityArray.size(); i++) {
-		if (m_entityArray[i] && m_entityArray[i]->IsAlive()) {
-			for (int j = 0; j < (int)m_projectileArray.size(); j++) {
-				if (m_projectileArray[j] && m_projectileArray[j]->IsAlive()) {
-					CollideEntityAndProjectile( m_entityArray[i], m_projectileArray[j] );
+		for (int i = 0; i < (int)m_entityArray.size(); i++) {
+			if (m_entityArray[i] && m_entityArray[i]->IsAlive()) {
+				for (int j = 0; j < m_projectilePool.GetNumOfSlots(); j++) {
+					Projectile* projectile = m_projectilePool.GetProjectile( j );
+					if (projectile && projectile->IsAlive()) {
+						CollideEntityAndProjectile( m_entityArray[i], projectile );
+					}
 				}
 			}
 		}
@@ -1362,13 +1337,55 @@ void Game::UpdateCollisions()
 	}
 }
 
+void Game::BuildCollisionGrids()
+{
+	AABB2 const& roomBounds = m_curRoom->m_bounds;
+	// dead entities stay in the grid, range damage still reaches them like it does in a full scan
+	m_gridEntityIndexes.clear();
+	m_gridItemBounds.clear();
+	for (int i = 0; i < (int)m_entityArray.size(); i++) {
+		if (m_entityArray[i]) {
+			m_gridEntityIndexes.push_back( i );
+			m_gridItemBounds.push_back( GetDiscBounds( m_entityArray[i]->m_position, m_entityArray[i]->m_physicsRadius ) );
+		}
+	}
+	m_entityGrid.Build( roomBounds, UniformGrid2D::GetSuggestedNumOfCells( roomBounds, (int)m_gridItemBounds.size() ), m_gridItemBounds );
+
+	m_gridProjectileIndexes.clear();
+	m_gridItemBounds.clear();
+	for (int i = 0; i < m_projectilePool.GetNumOfSlots(); i++) {
+		Projectile* projectile = m_projectilePool.GetProjectile( i );
+		if (projectile && projectile->IsAlive()) {
+			m_gridProjectileIndexes.push_back( i );
+			m_gridItemBounds.push_back( GetDiscBounds( projectile->GetPosition(), projectile->m_physicsRadius ) );
+		}
+	}
+	m_projectileGrid.Build( roomBounds, UniformGrid2D::GetSuggestedNumOfCells( roomBounds, (int)m_gridItemBounds.size() ), m_gridItemBounds );
+}
+
+void Game::GetEntitiesInRange( Vec2 const& position, float range, std::vector<int>& out_entityIndexes ) const
+{
+	if (m_isEntityGridValid) {
+		// the grid appends its item indexes, turn them into entity indexes in place
+		size_t firstNewIndex = out_entityIndexes.size();
+		m_entityGrid.GetItemsOverlappingBox( GetDiscBounds( position, range ), out_entityIndexes );
+		for (size_t i = firstNewIndex; i < out_entityIndexes.size(); i++) {
+			out_entityIndexes[i] = m_gridEntityIndexes[out_entityIndexes[i]];
+		}
+		return;
+	}
+	for (int i = 0; i < (int)m_entityArray.size(); i++) {
+		out_entityIndexes.push_back( i );
+	}
+}
+
 void Game::CollideTwoEntities( Entity* a, Entity* b )
 {
 	if (!a->m_def.m_enableCollision || !b->m_def.m_enableCollision) {
 		return;
 	}
-	if (!a->IsInvincible() && !b->IsInvincible() && DoDiscsOverlap( a->m_position, a->m_physicsRadius, b->m_position, b->m_physicsRadius )
-		&& a->m_def.m_faction != b->m_def.m_faction) {
+	if (IsFactionHostile( a->m_def.m_factionID, b->m_def.m_factionID ) && !a->IsInvincible() && !b->IsInvincible()
+		&& DoDiscsOverlap( a->m_position, a->m_physicsRadius, b->m_position, b->m_physicsRadius )) {
 		if (a == m_playerShip) {
 			if (m_playerShip->m_collisionDamage) {
 				b->BeAttackedOnce( 2.f, Vec2( 0.f, 0.f ), 0.3f, a );
@@ -1408,7 +1425,7 @@ void Game::CollideTwoEntities( Entity* a, Entity* b )
 
 void Game::CollideEntityAndProjectile( Entity* entity, Projectile* projectile )
 {
-	if (entity->m_def.m_faction == projectile->m_faction) {
+	if (!IsFactionHostile( projectile->GetFaction(), entity->m_def.m_factionID )) {
 		return;
 	}
 	if (entity->IsInvincible()) {
@@ -1417,25 +1434,27 @@ void Game::CollideEntityAndProjectile( Entity* entity, Projectile* projectile )
 	if (entity == m_playerShip && m_playerShip->m_subWeaponShieldDashOn) {
 		return;
 	}
-	if (DoDiscsOverlap( entity->m_position, entity->m_physicsRadius, projectile->m_position, projectile->m_physicsRadius )) {
+	if (DoDiscsOverlap( entity->m_position, entity->m_physicsRadius, projectile->GetPosition(), projectile->m_physicsRadius )) {
 		if (projectile->m_isPuncturing) {
 			projectile->SpawnCollisionEffect();
 			if (projectile->m_hasRangeDamage) {
 				DealRangeDamage( projectile, true, 100.f );
 			}
 			else {
-				entity->BeAttackedOnce( projectile->m_damage, (projectile->m_position - entity->m_position).GetNormalized(), 100.f, projectile, false, projectile->m_velocity );
+				entity->BeAttackedOnce( projectile->m_damage, (projectile->GetPosition() - entity->m_position).GetNormalized(), 100.f, projectile, false, projectile->GetVelocity() );
 			}
 		}
 		else {
-			PushDiscOutOfFixedDisc2D( projectile->m_position, projectile->m_physicsRadius, entity->m_position, entity->m_physicsRadius );
+			Vec2 projectilePosition = projectile->GetPosition();
+			PushDiscOutOfFixedDisc2D( projectilePosition, projectile->m_physicsRadius, entity->m_position, entity->m_physicsRadius );
+			projectile->SetPosition( projectilePosition );
 			projectile->SpawnCollisionEffect();
 			projectile->Die();
 			if (projectile->m_hasRangeDamage) {
 				DealRangeDamage( projectile );
 			}
 			else {
-				entity->BeAttacked( projectile->m_damage, (projectile->m_position - entity->m_position).GetNormalized(), false, projectile->m_velocity );
+				entity->BeAttacked( projectile->m_damage, (projectile->GetPosition() - entity->m_position).GetNormalized(), false, projectile->GetVelocity() );
 			}
 		}
 		if (projectile->m_isPoisonous) {
@@ -1707,9 +1726,10 @@ void Game::DebugKillEverything()
 
 bool Game::IsPlayerBulletInRange( Vec2 const& pos, float rangeRadius ) const
 {
-	for (int i = 0; i < (int)m_projectileArray.size(); i++) {
-		if (m_projectileArray[i] && m_projectileArray[i]->m_faction == "Player") {
-			if (IsPointInsideDisc2D( m_projectileArray[i]->m_position, pos, rangeRadius )) {
+	for (int i = 0; i < m_projectilePool.GetNumOfSlots(); i++) {
+		Projectile* projectile = m_projectilePool.GetProjectile( i );
+		if (projectile && projectile->GetFaction() == FACTION_ID_PLAYER) {
+			if (IsPointInsideDisc2D( projectile->GetPosition(), pos, rangeRadius )) {
 				return true;
 			}
 		}
@@ -1719,17 +1739,23 @@ bool Game::IsPlayerBulletInRange( Vec2 const& pos, float rangeRadius ) const
 
 void Game::DealRangeDamage( Projectile* proj, bool dealOnce /*= false*/, float coolDownTime /*= 0.f */ )
 {
-	for (auto entity : m_entityArray) {
+	// taken out of the member so a range damage dealt while this one runs gets its own list
+	std::vector<int> entityIndexes;
+	entityIndexes.swap( m_rangeDamageEntityIndexes );
+	entityIndexes.clear();
+	GetEntitiesInRange( proj->GetPosition(), proj->m_rangeDamageRadius, entityIndexes );
+	for (int entityIndex : entityIndexes) {
+		Entity* entity = m_entityArray[entityIndex];
 		if (!entity) {
 			continue;
 		}
-		if (entity->m_def.m_faction == proj->m_faction) {
+		if (!IsFactionHostile( proj->GetFaction(), entity->m_def.m_factionID )) {
 			continue;
 		}
 		if (entity->IsInvincible()) {
 			continue;
 		}
-		if (DoDiscsOverlap( proj->m_position, proj->m_rangeDamageRadius, entity->m_position, entity->m_physicsRadius )) {
+		if (DoDiscsOverlap( proj->GetPosition(), proj->m_rangeDamageRadius, entity->m_position, entity->m_physicsRadius )) {
 			if (dealOnce) {
 				entity->BeAttackedOnce( proj->m_rangeDamagePercentage * proj->m_damage, Vec2( 0.f, 0.f ), coolDownTime, proj );
 			}
@@ -1738,18 +1764,25 @@ void Game::DealRangeDamage( Projectile* proj, bool dealOnce /*= false*/, float c
 			}
 		}
 	}
+	m_rangeDamageEntityIndexes.swap( entityIndexes );
 }
 
-void Game::DealRangeDamage( float damage, Vec2 const& position, float range, std::string const& sourceFaction, bool dealOnce /*= false*/, float coolDownTime /*= 0.f */, void* source )
+void Game::DealRangeDamage( float damage, Vec2 const& position, float range, FactionID sourceFaction, bool dealOnce /*= false*/, float coolDownTime /*= 0.f */, void* source )
 {
-	for (auto entity : m_entityArray) {
-		if (!entity) {
+	FactionMask hostileMask = g_hostileFactionMasks[sourceFaction];
+	std::vector<int> entityIndexes;
+	entityIndexes.swap( m_rangeDamageEntityIndexes );
+	entityIndexes.clear();
+	GetEntitiesInRange( position, range, entityIndexes );
+	for (int entityIndex : entityIndexes) {
+		Entity* entity = m_entityArray[entityIndex];
+		if (!entity || (hostileMask & GetFactionMask( entity->m_def.m_factionID )) == 0) {
 			continue;
 		}
 		if (entity->IsInvincible()) {
 			continue;
 		}
-		if (DoDiscsOverlap( position, range, entity->m_position, entity->m_physicsRadius ) && entity->m_def.m_faction != sourceFaction) {
+		if (DoDiscsOverlap( position, range, entity->m_position, entity->m_physicsRadius )) {
 			if (dealOnce) {
 				entity->BeAttackedOnce( damage, Vec2( 0.f, 0.f ), coolDownTime, source );
 			}
@@ -1758,6 +1791,97 @@ void Game::DealRangeDamage( float damage, Vec2 const& position, float range, std
 			}
 		}
 	}
+	m_rangeDamageEntityIndexes.swap( entityIndexes );
+}
+
+bool Game::Event_CollisionBenchmark( EventArgs& args )
+{
+	Game* game = g_theGame;
+	if (game == nullptr || game->m_curRoom == nullptr || game->m_state != GameState::IN_ROOM) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "CollisionBenchmark needs a game in a room" );
+		return true;
+	}
+	int numOfProjectiles = args.GetValue( "projectiles", 5000 );
+	int numOfFrames = args.GetValue( "frames", 60 );
+	if (numOfFrames < 1) {
+		numOfFrames = 1;
+	}
+
+	// bullets of a faction nobody is in test against every entity, but start clear of them so none of them hits
+	ProjectileDefinition const& def = ProjectileDefinition::GetDefinition( "EnemyBullet" );
+	AABB2 const& roomBounds = game->m_curRoom->m_bounds;
+	std::vector<Vec2> stressPositions;
+	stressPositions.reserve( numOfProjectiles );
+	for (int i = 0; i < numOfProjectiles; i++) {
+		for (int tries = 0; tries < 20; tries++) {
+			Vec2 position = roomBounds.GetRandomPointInside();
+			bool isNearEntity = false;
+			for (auto entity : game->m_entityArray) {
+				if (entity && DoDiscsOverlap( position, 5.f, entity->m_position, entity->m_physicsRadius )) {
+					isNearEntity = true;
+					break;
+				}
+			}
+			if (!isNearEntity) {
+				stressPositions.push_back( position );
+				break;
+			}
+		}
+	}
+	FactionID stressFaction = GetFactionIDByName( "CollisionBenchmark" );
+	if (!DoFactionMasksMatchNames()) {
+		g_devConsole->AddLine( DevConsole::INFO_ERROR, "Faction hostility masks do not match the faction names" );
+	}
+	std::vector<Projectile*> stressProjectiles;
+	stressProjectiles.reserve( stressPositions.size() );
+	double spawnStartTime = GetCurrentTimeSeconds();
+	for (Vec2 const& position : stressPositions) {
+		Projectile* projectile = game->SpawnProjectileToGame( def, position, 0.f );
+		projectile->SetFaction( stressFaction );
+		stressProjectiles.push_back( projectile );
+	}
+	double spawnSeconds = GetCurrentTimeSeconds() - spawnStartTime;
+
+	int numOfEntities = 0;
+	for (auto entity : game->m_entityArray) {
+		if (entity && entity->IsAlive()) {
+			++numOfEntities;
+		}
+	}
+	int numOfAllProjectiles = game->m_projectilePool.GetNumOfAliveProjectiles();
+
+	bool useCollisionGrid = game->m_useCollisionGrid;
+	double seconds[2] = {};
+	for (int pass = 0; pass < 2; pass++) {
+		game->m_useCollisionGrid = pass == 1;
+		double startTime = GetCurrentTimeSeconds();
+		for (int frame = 0; frame < numOfFrames; frame++) {
+			game->UpdateCollisions();
+		}
+		seconds[pass] = GetCurrentTimeSeconds() - startTime;
+	}
+	game->m_useCollisionGrid = useCollisionGrid;
+
+	// no time passes, so nothing moves or expires, but every projectile goes through the update loop
+	double updateStartTime = GetCurrentTimeSeconds();
+	for (int frame = 0; frame < numOfFrames; frame++) {
+		game->m_projectilePool.Update( 0.f );
+	}
+	double updateSeconds = GetCurrentTimeSeconds() - updateStartTime;
+
+	int numOfHits = 0;
+	for (auto projectile : stressProjectiles) {
+		if (!projectile->IsAlive()) {
+			++numOfHits;
+		}
+		projectile->Die( false );
+	}
+	g_devConsole->AddLine( DevConsole::INFO_MAJOR, Stringf( "CollisionBenchmark %d entities, %d projectiles, %d frames", numOfEntities, numOfAllProjectiles, numOfFrames ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "Full scan %.3f ms/frame, grid %.3f ms/frame, %d stress bullets hit something",
+		seconds[0] * 1000.0 / numOfFrames, seconds[1] * 1000.0 / numOfFrames, numOfHits ) );
+	g_devConsole->AddLine( DevConsole::INFO_MINOR, Stringf( "Projectile pool: spawn %.3f us per projectile, update %.3f ms/frame",
+		stressProjectiles.empty() ? 0.0 : spawnSeconds * 1e6 / (double)stressProjectiles.size(), updateSeconds * 1000.0 / numOfFrames ) );
+	return true;
 }
 
 void Game::PickUpItem( Vec2 const& pos )
@@ -1988,11 +2112,12 @@ void Game::ExitChooseItemMode()
 
 Entity* Game::GetNearestEnemy( Vec2 const& position, float maxDist, Entity* excludeEnemy ) const
 {
+	static FactionID const neutralFaction = GetFactionIDByName( "Neutral" );
 	float minDist = maxDist * maxDist;
 	Entity* entity = nullptr;
 	for (int i = 0; i < (int)m_entityArray.size(); i++) {
 		if (m_entityArray[i] && m_entityArray[i] != excludeEnemy && m_entityArray[i]->IsAlive() 
-			&& m_entityArray[i]->m_def.m_faction != "Player" && m_entityArray[i]->m_def.m_faction != "Neutral" 
+			&& m_entityArray[i]->m_def.m_factionID != FACTION_ID_PLAYER && m_entityArray[i]->m_def.m_factionID != neutralFaction
 			&& GetDistanceSquared2D(position, m_entityArray[i]->m_position) < minDist) {
 			minDist = GetDistanceSquared2D( position, m_entityArray[i]->m_position );
 			entity = m_entityArray[i];
@@ -2019,10 +2144,11 @@ void Game::GoToNextFloor()
 	//BeginGame();
 }
 
-void Game::SetTimeScaleOfAllEntity( std::string const& friendlyFaction, float newTimeScale )
+void Game::SetTimeScaleOfAllEntity( FactionID friendlyFaction, float newTimeScale )
 {
+	FactionMask hostileMask = g_hostileFactionMasks[friendlyFaction];
 	for (int i = 0; i < (int)m_entityArray.size(); i++) {
-		if (m_entityArray[i] && m_entityArray[i]->IsAlive() && m_entityArray[i]->m_def.m_faction != friendlyFaction) {
+		if (m_entityArray[i] && (hostileMask & GetFactionMask( m_entityArray[i]->m_def.m_factionID )) != 0 && m_entityArray[i]->IsAlive()) {
 			m_entityArray[i]->m_clock->SetTimeScale( newTimeScale );
 		}
 	}
@@ -2161,7 +2287,7 @@ void Game::CleanUpCurLevel()
 	ItemDefinition::ResetAllInRoomItems();
 	RoomDefinition::ResetAllDefinitionsForEachFloor();
 	for (auto& entity : m_entityArray) {
-		if (entity && entity->m_def.m_faction != "Player") {
+		if (entity && entity->m_def.m_factionID != FACTION_ID_PLAYER) {
 			delete entity;
 			entity = nullptr;
 		}
@@ -2174,10 +2300,7 @@ void Game::CleanUpCurLevel()
 		}
 	}
 
-	for (auto& projectile : m_projectileArray) {
-		delete projectile;
-		projectile = nullptr;
-	}
+	m_projectilePool.Clear();
 	for (auto room : m_roomMap) {
 		delete room;
 	}
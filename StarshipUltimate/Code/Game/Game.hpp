@@ -5,6 +5,7 @@
 #include "Game/Effects.hpp"
 #include "Game/Weapon.hpp"
 #include "Engine/Renderer/Camera.hpp"
+#include "Engine/Math/UniformGrid2D.hpp"
 
 class Renderer;
 class Clock;
@@ -45,7 +46,7 @@ public:
 	std::vector<int> m_hidingShopItems;
 
 	PlayerController* m_playerController;
-	std::vector<Projectile*> m_projectileArray;
+	ProjectilePool m_projectilePool;
 
 	int m_curLevel = 0;
 	std::vector<std::string> m_levelSequence;
@@ -80,7 +81,7 @@ public:
 	void AddEntityToGame( Entity* entityToAdd );
 	void RemoveEntityFromGame( Entity* entityToRemove );
 
-	StarshipRayCastResult RayCastVsEntities( Vec2 position, Vec2 direction, float maxDist, Entity* ignoreEntity, std::string const& targetFaction, bool targetReflector = false );
+	StarshipRayCastResult RayCastVsEntities( Vec2 position, Vec2 direction, float maxDist, Entity* ignoreEntity, FactionID targetFaction, bool targetReflector = false );
 	
 	std::vector<DiamondReflector*> GetAllDiamondReflectors() const;
 
@@ -99,7 +100,7 @@ public:
 	bool IsPlayerBulletInRange( Vec2 const& pos, float rangeRadius ) const;
 
 	void DealRangeDamage( Projectile* proj, bool dealOnce = false, float coolDownTime = 0.f );
-	void DealRangeDamage( float damage, Vec2 const& position, float range, std::string const& sourceFaction="Default", bool dealOnce = false, float coolDownTime = 0.f, void* source = nullptr);
+	void DealRangeDamage( float damage, Vec2 const& position, float range, FactionID sourceFaction = FACTION_ID_DEFAULT, bool dealOnce = false, float coolDownTime = 0.f, void* source = nullptr);
 
 	void PickUpItem( Vec2 const& pos );
 	void TransferItemToMaxHealth( Vec2 const& pos );
@@ -116,13 +117,21 @@ public:
 
 	void GoToNextFloor();
 
-	void SetTimeScaleOfAllEntity( std::string const& friendlyFaction, float newTimeScale );
+	/// Set the time scale of every entity hostile to the faction
+	void SetTimeScaleOfAllEntity( FactionID friendlyFaction, float newTimeScale );
 
 	void RerandomizeAllItemsInRoom( bool onlyShop = false);
 
 	void GenerateNewShopToLevel( int levelOfShop = 1 );
 
 	void GetAllEntityByDef( std::vector<Entity*>& out_entityArray, EntityDefinition const& def ) const;
+
+	// console command: CollisionBenchmark projectiles=5000 frames=60
+	// fills the current room with hostile bullets away from every entity and times the collision pass with and without the grid,
+	// then how long the projectile pool takes to spawn and update them
+	static bool Event_CollisionBenchmark( EventArgs& args );
+
+	bool m_useCollisionGrid = true;
 private:
 	void HandleKeys();
 	void BeginGame();
@@ -134,10 +143,12 @@ private:
 	void RenderAllGameObjects() const;
 	void RenderItemsInRoom() const;
 	void DebugRenderAllGameObjects() const;
-	void AddProjectileToGame( Projectile* projectile );
 	void RenderUI() const;
 
 	void UpdateCollisions();
+	void BuildCollisionGrids();
+	/// Array indexes of the entities that may be within range, in array order, every index when the entity grid is out of date
+	void GetEntitiesInRange( Vec2 const& position, float range, std::vector<int>& out_entityIndexes ) const;
 	void CollideTwoEntities( Entity* a, Entity* b );
 	void CollideEntityAndProjectile( Entity* entity, Projectile* projectile );
 
@@ -185,6 +196,20 @@ private:
 	int m_curHoveringButtom = 0;
 	int m_numOfButtons = 4;
 	int m_bossKilledThisFloor = 0;
+
+	// broadphase of UpdateCollisions, rebuilt every frame over the current room
+	// grid items are indexes into m_gridEntityIndexes and m_gridProjectileIndexes, which hold ascending entity indexes and projectile slots,
+	// so candidates come out in the same order as a scan over m_entityArray or the projectile pool
+	UniformGrid2D m_entityGrid;
+	UniformGrid2D m_projectileGrid;
+	std::vector<int> m_gridEntityIndexes;
+	std::vector<int> m_gridProjectileIndexes;
+	std::vector<AABB2> m_gridItemBounds;
+	std::vector<int> m_gridCandidates;
+	// reused by DealRangeDamage so it does not allocate a list per call
+	std::vector<int> m_rangeDamageEntityIndexes;
+	// range damage only uses the entity grid while UpdateCollisions runs, entities move and spawn at any other time
+	bool m_isEntityGridValid = false;
 };
 
 
@@ -239,6 +239,54 @@ Vec2 Starship_GetRandomPosInCapsule( Vec2 const& startPos, Vec2 const& endPos, f
 	return GetRandomPointInDisc2D( radius, refPos );
 }
 
+FactionMask g_hostileFactionMasks[MAX_NUM_OF_FACTIONS] = {
+	GetFactionMask( FACTION_ID_DEFAULT ) | GetFactionMask( FACTION_ID_PLAYER ),
+	GetFactionMask( FACTION_ID_NONE ) | GetFactionMask( FACTION_ID_PLAYER ),
+	GetFactionMask( FACTION_ID_NONE ) | GetFactionMask( FACTION_ID_DEFAULT ) };
+
+static std::vector<std::string>& GetFactionNames()
+{
+	static std::vector<std::string> factionNames = { "", "Default", "Player" };
+	return factionNames;
+}
+
+FactionID GetFactionIDByName( std::string const& factionName )
+{
+	std::vector<std::string>& factionNames = GetFactionNames();
+	for (int i = 0; i < (int)factionNames.size(); i++) {
+		if (factionNames[i] == factionName) {
+			return (FactionID)i;
+		}
+	}
+	GUARANTEE_OR_DIE( (int)factionNames.size() < MAX_NUM_OF_FACTIONS, "Too many factions for the faction masks" );
+	FactionID factionID = (FactionID)factionNames.size();
+	factionNames.push_back( factionName );
+	// the new faction against every faction before it
+	for (int i = 0; i < (int)factionID; i++) {
+		g_hostileFactionMasks[i] |= GetFactionMask( factionID );
+		g_hostileFactionMasks[factionID] |= GetFactionMask( (FactionID)i );
+	}
+	return factionID;
+}
+
+bool DoFactionMasksMatchNames()
+{
+	std::vector<std::string> const& factionNames = GetFactionNames();
+	for (int a = 0; a < (int)factionNames.size(); a++) {
+		for (int b = 0; b < (int)factionNames.size(); b++) {
+			if (IsFactionHostile( (FactionID)a, (FactionID)b ) != (factionNames[a] != factionNames[b])) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+std::string const& GetFactionName( FactionID factionID )
+{
+	return GetFactionNames()[factionID];
+}
+
 Clock* GetGameClock()
 {
 	return g_theGame->m_gameClock;
@@ -76,6 +76,25 @@ Vec2 Starship_GetRandomPosInCapsule( Vec2 const& startPos, Vec2 const& endPos, f
 Clock* GetGameClock();
 RandomNumberGenerator* GetRandGen();
 
+// factions are compared as small integers, a name gets its id the first time it is looked up
+// id 0 is the empty name, the faction of a projectile nobody set one for, id 1 is "Default", the faction of entities without one, id 2 is "Player"
+typedef unsigned char FactionID;
+typedef uint64_t FactionMask;
+constexpr FactionID FACTION_ID_NONE = 0;
+constexpr FactionID FACTION_ID_DEFAULT = 1;
+constexpr FactionID FACTION_ID_PLAYER = 2;
+constexpr int MAX_NUM_OF_FACTIONS = 64;
+FactionID GetFactionIDByName( std::string const& factionName );
+std::string const& GetFactionName( FactionID factionID );
+
+// bit b of g_hostileFactionMasks[a] is set when faction a fights faction b, filled in when a faction gets its id
+// every faction is hostile to every other faction and friendly to itself
+extern FactionMask g_hostileFactionMasks[MAX_NUM_OF_FACTIONS];
+/// Whether the masks give the same answer as comparing the names for every pair of factions with an id
+bool DoFactionMasksMatchNames();
+constexpr FactionMask GetFactionMask( FactionID factionID ) { return (FactionMask)1 << factionID; }
+inline bool IsFactionHostile( FactionID faction, FactionID otherFaction ) { return (g_hostileFactionMasks[faction] & GetFactionMask( otherFaction )) != 0; }
+
 enum class RoomDirection {
 	UP,
 	DOWN,
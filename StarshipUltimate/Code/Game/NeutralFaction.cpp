@@ -738,7 +738,7 @@ void BossMercyKiller::Update( float deltaTime )
 			for (int i = 0; i < 8; i++) {
 				float rndAngle = GetRandGen()->RollRandomFloatInRange( -5.f, 5.f );
 				Projectile* projectile = g_theGame->SpawnProjectileToGame( *m_obsidianDef, m_position, shootOrientation + rndAngle, Vec2::MakeFromPolarDegrees( shootOrientation + rndAngle, m_obsidianDef->m_speed ) );
-				projectile->m_faction = m_def.m_faction;
+				projectile->SetFaction( m_def.m_factionID );
 			}
 		}
 	}
@@ -798,7 +798,7 @@ void BossMercyKiller::Update( float deltaTime )
 				for (int i = 0; i < 3; i++) {
 					float rndAngle = GetRandGen()->RollRandomFloatInRange( -5.f, 5.f );
 					Projectile* projectile = g_theGame->SpawnProjectileToGame( *m_obsidianDef, m_position, shootOrientation + rndAngle, Vec2::MakeFromPolarDegrees( shootOrientation + rndAngle, m_obsidianDef->m_speed ) );
-					projectile->m_faction = m_def.m_faction;
+					projectile->SetFaction( m_def.m_factionID );
 				}
 			}
 		}
@@ -50,7 +50,7 @@ void PlayerAsteroid::Update( float deltaTime )
 	m_position = m_owner->m_position + Vec2::MakeFromPolarDegrees( m_oritationToOwner, m_owner->m_cosmeticRadius * 6.f );
 
 	for (auto entity : g_theGame->m_entityArray) {
-		if (entity && entity->m_def.m_faction != m_def.m_faction && DoDiscsOverlap( m_position, m_physicsRadius, entity->m_position, entity->m_physicsRadius )) {
+		if (entity && IsFactionHostile( m_def.m_factionID, entity->m_def.m_factionID ) && DoDiscsOverlap( m_position, m_physicsRadius, entity->m_position, entity->m_physicsRadius )) {
 			entity->BeAttackedOnce( 1.f, Vec2(), 0.04f, this );
 		}
 	}
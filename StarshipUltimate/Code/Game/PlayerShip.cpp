@@ -141,7 +141,7 @@ void PlayerShip::Update( float deltaTime )
 
 	if (m_timeStopTimer->HasPeriodElapsed()) {
 		m_timeStopTimer->Stop();
-		g_theGame->SetTimeScaleOfAllEntity( m_def.m_faction, 1.f );
+		g_theGame->SetTimeScaleOfAllEntity( m_def.m_factionID, 1.f );
 	}
 
 	if (m_subWeaponShieldDashOn) {
@@ -622,7 +622,7 @@ void PlayerShip::PerformSkill()
 	else if (m_timeStop) {
 		if (def.CanBeUsed()) {
 			def.AddCharge( -1 );
-			g_theGame->SetTimeScaleOfAllEntity( m_def.m_faction, 0.f );
+			g_theGame->SetTimeScaleOfAllEntity( m_def.m_factionID, 0.f );
 			m_timeStopTimer->Start();
 		}
 	}
@@ -644,7 +644,7 @@ void PlayerShip::PerformSkill()
 			((PlayerController*)m_controller)->m_reward -= 10;
 			L1:
 			SunFlame* sf = (SunFlame*)g_theGame->SpawnEffectToGame( EffectType::SunFlame, m_position );
-			sf->m_faction = m_def.m_faction;
+			sf->m_faction = m_def.m_factionID;
 			sf->m_dist = 300.f;
 			sf->m_damage = 3.f;
 		}
@@ -653,7 +653,7 @@ void PlayerShip::PerformSkill()
 		if (def.CanBeUsed()) {
 			def.AddCharge( -1 );
 			m_position = g_theGame->m_worldCamera.GetCursorWorldPosition( g_window->GetNormalizedCursorPos() );
-			g_theGame->DealRangeDamage( 5.f * GetMainWeaponDamage(), m_position, m_cosmeticRadius * 5.f, m_def.m_faction );
+			g_theGame->DealRangeDamage( 5.f * GetMainWeaponDamage(), m_position, m_cosmeticRadius * 5.f, m_def.m_factionID );
 			StartRespawnParticle();
 		}
 	}
@@ -718,7 +718,7 @@ void PlayerShip::FireSubWeapon()
 			mine->BeginPlay();
 		}
 		else if (m_subWeaponCoinGun && ((PlayerController*)m_controller)->m_reward >= 1) {
-			CoinBullet* coin = (CoinBullet*)m_subWeaponCoinGunPtr->Fire( GetForwardNormal(), m_position );
+			Projectile* coin = m_subWeaponCoinGunPtr->Fire( GetForwardNormal(), m_position );
 			coin->m_damage = GetMainWeaponDamage() * 5.f;
 			m_subWeaponCoolDownTimer->Start();
 			((PlayerController*)m_controller)->m_reward -= 1;
@@ -1002,8 +1002,8 @@ void PlayerShip::SetBulletAttributes( Projectile* proj )
 		if (m_bulletAddDamageByLifeTime) {
 			proj->m_addDamageByLifeTime = true;
 		}
-		proj->m_velocity *= (1.f + m_bulletSpeedModifier);
-		proj->m_lifeTimer->SetPeriodSeconds( proj->m_lifeTimer->GetPeriodSeconds() * GetClamped( (1.f + m_bulletLifeTimeModifier), 0.1f, 100.f ) );
+		proj->SetVelocity( proj->GetVelocity() * (1.f + m_bulletSpeedModifier) );
+		proj->SetLifeSeconds( proj->GetLifeSeconds() * GetClamped( (1.f + m_bulletLifeTimeModifier), 0.1f, 100.f ) );
 	}
 }
 
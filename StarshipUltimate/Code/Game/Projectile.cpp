@@ -4,135 +4,6 @@
 
 std::vector<ProjectileDefinition> ProjectileDefinition::s_definitions;
 
-Projectile::Projectile( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	: m_position( startPos )
-	, m_def( def )
-	, m_orientationDegrees( startOrientation )
-	, m_velocity( startVelocity )
-{
-	m_lifeTimer = new Timer( m_def.m_lifeSeconds, g_theGame->m_gameClock );
-	m_lifeTimer->Start();
-	m_rangeDamageRadius = m_def.m_damageRange;
-	m_rangeDamagePercentage = m_def.m_damageModifier;
-	m_damage *= m_def.m_damageModifier;
-	if (m_rangeDamageRadius > 0.f) {
-		m_hasRangeDamage = true;
-	}
-}
-
-Projectile::~Projectile()
-{
-	delete m_lifeTimer;
-	m_lifeTimer = nullptr;
-}
-
-void Projectile::Update( float deltaTime )
-{
-	UNUSED( deltaTime );
-	if (m_isDead) {
-		m_isGarbage = true;
-		return;
-	}
-
-	if (m_addDamageByLifeTime) {
-		m_damage += deltaTime;
-	}
-
-	if (m_lifeTimer->HasPeriodElapsed()) {
-		Die( false );
-	}
-}
-
-void Projectile::SpawnCollisionEffect()
-{
-
-}
-
-void Projectile::DebugRender() const
-{
-	DebugDrawLine( m_position, m_orientationDegrees, m_cosmeticRadius, 0.2f, Rgba8( 255, 0, 0, 255 ) );
-	DebugDrawLine( m_position, m_orientationDegrees + 90.f, m_cosmeticRadius, 0.2f, Rgba8( 0, 255, 0, 255 ) );
-	DebugDrawRing( m_position, m_cosmeticRadius, 0.2f, Rgba8( 255, 0, 255, 255 ) );
-	DebugDrawRing( m_position, m_physicsRadius, 0.2f, Rgba8( 0, 255, 255, 255 ) );
-	DebugDrawLine( m_position, Atan2Degrees( m_velocity.y, m_velocity.x ), m_velocity.GetLength(), 0.2f, Rgba8( 255, 255, 0, 255 ) );
-}
-
-Vec2 Projectile::GetForwardNormal() const
-{
-	return Vec2::MakeFromPolarDegrees( m_orientationDegrees );
-}
-
-bool Projectile::IsAlive() const
-{
-	return !m_isDead;
-}
-
-Mat44 Projectile::GetModelMatrix() const
-{
-	Mat44 translationMat = Mat44::CreateTranslation2D( m_position );
-	translationMat.Append( Mat44::CreateZRotationDegrees( m_orientationDegrees ) );
-	return translationMat;
-}
-
-Shuriken::Shuriken( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile( def, startPos, startOrientation, startVelocity )
-{
-	m_physicsRadius = 0.3f;
-	m_cosmeticRadius = 0.5f;
-	m_damage = 1.f;
-}
-
-Shuriken::~Shuriken()
-{
-
-}
-
-void Shuriken::BeginPlay()
-{
-
-}
-
-void Shuriken::Update( float deltaTime )
-{
-	Projectile::Update( deltaTime );
-	if (g_theGame->m_worldCamera.m_cameraBox.IsPointInside( m_position )) {
-		m_position += m_velocity * deltaTime;
-		m_orientationDegrees += 360.f * deltaTime;
-	}
-}
-
-void Shuriken::Render() const
-{
-	Rgba8 bladeColor = Rgba8( 96, 96, 96 );
-	float sideLength = 0.6f;
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 100 );
-	verts.emplace_back( Vec2( sideLength, sideLength ), bladeColor );
-	verts.emplace_back( Vec2( sideLength, -sideLength ), bladeColor );
-	verts.emplace_back( Vec2( sideLength * 3.f, 0.f ), bladeColor );
-	verts.emplace_back( Vec2( sideLength, sideLength ), bladeColor );
-	verts.emplace_back( Vec2( 0.f, sideLength * 3.f ), bladeColor );
-	verts.emplace_back( Vec2( -sideLength, sideLength ), bladeColor );
-	verts.emplace_back( Vec2( -sideLength, sideLength ), bladeColor );
-	verts.emplace_back( Vec2( -sideLength * 3.f, 0.f ), bladeColor );
-	verts.emplace_back( Vec2( -sideLength, -sideLength ), bladeColor );
-	verts.emplace_back( Vec2( -sideLength, -sideLength ), bladeColor );
-	verts.emplace_back( Vec2( 0.f, -sideLength * 3.f ), bladeColor );
-	verts.emplace_back( Vec2( sideLength, -sideLength ), bladeColor );
-	AddVertsForDisc2D( verts, Vec2( 0.f, 0.f ), 0.8f, Rgba8( 192, 192, 192 ) );
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
-}
-
-void Shuriken::Die( bool dieByCollision /*= true */ )
-{
-	UNUSED( dieByCollision );
-	m_isDead = true;
-}
-
 ProjectileDefinition::ProjectileDefinition()
 {
 
@@ -146,7 +17,42 @@ ProjectileDefinition::ProjectileDefinition( XmlElement* xmlIter )
 	m_damageModifier = ParseXmlAttribute( *xmlIter, "damageModifier", m_damageModifier );
 	m_damageRange = ParseXmlAttribute( *xmlIter, "damageRange", m_damageRange );
 	m_rangeDamageModifier = ParseXmlAttribute( *xmlIter, "rangeDamageModifier", m_rangeDamageModifier );
-
+	m_type = GetTypeByName( m_name );
+	switch (m_type) {
+	case ProjectileType::Shuriken:
+		m_physicsRadius = 0.3f;
+		m_cosmeticRadius = 0.5f;
+		break;
+	case ProjectileType::Rocket:
+		m_physicsRadius = 2.f;
+		m_cosmeticRadius = 3.f;
+		break;
+	case ProjectileType::DemonBullet:
+		m_physicsRadius = 1.6f;
+		m_cosmeticRadius = 1.5f;
+		break;
+	case ProjectileType::EnemyBullet:
+		m_physicsRadius = 1.6f;
+		m_cosmeticRadius = 1.3f;
+		break;
+	case ProjectileType::CurveMissile:
+		m_physicsRadius = 0.5f;
+		m_cosmeticRadius = 0.6f;
+		break;
+	case ProjectileType::CoinBullet:
+		m_physicsRadius = 0.8f;
+		m_cosmeticRadius = 0.6f;
+		break;
+	case ProjectileType::SharpenedObsidian:
+	case ProjectileType::Arrow:
+		m_physicsRadius = 0.3f;
+		m_cosmeticRadius = 0.8f;
+		break;
+	default:
+		break;
+	}
+	m_physicsRadius = ParseXmlAttribute( *xmlIter, "physicsRadius", m_physicsRadius );
+	m_cosmeticRadius = ParseXmlAttribute( *xmlIter, "cosmeticRadius", m_cosmeticRadius );
 }
 
 void ProjectileDefinition::SetUpProjectileDefinitions()
@@ -175,147 +81,246 @@ ProjectileDefinition const& ProjectileDefinition::GetDefinition( std::string con
 	ERROR_AND_DIE( Stringf( "No Such Projectile Definition %s", name.c_str() ) );
 }
 
-Rocket::Rocket( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile(def, startPos, startOrientation, startVelocity)
+ProjectileType ProjectileDefinition::GetTypeByName( std::string const& name )
 {
-	m_cosmeticRadius = 3.f;
-	m_physicsRadius = 2.f;
+	if (name == "Bullet") {
+		return ProjectileType::PlayerBullet;
+	}
+	else if (name == "Shuriken") {
+		return ProjectileType::Shuriken;
+	}
+	else if (name == "Rocket") {
+		return ProjectileType::Rocket;
+	}
+	else if (name == "DemonBullet") {
+		return ProjectileType::DemonBullet;
+	}
+	else if (name == "EnemyBullet") {
+		return ProjectileType::EnemyBullet;
+	}
+	else if (name == "CurveMissile") {
+		return ProjectileType::CurveMissile;
+	}
+	else if (name == "CoinBullet") {
+		return ProjectileType::CoinBullet;
+	}
+	else if (name == "SharpenedObsidian") {
+		return ProjectileType::SharpenedObsidian;
+	}
+	else if (name == "Arrow") {
+		return ProjectileType::Arrow;
+	}
+	ERROR_AND_DIE( Stringf( "No such projectile name %s", name.c_str() ) );
 }
 
-Rocket::~Rocket()
+Projectile::Projectile()
 {
 
 }
 
-void Rocket::BeginPlay()
+void Projectile::BeginPlay()
 {
-	m_rangeDamageRadius = m_def.m_damageRange;
-	m_rangeDamagePercentage = m_def.m_damageModifier;
-	m_damage *= m_def.m_damageModifier;
-	if (m_rangeDamageRadius > 0.f) {
-		m_hasRangeDamage = true;
+	if (GetType() == ProjectileType::Rocket) {
+		m_rangeDamageRadius = m_def->m_damageRange;
+		m_rangeDamagePercentage = m_def->m_damageModifier;
+		m_damage *= m_def->m_damageModifier;
+		if (m_rangeDamageRadius > 0.f) {
+			m_hasRangeDamage = true;
+		}
+	}
+	else if (GetType() == ProjectileType::CurveMissile) {
+		Vec2 const& position = GetPosition();
+		m_curve.m_startPos = position;
+		m_curve.m_endPos = m_targetPosition;
+		float distance = GetDistance2D( m_targetPosition, position );
+		Vec2 middlePos = (position + m_targetPosition) * 0.5f;
+
+		Vec2 sideVec = (m_targetPosition - position).GetNormalized();
+		if (m_goUp) {
+			sideVec.Rotate90Degrees();
+		}
+		else {
+			sideVec.RotateMinus90Degrees();
+		}
+		m_curve.m_guidePos1 = middlePos + sideVec * distance * 0.3f;
+		m_curve.m_guidePos2 = m_curve.m_guidePos1;
 	}
 }
 
-void Rocket::Update( float deltaTime )
+void Projectile::Die( bool dieByCollision /*= true */ )
 {
-	Projectile::Update( deltaTime );
-	m_position += m_velocity * deltaTime;
+	UNUSED( dieByCollision );
+	if (!IsAlive()) {
+		return;
+	}
+	m_pool->m_states[m_slot] = ProjectilePool::SlotState::DEAD;
+	--m_pool->m_numOfAliveProjectiles;
+
+	if (GetType() == ProjectileType::CurveMissile) {
+		Vec2 const& position = GetPosition();
+		ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( position, position ),
+			FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
+			AABB2( Vec2( -10.f, -10.f ), Vec2( 10.f, 10.f ) ),
+			FloatRange( 0.2f, 0.4f ), Rgba8( 255, 178, 102 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+			FloatRange( 40.f, 75.f ), nullptr,
+			Rgba8( 255, 178, 102, 0 ) );
+	}
 }
 
-void Rocket::Render() const
+void Projectile::SpawnCollisionEffect()
 {
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 100 );
-	AddVertsForCapsule2D( verts, Vec2( -1.f, 0.f ), Vec2( 2.f, 0.f ), 0.5f, Rgba8( 102, 178, 255 ) );
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
+	Vec2 const& position = GetPosition();
+	switch (GetType()) {
+	case ProjectileType::PlayerBullet: {
+		Rgba8 color1, color2;
+		if (m_isPoisonous) {
+			color1 = Rgba8( 0, 255, 0, 150 );
+			color2 = Rgba8( 0, 255, 0, 0 );
+		}
+		else {
+			color1 = Rgba8( 0, 0, 255, 150 );
+			color2 = Rgba8( 0, 0, 255, 0 );
+		}
+		if (m_hasRangeDamage) {
+			ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( position, position ),
+				FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
+				AABB2( Vec2( -30.f, -30.f ), Vec2( 30.f, 30.f ) ),
+				FloatRange( 0.2f, 0.4f ), color1, Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+				FloatRange( 40.f, 75.f ), nullptr,
+				color2 );
+		}
+		else {
+			Vec2 const& velocity = GetVelocity();
+			ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( position, position ),
+				FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
+				AABB2( Vec2( -20.f, -20.f ) - velocity, Vec2( 20.f, 20.f ) - velocity ),
+				FloatRange( 0.2f, 0.4f ), color1, Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+				FloatRange( 40.f, 75.f ), nullptr,
+				color2 );
+		}
+		break;
+	}
+	case ProjectileType::Rocket:
+		ParticleSystem2DAddEmitter( 400, 0.05f, AABB2( position - Vec2( m_cosmeticRadius, m_cosmeticRadius ), position + Vec2( m_cosmeticRadius, m_cosmeticRadius ) ),
+			FloatRange( m_cosmeticRadius * 0.2f, m_cosmeticRadius * 0.5f ),
+			AABB2( Vec2( 0.f, 20.f ), -GetForwardNormal() * 15.f + Vec2( 0.f, 20.f ) ),
+			FloatRange( 0.6f, 1.f ), Rgba8( 0, 0, 255, 150 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+			FloatRange( 40.f, 75.f ), nullptr,
+			Rgba8( 0, 0, 255, 0 ), 60.f, 0.f );
+		break;
+	case ProjectileType::DemonBullet:
+		ParticleSystem2DAddEmitter( 400, 0.05f, AABB2( position - Vec2( m_cosmeticRadius, m_cosmeticRadius ), position + Vec2( m_cosmeticRadius, m_cosmeticRadius ) ),
+			FloatRange( m_cosmeticRadius * 0.2f, m_cosmeticRadius * 0.5f ),
+			AABB2( Vec2( 0.f, 20.f ), -GetForwardNormal() * 15.f + Vec2( 0.f, 20.f ) ),
+			FloatRange( 0.6f, 1.f ), Rgba8( 204, 0, 0, 150 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+			FloatRange( 40.f, 75.f ), nullptr,
+			Rgba8( 204, 0, 0, 0 ), 60.f, 0.f );
+		break;
+	case ProjectileType::CoinBullet: {
+		ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( position, position ),
+			FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
+			AABB2( Vec2( -10.f, -10.f ), Vec2( 10.f, 10.f ) ),
+			FloatRange( 0.2f, 0.4f ), Rgba8( 255, 178, 102 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
+			FloatRange( 40.f, 75.f ), nullptr,
+			Rgba8( 255, 178, 102, 0 ) );
+
+		// return money
+		float rnd = GetRandGen()->RollRandomFloatZeroToOne();
+		if (rnd < 0.8f) {
+			g_theGame->SpawnEffectToGame( EffectType::Reward, position );
+		}
+		else {
+			g_theGame->SpawnEffectToGame( EffectType::Reward, position );
+			g_theGame->SpawnEffectToGame( EffectType::Reward, position );
+		}
+		break;
+	}
+	default:
+		break;
+	}
 }
 
-void Rocket::Die( bool dieByCollision /*= true */ )
+void Projectile::DebugRender() const
 {
-	UNUSED( dieByCollision );
-	m_isDead = true;
+	Vec2 const& position = GetPosition();
+	Vec2 const& velocity = GetVelocity();
+	float orientationDegrees = GetOrientationDegrees();
+	DebugDrawLine( position, orientationDegrees, m_cosmeticRadius, 0.2f, Rgba8( 255, 0, 0, 255 ) );
+	DebugDrawLine( position, orientationDegrees + 90.f, m_cosmeticRadius, 0.2f, Rgba8( 0, 255, 0, 255 ) );
+	DebugDrawRing( position, m_cosmeticRadius, 0.2f, Rgba8( 255, 0, 255, 255 ) );
+	DebugDrawRing( position, m_physicsRadius, 0.2f, Rgba8( 0, 255, 255, 255 ) );
+	DebugDrawLine( position, Atan2Degrees( velocity.y, velocity.x ), velocity.GetLength(), 0.2f, Rgba8( 255, 255, 0, 255 ) );
 }
 
-void Rocket::SpawnCollisionEffect()
+Vec2 Projectile::GetForwardNormal() const
 {
-	ParticleSystem2DAddEmitter( 400, 0.05f, AABB2( m_position - Vec2(m_cosmeticRadius, m_cosmeticRadius), m_position + Vec2( m_cosmeticRadius, m_cosmeticRadius ) ),
-		FloatRange( m_cosmeticRadius * 0.2f, m_cosmeticRadius * 0.5f ),
-		AABB2( Vec2( 0.f, 20.f ), -Vec2::MakeFromPolarDegrees( m_orientationDegrees ) * 15.f + Vec2( 0.f, 20.f ) ),
-		FloatRange( 0.6f, 1.f ), Rgba8( 0, 0, 255, 150 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
-		FloatRange( 40.f, 75.f ), nullptr,
-		Rgba8( 0, 0, 255, 0 ), 60.f, 0.f );
+	return Vec2::MakeFromPolarDegrees( GetOrientationDegrees() );
 }
 
-DemonBullet::DemonBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile(def, startPos, startOrientation, startVelocity)
+bool Projectile::IsAlive() const
 {
-	m_cosmeticRadius = 1.5f;
-	m_physicsRadius = 1.6f;
+	return m_pool->m_states[m_slot] == ProjectilePool::SlotState::ALIVE;
 }
 
-DemonBullet::~DemonBullet()
+ProjectileType Projectile::GetType() const
 {
-
+	return m_pool->m_types[m_slot];
 }
 
-void DemonBullet::BeginPlay()
+Vec2 const& Projectile::GetPosition() const
 {
-
+	return m_pool->m_positions[m_slot];
 }
 
-void DemonBullet::Update( float deltaTime )
+void Projectile::SetPosition( Vec2 const& position )
 {
-	Projectile::Update( deltaTime );
-	m_position += m_velocity * deltaTime;
+	m_pool->m_positions[m_slot] = position;
 }
 
-void DemonBullet::Render() const
+Vec2 const& Projectile::GetVelocity() const
 {
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 100 );
-	AddVertsForDisc2D( verts, Vec2(), m_cosmeticRadius, Rgba8(204, 0, 0));
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
+	return m_pool->m_velocities[m_slot];
 }
 
-void DemonBullet::Die( bool dieByCollision /*= true */ )
+void Projectile::SetVelocity( Vec2 const& velocity )
 {
-	UNUSED( dieByCollision );
-	m_isDead = true;
+	m_pool->m_velocities[m_slot] = velocity;
 }
 
-void DemonBullet::SpawnCollisionEffect()
+float Projectile::GetOrientationDegrees() const
 {
-	ParticleSystem2DAddEmitter( 400, 0.05f, AABB2( m_position - Vec2( m_cosmeticRadius, m_cosmeticRadius ), m_position + Vec2( m_cosmeticRadius, m_cosmeticRadius ) ),
-		FloatRange( m_cosmeticRadius * 0.2f, m_cosmeticRadius * 0.5f ),
-		AABB2( Vec2( 0.f, 20.f ), -Vec2::MakeFromPolarDegrees( m_orientationDegrees ) * 15.f + Vec2( 0.f, 20.f ) ),
-		FloatRange( 0.6f, 1.f ), Rgba8( 204, 0, 0, 150 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
-		FloatRange( 40.f, 75.f ), nullptr,
-		Rgba8( 204, 0, 0, 0 ), 60.f, 0.f );
+	return m_pool->m_orientationDegrees[m_slot];
 }
 
-EnemyBullet::EnemyBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile(def, startPos, startOrientation, startVelocity)
+float Projectile::GetLifeSeconds() const
 {
-	m_cosmeticRadius = 1.3f;
-	m_physicsRadius = 1.6f;
+	return m_pool->m_lifeSeconds[m_slot];
 }
 
-EnemyBullet::~EnemyBullet()
+void Projectile::SetLifeSeconds( float lifeSeconds )
 {
-
+	m_pool->m_lifeSeconds[m_slot] = lifeSeconds;
 }
 
-void EnemyBullet::BeginPlay()
+FactionID Projectile::GetFaction() const
 {
-
+	return m_pool->m_factions[m_slot];
 }
 
-void EnemyBullet::Update( float deltaTime )
+void Projectile::SetFaction( FactionID faction )
 {
-	Projectile::Update( deltaTime );
-	m_position += m_velocity * deltaTime;
+	m_pool->m_factions[m_slot] = faction;
 }
 
-void EnemyBullet::Render() const
+static void AddVertsForGlowingBullet( std::vector<Vertex_PCU>& verts, float cosmeticRadius, Rgba8 const& glowColor, Rgba8 const& coreColor )
 {
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 300 );
 	constexpr int NUM_SIDES = 20;
 	constexpr float DEGREES_PER_SIDE = 360.f / (float)NUM_SIDES;
 	constexpr float RADIANS_PER_SIDE = DEGREES_PER_SIDE * PI / 180.f;
-	float radius = m_cosmeticRadius * 0.7f;
-	float thickness = m_cosmeticRadius * 0.6f;
-	Rgba8 outerColor = Rgba8( 255, 102, 102, 100 );
-	Rgba8 innerColor = Rgba8( 255, 102, 102 );
+	float radius = cosmeticRadius * 0.7f;
+	float thickness = cosmeticRadius * 0.6f;
+	Rgba8 outerColor = Rgba8( glowColor.r, glowColor.g, glowColor.b, 100 );
+	Rgba8 innerColor = glowColor;
 	for (int i = 0; i < NUM_SIDES; i++) {
 		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * radius, SinRadians( RADIANS_PER_SIDE * i ) * radius ), innerColor );
 		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * i ) * (radius + thickness) ), outerColor );
@@ -324,294 +329,326 @@ void EnemyBullet::Render() const
 		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * i ) * (radius + thickness) ), outerColor );
 		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * (radius + thickness) ), outerColor );
 	}
-
-	AddVertsForDisc2D( verts, Vec2(), m_cosmeticRadius * 0.7f, Rgba8( 255, 255, 255 ) );
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
-}
-
-void EnemyBullet::Die( bool dieByCollision /*= true */ )
-{
-	UNUSED( dieByCollision );
-	m_isDead = true;
-}
-
-void EnemyBullet::SpawnCollisionEffect()
-{
-
+	AddVertsForDisc2D( verts, Vec2(), cosmeticRadius * 0.7f, coreColor );
 }
 
-CurveMissile::CurveMissile( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile(def, startPos, startOrientation, startVelocity)
+static void AddVertsForPlayerBullet( std::vector<Vertex_PCU>& verts, Rgba8 const& color1, Rgba8 const& color2, Rgba8 const& color3 )
 {
-	m_physicsRadius = 0.5f;
-	m_cosmeticRadius = 0.6f;
+	verts.emplace_back( Vec2( 1.f, 0.f ), color1 );
+	verts.emplace_back( Vec2( 0.f, 0.5f ), color1 );
+	verts.emplace_back( Vec2( 0.f, -0.5f ), color1 );
+	verts.emplace_back( Vec2( 0.f, -0.5f ), color2 );
+	verts.emplace_back( Vec2( 0.f, 0.5f ), color2 );
+	verts.emplace_back( Vec2( -2.f, 0.f ), color3 );
 }
 
-CurveMissile::~CurveMissile()
+static Rgba8 GetTintedColor( Rgba8 const& color, Rgba8 const& tint )
 {
-
+	return Rgba8( (unsigned char)((int)color.r * tint.r / 255), (unsigned char)((int)color.g * tint.g / 255),
+		(unsigned char)((int)color.b * tint.b / 255), (unsigned char)((int)color.a * tint.a / 255) );
 }
 
-void CurveMissile::BeginPlay()
+ProjectilePool::ProjectilePool()
 {
-	m_curve.m_startPos = m_position;
-	m_curve.m_endPos = m_targetPosition;
-	float distance = GetDistance2D( m_targetPosition, m_position );
-	Vec2 middlePos = (m_position + m_targetPosition) * 0.5f;
+	AddSlots( 1024 );
+	m_verts.reserve( 16384 );
 
-	Vec2 sideVec = (m_targetPosition - m_position).GetNormalized();
-	if (m_goUp) {
-		sideVec.Rotate90Degrees();
-	}
-	else {
-		sideVec.RotateMinus90Degrees();
-	}
-	m_curve.m_guidePos1 = middlePos + sideVec * distance * 0.3f;
-	m_curve.m_guidePos2 = m_curve.m_guidePos1;
-}
+	std::vector<Vertex_PCU>& playerBulletVerts = m_typeVerts[(int)ProjectileType::PlayerBullet];
+	AddVertsForPlayerBullet( playerBulletVerts, Rgba8( 0, 255, 255, 255 ), Rgba8( 0, 0, 255, 255 ), Rgba8( 0, 0, 255, 0 ) );
+	AddVertsForPlayerBullet( m_icedPlayerBulletVerts, Rgba8( 255, 255, 255, 255 ), Rgba8( 192, 192, 192, 255 ), Rgba8( 192, 192, 192, 0 ) );
 
-void CurveMissile::Update( float deltaTime )
-{
-	Projectile::Update( deltaTime );
-	m_distance += deltaTime * m_def.m_speed;
-	m_lastFramePos = m_position;
-	m_position = m_curve.EvaluateAtApproximateDistance( m_distance );
-	m_orientationDegrees = (m_position - m_lastFramePos).GetOrientationDegrees();
+	std::vector<Vertex_PCU>& shurikenVerts = m_typeVerts[(int)ProjectileType::Shuriken];
+	Rgba8 bladeColor = Rgba8( 96, 96, 96 );
+	float sideLength = 0.6f;
+	shurikenVerts.emplace_back( Vec2( sideLength, sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( sideLength, -sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( sideLength * 3.f, 0.f ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( sideLength, sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( 0.f, sideLength * 3.f ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( -sideLength, sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( -sideLength, sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( -sideLength * 3.f, 0.f ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( -sideLength, -sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( -sideLength, -sideLength ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( 0.f, -sideLength * 3.f ), bladeColor );
+	shurikenVerts.emplace_back( Vec2( sideLength, -sideLength ), bladeColor );
+	AddVertsForDisc2D( shurikenVerts, Vec2( 0.f, 0.f ), 0.8f, Rgba8( 192, 192, 192 ) );
 
-	if (Starship_IsVec2NearlyZero( m_position - m_targetPosition )) {
-		// die
-		Die();
-	}
-}
+	AddVertsForCapsule2D( m_typeVerts[(int)ProjectileType::Rocket], Vec2( -1.f, 0.f ), Vec2( 2.f, 0.f ), 0.5f, Rgba8( 102, 178, 255 ) );
+	AddVertsForDisc2D( m_typeVerts[(int)ProjectileType::DemonBullet], Vec2(), 1.f, Rgba8( 204, 0, 0 ) );
+	AddVertsForGlowingBullet( m_typeVerts[(int)ProjectileType::EnemyBullet], 1.f, Rgba8( 255, 102, 102 ), Rgba8( 255, 255, 255 ) );
 
-void CurveMissile::Render() const
-{
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 100 );
-	Starship_AddVertsForArch( verts, Vec2( -0.5f, 0.f ), Vec2( 0.5f, 0.f ), 0.5f, Rgba8( 255, 178, 102 ) );
-	verts.emplace_back( Vec2( -0.5f, 0.5f ), Rgba8( 255, 178, 102 ) );
-	verts.emplace_back( Vec2( -4.f, 0.f ), Rgba8( 255, 178, 102, 100 ) );
-	verts.emplace_back( Vec2( -0.5f, -0.5f ), Rgba8( 255, 178, 102 ) );
+	std::vector<Vertex_PCU>& missileVerts = m_typeVerts[(int)ProjectileType::CurveMissile];
+	Starship_AddVertsForArch( missileVerts, Vec2( -0.5f, 0.f ), Vec2( 0.5f, 0.f ), 0.5f, Rgba8( 255, 178, 102 ) );
+	missileVerts.emplace_back( Vec2( -0.5f, 0.5f ), Rgba8( 255, 178, 102 ) );
+	missileVerts.emplace_back( Vec2( -4.f, 0.f ), Rgba8( 255, 178, 102, 100 ) );
+	missileVerts.emplace_back( Vec2( -0.5f, -0.5f ), Rgba8( 255, 178, 102 ) );
 
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
-}
+	AddVertsForGlowingBullet( m_typeVerts[(int)ProjectileType::CoinBullet], 1.f, Rgba8( 255, 153, 51 ), Rgba8( 255, 255, 51 ) );
 
-void CurveMissile::Die( bool dieByCollision /*= true */ )
-{
-	UNUSED( dieByCollision );
-	m_isDead = true;
+	// sharpened obsidian jitters, its verts are rolled again every frame
 
-	ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( m_position, m_position ),
-		FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
-		AABB2( Vec2( -10.f, -10.f ), Vec2( 10.f, 10.f ) ),
-		FloatRange( 0.2f, 0.4f ), Rgba8( 255, 178, 102 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
-		FloatRange( 40.f, 75.f ), nullptr,
-		Rgba8( 255, 178, 102, 0 ) );
+	std::vector<Vertex_PCU>& arrowVerts = m_typeVerts[(int)ProjectileType::Arrow];
+	float arrowRadius = 0.8f;
+	AddVertsForAABB2D( arrowVerts, AABB2( Vec2( -3.f * arrowRadius, -0.5f * arrowRadius ), Vec2( 0.f, 0.5f * arrowRadius ) ), Rgba8( 102, 51, 0 ) );
+	arrowVerts.emplace_back( Vec2( 0.f, arrowRadius ), Rgba8( 224, 224, 224 ) );
+	arrowVerts.emplace_back( Vec2( 0.f, -arrowRadius ), Rgba8( 224, 224, 224 ) );
+	arrowVerts.emplace_back( Vec2( 0.5f * arrowRadius, 0.f ), Rgba8( 224, 224, 224 ) );
 }
 
-void CurveMissile::SpawnCollisionEffect()
+ProjectilePool::~ProjectilePool()
 {
-
+	delete m_vertexBuffer;
+	m_vertexBuffer = nullptr;
 }
 
-CoinBullet::CoinBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile( def, startPos, startOrientation, startVelocity )
+Projectile* ProjectilePool::SpawnProjectile( ProjectileDefinition const& def, Vec2 const& position, float orientationDegrees, Vec2 const& velocity )
 {
-	m_cosmeticRadius = 0.6f;
-	m_physicsRadius = 0.8f;
-}
-
-CoinBullet::~CoinBullet()
-{
-
+	if (m_numOfFreeSlots == 0) {
+		AddSlots( GetNumOfSlots() );
+	}
+	int slot = m_freeSlots[m_firstFreeSlot];
+	m_firstFreeSlot = (m_firstFreeSlot + 1) % (int)m_freeSlots.size();
+	--m_numOfFreeSlots;
+
+	m_positions[slot] = position;
+	m_velocities[slot] = velocity;
+	m_orientationDegrees[slot] = orientationDegrees;
+	m_ages[slot] = 0.f;
+	m_lifeSeconds[slot] = def.m_lifeSeconds;
+	m_factions[slot] = 0;
+	m_types[slot] = def.m_type;
+	m_states[slot] = SlotState::ALIVE;
+	++m_numOfAliveProjectiles;
+
+	Projectile& projectile = m_projectiles[slot];
+	projectile = Projectile();
+	projectile.m_pool = this;
+	projectile.m_slot = slot;
+	projectile.m_def = &def;
+	projectile.m_rangeDamageRadius = def.m_damageRange;
+	projectile.m_rangeDamagePercentage = def.m_damageModifier;
+	projectile.m_damage *= def.m_damageModifier;
+	if (projectile.m_rangeDamageRadius > 0.f) {
+		projectile.m_hasRangeDamage = true;
+	}
+	projectile.m_physicsRadius = def.m_physicsRadius;
+	projectile.m_cosmeticRadius = def.m_cosmeticRadius;
+	if (def.m_type == ProjectileType::Shuriken || def.m_type == ProjectileType::SharpenedObsidian || def.m_type == ProjectileType::Arrow) {
+		projectile.m_damage = 1.f;
+	}
+	return &projectile;
 }
 
-void CoinBullet::BeginPlay()
+void ProjectilePool::Update( float deltaSeconds )
 {
+	AABB2 const& cameraBox = g_theGame->m_worldCamera.m_cameraBox;
+	int numOfSlots = GetNumOfSlots();
+	for (int slot = 0; slot < numOfSlots; slot++) {
+		if (m_states[slot] == SlotState::DEAD) {
+			m_states[slot] = SlotState::GARBAGE;
+			continue;
+		}
+		if (m_states[slot] != SlotState::ALIVE) {
+			continue;
+		}
+		Projectile& projectile = m_projectiles[slot];
+		if (projectile.m_addDamageByLifeTime) {
+			projectile.m_damage += deltaSeconds;
+		}
+		m_ages[slot] += deltaSeconds;
+		if (m_ages[slot] >= m_lifeSeconds[slot]) {
+			projectile.Die( false );
+		}
 
+		Vec2& position = m_positions[slot];
+		Vec2& velocity = m_velocities[slot];
+		switch (m_types[slot]) {
+		case ProjectileType::PlayerBullet:
+			position += velocity * deltaSeconds;
+			if (!cameraBox.IsPointInside( position )) {
+				projectile.Die( false );
+			}
+			break;
+		case ProjectileType::Shuriken:
+			if (cameraBox.IsPointInside( position )) {
+				position += velocity * deltaSeconds;
+				m_orientationDegrees[slot] += 360.f * deltaSeconds;
+			}
+			break;
+		case ProjectileType::SharpenedObsidian:
+			if (cameraBox.IsPointInside( position )) {
+				position += velocity * deltaSeconds;
+			}
+			break;
+		case ProjectileType::Arrow:
+			if (cameraBox.IsPointInside( position )) {
+				velocity += Vec2( 0.f, -50.f ) * deltaSeconds;
+				m_orientationDegrees[slot] = velocity.GetOrientationDegrees();
+				position += velocity * deltaSeconds;
+			}
+			break;
+		case ProjectileType::CurveMissile: {
+			projectile.m_distance += deltaSeconds * projectile.m_def->m_speed;
+			Vec2 lastFramePos = position;
+			position = projectile.m_curve.EvaluateAtApproximateDistance( projectile.m_distance );
+			m_orientationDegrees[slot] = (position - lastFramePos).GetOrientationDegrees();
+			if (Starship_IsVec2NearlyZero( position - projectile.m_targetPosition )) {
+				projectile.Die();
+			}
+			break;
+		}
+		default:
+			position += velocity * deltaSeconds;
+			break;
+		}
+	}
 }
 
-void CoinBullet::Update( float deltaTime )
+void ProjectilePool::RemoveGarbageProjectiles()
 {
-	Projectile::Update( deltaTime );
-	m_position += m_velocity * deltaTime;
+	int numOfSlots = GetNumOfSlots();
+	for (int slot = 0; slot < numOfSlots; slot++) {
+		if (m_states[slot] == SlotState::GARBAGE) {
+			m_states[slot] = SlotState::FREE;
+			m_freeSlots[(m_firstFreeSlot + m_numOfFreeSlots) % numOfSlots] = slot;
+			++m_numOfFreeSlots;
+		}
+	}
 }
 
-void CoinBullet::Render() const
+void ProjectilePool::Render() const
 {
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 300 );
-	constexpr int NUM_SIDES = 20;
-	constexpr float DEGREES_PER_SIDE = 360.f / (float)NUM_SIDES;
-	constexpr float RADIANS_PER_SIDE = DEGREES_PER_SIDE * PI / 180.f;
-	float radius = m_cosmeticRadius * 0.7f;
-	float thickness = m_cosmeticRadius * 0.6f;
-	Rgba8 outerColor = Rgba8( 255, 153, 51, 100 );
-	Rgba8 innerColor = Rgba8( 255, 153, 51 );
-	for (int i = 0; i < NUM_SIDES; i++) {
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * radius, SinRadians( RADIANS_PER_SIDE * i ) * radius ), innerColor );
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * i ) * (radius + thickness) ), outerColor );
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * radius, SinRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * radius ), innerColor );
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * radius, SinRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * radius ), innerColor );
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * i ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * i ) * (radius + thickness) ), outerColor );
-		verts.emplace_back( Vec2( CosRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * (radius + thickness), SinRadians( RADIANS_PER_SIDE * ((i + 1) % NUM_SIDES) ) * (radius + thickness) ), outerColor );
+	m_verts.clear();
+	int numOfSlots = GetNumOfSlots();
+	for (int slot = 0; slot < numOfSlots; slot++) {
+		// dead projectiles are still drawn in the frame they die
+		if (m_states[slot] == SlotState::ALIVE || m_states[slot] == SlotState::DEAD) {
+			AddVertsForProjectile( slot );
+		}
 	}
-
-	AddVertsForDisc2D( verts, Vec2(), m_cosmeticRadius * 0.7f, Rgba8( 255, 255, 51 ) );
+	if (m_verts.empty()) {
+		return;
+	}
+	size_t dataSize = m_verts.size() * sizeof( Vertex_PCU );
+	if (m_vertexBuffer == nullptr) {
+		m_vertexBuffer = g_theRenderer->CreateVertexBuffer( dataSize );
+	}
+	g_theRenderer->CopyCPUToGPU( m_verts.data(), dataSize, m_vertexBuffer );
 	g_theRenderer->BindTexture( nullptr );
 	g_theRenderer->BindShader( nullptr );
 	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
+	g_theRenderer->SetModelConstants();
+	g_theRenderer->DrawVertexBuffer( m_vertexBuffer, (int)m_verts.size() );
 }
 
-void CoinBullet::Die( bool dieByCollision /*= true */ )
+void ProjectilePool::DebugRender() const
 {
-	UNUSED( dieByCollision );
-	m_isDead = true;
+	int numOfSlots = GetNumOfSlots();
+	for (int slot = 0; slot < numOfSlots; slot++) {
+		if (m_states[slot] != SlotState::FREE) {
+			m_projectiles[slot].DebugRender();
+		}
+	}
 }
 
-void CoinBullet::SpawnCollisionEffect()
+void ProjectilePool::Clear()
 {
-	ParticleSystem2DAddEmitter( 300, 0.05f, AABB2( m_position, m_position ),
-		FloatRange( m_cosmeticRadius * 0.6f, m_cosmeticRadius * 1.2f ),
-		AABB2( Vec2( -10.f, -10.f ), Vec2( 10.f, 10.f ) ),
-		FloatRange( 0.2f, 0.4f ), Rgba8( 255, 178, 102 ), Particle2DShape::Asteroid, true, FloatRange( 0.f, 360.f ),
-		FloatRange( 40.f, 75.f ), nullptr,
-		Rgba8( 255, 178, 102, 0 ) );
-
-	// return money
-	float rnd = GetRandGen()->RollRandomFloatZeroToOne();
-	if (rnd < 0.8f) {
-		g_theGame->SpawnEffectToGame( EffectType::Reward, m_position );
-	}
-	else {
-		g_theGame->SpawnEffectToGame( EffectType::Reward, m_position );
-		g_theGame->SpawnEffectToGame( EffectType::Reward, m_position );
+	int numOfSlots = GetNumOfSlots();
+	m_firstFreeSlot = 0;
+	m_numOfFreeSlots = numOfSlots;
+	for (int slot = 0; slot < numOfSlots; slot++) {
+		m_states[slot] = SlotState::FREE;
+		m_freeSlots[slot] = slot;
 	}
+	m_numOfAliveProjectiles = 0;
 }
 
-SharpenedObsidian::SharpenedObsidian( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile(def, startPos, startOrientation, startVelocity)
+int ProjectilePool::GetNumOfSlots() const
 {
-	m_physicsRadius = 0.3f;
-	m_cosmeticRadius = 0.8f;
-	m_damage = 1.f;
+	return (int)m_states.size();
 }
 
-SharpenedObsidian::~SharpenedObsidian()
+Projectile* ProjectilePool::GetProjectile( int slot ) const
 {
-
+	if (m_states[slot] == SlotState::FREE) {
+		return nullptr;
+	}
+	return &m_projectiles[slot];
 }
 
-void SharpenedObsidian::BeginPlay()
+int ProjectilePool::GetNumOfAliveProjectiles() const
 {
-
+	return m_numOfAliveProjectiles;
 }
 
-void SharpenedObsidian::Update( float deltaTime )
+void ProjectilePool::AddSlots( int numOfSlots )
 {
-	Projectile::Update( deltaTime );
-	if (g_theGame->m_worldCamera.m_cameraBox.IsPointInside( m_position )) {
-		m_position += m_velocity * deltaTime;
+	// only called with no free slot left, so the ring of free slots starts over at the front
+	int firstNewSlot = GetNumOfSlots();
+	int newNumOfSlots = firstNewSlot + numOfSlots;
+	m_positions.resize( newNumOfSlots );
+	m_velocities.resize( newNumOfSlots );
+	m_orientationDegrees.resize( newNumOfSlots, 0.f );
+	m_ages.resize( newNumOfSlots, 0.f );
+	m_lifeSeconds.resize( newNumOfSlots, 0.f );
+	m_factions.resize( newNumOfSlots, 0 );
+	m_types.resize( newNumOfSlots, ProjectileType::PlayerBullet );
+	m_states.resize( newNumOfSlots, SlotState::FREE );
+	m_projectiles.resize( newNumOfSlots );
+	m_freeSlots.resize( newNumOfSlots );
+	m_firstFreeSlot = 0;
+	m_numOfFreeSlots = numOfSlots;
+	for (int i = 0; i < numOfSlots; i++) {
+		m_freeSlots[i] = firstNewSlot + i;
 	}
 }
 
-void SharpenedObsidian::Render() const
+void ProjectilePool::AddVertsForProjectile( int slot ) const
 {
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 300 );
-
-	constexpr int NUM_OF_DEBRIS_VERTS = 48;
-	float randR[NUM_OF_DEBRIS_VERTS / 3];
-	for (int i = 0; i < NUM_OF_DEBRIS_VERTS / 3; i++) {
-		randR[i] = g_engineRNG->RollRandomFloatInRange( 0.8f * m_cosmeticRadius, 1.f * m_cosmeticRadius );
+	Projectile const& projectile = m_projectiles[slot];
+	ProjectileType type = m_types[slot];
+	Rgba8 tint = projectile.m_color;
+	float scale = 1.f;
+	size_t firstVert = m_verts.size();
+	if (type == ProjectileType::PlayerBullet) {
+		scale = projectile.m_scale;
+		if (projectile.m_isPoisonous && projectile.m_isIced) {
+			tint = Rgba8( 128, 128, 128 );
+		}
+		else if (projectile.m_isPoisonous) {
+			tint = Rgba8( 128, 255, 0 );
+		}
+		std::vector<Vertex_PCU> const& bulletVerts = (projectile.m_isIced && !projectile.m_isPoisonous) ? m_icedPlayerBulletVerts : m_typeVerts[(int)type];
+		m_verts.insert( m_verts.end(), bulletVerts.begin(), bulletVerts.end() );
 	}
-	for (int i = 0; i < NUM_OF_DEBRIS_VERTS / 3; i++) {
-		Vertex_PCU vert1, vert2, vert3;
-		vert1.m_position = Vec3( 0, 0, 0 );
-		vert1.m_color = Rgba8( 51, 0, 102 );
-		vert1.m_uvTexCoords = Vec2( 0, 0 );
-		vert2.m_position = Vec3( CosRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * i ) * randR[i], SinRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * i ) * randR[i], 0 );
-		vert2.m_color = Rgba8( 51, 0, 102 );
-		vert2.m_uvTexCoords = Vec2( 0, 0 );
-		vert3.m_position = Vec3( CosRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * (i + 1) ) * randR[(i + 1) % (NUM_OF_DEBRIS_VERTS / 3)], SinRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * (i + 1) ) * randR[(i + 1) % (NUM_OF_DEBRIS_VERTS / 3)], 0 );
-		vert3.m_color = Rgba8( 51, 0, 102 );
-		vert3.m_uvTexCoords = Vec2( 0, 0 );
-		verts.push_back( vert1 );
-		verts.push_back( vert2 );
-		verts.push_back( vert3 );
+	else if (type == ProjectileType::SharpenedObsidian) {
+		constexpr int NUM_OF_DEBRIS_VERTS = 48;
+		float randR[NUM_OF_DEBRIS_VERTS / 3];
+		for (int i = 0; i < NUM_OF_DEBRIS_VERTS / 3; i++) {
+			randR[i] = g_engineRNG->RollRandomFloatInRange( 0.8f * projectile.m_cosmeticRadius, 1.f * projectile.m_cosmeticRadius );
+		}
+		Rgba8 debrisColor = Rgba8( 51, 0, 102 );
+		for (int i = 0; i < NUM_OF_DEBRIS_VERTS / 3; i++) {
+			float nextR = randR[(i + 1) % (NUM_OF_DEBRIS_VERTS / 3)];
+			m_verts.emplace_back( Vec2( 0.f, 0.f ), debrisColor );
+			m_verts.emplace_back( Vec2( CosRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * i ) * randR[i], SinRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * i ) * randR[i] ), debrisColor );
+			m_verts.emplace_back( Vec2( CosRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * (i + 1) ) * nextR, SinRadians( 6 * PI / NUM_OF_DEBRIS_VERTS * (i + 1) ) * nextR ), debrisColor );
+		}
 	}
-
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
-}
-
-void SharpenedObsidian::Die( bool dieByCollision /*= true */ )
-{
-	UNUSED( dieByCollision );
-	m_isDead = true;
-}
-
-Arrow::Arrow( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation /*= 0.f*/, Vec2 const& startVelocity /*= Vec2() */ )
-	:Projectile( def, startPos, startOrientation, startVelocity )
-{
-	m_physicsRadius = 0.3f;
-	m_cosmeticRadius = 0.8f;
-	m_damage = 1.f;
-}
-
-Arrow::~Arrow()
-{
-
-}
-
-void Arrow::BeginPlay()
-{
-
-}
-
-void Arrow::Update( float deltaTime )
-{
-	Projectile::Update( deltaTime );
-	if (g_theGame->m_worldCamera.m_cameraBox.IsPointInside( m_position )) {
-		m_velocity += (Vec2( 0.f, -50.f ) * deltaTime);
-		m_orientationDegrees = m_velocity.GetOrientationDegrees();
-		m_position += m_velocity * deltaTime;
+	else {
+		if (type == ProjectileType::DemonBullet || type == ProjectileType::EnemyBullet || type == ProjectileType::CoinBullet) {
+			scale = projectile.m_cosmeticRadius;
+		}
+		std::vector<Vertex_PCU> const& typeVerts = m_typeVerts[(int)type];
+		m_verts.insert( m_verts.end(), typeVerts.begin(), typeVerts.end() );
 	}
-}
-
-void Arrow::Render() const
-{
-	std::vector<Vertex_PCU> verts;
-	verts.reserve( 30 );
-	
-	AddVertsForAABB2D( verts, AABB2( Vec2( -3.f * m_cosmeticRadius, -0.5f * m_cosmeticRadius ), Vec2( 0.f, 0.5f * m_cosmeticRadius ) ), Rgba8( 102, 51, 0 ) );
-	verts.emplace_back( Vec2( 0.f, m_cosmeticRadius ), Rgba8( 224, 224, 224 ) );
-	verts.emplace_back( Vec2( 0.f, -m_cosmeticRadius ), Rgba8( 224, 224, 224 ) );
-	verts.emplace_back( Vec2( 0.5f * m_cosmeticRadius, 0.f ), Rgba8( 224, 224, 224 ) );
 
-	g_theRenderer->BindTexture( nullptr );
-	g_theRenderer->BindShader( nullptr );
-	g_theRenderer->SetBlendMode( BlendMode::ALPHA );
-	g_theRenderer->SetModelConstants( GetModelMatrix(), m_color );
-	g_theRenderer->DrawVertexArray( verts );
-}
-
-void Arrow::Die( bool dieByCollision /*= true */ )
-{
-	UNUSED( dieByCollision );
-	m_isDead = true;
+	int numOfVerts = (int)(m_verts.size() - firstVert);
+	TransformVertexArrayXY3D( numOfVerts, &m_verts[firstVert], scale, m_orientationDegrees[slot], m_positions[slot] );
+	if (!(tint == Rgba8::WHITE)) {
+		for (size_t i = firstVert; i < m_verts.size(); i++) {
+			m_verts[i].m_color = GetTintedColor( m_verts[i].m_color, tint );
+		}
+	}
 }
-
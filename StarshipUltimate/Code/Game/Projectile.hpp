@@ -1,57 +1,77 @@
 #pragma once
 #include "Game/GameCommon.hpp"
+#include "Engine/Math/Curves.hpp"
+#include <deque>
+
+enum class ProjectileType : unsigned char {
+	PlayerBullet,
+	Shuriken,
+	Rocket,
+	DemonBullet,
+	EnemyBullet,
+	CurveMissile,
+	CoinBullet,
+	SharpenedObsidian,
+	Arrow,
+	NUM
+};
 
 struct ProjectileDefinition {
 	float m_lifeSeconds = 1.5f;
 	float m_speed = 60.f;
 	std::string m_name = "Bullet";
+	ProjectileType m_type = ProjectileType::PlayerBullet;
 	float m_damageModifier = 1.f;
 	float m_damageRange = 0.f;
 	float m_rangeDamageModifier = 1.f;
+	float m_physicsRadius = 0.5f;
+	float m_cosmeticRadius = 0.5f;
 
 	ProjectileDefinition();
 	ProjectileDefinition( XmlElement* xmlIter );
 	static void SetUpProjectileDefinitions();
 	static std::vector<ProjectileDefinition> s_definitions;
 	static ProjectileDefinition const& GetDefinition( std::string const& name );
+	static ProjectileType GetTypeByName( std::string const& name );
 };
 
+class ProjectilePool;
 
+//-----------------------------------------------------------------------------------------------
+// One projectile in a ProjectilePool, behaviour is picked by the type of its definition
+// Position, velocity, orientation, life time and faction live in the pool's arrays, the rest lives here
+// A projectile stays valid until the frame after it dies, do not keep the pointer longer than the frame it is spawned in
 class Projectile {
+	friend class ProjectilePool;
 public:
-	Projectile( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~Projectile();
+	Projectile();
 
-	virtual void BeginPlay() = 0;
-	virtual void Update( float deltaTime );
-	virtual void Render() const = 0;
-	virtual void Die( bool dieByCollision = true ) = 0;
-	virtual void SpawnCollisionEffect();
-	virtual void DebugRender() const;
+	/// Set up a missile after m_targetPosition and m_goUp are set, or a rocket after its damage is set
+	void BeginPlay();
+	void Die( bool dieByCollision = true );
+	void SpawnCollisionEffect();
+	void DebugRender() const;
 
 	Vec2 GetForwardNormal() const;
 	bool IsAlive() const;
-
-protected:
-	Mat44 GetModelMatrix() const;
+	ProjectileType GetType() const;
+
+	Vec2 const& GetPosition() const;
+	void SetPosition( Vec2 const& position );
+	Vec2 const& GetVelocity() const;
+	void SetVelocity( Vec2 const& velocity );
+	float GetOrientationDegrees() const;
+	float GetLifeSeconds() const;
+	void SetLifeSeconds( float lifeSeconds );
+	FactionID GetFaction() const;
+	void SetFaction( FactionID faction );
 
 public:
-	Vec2 m_position; // the Entitys 2D( x, y ) Cartesian origin / center location, in world space
-	Vec2 m_velocity; // the Entitys linear 2D( x, y ) velocity, in world units per second
-	float m_orientationDegrees; // its forward direction angle, in degrees( counter - clock.from + x / east )
-	Vec2 m_accelerateVelocity;
-	float m_angularVelocity; // the Entitys signed angular velocity( spin rate ), in degrees per second
-	float m_physicsRadius; // the Entitys( inner, conservative ) disc - radius for all physics purposes
-	float m_cosmeticRadius; // the Entitys( outer, liberal ) disc - radius that encloses all of its vertexes
-	float m_health; // how many hits the entity can sustain before dying
-	float m_maxHealth;
-	bool m_isDead = false; // whether the Entity is dead in the game; affects entityand game logic
-	bool m_isGarbage = false; // whether the Entity should be deleted at the end of Game::Update()
-	ProjectileDefinition const& m_def;
+	ProjectileDefinition const* m_def = nullptr;
+	float m_physicsRadius = 0.5f; // the projectile's( inner, conservative ) disc - radius for all physics purposes
+	float m_cosmeticRadius = 0.5f; // the projectile's( outer, liberal ) disc - radius that encloses all of its vertexes
 	Rgba8 m_color = Rgba8( 255, 255, 255 );
-	float m_mass = 1.f;
 	float m_damage = 1.f;
-	float m_rangeDamage = 1.f;
 
 	bool m_isPuncturing = false;
 	bool m_hasRangeDamage = false;
@@ -64,114 +84,73 @@ public:
 
 	float m_scale = 1.f;
 
-	VertexBuffer* m_vertexBuffer = nullptr;
-	Timer* m_lifeTimer;
-
-	std::string m_faction;
-
 	bool m_addDamageByLifeTime = false;
-};
-
-class Shuriken : public Projectile {
-public:
-	Shuriken( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~Shuriken();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-};
-
-class Rocket : public Projectile {
-public:
-	Rocket( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~Rocket();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-
-	virtual void SpawnCollisionEffect() override;
-};
-
-class DemonBullet :public Projectile {
-public:
-	DemonBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~DemonBullet();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-
-	virtual void SpawnCollisionEffect() override;
-};
-
-class EnemyBullet : public Projectile {
-public:
-	EnemyBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~EnemyBullet();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-
-	virtual void SpawnCollisionEffect() override;
-};
-
-class CurveMissile : public Projectile {
-public:
-	CurveMissile( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~CurveMissile();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-
-	virtual void SpawnCollisionEffect() override;
 
+	// curve missile
 	CubicBezierCurve2D m_curve;
 	Vec2 m_targetPosition;
 	bool m_goUp = false;
-	Vec2 m_lastFramePos;
 	float m_distance = 0.f;
-};
-
-class CoinBullet : public Projectile {
-public:
-	CoinBullet( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~CoinBullet();
 
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-
-	virtual void SpawnCollisionEffect() override;
+private:
+	ProjectilePool* m_pool = nullptr;
+	int m_slot = -1;
 };
 
-class SharpenedObsidian : public Projectile {
+//-----------------------------------------------------------------------------------------------
+// Every projectile of the game in one set of arrays, one slot per projectile
+// Slots of projectiles that died are reused oldest first, so shooting does not allocate once the pool is warm
+// and a new projectile takes a long freed address, entities remember damage sources by address
+// Update moves every projectile in one loop and Render draws all of them from one vertex buffer
+class ProjectilePool {
+	friend class Projectile;
 public:
-	SharpenedObsidian( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~SharpenedObsidian();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
+	ProjectilePool();
+	~ProjectilePool();
+
+	Projectile* SpawnProjectile( ProjectileDefinition const& def, Vec2 const& position, float orientationDegrees, Vec2 const& velocity );
+	void Update( float deltaSeconds );
+	/// Free the slots of projectiles that died before this frame's update
+	void RemoveGarbageProjectiles();
+	void Render() const;
+	void DebugRender() const;
+	void Clear();
+
+	/// Slots are numbered from 0 to GetNumOfSlots() - 1 and keep their number for the life of the pool
+	int GetNumOfSlots() const;
+	/// nullptr for a free slot, dead projectiles are returned until their slot is freed
+	Projectile* GetProjectile( int slot ) const;
+	int GetNumOfAliveProjectiles() const;
+
+private:
+	enum class SlotState : unsigned char { FREE, ALIVE, DEAD, GARBAGE };
+
+	void AddSlots( int numOfSlots );
+	void AddVertsForProjectile( int slot ) const;
+
+private:
+	// one entry per slot
+	std::vector<Vec2> m_positions;
+	std::vector<Vec2> m_velocities;
+	std::vector<float> m_orientationDegrees;
+	std::vector<float> m_ages;
+	std::vector<float> m_lifeSeconds;
+	std::vector<FactionID> m_factions;
+	std::vector<ProjectileType> m_types;
+	std::vector<SlotState> m_states;
+	// a deque so the projectiles do not move when slots are added
+	mutable std::deque<Projectile> m_projectiles;
+
+	// free slots as a ring, taken from the front and given back at the end
+	std::vector<int> m_freeSlots;
+	int m_firstFreeSlot = 0;
+	int m_numOfFreeSlots = 0;
+	int m_numOfAliveProjectiles = 0;
+
+	// shapes of every type in local space, drawn with the projectile's position, orientation and scale
+	// disc shaped types are built with radius 1 and scaled by the projectile's cosmetic radius
+	std::vector<Vertex_PCU> m_typeVerts[(int)ProjectileType::NUM];
+	std::vector<Vertex_PCU> m_icedPlayerBulletVerts;
+	mutable std::vector<Vertex_PCU> m_verts;
+	mutable VertexBuffer* m_vertexBuffer = nullptr;
 };
-
-class Arrow : public Projectile {
-public:
-	Arrow( ProjectileDefinition const& def, Vec2 const& startPos, float startOrientation = 0.f, Vec2 const& startVelocity = Vec2() );
-	virtual ~Arrow();
-
-	virtual void BeginPlay();
-	virtual void Update( float deltaTime );
-	virtual void Render() const;
-	virtual void Die( bool dieByCollision = true );
-};
\ No newline at end of file
@@ -35,7 +35,7 @@ Projectile* BulletGun::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	//float actualSpeed = DotProduct2D( m_owner->m_velocity, normal ) + m_projectileDef.m_speed;
 	Projectile* projectile = g_theGame->SpawnProjectileToGame( GetProjectileDef(), startPos, forwardVec.GetOrientationDegrees(), forwardVec * GetProjectileDef().m_speed );
-	projectile->m_faction = m_owner->m_def.m_faction;
+	projectile->SetFaction( m_owner->m_def.m_factionID );
 	projectile->m_damage = m_owner->GetMainWeaponDamage();
 	return projectile;
 }
@@ -54,8 +54,8 @@ RayShooter::~RayShooter()
 Projectile* RayShooter::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	Vec2 endPos;
-	StarshipRayCastResult res1 = g_theGame->RayCastVsEntities( startPos + forwardVec.GetRotated90Degrees() * m_owner->m_physicsRadius * 0.5f, forwardVec, 50.f, m_owner, "Player", m_weaponDef.m_canTriggerReflection );
-	StarshipRayCastResult res2 = g_theGame->RayCastVsEntities( startPos + forwardVec.GetRotatedMinus90Degrees() * m_owner->m_physicsRadius * 0.5f, forwardVec, 50.f, m_owner, "Player", m_weaponDef.m_canTriggerReflection );
+	StarshipRayCastResult res1 = g_theGame->RayCastVsEntities( startPos + forwardVec.GetRotated90Degrees() * m_owner->m_physicsRadius * 0.5f, forwardVec, 50.f, m_owner, FACTION_ID_PLAYER, m_weaponDef.m_canTriggerReflection );
+	StarshipRayCastResult res2 = g_theGame->RayCastVsEntities( startPos + forwardVec.GetRotatedMinus90Degrees() * m_owner->m_physicsRadius * 0.5f, forwardVec, 50.f, m_owner, FACTION_ID_PLAYER, m_weaponDef.m_canTriggerReflection );
 	if (res1.m_didImpact && res2.m_didImpact) {
 		if (res1.m_impactDist < res2.m_impactDist) {
 			if (res1.m_entityHit->m_controller && res1.m_entityHit->m_controller->IsPlayer()) {
@@ -195,7 +195,7 @@ RocketShooter::~RocketShooter()
 Projectile* RocketShooter::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	Projectile* projectile = g_theGame->SpawnProjectileToGame( GetProjectileDef(), startPos, m_owner->m_orientationDegrees, forwardVec * GetProjectileDef().m_speed );
-	projectile->m_faction = m_owner->m_def.m_faction;
+	projectile->SetFaction( m_owner->m_def.m_factionID );
 	projectile->m_damage = m_owner->GetMainWeaponDamage();
 	projectile->BeginPlay();
 	return projectile;
@@ -216,7 +216,7 @@ Projectile* EnemyBulletGun::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	//float actualSpeed = DotProduct2D( m_owner->m_velocity, normal ) + m_projectileDef.m_speed;
 	Projectile* projectile = g_theGame->SpawnProjectileToGame( GetProjectileDef(), startPos, forwardVec.GetOrientationDegrees(), forwardVec * GetProjectileDef().m_speed );
-	projectile->m_faction = m_owner->m_def.m_faction;
+	projectile->SetFaction( m_owner->m_def.m_factionID );
 	projectile->m_damage = m_owner->GetMainWeaponDamage();
 	return projectile;
 }
@@ -236,7 +236,7 @@ Projectile* MissileGun::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	UNUSED( forwardVec );
 	Projectile* projectile = g_theGame->SpawnProjectileToGame( GetProjectileDef(), startPos, 0.f );
-	projectile->m_faction = m_owner->m_def.m_faction;
+	projectile->SetFaction( m_owner->m_def.m_factionID );
 	projectile->m_damage = m_owner->GetMainWeaponDamage();
 	return projectile;
 }
@@ -257,7 +257,7 @@ Projectile* Spray::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 		SectorSprayAttack* effect = (SectorSprayAttack*)g_theGame->SpawnEffectToGame( EffectType::SectorSprayAttack, startPos );
 		effect->m_forwardDegrees = forwardVec.GetOrientationDegrees();
 		effect->m_rangeDegrees = m_sectorRangeDegrees;
-		effect->m_faction = m_owner->m_def.m_faction;
+		effect->m_faction = m_owner->m_def.m_factionID;
 		effect->m_damage = m_owner->GetMainWeaponDamage();
 		effect->m_dist = m_length;
 		effect->m_isPoisonous = m_isPoisonous;
@@ -267,7 +267,7 @@ Projectile* Spray::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 		SprayAttack* effect = (SprayAttack*)g_theGame->SpawnEffectToGame( EffectType::SprayAttack, startPos );
 		effect->m_boundingBox.m_center = startPos;
 		effect->m_boundingBox.m_iBasisNormal = forwardVec;
-		effect->m_faction = m_owner->m_def.m_faction;
+		effect->m_faction = m_owner->m_def.m_factionID;
 		effect->m_damage = m_owner->GetMainWeaponDamage();
 		effect->m_width = m_owner->m_cosmeticRadius * 2.f;
 		effect->m_dist = m_length;
@@ -292,7 +292,7 @@ CoinGun::~CoinGun()
 Projectile* CoinGun::Fire( Vec2 const& forwardVec, Vec2 const& startPos )
 {
 	Projectile* projectile = g_theGame->SpawnProjectileToGame( GetProjectileDef(), startPos, forwardVec.GetOrientationDegrees(), forwardVec * GetProjectileDef().m_speed );
-	projectile->m_faction = m_owner->m_def.m_faction;
+	projectile->SetFaction( m_owner->m_def.m_factionID );
 	projectile->m_damage = m_owner->GetMainWeaponDamage();
 	return projectile;
 }